@@ -123,6 +123,13 @@ end
 -- Pre-process line, determining stripped text, karaoke data and splitting off furigana data
 -- Modifies the object passed for line
 function karaskel.preproc_line_text(meta, styles, line)
+	-- Use the native implementation of all of this when it's available
+	if aegisub.karaskel_layout then
+		line.kara = nil
+		aegisub.karaskel_layout(line)
+		return
+	end
+
 	-- Assume line is class=dialogue
 	local kara = aegisub.parse_karaoke_data(line)
 	line.kara = { n = 0 }
@@ -268,6 +275,19 @@ function karaskel.preproc_line_size(meta, styles, line)
 		line.styleref = styles[1]
 	end
 	
+	if styles[line.style .. "-furigana"] then
+		line.furistyle = styles[line.style .. "-furigana"]
+	else
+		aegisub.debug.out(4, "No furigana style defined for style '%s'\n", line.style)
+		line.furistyle = false
+	end
+	
+	-- The native implementation measures everything in one go
+	if aegisub.karaskel_layout then
+		aegisub.karaskel_layout(line, line.styleref, line.furistyle, meta.video_x_correct_factor)
+		return
+	end
+	
 	-- Calculate whole line sizing
 	line.width, line.height, line.descent, line.extlead = aegisub.text_extents(line.styleref, line.text_stripped)
 	line.width = line.width * meta.video_x_correct_factor
@@ -283,12 +303,6 @@ function karaskel.preproc_line_size(meta, styles, line)
 	end
 	
 	-- Calculate furigana sizing
-	if styles[line.style .. "-furigana"] then
-		line.furistyle = styles[line.style .. "-furigana"]
-	else
-		aegisub.debug.out(4, "No furigana style defined for style '%s'\n", line.style)
-		line.furistyle = false
-	end
 	if line.furistyle then
 		for f = 1, line.furi.n do
 			local furi = line.furi[f]
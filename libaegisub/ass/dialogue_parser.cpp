@@ -18,6 +18,8 @@
 
 #include "libaegisub/spellchecker.h"
 
+#include <algorithm>
+
 #include <boost/locale/boundary/index.hpp>
 #include <boost/locale/boundary/segment.hpp>
 #include <boost/locale/boundary/types.hpp>
@@ -29,6 +31,33 @@ using namespace agi::ass;
 namespace dt = DialogueTokenType;
 namespace ss = SyntaxStyle;
 
+/// Get the style of a token
+/// @param prev_style Style of the preceding token, or NORMAL if there is none
+int TokenStyle(DialogueToken tok, int prev_style, std::string const& text, size_t pos, agi::SpellChecker *spellchecker) {
+	switch (tok.type) {
+		case dt::KARAOKE_TEMPLATE: return ss::KARAOKE_TEMPLATE;
+		case dt::KARAOKE_VARIABLE: return ss::KARAOKE_VARIABLE;
+		case dt::LINE_BREAK: return ss::LINE_BREAK;
+		case dt::ERROR:      return ss::ERROR;
+		case dt::ARG:        return ss::PARAMETER;
+		case dt::COMMENT:    return ss::COMMENT;
+		case dt::DRAWING:    return ss::DRAWING;
+		case dt::TEXT:       return ss::NORMAL;
+		case dt::TAG_NAME:   return ss::TAG;
+		case dt::OPEN_PAREN: case dt::CLOSE_PAREN: case dt::ARG_SEP: case dt::TAG_START:
+			return ss::PUNCTUATION;
+		case dt::OVR_BEGIN: case dt::OVR_END:
+			return ss::OVERRIDE;
+		case dt::WHITESPACE:
+			return prev_style == ss::PARAMETER ? ss::PARAMETER : ss::NORMAL;
+		case dt::WORD:
+			if (spellchecker && !spellchecker->CheckWord(text.substr(pos, tok.length)))
+				return ss::SPELLING;
+			return ss::NORMAL;
+	}
+	return ss::NORMAL;
+}
+
 class SyntaxHighlighter {
 	TokenVec ranges;
 	std::string const& text;
@@ -53,36 +82,8 @@ public:
 		size_t pos = 0;
 
 		for (auto tok : tokens) {
-			switch (tok.type) {
-				case dt::KARAOKE_TEMPLATE: SetStyling(tok.length, ss::KARAOKE_TEMPLATE); break;
-				case dt::KARAOKE_VARIABLE: SetStyling(tok.length, ss::KARAOKE_VARIABLE); break;
-				case dt::LINE_BREAK: SetStyling(tok.length, ss::LINE_BREAK); break;
-				case dt::ERROR:      SetStyling(tok.length, ss::ERROR);      break;
-				case dt::ARG:        SetStyling(tok.length, ss::PARAMETER);  break;
-				case dt::COMMENT:    SetStyling(tok.length, ss::COMMENT);    break;
-				case dt::DRAWING:    SetStyling(tok.length, ss::DRAWING);    break;
-				case dt::TEXT:       SetStyling(tok.length, ss::NORMAL);     break;
-				case dt::TAG_NAME:   SetStyling(tok.length, ss::TAG);        break;
-				case dt::OPEN_PAREN: case dt::CLOSE_PAREN: case dt::ARG_SEP: case dt::TAG_START:
-					SetStyling(tok.length, ss::PUNCTUATION);
-					break;
-				case dt::OVR_BEGIN: case dt::OVR_END:
-					SetStyling(tok.length, ss::OVERRIDE);
-					break;
-				case dt::WHITESPACE:
-					if (ranges.size() && ranges.back().type == ss::PARAMETER)
-						SetStyling(tok.length, ss::PARAMETER);
-					else
-						SetStyling(tok.length, ss::NORMAL);
-					break;
-				case dt::WORD:
-					if (spellchecker && !spellchecker->CheckWord(text.substr(pos, tok.length)))
-						SetStyling(tok.length, ss::SPELLING);
-					else
-						SetStyling(tok.length, ss::NORMAL);
-					break;
-			}
-
+			int prev_style = ranges.empty() ? ss::NORMAL : ranges.back().type;
+			SetStyling(tok.length, TokenStyle(tok, prev_style, text, pos, spellchecker));
 			pos += tok.length;
 		}
 
@@ -93,7 +94,7 @@ public:
 class WordSplitter {
 	std::string const& text;
 	std::vector<DialogueToken> &tokens;
-	size_t pos = 0;
+	size_t pos;
 
 	void SwitchTo(size_t &i, int type, size_t len) {
 		auto old = tokens[i];
@@ -119,9 +120,11 @@ class WordSplitter {
 	}
 
 public:
-	WordSplitter(std::string const& text, std::vector<DialogueToken> &tokens)
+	/// @param pos Position in text of the first token
+	WordSplitter(std::string const& text, std::vector<DialogueToken> &tokens, size_t pos = 0)
 	: text(text)
 	, tokens(tokens)
+	, pos(pos)
 	{ }
 
 	void SplitWords() {
@@ -214,5 +217,97 @@ void SplitWords(std::string const& str, std::vector<DialogueToken> &tokens) {
 	WordSplitter(str, tokens).SplitWords();
 }
 
+std::pair<size_t, size_t> DialogueHighlighter::Update(std::string const& new_text, bool new_karaoke_templater, SpellChecker *spellchecker, size_t unchanged_prefix, size_t unchanged_suffix) {
+	auto new_lexed = TokenizeDialogueBody(new_text, new_karaoke_templater);
+	MarkDrawings(new_text, new_lexed);
+
+	// Find the bytes at each end of the line which are the same as before
+	size_t prefix = 0, suffix = 0;
+	if (new_karaoke_templater == karaoke_templater) {
+		size_t limit = std::min({text.size(), new_text.size(), unchanged_prefix});
+		while (prefix < limit && text[prefix] == new_text[prefix])
+			++prefix;
+
+		limit = std::min(std::min(text.size(), new_text.size()) - prefix, unchanged_suffix);
+		while (suffix < limit && text[text.size() - suffix - 1] == new_text[new_text.size() - suffix - 1])
+			++suffix;
+	}
+
+	// Lexed tokens which lie entirely within the unchanged bytes split into
+	// the same words with the same spellings as before, so their results
+	// can be reused. Everything in between has to be redone.
+	auto same = [](DialogueToken a, DialogueToken b) { return a.type == b.type && a.length == b.length; };
+
+	size_t first = 0, begin = 0, first_split = 0;
+	while (first < lexed.size() && first < new_lexed.size() && same(lexed[first], new_lexed[first]) && begin + lexed[first].length <= prefix) {
+		begin += lexed[first].length;
+		first_split += split_counts[first];
+		++first;
+	}
+
+	size_t last = 0, end_len = 0, last_split = 0;
+	while (first + last < lexed.size() && first + last < new_lexed.size()) {
+		auto old_tok = lexed[lexed.size() - last - 1];
+		if (!same(old_tok, new_lexed[new_lexed.size() - last - 1]) || end_len + old_tok.length > suffix)
+			break;
+		end_len += old_tok.length;
+		last_split += split_counts[lexed.size() - last - 1];
+		++last;
+	}
+
+	std::vector<size_t> new_counts(split_counts.begin(), split_counts.begin() + first);
+	TokenVec new_tokens(tokens.begin(), tokens.begin() + first_split);
+	TokenVec new_styles(styles.begin(), styles.begin() + first_split);
+
+	size_t pos = begin;
+	int prev_style = new_styles.empty() ? ss::NORMAL : new_styles.back().type;
+	for (size_t i = first; i < new_lexed.size() - last; ++i) {
+		TokenVec split{new_lexed[i]};
+		if (split[0].type == dt::TEXT)
+			WordSplitter(new_text, split, pos).SplitWords();
+		new_counts.push_back(split.size());
+
+		for (auto tok : split) {
+			prev_style = TokenStyle(tok, prev_style, new_text, pos, spellchecker);
+			new_tokens.push_back(tok);
+			new_styles.push_back(DialogueToken{prev_style, tok.length});
+			pos += tok.length;
+		}
+	}
+
+	// Whitespace is styled based on what comes before it, so any at the
+	// start of the reused tokens may have changed style
+	bool leading = true;
+	for (size_t i = tokens.size() - last_split; i < tokens.size(); ++i) {
+		auto style = styles[i];
+		if (leading && tokens[i].type == dt::WHITESPACE) {
+			style.type = prev_style = TokenStyle(tokens[i], prev_style, new_text, pos, spellchecker);
+			pos += tokens[i].length;
+		}
+		else
+			leading = false;
+		new_tokens.push_back(tokens[i]);
+		new_styles.push_back(style);
+	}
+	new_counts.insert(new_counts.end(), split_counts.end() - last, split_counts.end());
+
+	text = new_text;
+	karaoke_templater = new_karaoke_templater;
+	lexed = std::move(new_lexed);
+	split_counts = std::move(new_counts);
+	tokens = std::move(new_tokens);
+	styles = std::move(new_styles);
+
+	return {begin, pos};
+}
+
+void DialogueHighlighter::Reset() {
+	text.clear();
+	lexed.clear();
+	split_counts.clear();
+	tokens.clear();
+	styles.clear();
+}
+
 }
 }
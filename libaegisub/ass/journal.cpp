@@ -0,0 +1,342 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "libaegisub/ass/journal.h"
+
+#include "libaegisub/exception.h"
+#include "libaegisub/fs.h"
+#include "libaegisub/io.h"
+#include "libaegisub/make_unique.h"
+
+#include <boost/crc.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <unordered_map>
+
+namespace {
+/// Identifies journal files; bump the final digit when the format changes
+const char journal_magic[8] = {'A', 'G', 'I', 'J', 'R', 'N', 'L', '1'};
+
+enum Op : char {
+	OP_INFO = 1,
+	OP_STYLES,
+	OP_EXTRADATA,
+	OP_CLEAR_EVENTS,
+	OP_REMOVE_EVENT,
+	OP_SET_EVENT
+};
+
+// All integers are stored little-endian regardless of platform so that
+// journals can be recovered on a different machine
+void put_u32(std::string& out, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+void put_str(std::string& out, std::string const& str) {
+	put_u32(out, str.size());
+	out += str;
+}
+
+void put_lines(std::string& out, Op op, std::vector<std::string> const& lines) {
+	out += op;
+	put_u32(out, lines.size());
+	for (auto const& line : lines)
+		put_str(out, line);
+}
+
+uint32_t checksum(const char *data, size_t size) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+
+/// Get the size and checksum which precede a record
+std::string record_header(std::string const& data) {
+	std::string header;
+	put_u32(header, data.size());
+	put_u32(header, checksum(data.data(), data.size()));
+	return header;
+}
+
+/// Reads values out of a record, noting if it runs past the end
+struct reader {
+	const char *pos;
+	const char *end;
+	bool ok = true;
+
+	reader(const char *begin, const char *end) : pos(begin), end(end) { }
+
+	uint32_t u32() {
+		if (end - pos < 4) {
+			ok = false;
+			return 0;
+		}
+		uint32_t value = 0;
+		for (int i = 0; i < 4; ++i)
+			value |= static_cast<uint32_t>(static_cast<unsigned char>(pos[i])) << (i * 8);
+		pos += 4;
+		return value;
+	}
+
+	std::string str() {
+		uint32_t size = u32();
+		if (!ok || static_cast<size_t>(end - pos) < size) {
+			ok = false;
+			return std::string();
+		}
+		std::string ret(pos, size);
+		pos += size;
+		return ret;
+	}
+
+	std::vector<std::string> lines() {
+		std::vector<std::string> ret;
+		uint32_t count = u32();
+		for (uint32_t i = 0; ok && i < count; ++i)
+			ret.push_back(str());
+		return ret;
+	}
+};
+
+bool read_u32(std::istream& in, uint32_t& value) {
+	char buf[4];
+	if (!in.read(buf, 4)) return false;
+	value = reader(buf, buf + 4).u32();
+	return true;
+}
+
+/// Dialogue lines being replayed
+///
+/// Each line only knows which line comes before it, as only the lines whose
+/// predecessor changed are recorded and so the lines after a moved line must
+/// not move with it. The order is only put together once everything has
+/// been replayed.
+class event_list {
+	std::unordered_map<int, std::pair<int, std::string>> lines;
+
+public:
+	void clear() {
+		lines.clear();
+	}
+
+	void remove(int id) {
+		lines.erase(id);
+	}
+
+	void set(int id, int prev_id, std::string line) {
+		lines[id] = std::make_pair(prev_id, std::move(line));
+	}
+
+	std::vector<std::pair<int, std::string>> get() {
+		std::unordered_map<int, int> next;
+		next.reserve(lines.size());
+		for (auto const& line : lines)
+			next.emplace(line.second.first, line.first);
+
+		std::vector<std::pair<int, std::string>> ret;
+		ret.reserve(lines.size());
+		for (auto it = next.find(0); it != next.end(); it = next.find(it->second)) {
+			auto line = lines.find(it->second);
+			// A damaged journal could have a cycle
+			if (line == lines.end()) break;
+			ret.emplace_back(line->first, std::move(line->second.second));
+			lines.erase(line);
+		}
+
+		// Shouldn't happen, but keep any lines which didn't end up in the
+		// chain rather than dropping them
+		std::map<int, std::string> orphans;
+		for (auto& line : lines)
+			orphans.emplace(line.first, std::move(line.second.second));
+		for (auto& line : orphans)
+			ret.emplace_back(line.first, std::move(line.second));
+		lines.clear();
+
+		return ret;
+	}
+};
+
+/// A single decoded operation from a record
+struct operation {
+	Op op;
+	int id = 0;
+	int prev_id = 0;
+	std::string line;
+	std::vector<std::string> lines;
+};
+
+/// Decode every operation in a record
+/// @return false if the record is malformed
+bool decode(reader r, std::vector<operation>& ops) {
+	ops.clear();
+	while (r.ok && r.pos < r.end) {
+		operation op;
+		op.op = static_cast<Op>(*r.pos++);
+		switch (op.op) {
+			case OP_INFO:
+			case OP_STYLES:
+			case OP_EXTRADATA:
+				op.lines = r.lines();
+				break;
+			case OP_CLEAR_EVENTS:
+				break;
+			case OP_REMOVE_EVENT:
+				op.id = static_cast<int32_t>(r.u32());
+				break;
+			case OP_SET_EVENT:
+				op.id = static_cast<int32_t>(r.u32());
+				op.prev_id = static_cast<int32_t>(r.u32());
+				op.line = r.str();
+				break;
+			default:
+				return false;
+		}
+		ops.push_back(std::move(op));
+	}
+	return r.ok;
+}
+
+/// Apply the operations of a record which has been fully decoded, so that
+/// a malformed record never leaves the state partially updated
+void apply(std::vector<operation>& ops, agi::ass::JournalState& state, event_list& events) {
+	for (auto& op : ops) {
+		switch (op.op) {
+			case OP_INFO:
+				state.info = std::move(op.lines);
+				break;
+			case OP_STYLES:
+				state.styles = std::move(op.lines);
+				break;
+			case OP_EXTRADATA:
+				state.extradata = std::move(op.lines);
+				break;
+			case OP_CLEAR_EVENTS:
+				events.clear();
+				break;
+			case OP_REMOVE_EVENT:
+				events.remove(op.id);
+				break;
+			case OP_SET_EVENT:
+				events.set(op.id, op.prev_id, std::move(op.line));
+				break;
+		}
+	}
+}
+}
+
+namespace agi { namespace ass {
+void JournalRecord::SetInfo(std::vector<std::string> const& lines) {
+	put_lines(data, OP_INFO, lines);
+}
+
+void JournalRecord::SetStyles(std::vector<std::string> const& lines) {
+	put_lines(data, OP_STYLES, lines);
+}
+
+void JournalRecord::SetExtradata(std::vector<std::string> const& lines) {
+	put_lines(data, OP_EXTRADATA, lines);
+}
+
+void JournalRecord::ClearEvents() {
+	data += OP_CLEAR_EVENTS;
+}
+
+void JournalRecord::RemoveEvent(int id) {
+	data += OP_REMOVE_EVENT;
+	put_u32(data, id);
+}
+
+void JournalRecord::SetEvent(int id, int prev_id, std::string const& line) {
+	data += OP_SET_EVENT;
+	put_u32(data, id);
+	put_u32(data, prev_id);
+	put_str(data, line);
+}
+
+JournalWriter::JournalWriter(agi::fs::path const& path, std::string const& source, JournalRecord const& checkpoint)
+: path(path)
+{
+	std::string header(journal_magic, sizeof(journal_magic));
+	put_str(header, source);
+
+	{
+		io::Save file(path, true);
+		auto& out = file.Get();
+		out.write(header.data(), header.size());
+		header = record_header(checkpoint.data);
+		out.write(header.data(), header.size());
+		out.write(checkpoint.data.data(), checkpoint.data.size());
+		file.Commit();
+	}
+
+	out = agi::make_unique<boost::filesystem::ofstream>(path, std::ios::binary | std::ios::app);
+	if (!out->good())
+		throw fs::WriteDenied(path);
+	size = fs::Size(path);
+}
+
+JournalWriter::~JournalWriter() { }
+
+void JournalWriter::Write(JournalRecord const& record) {
+	if (record.empty()) return;
+
+	auto header = record_header(record.data);
+	out->write(header.data(), header.size());
+	out->write(record.data.data(), record.data.size());
+	out->flush();
+	if (!out->good())
+		throw fs::WriteDenied(path);
+	size += header.size() + record.data.size();
+}
+
+JournalState ReadJournal(std::istream& in) {
+	char magic[sizeof(journal_magic)];
+	if (!in.read(magic, sizeof(magic)) || memcmp(magic, journal_magic, sizeof(magic)))
+		throw InvalidInputException("Not a journal file");
+
+	JournalState state;
+	uint32_t size;
+	if (!read_u32(in, size) || size > (1u << 16))
+		throw InvalidInputException("Damaged journal file");
+	state.source.resize(size);
+	if (size && !in.read(&state.source[0], size))
+		throw InvalidInputException("Damaged journal file");
+
+	event_list events;
+	std::vector<char> record;
+	std::vector<operation> ops;
+	uint32_t crc;
+	while (read_u32(in, size) && read_u32(in, crc)) {
+		// A damaged size could be anything, so don't trust it too much
+		if (size > (1u << 30)) break;
+		record.resize(size);
+		if (size && !in.read(record.data(), size)) break;
+		if (checksum(record.data(), size) != crc) break;
+		if (!decode(reader(record.data(), record.data() + size), ops)) break;
+		apply(ops, state, events);
+	}
+
+	state.events = events.get();
+	return state;
+}
+
+JournalState ReadJournal(agi::fs::path const& path) {
+	return ReadJournal(*io::Open(path, true));
+}
+} }
@@ -21,7 +21,96 @@
 #include "libaegisub/log.h"
 #include "libaegisub/util.h"
 
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Samples are log-scaled so that quiet passages are still visible, with 127
+// steps from silence to full scale on each side of zero
+const double log_steps = 127 / std::log2(32769.0);
+}
+
 namespace agi {
+AudioChannelSummary::AudioChannelSummary(int channels, int64_t num_samples, int sample_rate)
+: channels(channels)
+, sample_rate(sample_rate)
+, blocks((num_samples + block_size - 1) / block_size)
+, peaks(new std::atomic<uint8_t>[static_cast<size_t>(blocks * channels * 2)])
+{
+	for (int64_t i = 0; i < blocks * channels; ++i) {
+		peaks[i * 2].store(255, std::memory_order_relaxed);
+		peaks[i * 2 + 1].store(0, std::memory_order_relaxed);
+	}
+}
+
+uint8_t AudioChannelSummary::Encode(int16_t sample) {
+	int magnitude = static_cast<int>(std::log2(1.0 + std::abs(static_cast<int>(sample))) * log_steps + 0.5);
+	magnitude = std::min(magnitude, 127);
+	return static_cast<uint8_t>(sample < 0 ? 128 - magnitude : 128 + magnitude);
+}
+
+int16_t AudioChannelSummary::Decode(uint8_t value) {
+	int magnitude = std::abs(value - 128);
+	int sample = std::min(static_cast<int>(std::exp2(magnitude / log_steps) - 1.0 + 0.5), 32767);
+	return static_cast<int16_t>(value < 128 ? -sample : sample);
+}
+
+void AudioChannelSummary::Add(const int16_t *buf, int64_t start, int64_t count) {
+	if (start < 0) {
+		buf -= start * channels;
+		count += start;
+		start = 0;
+	}
+	count = std::min(count, blocks * block_size - start);
+
+	std::vector<int16_t> min(channels), max(channels);
+	while (count > 0) {
+		int64_t block = start / block_size;
+		int64_t len = std::min(count, (block + 1) * block_size - start);
+
+		std::fill(begin(min), end(min), INT16_MAX);
+		std::fill(begin(max), end(max), INT16_MIN);
+		for (int64_t i = 0; i < len; ++i) {
+			for (int c = 0; c < channels; ++c) {
+				int16_t sample = *buf++;
+				min[c] = std::min(min[c], sample);
+				max[c] = std::max(max[c], sample);
+			}
+		}
+
+		// Only one thread ever decodes a given provider's audio at a time, so
+		// merging with what's already there doesn't need to be atomic
+		auto peak = &peaks[block * channels * 2];
+		for (int c = 0; c < channels; ++c) {
+			uint8_t lo = Encode(min[c]), hi = Encode(max[c]);
+			if (lo < peak[c * 2].load(std::memory_order_relaxed))
+				peak[c * 2].store(lo, std::memory_order_relaxed);
+			if (hi > peak[c * 2 + 1].load(std::memory_order_relaxed))
+				peak[c * 2 + 1].store(hi, std::memory_order_relaxed);
+		}
+
+		start += len;
+		count -= len;
+	}
+}
+
+bool AudioChannelSummary::GetPeaks(int channel, int64_t start, int64_t count, int16_t &min, int16_t &max) const {
+	int64_t first = std::max<int64_t>(start, 0) / block_size;
+	int64_t last = std::min((start + count - 1) / block_size, blocks - 1);
+
+	uint8_t lo = 255, hi = 0;
+	for (int64_t block = first; block <= last; ++block) {
+		auto peak = &peaks[(block * channels + channel) * 2];
+		lo = std::min(lo, peak[0].load(std::memory_order_relaxed));
+		hi = std::max(hi, peak[1].load(std::memory_order_relaxed));
+	}
+
+	if (lo > hi) return false;
+	min = Decode(lo);
+	max = Decode(hi);
+	return true;
+}
+
 void AudioProvider::GetAudioWithVolume(void *buf, int64_t start, int64_t count, double volume) const {
 	GetAudio(buf, start, count);
 
@@ -92,6 +181,10 @@ public:
 		out.write(data.data(), data.size());
 	}
 
+	void commit() {
+		outfile.Commit();
+	}
+
 	template<typename Dest, typename Src>
 	void write(Src v) {
 		auto converted = static_cast<Dest>(v);
@@ -133,5 +226,6 @@ void SaveAudioClip(AudioProvider const& provider, fs::path const& path, int star
 		provider.GetAudio(&buf[0], i, spr);
 		out.write(buf);
 	}
+	out.commit();
 }
 }
@@ -106,13 +106,37 @@ public:
 	}
 };
 
+/// Records the peaks of each channel of 16-bit audio as it passes through,
+/// so that they're still available after the audio is mixed down
+class ChannelSummaryAudioProvider final : public AudioProviderWrapper {
+	std::shared_ptr<AudioChannelSummary> summary;
+
+public:
+	ChannelSummaryAudioProvider(std::unique_ptr<AudioProvider> src)
+	: AudioProviderWrapper(std::move(src))
+	, summary(std::make_shared<AudioChannelSummary>(channels, num_samples, sample_rate))
+	{
+		channel_summary = summary;
+	}
+
+	void FillBuffer(void *buf, int64_t start, int64_t count) const override {
+		source->GetAudio(buf, start, count);
+		summary->Add(static_cast<const int16_t *>(buf), start, count);
+	}
+};
+
 /// Non-mono 16-bit signed machine-endian -> mono 16-bit signed machine endian converter
 class DownmixAudioProvider final : public AudioProviderWrapper {
 	int src_channels;
+	/// Channel to keep, or -1 to average them all
+	int channel;
 	mutable std::vector<int16_t> src_buf;
 
 public:
-	DownmixAudioProvider(std::unique_ptr<AudioProvider> src) : AudioProviderWrapper(std::move(src)) {
+	DownmixAudioProvider(std::unique_ptr<AudioProvider> src, int channel)
+	: AudioProviderWrapper(std::move(src))
+	, channel(channel < channels ? channel : -1)
+	{
 		src_channels = channels;
 		channels = 1;
 	}
@@ -125,6 +149,12 @@ public:
 		source->GetAudio(&src_buf[0], start, count);
 
 		auto dst = static_cast<int16_t*>(buf);
+		if (channel >= 0) {
+			while (count-- > 0)
+				dst[count] = src_buf[count * src_channels + channel];
+			return;
+		}
+
 		// Just average the channels together
 		while (count-- > 0) {
 			int sum = 0;
@@ -173,7 +203,7 @@ public:
 }
 
 namespace agi {
-std::unique_ptr<AudioProvider> CreateConvertAudioProvider(std::unique_ptr<AudioProvider> provider) {
+std::unique_ptr<AudioProvider> CreateConvertAudioProvider(std::unique_ptr<AudioProvider> provider, int channel) {
 	// Ensure 16-bit audio with proper endianness
 	if (provider->AreSamplesFloat()) {
 		LOG_D("audio_provider") << "Converting float to S16";
@@ -187,10 +217,12 @@ std::unique_ptr<AudioProvider> CreateConvertAudioProvider(std::unique_ptr<AudioP
 		provider = agi::make_unique<BitdepthConvertAudioProvider<int16_t>>(std::move(provider));
 	}
 
-	// We currently only support mono audio
+	// Everything after this point only supports mono audio, so keep just
+	// enough of the original channels to display them
 	if (provider->GetChannels() != 1) {
 		LOG_D("audio_provider") << "Downmixing to mono from " << provider->GetChannels() << " channels";
-		provider = agi::make_unique<DownmixAudioProvider>(std::move(provider));
+		provider = agi::make_unique<ChannelSummaryAudioProvider>(std::move(provider));
+		provider = agi::make_unique<DownmixAudioProvider>(std::move(provider), channel);
 	}
 
 	// Some players don't like low sample rate audio
@@ -0,0 +1,191 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "libaegisub/audio/provider.h"
+
+#include "libaegisub/make_unique.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+using namespace agi;
+
+/// Number of samples decoded at a time by the background thread. Reads which
+/// miss the buffer have to wait for the chunk in progress to finish before
+/// they can use the source, so this bounds how long they can be kept waiting.
+const int64_t chunk_samples = 4096;
+
+class DecodeAheadAudioProvider final : public AudioProviderWrapper {
+	/// Guards the ring buffer bookkeeping
+	mutable std::mutex mutex;
+	/// Guards the source provider, which is not safe to use from two threads
+	mutable std::mutex source_mutex;
+	mutable std::condition_variable wake_decoder;
+	/// Signalled whenever the decoder finishes a chunk
+	mutable std::condition_variable chunk_done;
+	/// Is the decoder currently decoding the samples following the buffered ones?
+	bool in_flight = false;
+	bool cancelled = false;
+	/// Set if decoding on the background thread failed, after which all reads
+	/// go directly to the source
+	bool failed = false;
+	std::thread decoder;
+
+	/// Size in bytes of one sample for all channels
+	const int64_t frame_size;
+	/// Size of the ring buffer in samples
+	const int64_t capacity;
+	/// Decoded audio immediately following the end of the most recent read
+	mutable std::vector<char> ring;
+	/// Sample number of the first sample in the ring buffer
+	mutable int64_t ring_start = 0;
+	/// Number of decoded samples in the ring buffer
+	mutable int64_t ring_count = 0;
+	/// Position in the ring buffer of ring_start
+	mutable int64_t ring_head = 0;
+	/// Incremented whenever the ring buffer is moved to a new position, so
+	/// that a chunk decoded for the old position is not added to it
+	mutable uint64_t generation = 0;
+
+	void Discard(int64_t count) const {
+		ring_head = (ring_head + count) % capacity;
+		ring_start += count;
+		ring_count -= count;
+	}
+
+	void FillBuffer(void *buf, int64_t start, int64_t count) const override;
+	void Decode();
+
+public:
+	DecodeAheadAudioProvider(std::unique_ptr<AudioProvider> src, int64_t window)
+	: AudioProviderWrapper(std::move(src))
+	, frame_size(bytes_per_sample * channels)
+	, capacity(std::max<int64_t>(window, chunk_samples))
+	, ring(capacity * frame_size)
+	{
+		decoder = std::thread([&] { Decode(); });
+	}
+
+	~DecodeAheadAudioProvider() {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cancelled = true;
+		}
+		wake_decoder.notify_one();
+		decoder.join();
+	}
+};
+
+void DecodeAheadAudioProvider::Decode() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!cancelled) {
+		const int64_t end = ring_start + ring_count;
+		if (ring_count == capacity || end >= num_samples) {
+			wake_decoder.wait(lock);
+			continue;
+		}
+
+		// Reserve the free space after the buffered samples, stopping at the
+		// end of the buffer rather than splitting the read. Reads only ever
+		// consume buffered samples, so nothing else touches this region while
+		// it is decoded into with the lock released.
+		const int64_t tail = (ring_head + ring_count) % capacity;
+		const int64_t count = std::min({chunk_samples, capacity - ring_count, capacity - tail, num_samples - end});
+		const uint64_t reserved_generation = generation;
+		in_flight = true;
+
+		lock.unlock();
+		try {
+			std::lock_guard<std::mutex> source_lock(source_mutex);
+			source->GetAudio(&ring[tail * frame_size], end, count);
+		}
+		catch (...) {
+			// Nothing on this thread can report the error, so stop decoding
+			// ahead and leave reads to decode directly from the source, which
+			// will fail in the same way on the caller's thread
+			lock.lock();
+			failed = true;
+			in_flight = false;
+			ring_count = 0;
+			chunk_done.notify_all();
+			return;
+		}
+		lock.lock();
+
+		// The buffer may have been moved elsewhere while decoding
+		in_flight = false;
+		if (generation == reserved_generation)
+			ring_count += count;
+		chunk_done.notify_all();
+	}
+}
+
+void DecodeAheadAudioProvider::FillBuffer(void *buf, int64_t start, int64_t count) const {
+	auto out = static_cast<char *>(buf);
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			if (start >= ring_start && start < ring_start + ring_count) {
+				// Contiguous with (or overlapping) the previous read, so serve
+				// as much as possible from the buffer
+				Discard(start - ring_start);
+				while (count > 0 && ring_count > 0) {
+					const int64_t read = std::min({count, ring_count, capacity - ring_head});
+					memcpy(out, &ring[ring_head * frame_size], read * frame_size);
+					Discard(read);
+					out += read * frame_size;
+					start += read;
+					count -= read;
+				}
+			}
+
+			// A sequential read which has caught up with the decoder waits
+			// for the chunk being decoded at its position rather than
+			// throwing it away and decoding the same samples again
+			if (count == 0 || failed || start != ring_start || !in_flight)
+				break;
+			chunk_done.wait(lock);
+		}
+
+		// For a jump the buffer is moved to follow the new position
+		if (!failed && start + count != ring_start) {
+			ring_start = start + count;
+			ring_count = 0;
+			ring_head = 0;
+			++generation;
+		}
+	}
+
+	// Anything not buffered is decoded directly, as before. For a contiguous
+	// read the source is already positioned here.
+	if (count > 0) {
+		std::lock_guard<std::mutex> source_lock(source_mutex);
+		source->GetAudio(out, start, count);
+	}
+	wake_decoder.notify_one();
+}
+}
+
+namespace agi {
+std::unique_ptr<AudioProvider> CreateDecodeAheadAudioProvider(std::unique_ptr<AudioProvider> src, int64_t window) {
+	return agi::make_unique<DecodeAheadAudioProvider>(std::move(src), window);
+}
+}
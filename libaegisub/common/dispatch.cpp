@@ -18,48 +18,203 @@
 
 #include "libaegisub/util.h"
 
-#include <atomic>
-#include <boost/asio/io_service.hpp>
-#include <boost/asio/strand.hpp>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <thread>
 
 namespace {
-	boost::asio::io_service *service;
-	std::function<void (agi::dispatch::Thunk)> invoke_main;
+	using namespace agi::dispatch;
+	typedef std::chrono::steady_clock clock;
+
+	std::function<void (Thunk)> invoke_main;
 	std::atomic<uint_fast32_t> threads_running;
 
-	class MainQueue final : public agi::dispatch::Queue {
-		void DoInvoke(agi::dispatch::Thunk thunk) override {
-			invoke_main(thunk);
-		}
+	struct PriorityStats {
+		std::atomic<size_t> depth{0};
+		std::atomic<uint64_t> started{0};
+		std::atomic<int64_t> total_wait{0};
+		std::atomic<int64_t> max_wait{0};
 	};
+	PriorityStats stats[PRIORITY_COUNT];
 
-	class BackgroundQueue final : public agi::dispatch::Queue {
-		void DoInvoke(agi::dispatch::Thunk thunk) override {
-			service->post(thunk);
+	/// A thunk along with what's needed to track how long it waited to start
+	struct Task {
+		Thunk thunk;
+		Priority priority = PRIORITY_NORMAL;
+		clock::time_point queued;
+		/// Should this task be counted in the stats for its priority?
+		bool tracked = false;
+
+		Task() { }
+		Task(Thunk thunk, Priority priority, bool tracked = true)
+		: thunk(std::move(thunk)), priority(priority), queued(clock::now()), tracked(tracked)
+		{
+			if (tracked)
+				++stats[priority].depth;
 		}
-	};
 
-	class SerialQueue final : public agi::dispatch::Queue {
-		boost::asio::io_service::strand strand;
+		void operator()() {
+			if (tracked)
+				Record();
+			thunk();
+		}
 
-		void DoInvoke(agi::dispatch::Thunk thunk) override {
-			strand.post(thunk);
+		void Record() {
+			auto& s = stats[priority];
+			int64_t wait = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - queued).count();
+			--s.depth;
+			++s.started;
+			s.total_wait += wait;
+			int64_t max_wait = s.max_wait;
+			while (max_wait < wait && !s.max_wait.compare_exchange_weak(max_wait, wait)) ;
 		}
-	public:
-		SerialQueue() : strand(*service) { }
 	};
 
-	struct IOServiceThreadPool {
-		boost::asio::io_service io_service;
-		std::unique_ptr<boost::asio::io_service::work> work;
+	/// A pool of worker threads, each with its own deque of tasks for each
+	/// priority. Workers run the tasks they queued themselves newest first,
+	/// and when they run out take the oldest tasks queued from outside the
+	/// pool, and then steal the oldest tasks from the other workers.
+	class ThreadPool {
+		struct Worker {
+			std::mutex lock;
+			std::deque<Task> tasks[PRIORITY_COUNT];
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
 		std::vector<std::thread> threads;
 
-		IOServiceThreadPool() : work(new boost::asio::io_service::work(io_service)) { }
-		~IOServiceThreadPool() {
-			work.reset();
+		/// Tasks queued from threads which aren't part of the pool
+		std::mutex injected_lock;
+		std::deque<Task> injected[PRIORITY_COUNT];
+
+		/// Number of tasks of each priority in any of the queues
+		std::atomic<size_t> pending[PRIORITY_COUNT];
+		/// Number of workers currently running PRIORITY_BACKGROUND tasks
+		std::atomic<size_t> background_running{0};
+
+		std::mutex idle_lock;
+		std::condition_variable idle_cv;
+		/// Signalled when a place in the limit on running background tasks is
+		/// released, for background tasks waiting to get theirs back
+		std::condition_variable background_cv;
+		std::atomic<bool> stopping{false};
+
+		/// The worker running on the current thread, if any
+		static thread_local Worker *current;
+		/// Is the current thread a worker running a PRIORITY_BACKGROUND task?
+		static thread_local bool running_background;
+
+		bool PopFront(std::mutex& lock, std::deque<Task>& queue, Task *out) {
+			std::lock_guard<std::mutex> l(lock);
+			if (queue.empty()) return false;
+			*out = std::move(queue.front());
+			queue.pop_front();
+			return true;
+		}
+
+		bool PopBack(std::mutex& lock, std::deque<Task>& queue, Task *out) {
+			std::lock_guard<std::mutex> l(lock);
+			if (queue.empty()) return false;
+			*out = std::move(queue.back());
+			queue.pop_back();
+			return true;
+		}
+
+		bool PopAny(size_t self, int p, Task *out) {
+			if (PopBack(workers[self]->lock, workers[self]->tasks[p], out)) return true;
+			if (PopFront(injected_lock, injected[p], out)) return true;
+			for (size_t i = 1; i < workers.size(); ++i) {
+				auto& victim = *workers[(self + i) % workers.size()];
+				if (PopFront(victim.lock, victim.tasks[p], out)) return true;
+			}
+			return false;
+		}
+
+		/// Find a task to run. A PRIORITY_BACKGROUND task is only returned
+		/// with a place in the limit on running background tasks already
+		/// claimed for it.
+		bool FindTask(size_t self, Task *out) {
+			for (int p = PRIORITY_COUNT - 1; p > PRIORITY_BACKGROUND; --p) {
+				if (PopAny(self, p, out)) return true;
+			}
+
+			if (!ReserveBackground()) return false;
+			if (PopAny(self, PRIORITY_BACKGROUND, out)) return true;
+			ReleaseBackground();
+			return false;
+		}
+
+		/// Keep one worker free for anything more urgent than background
+		/// work, except when shutting down
+		bool CanRunBackground() const {
+			return stopping || background_running + 1 < workers.size();
+		}
+
+		/// Claim a place in the limit on running background tasks, checking
+		/// the limit and counting the new task in a single step so that two
+		/// workers can't both take the last place
+		bool ReserveBackground() {
+			size_t running = background_running;
+			do {
+				if (!stopping && running + 1 >= workers.size())
+					return false;
+			} while (!background_running.compare_exchange_weak(running, running + 1));
+			return true;
+		}
+
+		void ReleaseBackground() {
+			{
+				std::lock_guard<std::mutex> l(idle_lock);
+				--background_running;
+			}
+			// Background work may have been skipped while the place was held
+			idle_cv.notify_one();
+			background_cv.notify_one();
+		}
+
+		bool HasRunnableTask() const {
+			for (int p = PRIORITY_BACKGROUND + 1; p < PRIORITY_COUNT; ++p) {
+				if (pending[p]) return true;
+			}
+			return pending[PRIORITY_BACKGROUND] && CanRunBackground();
+		}
+
+		void Run(size_t self) {
+			current = workers[self].get();
+			Task task;
+
+			while (true) {
+				if (FindTask(self, &task)) {
+					--pending[task.priority];
+					bool background = task.priority == PRIORITY_BACKGROUND;
+					running_background = background;
+					task();
+					task.thunk = nullptr;
+					running_background = false;
+					if (background)
+						ReleaseBackground();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> l(idle_lock);
+				if (stopping && !HasRunnableTask()) break;
+				idle_cv.wait(l, [&]{ return stopping || HasRunnableTask(); });
+			}
+		}
+
+	public:
+		ThreadPool() {
+			for (auto& count : pending) count = 0;
+		}
+
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> l(idle_lock);
+				stopping = true;
+			}
+			idle_cv.notify_all();
+			background_cv.notify_all();
 #ifndef _WIN32
 			for (auto& thread : threads) thread.join();
 #else
@@ -69,25 +224,183 @@ namespace {
 			while (threads_running) std::this_thread::yield();
 #endif
 		}
+
+		void Start(size_t thread_count) {
+			for (size_t i = 0; i < thread_count; ++i)
+				workers.emplace_back(new Worker);
+			threads.reserve(thread_count);
+			for (size_t i = 0; i < thread_count; ++i) {
+				threads.emplace_back([=]{
+					++threads_running;
+					agi::util::SetThreadName("Dispatch Worker");
+					Run(i);
+					--threads_running;
+				});
+			}
+		}
+
+		void Post(Task task) {
+			auto priority = task.priority;
+			{
+				auto& lock = current ? current->lock : injected_lock;
+				auto& queue = current ? current->tasks[priority] : injected[priority];
+				std::lock_guard<std::mutex> l(lock);
+				{
+					// The count has to go up before the task can be taken
+					// from the queue, and taking the lock ensures that a
+					// worker can't miss it between checking for work and
+					// going to sleep
+					std::lock_guard<std::mutex> idle(idle_lock);
+					++pending[priority];
+				}
+				queue.push_back(std::move(task));
+			}
+			idle_cv.notify_one();
+		}
+
+		/// Called when the current thread is about to block waiting for other
+		/// work. A background task waiting on other background work gives up
+		/// its place in the limit on running background tasks while it waits,
+		/// as otherwise enough of them could leave nothing able to run the
+		/// work they're waiting for.
+		void BeginWait() {
+			if (running_background)
+				ReleaseBackground();
+		}
+
+		/// Called when the current thread has finished waiting. A background
+		/// task reclaims its place in the limit the same way a new one would,
+		/// blocking until one is free rather than going over the limit.
+		void EndWait() {
+			if (!running_background) return;
+			std::unique_lock<std::mutex> l(idle_lock);
+			background_cv.wait(l, [&]{ return ReserveBackground(); });
+		}
+
+		/// Is the current thread one of the pool's workers?
+		static bool OnWorker() { return current != nullptr; }
+	};
+
+	thread_local ThreadPool::Worker *ThreadPool::current = nullptr;
+	thread_local bool ThreadPool::running_background = false;
+
+	ThreadPool *pool;
+
+	class MainQueue final : public Queue {
+		void DoInvoke(Thunk thunk) override {
+			invoke_main(thunk);
+		}
+	};
+
+	class BackgroundQueue final : public Queue {
+		Priority priority;
+
+		void DoInvoke(Thunk thunk) override {
+			pool->Post(Task(std::move(thunk), priority));
+		}
+
+		/// Thunks on this queue may run in any order, so a worker waiting on
+		/// one may as well run it itself rather than tie up a second worker
+		/// (or, if all of them are waiting, deadlock)
+		bool TryRunInline(Thunk const& thunk) override {
+			if (!ThreadPool::OnWorker()) return false;
+			thunk();
+			return true;
+		}
+	public:
+		BackgroundQueue(Priority priority) : priority(priority) { }
+	};
+
+	/// Thunks for a serial queue, which are run one at a time and in order by
+	/// only having a task in the pool while there are thunks waiting. This is
+	/// shared with the queued task so that it outlives the queue if needed.
+	class SerialTasks final : public std::enable_shared_from_this<SerialTasks> {
+		Priority priority;
+		std::mutex lock;
+		std::deque<Task> tasks;
+		bool running = false;
+
+		void Schedule() {
+			auto self = shared_from_this();
+			pool->Post(Task([=] { self->RunOne(); }, priority, false));
+		}
+
+		void RunOne() {
+			Task task;
+			{
+				std::lock_guard<std::mutex> l(lock);
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+
+			task();
+			Finish();
+		}
+
+		void Finish() {
+			std::lock_guard<std::mutex> l(lock);
+			if (tasks.empty())
+				running = false;
+			else
+				Schedule();
+		}
+
+	public:
+		SerialTasks(Priority priority) : priority(priority) { }
+
+		/// Run the thunk on the calling thread if nothing else is queued or
+		/// running, holding off anything pushed meanwhile until it's done
+		bool TryRunInline(Thunk const& thunk) {
+			{
+				std::lock_guard<std::mutex> l(lock);
+				if (running) return false;
+				running = true;
+			}
+
+			try {
+				thunk();
+			}
+			catch (...) {
+				Finish();
+				throw;
+			}
+			Finish();
+			return true;
+		}
+
+		void Push(Thunk thunk) {
+			std::lock_guard<std::mutex> l(lock);
+			tasks.emplace_back(std::move(thunk), priority);
+			if (!running) {
+				running = true;
+				Schedule();
+			}
+		}
+	};
+
+	class SerialQueue final : public Queue {
+		std::shared_ptr<SerialTasks> tasks;
+
+		void DoInvoke(Thunk thunk) override {
+			tasks->Push(std::move(thunk));
+		}
+
+		bool TryRunInline(Thunk const& thunk) override {
+			return ThreadPool::OnWorker() && tasks->TryRunInline(thunk);
+		}
+	public:
+		SerialQueue(Priority priority) : tasks(std::make_shared<SerialTasks>(priority)) { }
 	};
 }
 
 namespace agi { namespace dispatch {
 
 void Init(std::function<void (Thunk)> invoke_main) {
-	static IOServiceThreadPool thread_pool;
-	::service = &thread_pool.io_service;
+	static ThreadPool thread_pool;
+	::pool = &thread_pool;
 	::invoke_main = invoke_main;
 
-	thread_pool.threads.reserve(std::max<unsigned>(4, std::thread::hardware_concurrency()));
-	for (size_t i = 0; i < thread_pool.threads.capacity(); ++i) {
-		thread_pool.threads.emplace_back([]{
-			++threads_running;
-			agi::util::SetThreadName("Dispatch Worker");
-			service->run();
-			--threads_running;
-		});
-	}
+	thread_pool.Start(std::max<unsigned>(4, std::thread::hardware_concurrency()));
 }
 
 void Queue::Async(Thunk thunk) {
@@ -102,7 +415,17 @@ void Queue::Async(Thunk thunk) {
 	});
 }
 
+void Queue::Async(Thunk thunk, CancellationToken token) {
+	Async([=] {
+		if (!token.IsCancelled())
+			thunk();
+	});
+}
+
 void Queue::Sync(Thunk thunk) {
+	if (TryRunInline(thunk))
+		return;
+
 	std::mutex m;
 	std::condition_variable cv;
 	std::unique_lock<std::mutex> l(m);
@@ -119,7 +442,9 @@ void Queue::Sync(Thunk thunk) {
 		done = true;
 		cv.notify_all();
 	});
+	if (pool) pool->BeginWait();
 	cv.wait(l, [&]{ return done; });
+	if (pool) pool->EndWait();
 	if (e) std::rethrow_exception(e);
 }
 
@@ -128,13 +453,27 @@ Queue& Main() {
 	return q;
 }
 
-Queue& Background() {
-	static BackgroundQueue q;
-	return q;
+Queue& Background(Priority priority) {
+	static BackgroundQueue queues[] = {
+		BackgroundQueue(PRIORITY_BACKGROUND),
+		BackgroundQueue(PRIORITY_NORMAL),
+		BackgroundQueue(PRIORITY_INTERACTIVE)
+	};
+	return queues[priority];
+}
+
+std::unique_ptr<Queue> Create(Priority priority) {
+	return std::unique_ptr<Queue>(new SerialQueue(priority));
 }
 
-std::unique_ptr<Queue> Create() {
-	return std::unique_ptr<Queue>(new SerialQueue);
+QueueStats GetStats(Priority priority) {
+	auto const& s = stats[priority];
+	QueueStats ret;
+	ret.depth = s.depth;
+	ret.started = s.started;
+	ret.total_wait = std::chrono::microseconds(s.total_wait);
+	ret.max_wait = std::chrono::microseconds(s.max_wait);
+	return ret;
 }
 
 } }
@@ -192,6 +192,7 @@ void Hotkey::Flush() {
 
 	io::Save file(config_file);
 	JsonWriter::Write(root, file.Get());
+	file.Commit();
 }
 
 void Hotkey::UpdateStrMap() {
@@ -56,11 +56,25 @@ Save::Save(fs::path const& file, bool binary)
 	}
 }
 
-Save::~Save() noexcept(false) {
+Save::~Save() {
+	if (committed) return;
+
+	fp.reset(); // Need to close before removing on Windows to unlock the file
+	LOG_D("agi/io/save/file") << "Discarding " << tmp_name << " as it was never committed";
+	boost::system::error_code ec;
+	boost::filesystem::remove(tmp_name, ec);
+}
+
+void Save::Commit() {
+	fp->flush();
+	if (!fp->good())
+		throw fs::WriteDenied(tmp_name);
 	fp.reset(); // Need to close before rename on Windows to unlock the file
+
 	for (int i = 0; i < 10; ++i) {
 		try {
 			fs::Rename(tmp_name, file_name);
+			committed = true;
 			return;
 		}
 		catch (agi::fs::FileSystemError const&) {
@@ -47,28 +47,109 @@ bool is_whitespace(std::string const& str) {
 	return true;
 }
 
-// strcmp but ignoring case and accents
-int compare(std::string const& a, std::string const& b) {
-	using namespace boost::locale;
-	return std::use_facet<collator<char>>(std::locale()).compare(collator_base::primary, a, b);
 }
 
+namespace agi {
+namespace {
+typedef boost::locale::collator<char> collator;
+
+/// Length in bytes of the first character of a non-empty string, including
+/// any combining marks which follow it
+size_t first_character_length(std::string const& str) {
+	size_t end = 0;
+	next_codepoint(str.c_str(), &end);
+	while (end < str.size()) {
+		size_t next = end;
+		if (!u_hasBinaryProperty(next_codepoint(str.c_str(), &next), UCHAR_GRAPHEME_EXTEND))
+			break;
+		end = next;
+	}
+	return end;
 }
 
-namespace agi {
+struct source_syllable {
+	std::string text;
+	std::string lower;
+	bool whitespace;
+};
+
+std::vector<source_syllable> prepare_source(std::vector<std::string> const& source_strings) {
+	std::vector<source_syllable> source;
+	source.reserve(source_strings.size());
+	for (auto const& syl : source_strings)
+		source.push_back(source_syllable{syl, boost::to_lower_copy(syl), is_whitespace(syl)});
+	return source;
+}
 
-karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_strings, std::string const& dest_string) {
-	karaoke_match_result result = { 0, 0 };
-	if (source_strings.empty()) return result;
+struct destination_character {
+	size_t offset;
+	size_t length;
+	bool whitespace;
+	/// Romanizations of this character followed by the next one, and then of
+	/// this character alone
+	std::vector<const char *> romaji;
+};
+
+/// The destination string split into characters, with everything which the
+/// matcher needs to know about each character looked up once rather than
+/// once per syllable
+class destination {
+	std::string const& str;
+	std::vector<destination_character> chars;
+
+public:
+	destination(std::string const& str) : str(str) {
+		using namespace boost::locale::boundary;
+		ssegment_index index(character, begin(str), end(str));
+		for (auto const& chr : index) {
+			size_t offset = std::distance(str.begin(), chr.begin());
+			chars.push_back(destination_character{offset, chr.length(), is_whitespace(chr.str()), {}});
+		}
 
-	using namespace boost::locale::boundary;
+		for (size_t i = 0; i < chars.size(); ++i) {
+			if (i + 1 < chars.size())
+				boost::copy(kana_to_romaji(this->str.substr(chars[i].offset, chars[i].length + chars[i + 1].length)), back_inserter(chars[i].romaji));
+			boost::copy(kana_to_romaji(this->str.substr(chars[i].offset, chars[i].length)), back_inserter(chars[i].romaji));
+		}
+	}
+
+	size_t size() const { return chars.size(); }
+	destination_character const& operator[](size_t i) const { return chars[i]; }
+	/// The rest of the string starting at the given character
+	const char *data(size_t i) const { return str.c_str() + chars[i].offset; }
+	std::string str_at(size_t i) const { return str.substr(chars[i].offset, chars[i].length); }
+	/// The characters in the range [first, last)
+	std::string substr(size_t first, size_t last) const {
+		if (first == last) return "";
+		size_t end = last == chars.size() ? str.size() : chars[last].offset;
+		return str.substr(chars[first].offset, end - chars[first].offset);
+	}
+};
+
+struct match_step {
+	karaoke_match_result result;
+	double confidence;
+};
+
+// How much each of the ways a syllable can be matched is trusted
+const double exact_confidence = 1.0;
+const double last_character_confidence = 0.9;
+const double next_syllable_confidence = 0.9;
+const double divided_confidence = 0.6;
+const double fallback_confidence = 0.3;
+
+match_step match_syllable(std::vector<source_syllable> const& source_strings, size_t src_begin, destination const& dest, size_t dst_begin, collator const& coll) {
 	using boost::starts_with;
 
+	match_step step = { { 0, 0 }, exact_confidence };
+	auto& result = step.result;
+	const size_t src_count = source_strings.size() - src_begin;
+	if (!src_count) return step;
+
 	result.source_length = 1;
-	ssegment_index destination_characters(character, begin(dest_string), end(dest_string));
-	auto src = boost::to_lower_copy(source_strings[0]);
-	auto dst = destination_characters.begin();
-	auto dst_end = destination_characters.end();
+	auto src = source_strings[src_begin].lower;
+	size_t dst = dst_begin;
+	const size_t dst_end = dest.size();
 
 	// Eat all the whitespace at the beginning of the source and destination
 	// syllables and exit if either ran out.
@@ -79,7 +160,7 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 		if (first_non_whitespace)
 			src = src.substr(first_non_whitespace);
 
-		while (dst != dst_end && is_whitespace(dst->str())) {
+		while (dst != dst_end && dest[dst].whitespace) {
 			++dst;
 			++result.destination_length;
 		}
@@ -87,14 +168,17 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 		// If we ran out of dest then this needs to match the rest of the
 		// source syllables (this probably means the user did something wrong)
 		if (dst == dst_end) {
-			result.source_length = source_strings.size();
+			result.source_length = src_count;
+			if (!src.empty() || !std::all_of(source_strings.begin() + src_begin + 1, source_strings.end(),
+			                                 [](source_syllable const& syl) { return syl.whitespace; }))
+				step.confidence = 0;
 			return true;
 		}
 
 		return src.empty();
 	};
 
-	if (eat_whitespace()) return result;
+	if (eat_whitespace()) return step;
 
 	// We now have a non-whitespace character at the beginning of both source
 	// and destination. Check if the source starts with a romanized kana, and
@@ -102,21 +186,22 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 	// character. If it does, match them and repeat.
 	while (!src.empty()) {
 		// First check for a basic match of the first character of the source and dest
-		auto first_src_char = ssegment_index(character, begin(src), end(src)).begin()->str();
-		if (compare(first_src_char, dst->str()) == 0) {
+		size_t first_src_char = first_character_length(src);
+		if (coll.compare(collator::primary, src.data(), src.data() + first_src_char,
+		                 dest.data(dst), dest.data(dst) + dest[dst].length) == 0) {
 			++dst;
 			++result.destination_length;
-			src.erase(0, first_src_char.size());
-			if (eat_whitespace()) return result;
+			src.erase(0, first_src_char);
+			if (eat_whitespace()) return step;
 			continue;
 		}
 
 		auto check = [&](kana_pair const& kp) -> bool {
-			if (!starts_with(&*dst->begin(), kp.kana)) return false;
+			if (!starts_with(dest.data(dst), kp.kana)) return false;
 
 			src = src.substr(strlen(kp.romaji));
 			for (size_t i = 0; kp.kana[i]; ) {
-				i += dst->length();
+				i += dest[dst].length;
 				++result.destination_length;
 				++dst;
 			}
@@ -126,7 +211,7 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 		bool matched = false;
 		for (auto const& match : romaji_to_kana(src)) {
 			if (check(match)) {
-				if (eat_whitespace()) return result;
+				if (eat_whitespace()) return step;
 				matched = true;
 				break;
 			}
@@ -137,10 +222,11 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 	// Source and dest are now non-empty and start with non-whitespace.
 	// If there's only one character left in the dest, it obviously needs to
 	// match all of the source syllables left.
-	if (std::distance(dst, dst_end) == 1) {
-		result.source_length = source_strings.size();
+	if (dst_end - dst == 1) {
+		result.source_length = src_count;
 		++result.destination_length;
-		return result;
+		step.confidence = last_character_confidence;
+		return step;
 	}
 
 	// We couldn't match the current character, but if we can match the *next*
@@ -164,44 +250,95 @@ karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_s
 		if (++dst == dst_end) break;
 
 		// Transliterate this character if it's a known hiragana or katakana character
-		std::vector<const char *> translit;
-		auto next = std::next(dst);
-		if (next != dst_end)
-			boost::copy(kana_to_romaji(dst->str() + next->str()), back_inserter(translit));
-		boost::copy(kana_to_romaji(dst->str()), back_inserter(translit));
+		auto const& translit = dest[dst].romaji;
+		auto dst_str = dest.str_at(dst);
 
 		// Search for it and the transliterated version in the source
 		int src_lookahead_max = (lookahead + 1) * max_character_length;
 		int src_lookahead_pos = 0;
-		for (auto const& syl : source_strings) {
+		for (size_t i = src_begin; i < source_strings.size(); ++i) {
+			auto const& syl = source_strings[i];
 			// Don't count blank syllables in the max search distance
-			if (is_whitespace(syl)) continue;
+			if (syl.whitespace) continue;
 			if (++src_lookahead_pos == 1) continue;
 			if (src_lookahead_pos > src_lookahead_max) break;
 
-			std::string lsyl = boost::to_lower_copy(syl);
-			if (!(starts_with(syl, dst->str()) || util::any_of(translit, [&](const char *str) { return starts_with(lsyl, str); })))
+			if (!(starts_with(syl.text, dst_str) || util::any_of(translit, [&](const char *str) { return starts_with(syl.lower, str); })))
 				continue;
 
 			// The syllable immediately after the current one matched, so
 			// everything up to the match must go with the current syllable.
 			if (src_lookahead_pos == 2) {
 				result.destination_length += lookahead + 1;
-				return result;
+				step.confidence = next_syllable_confidence;
+				return step;
 			}
 
 			// The match was multiple syllables ahead, so just divide the
 			// destination characters evenly between the source syllables
 			result.destination_length += 1;
 			result.source_length = static_cast<size_t>((src_lookahead_pos - 1.0) / (lookahead + 1.0) + .5);
-			return result;
+			step.confidence = divided_confidence;
+			return step;
 		}
 	}
 
 	// We wouldn't have gotten here if the dest was empty, so make sure at
 	// least one character is selected
 	result.destination_length = std::max<size_t>(result.destination_length, 1u);
+	step.confidence = fallback_confidence;
+
+	return step;
+}
+
+collator const& get_collator() {
+	return std::use_facet<collator>(std::locale());
+}
+
+}
+
+karaoke_match_result auto_match_karaoke(std::vector<std::string> const& source_strings, std::string const& dest_string) {
+	if (source_strings.empty()) return karaoke_match_result{0, 0};
+	return match_syllable(prepare_source(source_strings), 0, destination(dest_string), 0, get_collator()).result;
+}
+
+karaoke_line_match_result auto_match_karaoke_line(std::vector<std::string> const& source_strings, std::string const& dest_string) {
+	karaoke_line_match_result ret;
+	ret.confidence = 1;
+
+	auto source = prepare_source(source_strings);
+	destination dest(dest_string);
+	auto const& coll = get_collator();
+
+	// The line's confidence is the confidence of each group weighted by the
+	// number of syllables in it
+	double total_confidence = 0;
+	size_t src_pos = 0, dst_pos = 0;
+	while (src_pos < source.size()) {
+		auto step = match_syllable(source, src_pos, dest, dst_pos, coll);
+		size_t dst_next = std::min(dst_pos + step.result.destination_length, dest.size());
+		ret.groups.push_back(karaoke_match_group{step.result.source_length, dest.substr(dst_pos, dst_next)});
+		total_confidence += step.confidence * step.result.source_length;
+		src_pos += step.result.source_length;
+		dst_pos = dst_next;
+	}
+
+	if (!source.empty())
+		ret.confidence = total_confidence / source.size();
+
+	// Anything left over in the destination goes with the last group, but if
+	// it isn't just whitespace then the source ran out early and the whole
+	// line is suspect
+	if (dst_pos < dest.size()) {
+		if (ret.groups.empty())
+			ret.groups.push_back(karaoke_match_group{0, ""});
+		ret.groups.back().destination += dest.substr(dst_pos, dest.size());
+		for (; dst_pos < dest.size(); ++dst_pos) {
+			if (!dest[dst_pos].whitespace)
+				ret.confidence = 0;
+		}
+	}
 
-	return result;
+	return ret;
 }
 }
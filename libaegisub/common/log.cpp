@@ -17,13 +17,93 @@
 #include "libaegisub/cajun/elements.h"
 #include "libaegisub/cajun/writer.h"
 #include "libaegisub/dispatch.h"
+#include "libaegisub/exception.h"
 #include "libaegisub/util.h"
 
+#include <algorithm>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/range/algorithm/remove.hpp>
 #include <boost/range/algorithm/remove_if.hpp>
 #include <chrono>
+#include <deque>
+
+namespace {
+	/// Source of LogSink IDs, which start at 1 so that 0 can mean no sink
+	std::atomic<uint64_t> next_sink_id{1};
+
+	const char binary_log_magic[] = "AGILOG01";
+
+	enum {
+		RECORD_STRING = 0,
+		RECORD_MESSAGE = 1
+	};
+
+	/// Thrown when a binary log ends partway through a record
+	struct TruncatedLog { };
+
+	void write_varint(std::ostream& out, uint64_t value) {
+		char buf[10];
+		size_t len = 0;
+		do {
+			buf[len] = static_cast<char>(value & 0x7F);
+			value >>= 7;
+			if (value) buf[len] |= 0x80;
+			++len;
+		} while (value);
+		out.write(buf, len);
+	}
+
+	uint64_t read_varint(std::istream& in) {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			int byte = in.get();
+			if (byte == EOF)
+				throw TruncatedLog();
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return value;
+		}
+		throw agi::InvalidInputException("Malformed number in binary log");
+	}
+
+	void write_string(std::ostream& out, const char *str, size_t len) {
+		write_varint(out, len);
+		out.write(str, len);
+	}
+
+	std::string read_string(std::istream& in) {
+		// The length comes from the file, so read in bounded chunks rather
+		// than trusting it for the allocation; a corrupt length then runs
+		// into the end of the file instead of exhausting memory
+		uint64_t remaining = read_varint(in);
+		std::string str;
+		char buf[4096];
+		while (remaining) {
+			auto len = static_cast<std::streamsize>(std::min<uint64_t>(remaining, sizeof buf));
+			in.read(buf, len);
+			if (in.gcount() != len)
+				throw TruncatedLog();
+			str.append(buf, static_cast<size_t>(len));
+			remaining -= len;
+		}
+		return str;
+	}
+
+	void write_json(agi::log::SinkMessage const& sm, std::ostream& out) {
+		json::Object entry;
+		entry["sec"]      = sm.time / 1000000000;
+		entry["usec"]     = sm.time % 1000000000;
+		entry["severity"] = sm.severity;
+		entry["section"]  = sm.section;
+		entry["file"]     = sm.file;
+		entry["func"]     = sm.func;
+		entry["line"]     = sm.line;
+		entry["message"]  = sm.message;
+		agi::JsonWriter::Write(entry, out);
+	}
+}
 
 namespace agi { namespace log {
 
@@ -34,36 +114,164 @@ LogSink *log;
 /// Keep this ordered the same as Severity
 const char *Severity_ID = "EAWID";
 
-LogSink::LogSink() : queue(dispatch::Create()) { }
+/// Single-producer single-consumer ring buffer of the messages logged by a
+/// single thread
+struct LogSink::ThreadBuffer {
+	static const size_t capacity = 256;
+	SinkMessage messages[capacity];
+	/// Index of the next slot to write; only modified by the logging thread
+	std::atomic<size_t> head{0};
+	/// Index of the next slot to read; only modified by the sink's queue
+	std::atomic<size_t> tail{0};
+	/// Set once the logging thread is done with this buffer, after which it's
+	/// freed by the next flush
+	std::atomic<bool> orphaned{false};
+
+	/// Add a message to the buffer, returning false without touching the
+	/// message if the buffer is full
+	bool Push(SinkMessage& sm) {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == capacity)
+			return false;
+		messages[h % capacity] = std::move(sm);
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	void Drain(std::vector<SinkMessage>& out) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t h = head.load(std::memory_order_acquire);
+		for (; t != h; ++t)
+			out.push_back(std::move(messages[t % capacity]));
+		tail.store(t, std::memory_order_release);
+	}
+};
+
+/// The current thread's buffer, which is handed back to its sink to be freed
+/// when the thread exits or starts logging to a different sink
+struct ThreadBufferOwner {
+	/// ID of the sink the buffer belongs to
+	uint64_t sink_id = 0;
+	/// Shared with the sink, as either may go away first
+	std::shared_ptr<LogSink::ThreadBuffer> buffer;
+
+	void Release() {
+		if (buffer)
+			buffer->orphaned.store(true, std::memory_order_release);
+		buffer.reset();
+		sink_id = 0;
+	}
+
+	~ThreadBufferOwner() { Release(); }
+};
+
+static thread_local ThreadBufferOwner current_buffer;
+
+LogSink::LogSink() : queue(dispatch::Create()), id(next_sink_id++) { }
 
 LogSink::~LogSink() {
 	// The destructor for emitters may try to log messages, so disable all the
 	// emitters before destructing any
 	decltype(emitters) emitters_temp;
-	queue->Sync([&]{ swap(emitters_temp, emitters); });
+	queue->Sync([&]{
+		Flush();
+		swap(emitters_temp, emitters);
+	});
 }
 
-void LogSink::Log(SinkMessage const& sm) {
-	queue->Async([=] {
-		if (messages.size() < 250)
-			messages.push_back(sm);
-		else {
-			messages[next_idx] = sm;
-			if (++next_idx == 250)
-				next_idx = 0;
+LogSink::ThreadBuffer *LogSink::GetThreadBuffer() {
+	if (current_buffer.sink_id != id) {
+		auto buffer = std::make_shared<ThreadBuffer>();
+		{
+			std::lock_guard<std::mutex> lock(buffers_lock);
+			buffers.push_back(buffer);
 		}
-		for (auto& em : emitters) em->log(sm);
-	});
+		current_buffer.Release();
+		current_buffer.sink_id = id;
+		current_buffer.buffer = std::move(buffer);
+	}
+	return current_buffer.buffer.get();
+}
+
+void LogSink::Log(SinkMessage sm) {
+	if (!GetThreadBuffer()->Push(sm)) {
+		// The buffer is full, so hand this one off directly after everything
+		// which is already buffered
+		auto shared = std::make_shared<SinkMessage>(std::move(sm));
+		queue->Async([=] {
+			Flush();
+			Emit(*shared);
+		});
+		return;
+	}
+
+	if (!flush_queued.exchange(true))
+		queue->Async([=] { Flush(); });
+}
+
+void LogSink::Flush() {
+	// Cleared first so that anything logged while flushing queues another flush
+	flush_queued = false;
+
+	std::vector<SinkMessage> pending;
+	{
+		std::lock_guard<std::mutex> lock(buffers_lock);
+		for (auto& buffer : buffers) {
+			// Checked before draining so that nothing logged before the
+			// thread let go of the buffer can be missed
+			bool orphaned = buffer->orphaned.load(std::memory_order_acquire);
+			buffer->Drain(pending);
+			if (orphaned)
+				buffer.reset();
+		}
+		buffers.erase(boost::remove(buffers, nullptr), buffers.end());
+	}
+
+	std::stable_sort(pending.begin(), pending.end(),
+		[](SinkMessage const& a, SinkMessage const& b) { return a.time < b.time; });
+	for (auto const& sm : pending)
+		Emit(sm);
+}
+
+void LogSink::Emit(SinkMessage const& sm) {
+	if (messages.size() < 250)
+		messages.push_back(sm);
+	else {
+		messages[next_idx] = sm;
+		if (++next_idx == 250)
+			next_idx = 0;
+	}
+	for (auto& em : emitters) em->log(sm);
+}
+
+bool LogSink::SectionEnabled(const char *section) const {
+	auto sections = std::atomic_load(&disabled_sections);
+	for (auto const& disabled : *sections) {
+		if (boost::starts_with(section, disabled) && (section[disabled.size()] == '\0' || section[disabled.size()] == '/'))
+			return false;
+	}
+	return true;
+}
+
+void LogSink::SetDisabledSections(std::vector<std::string> sections) {
+	bool any = !sections.empty();
+	std::atomic_store(&disabled_sections, std::shared_ptr<const std::vector<std::string>>(
+		std::make_shared<std::vector<std::string>>(std::move(sections))));
+	has_disabled_sections = any;
 }
 
 void LogSink::Subscribe(std::unique_ptr<Emitter> em) {
 	LOG_D("agi/log/emitter/subscribe") << "Subscribe: " << this;
 	auto tmp = em.release();
-	queue->Sync([=] { emitters.emplace_back(tmp); });
+	queue->Sync([=] {
+		Flush();
+		emitters.emplace_back(tmp);
+	});
 }
 
 void LogSink::Unsubscribe(Emitter *em) {
 	queue->Sync([=] {
+		Flush();
 		emitters.erase(
 			boost::remove_if(emitters, [=](std::unique_ptr<Emitter> const& e) { return e.get() == em; }),
 			emitters.end());
@@ -71,9 +279,10 @@ void LogSink::Unsubscribe(Emitter *em) {
 	LOG_D("agi/log/emitter/unsubscribe") << "Un-Subscribe: " << this;
 }
 
-decltype(LogSink::messages) LogSink::GetMessages() const {
+decltype(LogSink::messages) LogSink::GetMessages() {
 	decltype(messages) ret;
 	queue->Sync([&] {
+		Flush();
 		ret.reserve(messages.size());
 		ret.insert(ret.end(), messages.begin() + next_idx, messages.end());
 		ret.insert(ret.end(), messages.begin(), messages.begin() + next_idx);
@@ -95,7 +304,7 @@ Message::Message(const char *section, Severity severity, const char *file, const
 
 Message::~Message() {
 	sm.message = std::string(buffer, (std::string::size_type)msg.tellp());
-	agi::log::log->Log(sm);
+	agi::log::log->Log(std::move(sm));
 }
 
 JsonEmitter::JsonEmitter(fs::path const& directory)
@@ -104,17 +313,100 @@ JsonEmitter::JsonEmitter(fs::path const& directory)
 }
 
 void JsonEmitter::log(SinkMessage const& sm) {
-	json::Object entry;
-	entry["sec"]      = sm.time / 1000000000;
-	entry["usec"]     = sm.time % 1000000000;
-	entry["severity"] = sm.severity;
-	entry["section"]  = sm.section;
-	entry["file"]     = sm.file;
-	entry["func"]     = sm.func;
-	entry["line"]     = sm.line;
-	entry["message"]  = sm.message;
-	agi::JsonWriter::Write(entry, *fp);
+	write_json(sm, *fp);
 	fp->flush();
 }
 
+BinaryEmitter::BinaryEmitter(fs::path const& directory)
+: fp(new boost::filesystem::ofstream(unique_path(directory/util::strftime("%Y-%m-%d-%H-%M-%S-%%%%%%%%.agilog")), std::ios::binary))
+{
+	fp->write(binary_log_magic, sizeof binary_log_magic - 1);
+}
+
+uint64_t BinaryEmitter::StringId(const char *str) {
+	auto it = string_ids.find(str);
+	if (it != string_ids.end()) return it->second;
+
+	uint64_t id = string_ids.size();
+	string_ids[str] = id;
+	fp->put(RECORD_STRING);
+	write_varint(*fp, id);
+	write_string(*fp, str, strlen(str));
+	return id;
+}
+
+void BinaryEmitter::log(SinkMessage const& sm) {
+	uint64_t section = StringId(sm.section);
+	uint64_t file = StringId(sm.file);
+	uint64_t func = StringId(sm.func);
+
+	// Times are stored as the zigzag-encoded difference from the previous
+	// message's time, as that's usually tiny
+	int64_t delta = sm.time - last_time;
+	last_time = sm.time;
+
+	fp->put(RECORD_MESSAGE);
+	write_varint(*fp, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+	fp->put(static_cast<char>(sm.severity));
+	write_varint(*fp, section);
+	write_varint(*fp, file);
+	write_varint(*fp, func);
+	write_varint(*fp, sm.line);
+	write_string(*fp, sm.message.data(), sm.message.size());
+	fp->flush();
+}
+
+bool ConvertBinaryLog(std::istream& in, std::ostream& out) {
+	char magic[sizeof binary_log_magic - 1];
+	in.read(magic, sizeof magic);
+	if (in.gcount() != sizeof magic || memcmp(magic, binary_log_magic, sizeof magic))
+		throw InvalidInputException("Not a binary log file");
+
+	// deque so that the pointers to the strings stay valid as it grows
+	std::deque<std::string> strings;
+	auto get_string = [&](uint64_t id) -> const char * {
+		if (id >= strings.size())
+			throw InvalidInputException("Undefined string in binary log");
+		return strings[id].c_str();
+	};
+
+	int64_t time = 0;
+	// Each message is only written once all of it has been read, so that a
+	// log cut off by a crash converts up to the last complete message
+	try {
+		for (int type; (type = in.get()) != EOF; ) {
+			if (type == RECORD_STRING) {
+				if (read_varint(in) != strings.size())
+					throw InvalidInputException("Out of order string in binary log");
+				strings.push_back(read_string(in));
+			}
+			else if (type == RECORD_MESSAGE) {
+				uint64_t zigzag = read_varint(in);
+				time += static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+
+				SinkMessage sm;
+				sm.time = time;
+				int severity = in.get();
+				if (severity == EOF)
+					throw TruncatedLog();
+				if (severity < Exception || severity > Debug)
+					throw InvalidInputException("Invalid severity in binary log");
+				sm.severity = static_cast<Severity>(severity);
+				sm.section = get_string(read_varint(in));
+				sm.file = get_string(read_varint(in));
+				sm.func = get_string(read_varint(in));
+				sm.line = static_cast<int>(read_varint(in));
+				sm.message = read_string(in);
+				write_json(sm, out);
+			}
+			else
+				throw InvalidInputException("Unknown record type in binary log");
+		}
+	}
+	catch (TruncatedLog const&) {
+		return false;
+	}
+	return true;
+}
+
 } }
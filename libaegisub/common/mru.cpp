@@ -120,7 +120,9 @@ void MRUManager::Flush() {
 			array.push_back(p.string());
 	}
 
-	agi::JsonWriter::Write(out, io::Save(config_name).Get());
+	io::Save file(config_name);
+	agi::JsonWriter::Write(out, file.Get());
+	file.Commit();
 }
 
 void MRUManager::Prune(const char *key, MRUListMap& map) const {
@@ -314,7 +314,9 @@ void Options::Flush() const {
 		}
 	}
 
-	agi::JsonWriter::Write(obj_out, io::Save(config_file).Get());
+	io::Save file(config_file);
+	agi::JsonWriter::Write(obj_out, file.Get());
+	file.Commit();
 }
 
 } // namespace agi
@@ -0,0 +1,186 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "libaegisub/sequence_match.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+using agi::sequence_match;
+typedef std::vector<uint64_t> sequence;
+
+/// Edit distance beyond which Myers gives up on a gap. Bounds the time and
+/// memory spent on regions that have been completely rewritten.
+const int max_edit_distance = 1024;
+
+class matcher {
+	sequence const& a;
+	sequence const& b;
+	std::vector<sequence_match> &out;
+
+	void myers(size_t a0, size_t a1, size_t b0, size_t b1);
+	void patience(size_t a0, size_t a1, size_t b0, size_t b1);
+
+public:
+	matcher(sequence const& a, sequence const& b, std::vector<sequence_match> &out)
+	: a(a), b(b), out(out)
+	{
+		patience(0, a.size(), 0, b.size());
+	}
+};
+
+void matcher::myers(size_t a0, size_t a1, size_t b0, size_t b1) {
+	const int n = a1 - a0, m = b1 - b0;
+	const int max_d = std::min(n + m, max_edit_distance);
+	const int offset = max_d + 1;
+
+	// v[k + offset] is the furthest x reached on diagonal k; trace[d] holds
+	// the diagonals -d..d after step d for walking back through the path
+	std::vector<int> v(2 * max_d + 3, 0);
+	std::vector<std::vector<int>> trace;
+
+	int found = -1;
+	for (int d = 0; d <= max_d && found < 0; ++d) {
+		for (int k = -d; k <= d; k += 2) {
+			int x;
+			if (k == -d || (k != d && v[k - 1 + offset] < v[k + 1 + offset]))
+				x = v[k + 1 + offset];
+			else
+				x = v[k - 1 + offset] + 1;
+			int y = x - k;
+			while (x < n && y < m && a[a0 + x] == b[b0 + y])
+				++x, ++y;
+			v[k + offset] = x;
+			if (x >= n && y >= m)
+				found = d;
+		}
+		trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+	}
+
+	if (found < 0) return;
+
+	std::vector<sequence_match> matches;
+	int x = n, y = m;
+	for (int d = found; d > 0; --d) {
+		auto const& prev = trace[d - 1];
+		auto prev_v = [&](int k) { return prev[k + d - 1]; };
+
+		int k = x - y;
+		int prev_k = (k == -d || (k != d && prev_v(k - 1) < prev_v(k + 1))) ? k + 1 : k - 1;
+		int prev_x = prev_v(prev_k);
+		int prev_y = prev_x - prev_k;
+
+		// The snake following the edit
+		while (x > prev_x && y > prev_y) {
+			--x, --y;
+			matches.emplace_back(a0 + x, b0 + y);
+		}
+		x = prev_x;
+		y = prev_y;
+	}
+	// The snake at the start, before any edits
+	while (x > 0 && y > 0) {
+		--x, --y;
+		matches.emplace_back(a0 + x, b0 + y);
+	}
+
+	out.insert(out.end(), matches.rbegin(), matches.rend());
+}
+
+void matcher::patience(size_t a0, size_t a1, size_t b0, size_t b1) {
+	// Common prefix
+	while (a0 < a1 && b0 < b1 && a[a0] == b[b0])
+		out.emplace_back(a0++, b0++);
+
+	// Common suffix, added after everything else
+	size_t suffix = 0;
+	while (a0 < a1 - suffix && b0 < b1 - suffix && a[a1 - suffix - 1] == b[b1 - suffix - 1])
+		++suffix;
+	a1 -= suffix;
+	b1 -= suffix;
+
+	if (a0 < a1 && b0 < b1) {
+		// Find the elements which occur exactly once on each side
+		struct occurrences {
+			size_t count_a, count_b;
+			size_t pos_a, pos_b;
+		};
+		std::unordered_map<uint64_t, occurrences> counts;
+		counts.reserve(a1 - a0);
+		for (size_t i = a0; i < a1; ++i) {
+			auto& occ = counts[a[i]];
+			++occ.count_a;
+			occ.pos_a = i;
+		}
+		for (size_t j = b0; j < b1; ++j) {
+			auto it = counts.find(b[j]);
+			if (it == counts.end()) continue;
+			++it->second.count_b;
+			it->second.pos_b = j;
+		}
+
+		std::vector<sequence_match> unique;
+		for (size_t i = a0; i < a1; ++i) {
+			auto const& occ = counts[a[i]];
+			if (occ.count_a == 1 && occ.count_b == 1)
+				unique.emplace_back(i, occ.pos_b);
+		}
+
+		if (unique.empty())
+			myers(a0, a1, b0, b1);
+		else {
+			// Longest increasing subsequence of the positions in b, by
+			// patience sorting
+			std::vector<size_t> tails; // index into unique of the top of each pile
+			std::vector<size_t> prev(unique.size());
+			for (size_t i = 0; i < unique.size(); ++i) {
+				auto pile = std::lower_bound(begin(tails), end(tails), unique[i].second,
+					[&](size_t t, size_t pos_b) { return unique[t].second < pos_b; });
+				prev[i] = pile == begin(tails) ? SIZE_MAX : *(pile - 1);
+				if (pile == end(tails))
+					tails.push_back(i);
+				else
+					*pile = i;
+			}
+
+			std::vector<sequence_match> anchors;
+			for (size_t i = tails.back(); i != SIZE_MAX; i = prev[i])
+				anchors.push_back(unique[i]);
+			std::reverse(begin(anchors), end(anchors));
+
+			for (auto const& anchor : anchors) {
+				patience(a0, anchor.first, b0, anchor.second);
+				out.push_back(anchor);
+				a0 = anchor.first + 1;
+				b0 = anchor.second + 1;
+			}
+			patience(a0, a1, b0, b1);
+		}
+	}
+
+	for (size_t i = 0; i < suffix; ++i)
+		out.emplace_back(a1 + i, b1 + i);
+}
+}
+
+namespace agi {
+std::vector<sequence_match> MatchSequences(std::vector<uint64_t> const& a, std::vector<uint64_t> const& b) {
+	std::vector<sequence_match> matches;
+	matcher(a, b, matches);
+	return matches;
+}
+}
@@ -200,6 +200,7 @@ void Framerate::Save(fs::path const& filename, int length) const {
 	boost::copy(timecodes, std::ostream_iterator<int>(out, "\n"));
 	for (int written = (int)timecodes.size(); written < length; ++written)
 		out << TimeAtFrame(written) << std::endl;
+	file.Commit();
 }
 
 int Framerate::FrameAtTime(int ms, Time type) const {
@@ -230,6 +231,58 @@ int Framerate::FrameAtTime(int ms, Time type) const {
 	return (int)distance(lower_bound(timecodes.rbegin(), timecodes.rend(), ms, std::greater<int>()), timecodes.rend()) - 1;
 }
 
+std::vector<int> Framerate::FramesAtTimes(std::vector<int> const& times, Time type) const {
+	std::vector<int> frames(times.size());
+
+	// Visit the times in ascending order, via a sorted permutation if they
+	// aren't already sorted
+	std::vector<size_t> order;
+	if (!std::is_sorted(times.begin(), times.end())) {
+		order.resize(times.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return times[a] < times[b];
+		});
+	}
+
+	// Same as FrameAtTime, with the binary search replaced by galloping
+	// forward through the timecodes from the previous time's position, so
+	// that dense times cost a step each and a few times far into a long
+	// list of timecodes cost a logarithmic search each
+	const int last_index = (int)timecodes.size() - 1;
+	int index = -1;
+	for (size_t i = 0; i < times.size(); ++i) {
+		const size_t pos = order.empty() ? i : order[i];
+		const int ms = type == EXACT ? times[pos] : times[pos] - 1;
+
+		int frame;
+		if (ms < 0)
+			frame = int((ms * numerator / denominator - 999) / 1000);
+		else if (ms > timecodes.back())
+			frame = int((ms * numerator - last + denominator - 1) / denominator / 1000) + last_index;
+		else {
+			if (index < last_index && timecodes[index + 1] <= ms) {
+				// Find a range ending past ms by doubling the step, then
+				// binary search within it
+				int lo = index + 1;
+				int step = 1;
+				while (lo + step <= last_index && timecodes[lo + step] <= ms) {
+					lo += step;
+					step *= 2;
+				}
+				auto end = timecodes.begin() + std::min(lo + step, last_index + 1);
+				index = (int)distance(timecodes.begin(), upper_bound(timecodes.begin() + lo, end, ms)) - 1;
+			}
+			frame = index;
+		}
+
+		frames[pos] = type == START ? frame + 1 : frame;
+	}
+
+	return frames;
+}
+
 int Framerate::TimeAtFrame(int frame, Time type) const {
 	if (type == START) {
 		int prev = TimeAtFrame(frame - 1);
@@ -14,7 +14,10 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#pragma once
+
 #include <string>
+#include <utility>
 #include <vector>
 
 #undef ERROR
@@ -79,5 +82,48 @@ namespace agi {
 		void SplitWords(std::string const& str, std::vector<DialogueToken> &tokens);
 
 		std::vector<DialogueToken> SyntaxHighlight(std::string const& text, std::vector<DialogueToken> const& tokens, SpellChecker *spellchecker);
+
+		/// @class DialogueHighlighter
+		/// @brief Word-split tokens and syntax styles of a line which is being edited
+		///
+		/// Rather than redoing everything for each change to the line, tokens
+		/// which are unchanged at the start and end of the line are reused
+		/// along with their styles, so only the words around the edit need to be
+		/// split and spellchecked again.
+		class DialogueHighlighter {
+			std::string text;
+			bool karaoke_templater = false;
+			/// Lexed tokens of the line with drawings marked
+			std::vector<DialogueToken> lexed;
+			/// Number of entries in tokens which each lexed token was split into
+			std::vector<size_t> split_counts;
+			/// Lexed tokens with words split out
+			std::vector<DialogueToken> tokens;
+			/// Style of each entry in tokens
+			std::vector<DialogueToken> styles;
+
+		public:
+			/// @brief Update the tokens and styles for the new text of the line
+			/// @param unchanged_prefix Upper bound on the bytes at the start of the line known to be unedited
+			/// @param unchanged_suffix Upper bound on the bytes at the end of the line known to be unedited
+			/// @return Byte range in the new text whose styles were recalculated
+			///
+			/// The unchanged text is found by comparing the old and new text,
+			/// which can be ambiguous when the edit is next to identical text.
+			/// Callers which need the styles to line up with the actual edit
+			/// (such as when the styles of the rest of the line are not being
+			/// applied again) should pass the bounds of the edit.
+			std::pair<size_t, size_t> Update(std::string const& new_text, bool karaoke_templater, SpellChecker *spellchecker, size_t unchanged_prefix = std::string::npos, size_t unchanged_suffix = std::string::npos);
+
+			/// Forget the current line so that the next update recalculates everything
+			void Reset();
+
+			std::string const& GetText() const { return text; }
+			/// Get the tokens of the line, as from SplitWords
+			std::vector<DialogueToken> const& GetTokens() const { return tokens; }
+			/// Get the style of each token. Unlike SyntaxHighlight, adjacent
+			/// tokens with the same style are not merged.
+			std::vector<DialogueToken> const& GetStyles() const { return styles; }
+		};
 	}
 }
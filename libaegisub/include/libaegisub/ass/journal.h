@@ -0,0 +1,119 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/fs_fwd.h>
+
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace agi { namespace ass {
+/// @class JournalRecord
+/// @brief The changes made to a script by a single commit
+///
+/// Sections are stored as the lines they'd be written to an ASS file as.
+/// Script info, styles and extradata are small and rarely change, so they
+/// are replaced as a whole when they do change, while dialogue lines are
+/// recorded individually. A line's position is recorded as the ID of the
+/// line before it, so inserting or moving a line only records the lines
+/// whose predecessor changed.
+class JournalRecord {
+	friend class JournalWriter;
+	std::string data;
+
+public:
+	/// Replace the script info lines
+	void SetInfo(std::vector<std::string> const& lines);
+	/// Replace the style lines
+	void SetStyles(std::vector<std::string> const& lines);
+	/// Replace the extradata lines
+	void SetExtradata(std::vector<std::string> const& lines);
+	/// Remove all dialogue lines
+	void ClearEvents();
+	/// Remove a dialogue line
+	void RemoveEvent(int id);
+	/// Add or replace a dialogue line
+	/// @param id      ID of the line
+	/// @param prev_id ID of the line before it, or 0 if it's the first line
+	/// @param line    The line as it would be written to an ASS file
+	void SetEvent(int id, int prev_id, std::string const& line);
+
+	/// Does this record contain no changes?
+	bool empty() const { return data.empty(); }
+	/// Size of the encoded record in bytes
+	size_t size() const { return data.size(); }
+};
+
+/// @class JournalWriter
+/// @brief Appends records to a journal file
+///
+/// Every journal begins with a checkpoint holding the full state of the
+/// script, so a journal can be compacted by replacing it with a new one.
+/// Each record is checksummed so that a record which was only partially
+/// written when the program died is ignored when the journal is read.
+class JournalWriter {
+	agi::fs::path path;
+	std::unique_ptr<std::ostream> out;
+	uint64_t size = 0;
+
+public:
+	/// Start a new journal, replacing any existing one at the same path
+	/// @param path       Journal file to write
+	/// @param source     File the journal's script was loaded from, if any
+	/// @param checkpoint Record which creates the full current state
+	///
+	/// The new journal is written to a temporary file and then moved into
+	/// place, so a crash while compacting leaves the old journal intact.
+	JournalWriter(agi::fs::path const& path, std::string const& source, JournalRecord const& checkpoint);
+	~JournalWriter();
+
+	/// Append a record and flush the stream, so that it survives the
+	/// program crashing. The file is not synced, so it may not survive the
+	/// system crashing.
+	/// @throws agi::fs::WriteDenied if the record could not be written
+	void Write(JournalRecord const& record);
+
+	/// Size of the journal file in bytes
+	uint64_t Size() const { return size; }
+
+	/// Path to the journal file
+	agi::fs::path const& GetPath() const { return path; }
+};
+
+/// The script produced by replaying a journal
+struct JournalState {
+	/// File the journal's script was loaded from, if any
+	std::string source;
+	std::vector<std::string> info;
+	std::vector<std::string> styles;
+	std::vector<std::string> extradata;
+	/// Dialogue lines and their IDs, in order
+	std::vector<std::pair<int, std::string>> events;
+};
+
+/// Replay a journal
+///
+/// Reading stops at the first damaged record.
+/// @throws agi::InvalidInputException if the file is not a journal
+JournalState ReadJournal(std::istream& in);
+JournalState ReadJournal(agi::fs::path const& path);
+} }
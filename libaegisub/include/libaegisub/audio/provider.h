@@ -20,9 +20,55 @@
 #include <libaegisub/fs_fwd.h>
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 namespace agi {
+/// @class AudioChannelSummary
+/// @brief Compact peaks of each channel of audio which is otherwise mixed
+///        down to mono
+///
+/// Each block of samples is summarised as the minimum and maximum sample of
+/// each channel with 8-bit log scaling, which is a few percent of the size
+/// of the mono audio even for 5.1, so the channels can be displayed
+/// separately without caching them all.
+class AudioChannelSummary {
+	int channels;
+	int sample_rate;
+	int64_t blocks;
+	/// Minimum and maximum of each channel in each block, or 255 and 0 for
+	/// blocks which haven't been decoded yet
+	std::unique_ptr<std::atomic<uint8_t>[]> peaks;
+
+public:
+	/// Number of samples in each block
+	static const int block_size = 256;
+
+	AudioChannelSummary(int channels, int64_t num_samples, int sample_rate);
+
+	/// Add the peaks of some interleaved 16-bit audio
+	/// @param buf   Audio with each sample holding one value per channel
+	/// @param start First sample in buf
+	/// @param count Number of samples per channel in buf
+	void Add(const int16_t *buf, int64_t start, int64_t count);
+
+	/// Get the smallest and largest sample of a channel over a range of audio
+	/// @return false if none of the range has been decoded yet
+	bool GetPeaks(int channel, int64_t start, int64_t count, int16_t &min, int16_t &max) const;
+
+	int GetChannels() const { return channels; }
+	/// Sample rate of the summarised audio, which may differ from the
+	/// converted audio's
+	int GetSampleRate() const { return sample_rate; }
+	/// Memory used by the summary in bytes
+	size_t GetSize() const { return static_cast<size_t>(blocks * channels * 2); }
+
+	/// Log-scale a sample to 8 bits, preserving order
+	static uint8_t Encode(int16_t sample);
+	/// Get the approximate sample for an encoded value
+	static int16_t Decode(uint8_t value);
+};
+
 class AudioProvider {
 protected:
 	int channels = 0;
@@ -34,6 +80,8 @@ protected:
 	int sample_rate = 0;
 	int bytes_per_sample = 0;
 	bool float_samples = false;
+	/// Peaks of each of the source's channels if it was mixed down to mono
+	std::shared_ptr<const AudioChannelSummary> channel_summary;
 
 	virtual void FillBuffer(void *buf, int64_t start, int64_t count) const = 0;
 
@@ -52,6 +100,10 @@ public:
 	int     GetChannels()       const { return channels; }
 	bool    AreSamplesFloat()   const { return float_samples; }
 
+	/// Get the peaks of each channel of the audio before it was mixed down to
+	/// mono, or nullptr if it wasn't
+	std::shared_ptr<const AudioChannelSummary> const& GetChannelSummary() const { return channel_summary; }
+
 	/// Does this provider benefit from external caching?
 	virtual bool NeedsCache() const { return false; }
 };
@@ -70,6 +122,7 @@ public:
 		sample_rate = source->GetSampleRate();
 		bytes_per_sample = source->GetBytesPerSample();
 		float_samples = source->AreSamplesFloat();
+		channel_summary = source->GetChannelSummary();
 	}
 };
 
@@ -86,8 +139,15 @@ class BackgroundRunner;
 std::unique_ptr<AudioProvider> CreateDummyAudioProvider(fs::path const& filename, BackgroundRunner *);
 std::unique_ptr<AudioProvider> CreatePCMAudioProvider(fs::path const& filename, BackgroundRunner *);
 
-std::unique_ptr<AudioProvider> CreateConvertAudioProvider(std::unique_ptr<AudioProvider> source_provider);
+/// Convert audio to 16-bit mono with a sample rate of at least 32 kHz
+/// @param channel Channel to keep when mixing down to mono, or -1 to average
+///                all of them
+std::unique_ptr<AudioProvider> CreateConvertAudioProvider(std::unique_ptr<AudioProvider> source_provider, int channel = -1);
 std::unique_ptr<AudioProvider> CreateLockAudioProvider(std::unique_ptr<AudioProvider> source_provider);
+/// Create a locked provider which decodes up to window samples past the end
+/// of each read on a background thread, so that sequential reads don't have
+/// to wait for a slow source
+std::unique_ptr<AudioProvider> CreateDecodeAheadAudioProvider(std::unique_ptr<AudioProvider> source_provider, int64_t window);
 std::unique_ptr<AudioProvider> CreateHDAudioProvider(std::unique_ptr<AudioProvider> source_provider, fs::path const& dir);
 std::unique_ptr<AudioProvider> CreateRAMAudioProvider(std::unique_ptr<AudioProvider> source_provider);
 
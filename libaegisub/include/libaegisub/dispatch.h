@@ -14,6 +14,9 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -21,16 +24,69 @@ namespace agi {
 	namespace dispatch {
 		typedef std::function<void()> Thunk;
 
+		/// Priorities for work run on the background thread pool. Queued work
+		/// at a higher priority is always started before work at a lower one,
+		/// and one worker is always kept free of PRIORITY_BACKGROUND work so
+		/// that higher priority work never has to wait for bulk jobs.
+		enum Priority {
+			/// Bulk work nobody is waiting on, such as spectrum fills, font
+			/// scans and autosaves
+			PRIORITY_BACKGROUND,
+			/// The default priority
+			PRIORITY_NORMAL,
+			/// Work needed to draw the next frame, such as the frame being
+			/// seeked to or the audio under the cursor
+			PRIORITY_INTERACTIVE,
+			PRIORITY_COUNT
+		};
+
+		/// A flag which can be set to tell work which has been queued but has
+		/// not yet started that it no longer needs to run. Copies share the
+		/// same flag.
+		class CancellationToken {
+			std::shared_ptr<std::atomic<bool>> cancelled;
+		public:
+			CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) { }
+
+			/// Skip all work using this token which hasn't started yet
+			void Cancel() { *cancelled = true; }
+			bool IsCancelled() const { return *cancelled; }
+		};
+
+		/// Statistics for all of the work queued at a single priority
+		struct QueueStats {
+			/// Number of thunks waiting to be run
+			size_t depth;
+			/// Number of thunks which have been started
+			uint64_t started;
+			/// Total time between being queued and starting for all started thunks
+			std::chrono::microseconds total_wait;
+			/// Longest time between being queued and starting for any thunk
+			std::chrono::microseconds max_wait;
+		};
+
 		class Queue {
 			virtual void DoInvoke(Thunk thunk)=0;
+			/// Run the thunk on the calling thread for Sync if that's
+			/// equivalent to queuing it and waiting, returning whether it ran
+			virtual bool TryRunInline(Thunk const& thunk) { return false; }
 		public:
 			virtual ~Queue() { }
 
 			/// Invoke the thunk on this processing queue, returning immediately
 			void Async(Thunk thunk);
 
+			/// Invoke the thunk on this processing queue, returning
+			/// immediately, unless the token is cancelled before it starts
+			void Async(Thunk thunk, CancellationToken token);
+
 			/// Invoke the thunk on this processing queue, returning only when
-			/// it's complete
+			/// it's complete. Called from a worker, Sync on a generic
+			/// background queue or an idle serial queue runs the thunk
+			/// immediately, and a PRIORITY_BACKGROUND thunk waiting on a busy
+			/// serial queue doesn't count towards the workers kept busy by
+			/// background work, so background work can wait on other
+			/// background work without deadlocking the pool.
 			void Sync(Thunk thunk);
 		};
 
@@ -41,10 +97,14 @@ namespace agi {
 		/// Get the main queue, which runs on the GUI thread
 		Queue& Main();
 
-		/// Get the generic background queue, which runs thunks in parallel
-		Queue& Background();
+		/// Get the generic background queue for the given priority, which runs
+		/// thunks in parallel
+		Queue& Background(Priority priority = PRIORITY_NORMAL);
+
+		/// Create a new serial queue whose thunks run at the given priority
+		std::unique_ptr<Queue> Create(Priority priority = PRIORITY_NORMAL);
 
-		/// Create a new serial queue
-		std::unique_ptr<Queue> Create();
+		/// Get the queue depth and wait times for work at the given priority
+		QueueStats GetStats(Priority priority);
 	}
 }
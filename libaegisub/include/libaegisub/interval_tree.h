@@ -0,0 +1,222 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file interval_tree.h
+/// @brief Dynamic index of half-open intervals supporting overlap queries
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace agi {
+/// @class interval_tree
+/// @brief A set of [begin, end) intervals, each carrying a value
+///
+/// Implemented as a treap ordered on begin where each node also stores the
+/// largest end in its subtree, so insertion and removal are O(log n) and
+/// finding the k intervals which overlap another is O(log n + k).
+///
+/// Two intervals overlap if each begins before the other ends. Intervals
+/// which merely touch do not overlap, and empty intervals never overlap
+/// anything.
+template<class Value, class Key = int>
+class interval_tree {
+	struct node {
+		Key begin, end, max_end;
+		Value value;
+		uint32_t priority;
+		std::unique_ptr<node> left, right;
+
+		node(Key begin, Key end, Value value, uint32_t priority)
+		: begin(begin), end(end), max_end(end), value(std::move(value)), priority(priority) { }
+	};
+
+	std::unique_ptr<node> root;
+	size_t count = 0;
+	uint32_t seed = 2463534242u;
+
+	uint32_t next_priority() {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return seed;
+	}
+
+	static void update(node *n) {
+		n->max_end = n->end;
+		if (n->left) n->max_end = std::max(n->max_end, n->left->max_end);
+		if (n->right) n->max_end = std::max(n->max_end, n->right->max_end);
+	}
+
+	static void rotate_right(std::unique_ptr<node>& n) {
+		std::unique_ptr<node> l = std::move(n->left);
+		n->left = std::move(l->right);
+		update(n.get());
+		l->right = std::move(n);
+		n = std::move(l);
+		update(n.get());
+	}
+
+	static void rotate_left(std::unique_ptr<node>& n) {
+		std::unique_ptr<node> r = std::move(n->right);
+		n->right = std::move(r->left);
+		update(n.get());
+		r->left = std::move(n);
+		n = std::move(r);
+		update(n.get());
+	}
+
+	static void insert(std::unique_ptr<node>& n, std::unique_ptr<node>& new_node) {
+		if (!n) {
+			n = std::move(new_node);
+			return;
+		}
+
+		if (new_node->begin < n->begin) {
+			insert(n->left, new_node);
+			if (n->left->priority > n->priority)
+				rotate_right(n);
+		}
+		else {
+			insert(n->right, new_node);
+			if (n->right->priority > n->priority)
+				rotate_left(n);
+		}
+		update(n.get());
+	}
+
+	static void remove_node(std::unique_ptr<node>& n) {
+		if (!n->left) {
+			std::unique_ptr<node> r = std::move(n->right);
+			n = std::move(r);
+		}
+		else if (!n->right) {
+			std::unique_ptr<node> l = std::move(n->left);
+			n = std::move(l);
+		}
+		else if (n->left->priority > n->right->priority) {
+			rotate_right(n);
+			remove_node(n->right);
+			update(n.get());
+		}
+		else {
+			rotate_left(n);
+			remove_node(n->left);
+			update(n.get());
+		}
+	}
+
+	static bool erase(std::unique_ptr<node>& n, Key begin, Key end, Value const& value) {
+		if (!n) return false;
+
+		bool found;
+		if (begin < n->begin)
+			found = erase(n->left, begin, end, value);
+		else if (n->begin < begin)
+			found = erase(n->right, begin, end, value);
+		else if (n->end == end && n->value == value) {
+			remove_node(n);
+			return true;
+		}
+		// Rotations can leave intervals with equal begins on either side
+		else
+			found = erase(n->left, begin, end, value) || erase(n->right, begin, end, value);
+
+		if (found)
+			update(n.get());
+		return found;
+	}
+
+	template<class Func>
+	static void query(node const* n, Key begin, Key end, Func& f) {
+		if (!n || !(begin < n->max_end)) return;
+		query(n->left.get(), begin, end, f);
+		// Everything to the right begins at or after this node
+		if (!(n->begin < end)) return;
+		if (begin < n->end && n->begin < n->end)
+			f(n->value);
+		query(n->right.get(), begin, end, f);
+	}
+
+	template<class Func>
+	static void in_order(node const* n, Func& f) {
+		if (!n) return;
+		in_order(n->left.get(), f);
+		f(n);
+		in_order(n->right.get(), f);
+	}
+
+public:
+	/// Add an interval
+	void insert(Key begin, Key end, Value value) {
+		std::unique_ptr<node> new_node(new node(begin, end, std::move(value), next_priority()));
+		insert(root, new_node);
+		++count;
+	}
+
+	/// Remove an interval previously added with the same begin, end and value
+	/// @return Was a matching interval found?
+	bool erase(Key begin, Key end, Value const& value) {
+		if (!erase(root, begin, end, value)) return false;
+		--count;
+		return true;
+	}
+
+	/// Call f with the value of each interval overlapping [begin, end), in
+	/// order of increasing begin
+	template<class Func>
+	void for_each_overlapping(Key begin, Key end, Func f) const {
+		if (begin < end)
+			query(root.get(), begin, end, f);
+	}
+
+	/// Call f(a, b) once for every pair of overlapping intervals, where a
+	/// begins at or before b
+	///
+	/// Runs in O(n + k) time for k overlapping pairs.
+	template<class Func>
+	void for_each_overlapping_pair(Func f) const {
+		std::vector<node const*> active;
+		auto visit = [&](node const* n) {
+			if (!(n->begin < n->end)) return;
+			active.erase(std::remove_if(begin(active), end(active),
+				[=](node const* a) { return !(n->begin < a->end); }), end(active));
+			for (auto a : active)
+				f(a->value, n->value);
+			active.push_back(n);
+		};
+		in_order(root.get(), visit);
+	}
+
+	/// Call f with the value of every interval, in order of increasing begin
+	template<class Func>
+	void for_each(Func f) const {
+		auto visit = [&](node const* n) { f(n->value); };
+		in_order(root.get(), visit);
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return !count; }
+
+	void clear() {
+		root.reset();
+		count = 0;
+	}
+};
+}
@@ -35,11 +35,17 @@ class Save {
 	std::unique_ptr<std::ostream> fp;
 	const fs::path file_name;
 	const fs::path tmp_name;
+	bool committed = false;
 
 public:
 	Save(fs::path const& file, bool binary = false);
-	~Save() noexcept(false);
+	/// Throw away the temporary file if Commit() was never called, leaving
+	/// the target untouched
+	~Save();
 	std::ostream& Get() { return *fp; }
+	/// Replace the target file with what was written. Must be called once
+	/// writing has finished successfully.
+	void Commit();
 };
 
 	} // namespace io
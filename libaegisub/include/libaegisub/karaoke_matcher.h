@@ -25,6 +25,28 @@ namespace agi {
 		size_t destination_length;
 	};
 
+	struct karaoke_match_group {
+		/// The number of strings in the source in this group
+		size_t source_length;
+		/// The part of the destination string matched to them
+		std::string destination;
+	};
+
+	struct karaoke_line_match_result {
+		/// The match for each group of syllables, in order
+		std::vector<karaoke_match_group> groups;
+		/// How much the matcher trusts the result, from 0 (a guess) to 1
+		double confidence;
+	};
+
 	/// Try to automatically select the portion of dst which corresponds to the first string in src
 	karaoke_match_result auto_match_karaoke(std::vector<std::string> const& src, std::string const& dst);
+
+	/// Match all of src against dst, as if the result of auto_match_karaoke
+	/// was accepted for each group in turn
+	///
+	/// Unlike repeated calls to auto_match_karaoke, dst is only split into
+	/// characters once, so this is the function to use for whole scripts.
+	/// It is safe to call from multiple threads at once.
+	karaoke_line_match_result auto_match_karaoke_line(std::vector<std::string> const& src, std::string const& dst);
 }
@@ -14,14 +14,21 @@
 
 #include <libaegisub/fs_fwd.h>
 
+#include <atomic>
 #include <boost/interprocess/streams/bufferstream.hpp>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 // These macros below aren't a perm solution, it will depend on how annoying they are through
 // actual usage, and also depends on msvc support.
-#define LOG_SINK(section, severity) agi::log::Message(section, severity, __FILE__, __FUNCTION__, __LINE__).stream()
+// Filtered messages are rejected before anything in the message is evaluated.
+#define LOG_SINK(section, severity) \
+	if (!agi::log::log->IsEnabled(section, severity)) ; \
+	else agi::log::Message(section, severity, __FILE__, __FUNCTION__, __LINE__).stream()
 #define LOG_E(section) LOG_SINK(section, agi::log::Exception)
 #define LOG_A(section) LOG_SINK(section, agi::log::Assert)
 #define LOG_W(section) LOG_SINK(section, agi::log::Warning)
@@ -68,7 +75,17 @@ struct SinkMessage {
 class Emitter;
 
 /// Log sink, single destination for all messages
+///
+/// Each thread which logs gets its own lock-free ring buffer of messages,
+/// which are collected and passed to the emitters in a batch on the sink's
+/// queue, so logging a message doesn't take any locks unless the thread's
+/// buffer is full.
+///
+/// Only the emitters' work is deferred to the queue: a message's text has
+/// already been formatted by the logging thread when it reaches Log().
 class LogSink {
+	friend struct ThreadBufferOwner;
+
 	std::vector<SinkMessage> messages;
 	size_t next_idx = 0;
 	std::unique_ptr<dispatch::Queue> queue;
@@ -76,12 +93,46 @@ class LogSink {
 	/// List of pointers to emitters
 	std::vector<std::unique_ptr<Emitter>> emitters;
 
+	struct ThreadBuffer;
+	/// Unique ID for this sink, used to tell if a thread's buffer is ours
+	const uint64_t id;
+	std::mutex buffers_lock;
+	/// Buffers of all threads which have logged to this sink, each freed once
+	/// its thread exits and its messages have been collected
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	/// Is there a flush of the thread buffers queued?
+	std::atomic<bool> flush_queued{false};
+
+	/// Least severe messages to log
+	std::atomic<int> level{Debug};
+	std::atomic<bool> has_disabled_sections{false};
+	std::shared_ptr<const std::vector<std::string>> disabled_sections;
+
+	ThreadBuffer *GetThreadBuffer();
+	bool SectionEnabled(const char *section) const;
+	/// Collect the messages from all of the thread buffers and emit them.
+	/// Must be called on the queue.
+	void Flush();
+	void Emit(SinkMessage const& sm);
+
 public:
 	LogSink();
 	~LogSink();
 
 	/// Insert a message into the sink.
-	void Log(SinkMessage const& sm);
+	void Log(SinkMessage sm);
+
+	/// Should a message with the given section and severity be logged?
+	bool IsEnabled(const char *section, Severity severity) const {
+		return severity <= level && (!has_disabled_sections || SectionEnabled(section));
+	}
+
+	/// Set the least severe messages which should be logged
+	void SetLevel(Severity severity) { level = severity; }
+
+	/// @brief Stop logging messages from some sections
+	/// @param sections Sections to drop, along with all of their subsections
+	void SetDisabledSections(std::vector<std::string> sections);
 
 	/// @brief Subscribe an emitter
 	/// @param em Emitter to add
@@ -93,7 +144,7 @@ public:
 
 	/// @brief @get the complete (current) log.
 	/// @return Const pointer to internal sink.
-	std::vector<SinkMessage> GetMessages() const;
+	std::vector<SinkMessage> GetMessages();
 };
 
 /// An emitter to produce human readable output for a log sink.
@@ -118,7 +169,39 @@ public:
 	void log(SinkMessage const&) override;
 };
 
+/// An emitter which writes the log to a file in a compact binary format
+///
+/// Strings which are the same for every message from a given log statement
+/// are only written the first time they're seen, and nothing is formatted
+/// until the file is converted to json with ConvertBinaryLog.
+class BinaryEmitter final : public Emitter {
+	std::unique_ptr<std::ostream> fp;
+	std::unordered_map<const char *, uint64_t> string_ids;
+	int64_t last_time = 0;
+
+	uint64_t StringId(const char *str);
+
+public:
+	/// Constructor
+	/// @param directory Directory to write the log file in
+	BinaryEmitter(fs::path const& directory);
+
+	void log(SinkMessage const&) override;
+};
+
+/// @brief Convert a log written by BinaryEmitter to the format written by JsonEmitter
+/// @param in Binary log file
+/// @param out Stream to write json to
+/// @return false if the log ends partway through a record, as it will if
+///         the program crashed while writing it, in which case everything
+///         before the incomplete record is converted
+/// @throws agi::InvalidInputException if the input is not a binary log
+bool ConvertBinaryLog(std::istream& in, std::ostream& out);
+
 /// Generates a message and submits it to the log sink.
+///
+/// Everything written to stream() is formatted immediately on the calling
+/// thread; only messages which pass LogSink::IsEnabled get this far.
 class Message {
 	boost::interprocess::obufferstream msg;
 	SinkMessage sm;
@@ -17,6 +17,7 @@
 /// @ingroup libaegisub
 
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include <libaegisub/color.h>
@@ -172,4 +173,48 @@ CONFIG_OPTIONVALUE_ACCESSORS(std::vector<bool>, ListBool)
 #undef CONFIG_OPTIONVALUE
 #undef CONFIG_OPTIONVALUE_LIST
 #undef CONFIG_OPTIONVALUE_ACCESSORS
+
+namespace detail {
+	inline void GetOptionValue(OptionValue const& opt, std::string& out) { out = opt.GetString(); }
+	inline void GetOptionValue(OptionValue const& opt, int64_t& out) { out = opt.GetInt(); }
+	inline void GetOptionValue(OptionValue const& opt, double& out) { out = opt.GetDouble(); }
+	inline void GetOptionValue(OptionValue const& opt, Color& out) { out = opt.GetColor(); }
+	inline void GetOptionValue(OptionValue const& opt, bool& out) { out = opt.GetBool(); }
+	inline void GetOptionValue(OptionValue const& opt, std::vector<std::string>& out) { out = opt.GetListString(); }
+	inline void GetOptionValue(OptionValue const& opt, std::vector<int64_t>& out) { out = opt.GetListInt(); }
+	inline void GetOptionValue(OptionValue const& opt, std::vector<double>& out) { out = opt.GetListDouble(); }
+	inline void GetOptionValue(OptionValue const& opt, std::vector<Color>& out) { out = opt.GetListColor(); }
+	inline void GetOptionValue(OptionValue const& opt, std::vector<bool>& out) { out = opt.GetListBool(); }
+}
+
+/// @class CachedOptionValue
+/// @brief A copy of an option's value which is updated whenever the option
+///        changes
+///
+/// For options read in paint and keystroke handlers, where looking the
+/// option up by name each time is a significant part of the cost. The type
+/// is checked once when this is created rather than on every read.
+template<typename T>
+class CachedOptionValue {
+	OptionValue *opt;
+	T value;
+	signal::Connection connection;
+
+public:
+	explicit CachedOptionValue(OptionValue *opt)
+	: opt(opt)
+	, connection(opt->Subscribe([=](OptionValue const& opt) { detail::GetOptionValue(opt, value); }))
+	{
+		detail::GetOptionValue(*opt, value);
+	}
+
+	CachedOptionValue(CachedOptionValue const& other) : CachedOptionValue(other.opt) { }
+	CachedOptionValue& operator=(CachedOptionValue const&) = delete;
+
+	T const& operator*() const { return value; }
+	T const* operator->() const { return &value; }
+
+	/// Get the option this is a copy of
+	OptionValue *Option() const { return opt; }
+};
 } // namespace agi
@@ -0,0 +1,44 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file sequence_match.h
+/// @brief Alignment of two sequences of hashes for diffing
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace agi {
+	/// A pair of indices of equal elements in the two sequences
+	typedef std::pair<size_t, size_t> sequence_match;
+
+	/// @brief Find the elements two sequences have in common
+	/// @param a Old sequence, typically hashes of lines
+	/// @param b New sequence
+	/// @return Pairs (i, j) with a[i] == b[j], strictly increasing in both i and j
+	///
+	/// Uses patience diff: common prefixes and suffixes are matched, then
+	/// elements which occur exactly once in each sequence are used as anchors
+	/// and the gaps between them are matched recursively. Gaps with no
+	/// unique elements fall back to Myers' O(ND) algorithm, which gives up
+	/// and leaves the gap unmatched if the two sides differ too much. This
+	/// keeps the result close to a minimal diff while running in roughly
+	/// linear time on the sort of edits made to real files.
+	std::vector<sequence_match> MatchSequences(std::vector<uint64_t> const& a, std::vector<uint64_t> const& b);
+}
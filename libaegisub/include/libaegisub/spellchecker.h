@@ -16,11 +16,18 @@
 
 #pragma once
 
+#include <libaegisub/signal.h>
+
 #include <string>
 #include <vector>
 
 namespace agi {
 class SpellChecker {
+protected:
+	/// Signal for when the dictionary finishes loading, or the words in it or
+	/// the language of it change
+	agi::signal::Signal<> DictionaryChanged;
+
 public:
 	virtual ~SpellChecker() { }
 
@@ -54,6 +61,12 @@ public:
 
 	/// Get a list of languages which dictionaries are present for
 	virtual std::vector<std::string> GetLanguageList()=0;
+
+	/// Is the dictionary still being loaded in the background? Until it has
+	/// loaded every word is treated as correct and there are no suggestions.
+	virtual bool IsLoading() { return false; }
+
+	DEFINE_SIGNAL_ADDERS(DictionaryChanged, AddDictionaryChangedListener)
 };
 
 }
@@ -117,6 +117,17 @@ public:
 	/// start/end time would first/last be visible
 	int FrameAtTime(int ms, Time type = EXACT) const;
 
+	/// @brief Get the frames visible at each of a list of times
+	/// @param times Times in milliseconds
+	/// @param type Time mode
+	/// @return FrameAtTime(times[i], type) for each time
+	///
+	/// Sorted times are converted with a single galloping walk over the
+	/// timecodes rather than a full search per time, so converting n times
+	/// with m timecodes is O(n + m), and O(n + log m) for times close
+	/// together. Unsorted times are sorted first.
+	std::vector<int> FramesAtTimes(std::vector<int> const& times, Time type = EXACT) const;
+
 	/// @brief Get the time at a given frame
 	/// @param frame Frame number
 	/// @param type Time mode
@@ -21,8 +21,27 @@
 
 namespace {
 using namespace agi::dispatch;
+typedef std::chrono::steady_clock clock;
 std::function<void (Thunk)> invoke_main;
 
+struct PriorityStats {
+    std::atomic<size_t> depth{0};
+    std::atomic<uint64_t> started{0};
+    std::atomic<int64_t> total_wait{0};
+    std::atomic<int64_t> max_wait{0};
+};
+PriorityStats stats[PRIORITY_COUNT];
+
+void record_start(Priority priority, clock::time_point queued) {
+    auto& s = stats[priority];
+    int64_t wait = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - queued).count();
+    --s.depth;
+    ++s.started;
+    s.total_wait += wait;
+    int64_t max_wait = s.max_wait;
+    while (max_wait < wait && !s.max_wait.compare_exchange_weak(max_wait, wait)) ;
+}
+
 struct OSXQueue : Queue {
     virtual void DoSync(Thunk thunk)=0;
 };
@@ -54,11 +73,16 @@ struct MainQueue final : OSXQueue {
 
 struct GCDQueue final : OSXQueue {
     dispatch_queue_t queue;
-    GCDQueue(dispatch_queue_t queue) : queue(queue) { }
+    Priority priority;
+    GCDQueue(dispatch_queue_t queue, Priority priority) : queue(queue), priority(priority) { }
     ~GCDQueue() { dispatch_release(queue); }
 
     void DoInvoke(Thunk thunk) override {
+        ++stats[priority].depth;
+        auto queued = clock::now();
+        auto priority = this->priority;
         dispatch_async(queue, ^{
+            record_start(priority, queued);
             try {
                 thunk();
             }
@@ -91,6 +115,12 @@ void Init(std::function<void (Thunk)> invoke_main) {
 }
 
 void Queue::Async(Thunk thunk) { DoInvoke(std::move(thunk)); }
+void Queue::Async(Thunk thunk, CancellationToken token) {
+    DoInvoke([=] {
+        if (!token.IsCancelled())
+            thunk();
+    });
+}
 void Queue::Sync(Thunk thunk) { static_cast<OSXQueue *>(this)->DoSync(std::move(thunk)); }
 
 Queue& Main() {
@@ -98,13 +128,36 @@ Queue& Main() {
     return q;
 }
 
-Queue& Background() {
-    static GCDQueue q(dispatch_get_global_queue(0, DISPATCH_QUEUE_PRIORITY_DEFAULT));
-    return q;
+static long gcd_priority(Priority priority) {
+    switch (priority) {
+        case PRIORITY_BACKGROUND:  return DISPATCH_QUEUE_PRIORITY_BACKGROUND;
+        case PRIORITY_INTERACTIVE: return DISPATCH_QUEUE_PRIORITY_HIGH;
+        default:                   return DISPATCH_QUEUE_PRIORITY_DEFAULT;
+    }
+}
+
+Queue& Background(Priority priority) {
+    static GCDQueue queues[] = {
+        GCDQueue(dispatch_get_global_queue(gcd_priority(PRIORITY_BACKGROUND), 0), PRIORITY_BACKGROUND),
+        GCDQueue(dispatch_get_global_queue(gcd_priority(PRIORITY_NORMAL), 0), PRIORITY_NORMAL),
+        GCDQueue(dispatch_get_global_queue(gcd_priority(PRIORITY_INTERACTIVE), 0), PRIORITY_INTERACTIVE)
+    };
+    return queues[priority];
+}
+
+std::unique_ptr<Queue> Create(Priority priority) {
+    auto queue = dispatch_queue_create("Aegisub worker queue", DISPATCH_QUEUE_SERIAL);
+    dispatch_set_target_queue(queue, dispatch_get_global_queue(gcd_priority(priority), 0));
+    return std::unique_ptr<Queue>(new GCDQueue(queue, priority));
 }
 
-std::unique_ptr<Queue> Create() {
-    return std::unique_ptr<Queue>(new GCDQueue(dispatch_queue_create("Aegisub worker queue",
-                                                                     DISPATCH_QUEUE_SERIAL)));
+QueueStats GetStats(Priority priority) {
+    auto const& s = stats[priority];
+    QueueStats ret;
+    ret.depth = s.depth;
+    ret.started = s.started;
+    ret.total_wait = std::chrono::microseconds(s.total_wait);
+    ret.max_wait = std::chrono::microseconds(s.max_wait);
+    return ret;
 }
 } }
@@ -48,7 +48,9 @@ void Copy(fs::path const& from, fs::path const& to) {
 	acs::CheckDirWrite(to.parent_path());
 
 	auto in = io::Open(from, true);
-	io::Save(to).Get() << in->rdbuf();
+	io::Save file(to);
+	file.Get() << in->rdbuf();
+	file.Commit();
 }
 
 struct DirectoryIterator::PrivData {
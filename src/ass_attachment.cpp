@@ -55,7 +55,9 @@ size_t AssAttachment::GetSize() const {
 void AssAttachment::Extract(agi::fs::path const& filename) const {
 	auto header_end = entry_data.get().find('\n');
 	auto decoded = agi::ass::UUDecode(entry_data.get().c_str() + header_end + 1, &entry_data.get().back() + 1);
-	agi::io::Save(filename, true).Get().write(&decoded[0], decoded.size());
+	agi::io::Save file(filename, true);
+	file.Get().write(&decoded[0], decoded.size());
+	file.Commit();
 }
 
 std::string AssAttachment::GetFileName(bool raw) const {
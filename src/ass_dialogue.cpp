@@ -197,16 +197,19 @@ std::string AssDialogue::GetEntryData() const {
 }
 
 std::vector<std::unique_ptr<AssDialogueBlock>> AssDialogue::ParseTags() const {
+	return ParseTags(Text.get());
+}
+
+std::vector<std::unique_ptr<AssDialogueBlock>> AssDialogue::ParseTags(std::string const& text) {
 	std::vector<std::unique_ptr<AssDialogueBlock>> Blocks;
 
 	// Empty line, make an empty block
-	if (Text.get().empty()) {
+	if (text.empty()) {
 		Blocks.push_back(agi::make_unique<AssDialogueBlockPlain>());
 		return Blocks;
 	}
 
 	int drawingLevel = 0;
-	std::string const& text(Text.get());
 
 	for (size_t len = text.size(), cur = 0; cur < len; ) {
 		// Overrides block
@@ -283,6 +286,10 @@ bool AssDialogue::CollidesWith(const AssDialogue *target) const {
 
 static std::string get_text_p(AssDialogueBlock *d) { return d->GetText(); }
 std::string AssDialogue::GetStrippedText() const {
-	auto blocks = ParseTags();
+	return GetStrippedText(Text.get());
+}
+
+std::string AssDialogue::GetStrippedText(std::string const& text) {
+	auto blocks = ParseTags(text);
 	return join(blocks | agi::of_type<AssDialogueBlockPlain>() | transformed(get_text_p), "");
 }
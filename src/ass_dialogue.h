@@ -155,12 +155,16 @@ public:
 
 	/// Parse text as ASS and return block information
 	std::vector<std::unique_ptr<AssDialogueBlock>> ParseTags() const;
+	/// Parse the given text as ASS and return block information
+	static std::vector<std::unique_ptr<AssDialogueBlock>> ParseTags(std::string const& text);
 
 	/// Strip all ASS tags from the text
 	void StripTags();
 	/// Strip a specific ASS tag from the text
 	/// Get text without tags
 	std::string GetStrippedText() const;
+	/// Get the given text without tags
+	static std::string GetStrippedText(std::string const& text);
 
 	/// Update the text of the line from parsed blocks
 	void UpdateText(std::vector<std::unique_ptr<AssDialogueBlock>>& blocks);
@@ -0,0 +1,388 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file ass_diff.cpp
+/// @brief Line-aware comparison and three-way merging of subtitle files
+
+#include "ass_diff.h"
+
+#include "ass_file.h"
+#include "ass_style.h"
+
+#include <libaegisub/sequence_match.h>
+
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/join.hpp>
+#include <boost/functional/hash.hpp>
+#include <map>
+
+namespace {
+using namespace ass_diff;
+
+typedef std::vector<const AssDialogue *> line_list;
+
+uint64_t text_hash(AssDialogueBase const& line) {
+	return std::hash<std::string>()(line.Text.get());
+}
+
+uint64_t line_hash(AssDialogueBase const& line) {
+	size_t seed = text_hash(line);
+	boost::hash_combine(seed, line.Comment);
+	boost::hash_combine(seed, line.Layer);
+	boost::hash_combine(seed, (int)line.Start);
+	boost::hash_combine(seed, (int)line.End);
+	boost::hash_combine(seed, line.Style.get());
+	boost::hash_combine(seed, line.Actor.get());
+	boost::hash_combine(seed, line.Effect.get());
+	boost::hash_range(seed, line.Margin.begin(), line.Margin.end());
+	return seed;
+}
+
+template<class Hash>
+std::vector<uint64_t> hashes(line_list const& lines, size_t begin, size_t end, Hash hash) {
+	std::vector<uint64_t> ret;
+	ret.reserve(end - begin);
+	for (size_t i = begin; i < end; ++i)
+		ret.push_back(hash(*lines[i]));
+	return ret;
+}
+
+/// Could two lines with different text plausibly be versions of each other?
+bool related(AssDialogueBase const& a, AssDialogueBase const& b) {
+	if (a.Style != b.Style) return false;
+	if (a.Start == b.Start) return true;
+	return std::max(a.Start, b.Start) < std::min(a.End, b.End);
+}
+
+/// Pair up lines in a gap between two full matches, first by text and then
+/// by style and time
+void pair_gap(line_list const& a, size_t a0, size_t a1, line_list const& b, size_t b0, size_t b1, std::vector<int>& a_to_b) {
+	if (a0 == a1 || b0 == b1) return;
+
+	// Pairing only moves forward in both files, so a line from a which has
+	// no related line left in b stays unpaired
+	auto pair_remaining = [&](size_t i0, size_t i1, size_t j0, size_t j1) {
+		for (; i0 < i1 && j0 < j1; ++i0) {
+			for (size_t j = j0; j < j1; ++j) {
+				if (related(*a[i0], *b[j])) {
+					a_to_b[i0] = j;
+					j0 = j + 1;
+					break;
+				}
+			}
+		}
+	};
+
+	size_t i = a0, j = b0;
+	for (auto const& m : agi::MatchSequences(hashes(a, a0, a1, text_hash), hashes(b, b0, b1, text_hash))) {
+		size_t match_a = a0 + m.first, match_b = b0 + m.second;
+		pair_remaining(i, match_a, j, match_b);
+		a_to_b[match_a] = match_b;
+		i = match_a + 1;
+		j = match_b + 1;
+	}
+	pair_remaining(i, a1, j, b1);
+}
+
+/// Get the index of the counterpart in b of each line in a, or -1 if it
+/// has none
+std::vector<int> match_lines(line_list const& a, line_list const& b) {
+	std::vector<int> a_to_b(a.size(), -1);
+
+	size_t a0 = 0, b0 = 0;
+	for (auto const& m : agi::MatchSequences(hashes(a, 0, a.size(), line_hash), hashes(b, 0, b.size(), line_hash))) {
+		pair_gap(a, a0, m.first, b, b0, m.second, a_to_b);
+		a_to_b[m.first] = m.second;
+		a0 = m.first + 1;
+		b0 = m.second + 1;
+	}
+	pair_gap(a, a0, a.size(), b, b0, b.size(), a_to_b);
+
+	return a_to_b;
+}
+
+line_list events(AssFile const& file) {
+	line_list ret;
+	for (auto const& line : file.Events)
+		ret.push_back(&line);
+	return ret;
+}
+
+std::map<std::string, const AssStyle *> styles_by_name(AssFile const& file) {
+	std::map<std::string, const AssStyle *> ret;
+	for (auto const& style : file.Styles)
+		ret[boost::to_lower_copy(style.name)] = &style;
+	return ret;
+}
+
+void copy_fields(AssDialogueBase &dst, AssDialogueBase const& src, int fields) {
+	if (fields & FIELD_COMMENT) dst.Comment = src.Comment;
+	if (fields & FIELD_LAYER) dst.Layer = src.Layer;
+	if (fields & FIELD_START) dst.Start = src.Start;
+	if (fields & FIELD_END) dst.End = src.End;
+	if (fields & FIELD_STYLE) dst.Style = src.Style;
+	if (fields & FIELD_ACTOR) dst.Actor = src.Actor;
+	if (fields & FIELD_MARGIN) dst.Margin = src.Margin;
+	if (fields & FIELD_EFFECT) dst.Effect = src.Effect;
+	if (fields & FIELD_TEXT) dst.Text = src.Text;
+}
+
+/// Copy a line from another file, moving its extradata over
+AssDialogue *import_line(AssDialogue const& line, AssFile const& from, AssFile &to) {
+	auto copy = new AssDialogue(line);
+	if (!line.ExtradataIds.get().empty()) {
+		std::vector<uint32_t> ids;
+		for (auto const& entry : from.GetExtradata(line.ExtradataIds))
+			ids.push_back(to.AddExtradata(entry.key, entry.value));
+		copy->ExtradataIds = ids;
+	}
+	return copy;
+}
+}
+
+namespace ass_diff {
+int ChangedFields(AssDialogueBase const& a, AssDialogueBase const& b) {
+	int fields = 0;
+	if (a.Comment != b.Comment) fields |= FIELD_COMMENT;
+	if (a.Layer != b.Layer) fields |= FIELD_LAYER;
+	if (a.Start != b.Start) fields |= FIELD_START;
+	if (a.End != b.End) fields |= FIELD_END;
+	if (a.Style != b.Style) fields |= FIELD_STYLE;
+	if (a.Actor != b.Actor) fields |= FIELD_ACTOR;
+	if (a.Margin != b.Margin) fields |= FIELD_MARGIN;
+	if (a.Effect != b.Effect) fields |= FIELD_EFFECT;
+	if (a.Text != b.Text) fields |= FIELD_TEXT;
+	return fields;
+}
+
+std::string DescribeFields(int fields) {
+	static const std::pair<int, const char *> names[] = {
+		{FIELD_COMMENT, "comment"},
+		{FIELD_LAYER, "layer"},
+		{FIELD_START, "start"},
+		{FIELD_END, "end"},
+		{FIELD_STYLE, "style"},
+		{FIELD_ACTOR, "actor"},
+		{FIELD_MARGIN, "margins"},
+		{FIELD_EFFECT, "effect"},
+		{FIELD_TEXT, "text"}
+	};
+
+	std::vector<std::string> ret;
+	for (auto const& name : names) {
+		if (fields & name.first)
+			ret.emplace_back(name.second);
+	}
+	return boost::join(ret, ", ");
+}
+
+FileDiff Diff(AssFile const& old_file, AssFile const& new_file) {
+	FileDiff diff;
+
+	auto old_lines = events(old_file);
+	auto new_lines = events(new_file);
+	auto old_to_new = match_lines(old_lines, new_lines);
+
+	size_t j = 0;
+	for (size_t i = 0; i < old_lines.size(); ++i) {
+		int counterpart = old_to_new[i];
+		if (counterpart < 0) {
+			diff.lines.push_back(LineChange{REMOVED, old_lines[i], nullptr, 0, i + 1, 0});
+			continue;
+		}
+
+		for (; j < (size_t)counterpart; ++j)
+			diff.lines.push_back(LineChange{ADDED, nullptr, new_lines[j], 0, 0, j + 1});
+		++j;
+
+		if (int fields = ChangedFields(*old_lines[i], *new_lines[counterpart]))
+			diff.lines.push_back(LineChange{MODIFIED, old_lines[i], new_lines[counterpart], fields, i + 1, (size_t)counterpart + 1});
+	}
+	for (; j < new_lines.size(); ++j)
+		diff.lines.push_back(LineChange{ADDED, nullptr, new_lines[j], 0, 0, j + 1});
+
+	auto old_styles = styles_by_name(old_file);
+	auto new_styles = styles_by_name(new_file);
+	for (auto const& style : old_styles) {
+		auto it = new_styles.find(style.first);
+		if (it == new_styles.end())
+			diff.styles.push_back(StyleChange{REMOVED, style.second, nullptr});
+		else if (it->second->GetEntryData() != style.second->GetEntryData())
+			diff.styles.push_back(StyleChange{MODIFIED, style.second, it->second});
+	}
+	for (auto const& style : new_styles) {
+		if (!old_styles.count(style.first))
+			diff.styles.push_back(StyleChange{ADDED, nullptr, style.second});
+	}
+
+	return diff;
+}
+
+MergeResult Merge(AssFile const& base, AssFile &ours, AssFile const& theirs) {
+	MergeResult result;
+
+	auto base_lines = events(base);
+	auto our_lines = events(ours);
+	auto their_lines = events(theirs);
+	auto base_to_ours = match_lines(base_lines, our_lines);
+	auto base_to_theirs = match_lines(base_lines, their_lines);
+
+	// Lines added on each side are placed before the base line which
+	// follows them
+	auto insertions = [&](line_list const& lines, std::vector<int> const& base_to_side) {
+		std::vector<int> side_to_base(lines.size(), -1);
+		for (size_t i = 0; i < base_to_side.size(); ++i) {
+			if (base_to_side[i] >= 0)
+				side_to_base[base_to_side[i]] = i;
+		}
+
+		std::vector<std::vector<const AssDialogue *>> inserted(base_lines.size() + 1);
+		std::vector<const AssDialogue *> pending;
+		for (size_t j = 0; j < lines.size(); ++j) {
+			if (side_to_base[j] < 0)
+				pending.push_back(lines[j]);
+			else if (!pending.empty())
+				inserted[side_to_base[j]].swap(pending);
+		}
+		inserted.back().swap(pending);
+		return inserted;
+	};
+	auto our_insertions = insertions(our_lines, base_to_ours);
+	auto their_insertions = insertions(their_lines, base_to_theirs);
+
+	std::vector<AssDialogue *> merged;
+	merged.reserve(our_lines.size() + their_lines.size());
+	std::vector<AssDialogue *> deleted;
+
+	for (size_t i = 0; i <= base_lines.size(); ++i) {
+		for (auto line : our_insertions[i])
+			merged.push_back(const_cast<AssDialogue *>(line));
+		for (auto line : their_insertions[i]) {
+			// Skip lines which both sides added
+			bool duplicate = any_of(begin(our_insertions[i]), end(our_insertions[i]),
+				[&](const AssDialogue *ours) { return !ChangedFields(*ours, *line); });
+			if (!duplicate)
+				merged.push_back(import_line(*line, theirs, ours));
+		}
+
+		if (i == base_lines.size()) break;
+
+		auto base_line = base_lines[i];
+		auto our_line = base_to_ours[i] < 0 ? nullptr : const_cast<AssDialogue *>(our_lines[base_to_ours[i]]);
+		auto their_line = base_to_theirs[i] < 0 ? nullptr : their_lines[base_to_theirs[i]];
+		int our_changes = our_line ? ChangedFields(*base_line, *our_line) : 0;
+		int their_changes = their_line ? ChangedFields(*base_line, *their_line) : 0;
+
+		if (our_line && their_line) {
+			int conflicts = our_changes & their_changes & ChangedFields(*our_line, *their_line);
+			copy_fields(*our_line, *their_line, their_changes & ~our_changes);
+			merged.push_back(our_line);
+			if (conflicts)
+				result.lines.push_back(MergeConflict{CONFLICT_FIELDS, our_line, *their_line, conflicts});
+		}
+		else if (our_line) {
+			if (our_changes) {
+				merged.push_back(our_line);
+				result.lines.push_back(MergeConflict{CONFLICT_DELETED_BY_THEM, our_line, AssDialogueBase(), our_changes});
+			}
+			else
+				deleted.push_back(our_line);
+		}
+		else if (their_line && their_changes) {
+			auto line = import_line(*their_line, theirs, ours);
+			merged.push_back(line);
+			result.lines.push_back(MergeConflict{CONFLICT_DELETED_BY_US, line, *their_line, their_changes});
+		}
+	}
+
+	ours.Events.clear();
+	for (auto line : merged)
+		ours.Events.push_back(*line);
+	for (auto line : deleted)
+		delete line;
+
+	// Styles are matched by name, and only one side changing a style takes
+	// that side's version
+	auto base_styles = styles_by_name(base);
+	auto our_styles = styles_by_name(ours);
+	auto data = [](std::map<std::string, const AssStyle *> const& styles, std::string const& name) {
+		auto it = styles.find(name);
+		return it == styles.end() ? std::string() : it->second->GetEntryData();
+	};
+	for (auto const& style : styles_by_name(theirs)) {
+		std::string base_data = data(base_styles, style.first);
+		std::string their_data = style.second->GetEntryData();
+		if (their_data == base_data) continue;
+
+		auto our_style = our_styles.find(style.first);
+		if (our_style == our_styles.end()) {
+			if (base_data.empty())
+				ours.Styles.push_back(*new AssStyle(*style.second));
+			else
+				result.styles.push_back(style.second->name);
+			continue;
+		}
+
+		std::string const& our_data = our_style->second->GetEntryData();
+		if (our_data == their_data) continue;
+		if (our_data == base_data) {
+			auto replacement = new AssStyle(*style.second);
+			auto old = const_cast<AssStyle *>(our_style->second);
+			ours.Styles.insert(ours.Styles.iterator_to(*old), *replacement);
+			delete old;
+		}
+		else
+			result.styles.push_back(style.second->name);
+	}
+
+	// Styles they deleted
+	auto their_styles = styles_by_name(theirs);
+	for (auto const& style : base_styles) {
+		if (their_styles.count(style.first)) continue;
+		auto our_style = our_styles.find(style.first);
+		if (our_style == our_styles.end()) continue;
+		if (our_style->second->GetEntryData() == style.second->GetEntryData())
+			delete our_style->second;
+		else
+			result.styles.push_back(our_style->second->name);
+	}
+
+	return result;
+}
+
+bool Resolve(MergeConflict const& conflict, bool keep_theirs) {
+	switch (conflict.type) {
+		case CONFLICT_FIELDS:
+			if (keep_theirs)
+				copy_fields(*conflict.line, conflict.theirs, conflict.fields);
+			return false;
+		case CONFLICT_DELETED_BY_US:
+			if (!keep_theirs) {
+				delete conflict.line;
+				return true;
+			}
+			return false;
+		case CONFLICT_DELETED_BY_THEM:
+			if (keep_theirs) {
+				delete conflict.line;
+				return true;
+			}
+			return false;
+	}
+	return false;
+}
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file ass_diff.h
+/// @brief Line-aware comparison and three-way merging of subtitle files
+
+#pragma once
+
+#include "ass_dialogue.h"
+
+#include <string>
+#include <vector>
+
+class AssFile;
+class AssStyle;
+
+namespace ass_diff {
+	/// Fields of a dialogue line which can differ between versions
+	enum Field {
+		FIELD_COMMENT = 0x1,
+		FIELD_LAYER   = 0x2,
+		FIELD_START   = 0x4,
+		FIELD_END     = 0x8,
+		FIELD_STYLE   = 0x10,
+		FIELD_ACTOR   = 0x20,
+		FIELD_MARGIN  = 0x40,
+		FIELD_EFFECT  = 0x80,
+		FIELD_TEXT    = 0x100
+	};
+
+	/// Get the Field flags of the fields which differ between two lines
+	int ChangedFields(AssDialogueBase const& a, AssDialogueBase const& b);
+
+	/// Get a short comma-separated description of a set of Field flags
+	std::string DescribeFields(int fields);
+
+	enum ChangeType {
+		ADDED,
+		REMOVED,
+		MODIFIED
+	};
+
+	struct LineChange {
+		ChangeType type;
+		/// The line in the old file, or nullptr if it was added
+		const AssDialogue *old_line;
+		/// The line in the new file, or nullptr if it was removed
+		const AssDialogue *new_line;
+		/// Field flags of the fields which differ for modified lines
+		int fields;
+		/// 1-based position of the line in the old file, or 0 if it was added
+		size_t old_number;
+		/// 1-based position of the line in the new file, or 0 if it was removed
+		size_t new_number;
+	};
+
+	struct StyleChange {
+		ChangeType type;
+		const AssStyle *old_style;
+		const AssStyle *new_style;
+	};
+
+	struct FileDiff {
+		/// Changed lines, in file order
+		std::vector<LineChange> lines;
+		/// Changed styles, matched by name
+		std::vector<StyleChange> styles;
+	};
+
+	/// @brief Compare the events and styles of two files
+	///
+	/// Lines are aligned by hashes of their full contents, and the lines
+	/// left over between matches are then aligned by their text so that
+	/// retimed or restyled lines are reported as modifications rather than
+	/// as a removal and an addition. Lines still unpaired between two
+	/// matches are only paired up, in order, with lines which have the same
+	/// style and overlapping times; the rest are reported as removals and
+	/// additions.
+	///
+	/// The pointers in the result point into the two files.
+	FileDiff Diff(AssFile const& old_file, AssFile const& new_file);
+
+	enum ConflictType {
+		/// Both sides changed the same fields of a line to different values
+		CONFLICT_FIELDS,
+		/// Their side changed a line which our side deleted
+		CONFLICT_DELETED_BY_US,
+		/// Our side changed a line which their side deleted
+		CONFLICT_DELETED_BY_THEM
+	};
+
+	struct MergeConflict {
+		ConflictType type;
+		/// The line in the merged file. For field conflicts this holds our
+		/// values for the conflicting fields; for deletion conflicts it is
+		/// the version of the line which was changed.
+		AssDialogue *line;
+		/// Their version of the line, for field conflicts
+		AssDialogueBase theirs;
+		/// Field flags of the conflicting fields
+		int fields;
+	};
+
+	struct MergeResult {
+		std::vector<MergeConflict> lines;
+		/// Names of styles which both sides changed differently
+		std::vector<std::string> styles;
+	};
+
+	/// @brief Merge the changes made in theirs since base into ours
+	/// @param base Common ancestor of the two versions
+	/// @param ours File to merge into
+	/// @param theirs Other changed version
+	/// @return The conflicts which could not be merged automatically
+	///
+	/// Changes made on only one side, including changes to different fields
+	/// of the same line, are merged automatically. Where both sides changed
+	/// something differently our version is kept and a conflict is reported.
+	/// Lines from ours keep their identity, so the selection and undo
+	/// history remain meaningful. The caller is responsible for committing
+	/// the changes to ours.
+	MergeResult Merge(AssFile const& base, AssFile &ours, AssFile const& theirs);
+
+	/// @brief Resolve a conflict by picking one side's version of the line
+	/// @param keep_theirs Use their version rather than ours
+	/// @return Was the line deleted? If so conflict.line is no longer valid.
+	///
+	/// Deletion conflicts are merged as the changed line, so keeping the side
+	/// which deleted it deletes the line.
+	bool Resolve(MergeConflict const& conflict, bool keep_theirs);
+}
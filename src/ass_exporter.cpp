@@ -41,6 +41,8 @@
 #include "project.h"
 #include "subtitle_format.h"
 
+#include <libaegisub/make_unique.h>
+
 #include <memory>
 #include <wx/sizer.h>
 
@@ -80,18 +82,26 @@ std::vector<std::string> AssExporter::GetAllFilterNames() const {
 }
 
 void AssExporter::Export(agi::fs::path const& filename, std::string const& charset, wxWindow *export_dialog) {
-	AssFile subs(*c->ass);
+	Export(std::vector<agi::fs::path>{filename}, charset, export_dialog);
+}
 
-	for (auto filter : filters) {
-		filter->LoadSettings(is_default, c);
-		filter->ProcessSubs(&subs, export_dialog);
-	}
+void AssExporter::Export(std::vector<agi::fs::path> const& filenames, std::string const& charset, wxWindow *export_dialog) {
+	// Check the targets before running the filters, which may be slow;
+	// GetWriter throws for any file no format can write
+	for (auto const& filename : filenames)
+		SubtitleFormat::GetWriter(filename);
 
-	const SubtitleFormat *writer = SubtitleFormat::GetWriter(filename);
-	if (!writer)
-		throw agi::InvalidInputException("Unknown file type.");
+	// Writers never modify the file, so only filters need a copy
+	std::unique_ptr<AssFile> subs;
+	if (!filters.empty()) {
+		subs = agi::make_unique<AssFile>(*c->ass);
+		for (auto filter : filters) {
+			filter->LoadSettings(is_default, c);
+			filter->ProcessSubs(subs.get(), export_dialog);
+		}
+	}
 
-	writer->ExportFile(&subs, filename, c->project->Timecodes(), charset);
+	SubtitleFormat::ExportMultiple(subs ? subs.get() : c->ass.get(), filenames, c->project->Timecodes(), charset);
 }
 
 wxSizer *AssExporter::GetSettingsSizer(std::string const& name) {
@@ -75,6 +75,12 @@ public:
 	/// @param parent_window Parent window the filters should use when opening dialogs
 	void Export(agi::fs::path const& file, std::string const& charset, wxWindow *parent_window= nullptr);
 
+	/// Apply selected export filters once and save to each of several files
+	/// @param files Target filenames, each of which may be a different format
+	/// @param charset Target charset
+	/// @param parent_window Parent window the filters should use when opening dialogs
+	void Export(std::vector<agi::fs::path> const& files, std::string const& charset, wxWindow *parent_window= nullptr);
+
 	/// Add configuration panels for all registered filters to the target sizer
 	/// @param parent Parent window for controls
 	/// @param target_sizer Sizer to add configuration panels to
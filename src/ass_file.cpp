@@ -24,14 +24,20 @@
 #include "options.h"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
 #include <cassert>
 #include <unordered_map>
 #include <unordered_set>
 
-AssFile::AssFile() { }
+namespace {
+std::atomic<uint64_t> next_commit_version{0};
+}
+
+AssFile::AssFile() : commit_version(++next_commit_version) { }
 
 AssFile::~AssFile() {
 	Styles.clear_and_dispose([](AssStyle *e) { delete e; });
@@ -64,10 +70,10 @@ void AssFile::LoadDefault(bool include_dialogue_line, std::string const& style_c
 }
 
 AssFile::AssFile(const AssFile &from)
-: Info(from.Info)
+: commit_version(++next_commit_version)
+, Info(from.Info)
 , Attachments(from.Attachments)
 , Extradata(from.Extradata)
-, next_extradata_id(from.next_extradata_id)
 {
 	Styles.clone_from(from.Styles,
 		[](AssStyle const& e) { return new AssStyle(e); },
@@ -82,9 +88,8 @@ void AssFile::swap(AssFile& from) throw() {
 	Styles.swap(from.Styles);
 	Events.swap(from.Events);
 	Attachments.swap(from.Attachments);
-	Extradata.swap(from.Extradata);
+	std::swap(Extradata, from.Extradata);
 	std::swap(Properties, from.Properties);
-	std::swap(next_extradata_id, from.next_extradata_id);
 }
 
 AssFile& AssFile::operator=(AssFile from) {
@@ -161,7 +166,11 @@ std::vector<std::string> AssFile::GetStyles() const {
 }
 
 AssStyle *AssFile::GetStyle(std::string const& name) {
-	for (auto& style : Styles) {
+	return const_cast<AssStyle *>(static_cast<const AssFile *>(this)->GetStyle(name));
+}
+
+const AssStyle *AssFile::GetStyle(std::string const& name) const {
+	for (auto const& style : Styles) {
 		if (boost::iequals(style.name, name))
 			return &style;
 	}
@@ -175,6 +184,7 @@ int AssFile::Commit(wxString const& desc, int type, int amend_id, AssDialogue *s
 			event.Row = i++;
 	}
 
+	commit_version = ++next_commit_version;
 	PushState({desc, &amend_id, single_line});
 
 	AnnounceCommit(type, single_line);
@@ -227,48 +237,80 @@ void AssFile::Sort(EntryList<AssDialogue> &lst, CompFunc comp, std::set<AssDialo
 	}
 }
 
-uint32_t AssFile::AddExtradata(std::string const& key, std::string const& value) {
-	for (auto const& data : Extradata) {
-		// perform brute-force deduplication by simple key and value comparison
-		if (key == data.key && value == data.value) {
-			return data.id;
-		}
-	}
-	Extradata.push_back(ExtradataEntry{next_extradata_id, key, value});
-	return next_extradata_id++; // return old value, then post-increment
+size_t ExtradataStore::Hash(std::string const& key, std::string const& value) {
+	size_t seed = 0;
+	boost::hash_combine(seed, key);
+	boost::hash_combine(seed, value);
+	return seed;
 }
 
-namespace {
-struct extradata_id_cmp {
-	bool operator()(ExtradataEntry const& e, uint32_t id) {
-		return e.id < id;
-	}
-	bool operator()(uint32_t id, ExtradataEntry const& e) {
-		return id < e.id;
+void ExtradataStore::Reindex() {
+	index.clear();
+	index.reserve(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i)
+		index.emplace(Hash(entries[i].key, entries[i].value), i);
+}
+
+uint32_t ExtradataStore::Add(std::string const& key, std::string const& value) {
+	size_t hash = Hash(key, value);
+	auto range = index.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		auto const& entry = entries[it->second];
+		if (entry.key == key && entry.value == value)
+			return entry.id;
 	}
-};
 
-template<typename ExtradataType, typename Func>
-void enumerate_extradata(ExtradataType&& extradata, std::vector<uint32_t> const& id_list, Func&& f) {
-	auto begin = extradata.begin(), end = extradata.end();
-	for (auto id : id_list) {
-		auto it = lower_bound(begin, end, id, extradata_id_cmp{});
-		if (it != end) {
-			f(*it);
-			begin = it;
-		}
+	// New ids are always larger than the existing ones, so this keeps the
+	// entries sorted
+	index.emplace(hash, entries.size());
+	entries.push_back(ExtradataEntry{next_id, key, value});
+	return next_id++;
+}
+
+void ExtradataStore::Insert(ExtradataEntry entry) {
+	// ensure next_id is always at least 1 more than the largest existing id
+	next_id = std::max(entry.id + 1, next_id);
+
+	if (entries.empty() || entries.back().id < entry.id) {
+		index.emplace(Hash(entry.key, entry.value), entries.size());
+		entries.push_back(std::move(entry));
+		return;
 	}
+
+	auto it = lower_bound(entries.begin(), entries.end(), entry.id, [](ExtradataEntry const& e, uint32_t id) {
+		return e.id < id;
+	});
+	if (it != entries.end() && it->id == entry.id)
+		*it = std::move(entry);
+	else
+		entries.insert(it, std::move(entry));
+	Reindex();
+}
+
+void ExtradataStore::Assign(std::vector<ExtradataEntry> new_entries) {
+	entries = std::move(new_entries);
+	if (!entries.empty())
+		next_id = std::max(entries.back().id + 1, next_id);
+	Reindex();
+}
+
+ExtradataEntry const* ExtradataStore::Find(uint32_t id) const {
+	auto it = lower_bound(entries.begin(), entries.end(), id, [](ExtradataEntry const& e, uint32_t id) {
+		return e.id < id;
+	});
+	return it != entries.end() && it->id == id ? &*it : nullptr;
 }
 
-template<typename K, typename V>
-using reference_map = std::unordered_map<std::reference_wrapper<const K>, V, std::hash<K>, std::equal_to<K>>;
+uint32_t AssFile::AddExtradata(std::string const& key, std::string const& value) {
+	return Extradata.Add(key, value);
 }
 
 std::vector<ExtradataEntry> AssFile::GetExtradata(std::vector<uint32_t> const& id_list) const {
 	std::vector<ExtradataEntry> result;
-	enumerate_extradata(Extradata, id_list, [&](ExtradataEntry const& e) {
-		result.push_back(e);
-	});
+	for (auto id : id_list) {
+		if (auto entry = Extradata.Find(id))
+			result.push_back(*entry);
+	}
 	return result;
 }
 
@@ -276,33 +318,45 @@ void AssFile::CleanExtradata() {
 	if (Extradata.empty()) return;
 
 	std::unordered_set<uint32_t> ids_used;
+	std::vector<ExtradataEntry const*> line_entries;
 	for (auto& line : Events) {
-		if (line.ExtradataIds.get().empty()) continue;
-
-		// Find the ID for each unique key in the line
-		reference_map<std::string, uint32_t> keys_used;
-		enumerate_extradata(Extradata, line.ExtradataIds.get(), [&](ExtradataEntry const& e) {
-			keys_used[e.key] = e.id;
-		});
+		auto const& line_ids = line.ExtradataIds.get();
+		if (line_ids.empty()) continue;
+
+		// Find the entry for each unique key in the line, with later ids
+		// replacing earlier ones with the same key. Lines only ever have a
+		// few entries, so a linear search is cheaper than a map.
+		line_entries.clear();
+		for (auto id : line_ids) {
+			auto entry = Extradata.Find(id);
+			if (!entry) continue;
+			auto same_key = find_if(begin(line_entries), end(line_entries), [&](ExtradataEntry const *e) {
+				return e->key == entry->key;
+			});
+			if (same_key == end(line_entries))
+				line_entries.push_back(entry);
+			else if ((*same_key)->id < entry->id)
+				*same_key = entry;
+		}
 
-		for (auto const& used : keys_used)
-			ids_used.insert(used.second);
+		for (auto entry : line_entries)
+			ids_used.insert(entry->id);
 
 		// If any keys were duplicated or missing, update the id list
-		if (keys_used.size() != line.ExtradataIds.get().size()) {
+		if (line_entries.size() != line_ids.size()) {
 			std::vector<uint32_t> ids;
-			ids.reserve(keys_used.size());
-			for (auto const& used : keys_used)
-				ids.push_back(used.second);
+			ids.reserve(line_entries.size());
+			for (auto entry : line_entries)
+				ids.push_back(entry->id);
 			std::sort(begin(ids), end(ids));
 			line.ExtradataIds = std::move(ids);
 		}
 	}
 
+	// Erase all no-longer-used extradata entries
 	if (ids_used.size() != Extradata.size()) {
-		// Erase all no-longer-used extradata entries
-		Extradata.erase(std::remove_if(begin(Extradata), end(Extradata), [&](ExtradataEntry const& e) {
+		Extradata.RemoveIf([&](ExtradataEntry const& e) {
 			return !ids_used.count(e.id);
-		}), end(Extradata));
+		});
 	}
 }
@@ -32,9 +32,11 @@
 #include <libaegisub/fs_fwd.h>
 #include <libaegisub/signal.h>
 
+#include <algorithm>
 #include <boost/intrusive/list.hpp>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 class AssAttachment;
@@ -52,6 +54,51 @@ struct ExtradataEntry {
 	std::string value;
 };
 
+/// Extradata entries sorted by id, with an index from each key and value to
+/// the entry holding them so that adding duplicates doesn't need to search
+/// every entry
+class ExtradataStore {
+	std::vector<ExtradataEntry> entries;
+	/// Hash of key and value -> position in entries
+	std::unordered_multimap<size_t, size_t> index;
+	uint32_t next_id = 0;
+
+	static size_t Hash(std::string const& key, std::string const& value);
+	void Reindex();
+
+public:
+	typedef std::vector<ExtradataEntry>::const_iterator const_iterator;
+
+	/// Get the id of the entry with the given key and value, adding one if
+	/// there isn't one already
+	uint32_t Add(std::string const& key, std::string const& value);
+
+	/// Add an entry with a specific id, such as one read from a file
+	void Insert(ExtradataEntry entry);
+
+	/// Replace all entries, such as when restoring an undo state
+	void Assign(std::vector<ExtradataEntry> new_entries);
+
+	/// Get the entry with the given id, or nullptr if there is none
+	ExtradataEntry const* Find(uint32_t id) const;
+
+	/// Remove all of the entries for which pred returns true
+	template<typename Predicate>
+	void RemoveIf(Predicate pred) {
+		auto it = std::remove_if(entries.begin(), entries.end(), pred);
+		if (it == entries.end()) return;
+		entries.erase(it, entries.end());
+		Reindex();
+	}
+
+	std::vector<ExtradataEntry> const& Entries() const { return entries; }
+	const_iterator begin() const { return entries.begin(); }
+	const_iterator end() const { return entries.end(); }
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	void clear() { entries.clear(); index.clear(); }
+};
+
 struct AssFileCommit {
 	wxString const& message;
 	int *commit_id;
@@ -82,17 +129,19 @@ class AssFile {
 	/// A set of changes has been committed to the file (AssFile::COMMITType)
 	agi::signal::Signal<int, const AssDialogue*> AnnounceCommit;
 	agi::signal::Signal<AssFileCommit> PushState;
+
+	/// Changed on every commit; never shared with any other file, so it also
+	/// identifies which file the contents belong to
+	uint64_t commit_version;
 public:
 	/// The lines in the file
 	std::vector<AssInfo> Info;
 	EntryList<AssStyle> Styles;
 	EntryList<AssDialogue> Events;
 	std::vector<AssAttachment> Attachments;
-	std::vector<ExtradataEntry> Extradata;
+	ExtradataStore Extradata;
 	ProjectProperties Properties;
 
-	uint32_t next_extradata_id = 0;
-
 	AssFile();
 	AssFile(const AssFile &from);
 	AssFile& operator=(AssFile from);
@@ -112,6 +161,7 @@ public:
 	/// @param name Style name
 	/// @return Pointer to style or nullptr
 	AssStyle *GetStyle(std::string const& name);
+	const AssStyle *GetStyle(std::string const& name) const;
 
 	void swap(AssFile &) throw();
 
@@ -179,6 +229,10 @@ public:
 	/// @return Unique identifier for the new undo group
 	int Commit(wxString const& desc, int type, int commitId = -1, AssDialogue *single_line = nullptr);
 
+	/// Get a counter which is incremented by every commit, for caching things
+	/// derived from the file's contents
+	uint64_t GetCommitVersion() const { return commit_version; }
+
 	/// Comparison function for use when sorting
 	typedef bool (*CompFunc)(AssDialogue const& lft, AssDialogue const& rgt);
 
@@ -43,6 +43,7 @@
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <functional>
+#include <mutex>
 
 using namespace boost::adaptors;
 
@@ -174,9 +175,7 @@ struct AssOverrideTagProto {
 };
 
 static std::vector<AssOverrideTagProto> proto;
-static void load_protos() {
-	if (!proto.empty()) return;
-
+static void do_load_protos() {
 	proto.resize(56);
 	int i = 0;
 
@@ -307,6 +306,13 @@ static void load_protos() {
 	proto[i].AddParam(VariableDataType::BLOCK);
 }
 
+/// Lines are parsed on worker threads by some exporters, so the table has to
+/// be built exactly once
+static void load_protos() {
+	static std::once_flag loaded;
+	std::call_once(loaded, do_load_protos);
+}
+
 std::vector<std::string> tokenize(const std::string &text) {
 	std::vector<std::string> paramList;
 	paramList.reserve(6);
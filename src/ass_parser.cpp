@@ -217,9 +217,7 @@ void AssParser::ParseExtradataLine(std::string const &data) {
 			value = "";
 		}
 
-		// ensure next_extradata_id is always at least 1 more than the largest existing id
-		target->next_extradata_id = std::max(id+1, target->next_extradata_id);
-		target->Extradata.push_back(ExtradataEntry{id, std::move(key), std::move(value)});
+		target->Extradata.Insert(ExtradataEntry{id, std::move(key), std::move(value)});
 	}
 }
 
@@ -36,33 +36,170 @@
 
 #include "ass_file.h"
 #include "ass_style.h"
+#include "compat.h"
+#include "format.h"
 #include "options.h"
 
+#include <libaegisub/dispatch.h>
 #include <libaegisub/fs.h>
 #include <libaegisub/io.h>
 #include <libaegisub/line_iterator.h>
+#include <libaegisub/log.h>
 #include <libaegisub/make_unique.h>
 #include <libaegisub/path.h>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <map>
+#include <set>
+#include <wx/intl.h>
+#include <wx/msgdlg.h>
 
-AssStyleStorage::~AssStyleStorage() { }
-void AssStyleStorage::clear() { style.clear(); }
-void AssStyleStorage::push_back(std::unique_ptr<AssStyle> new_style) { style.emplace_back(std::move(new_style)); }
+namespace {
+/// Queue which catalog files are written on
+agi::dispatch::Queue& write_queue() {
+	static auto queue = agi::dispatch::Create(agi::dispatch::PRIORITY_BACKGROUND);
+	return *queue;
+}
+
+agi::fs::path catalog_dir() {
+	return config::path->Decode("?user/catalog/");
+}
+
+agi::fs::path catalog_path(std::string const& catalogname) {
+	return config::path->Decode("?user/catalog/" + catalogname + ".sty");
+}
+
+/// Cached listing of the catalog directory, only touched from the main thread
+struct {
+	/// Modification time of the directory when it was last scanned
+	time_t scan_time = -1;
+	/// Catalogs found by the last scan
+	std::set<std::string> scanned;
+	/// Catalogs successfully saved by this process
+	std::set<std::string> saved;
+	/// Catalogs with a save queued, once for each queued save
+	std::multiset<std::string> pending;
+	/// Number of times each catalog has been deleted, so that saves which
+	/// finish after a deletion don't resurrect it
+	std::map<std::string, unsigned> deletions;
+} catalog_cache;
+
+void scan_catalogs() {
+	auto dir = catalog_dir();
+	time_t mtime = agi::fs::DirectoryExists(dir) ? agi::fs::ModifiedTime(dir) : 0;
+	if (mtime == catalog_cache.scan_time) return;
+
+	catalog_cache.scanned.clear();
+	catalog_cache.scan_time = mtime;
+	if (!mtime) return;
+	for (auto const& file : agi::fs::DirectoryIterator(dir, "*.sty"))
+		catalog_cache.scanned.insert(agi::fs::path(file).stem().string());
+}
+}
+
+AssStyleStorage::AssStyleStorage()
+: save_generation(std::make_shared<std::atomic<unsigned>>(0))
+{
+}
+
+AssStyleStorage::~AssStyleStorage() {
+	// Don't let writes queued by this storage outlive it by much, as the
+	// program may be about to exit
+	if (*save_generation)
+		Flush();
+}
+
+void AssStyleStorage::clear() {
+	style.clear();
+	index.clear();
+}
+
+void AssStyleStorage::push_back(std::unique_ptr<AssStyle> new_style) {
+	AddToIndex(new_style.get());
+	style.emplace_back(std::move(new_style));
+}
+
+void AssStyleStorage::AddToIndex(AssStyle *new_style) {
+	// emplace doesn't replace existing entries, so the first of several
+	// styles with the same name wins, as with a linear search
+	index.emplace(boost::to_lower_copy(new_style->name), new_style);
+}
+
+void AssStyleStorage::Reindex() {
+	index.clear();
+	for (auto const& cur : style)
+		AddToIndex(cur.get());
+}
 
 void AssStyleStorage::Save() const {
 	if (file.empty()) return;
 
-	agi::fs::CreateDirectory(file.parent_path());
+	std::vector<std::string> lines;
+	lines.reserve(style.size());
+	for (auto const& cur : style)
+		lines.emplace_back(cur->GetEntryData());
 
-	agi::io::Save out(file);
-	out.Get() << "\xEF\xBB\xBF";
+	// Listed as a catalog while the write is pending, but only remembered
+	// as saved once it's actually been written
+	std::string catalog;
+	unsigned deletions = 0;
+	if (file == catalog_path(file.stem().string())) {
+		catalog = file.stem().string();
+		catalog_cache.pending.insert(catalog);
+		deletions = catalog_cache.deletions[catalog];
+	}
 
-	for (auto const& cur : style)
-		out.Get() << cur->GetEntryData() << std::endl;
+	auto generation = save_generation;
+	unsigned id = ++*generation;
+	auto filename = file;
+	write_queue().Async([=] {
+		std::string error;
+		// A newer snapshot of this storage is queued behind us
+		if (*generation == id) {
+			try {
+				agi::fs::CreateDirectory(filename.parent_path());
+
+				agi::io::Save out(filename);
+				out.Get() << "\xEF\xBB\xBF";
+
+				for (auto const& line : lines)
+					out.Get() << line << std::endl;
+				out.Commit();
+			}
+			catch (agi::Exception const& e) {
+				LOG_E("style_storage") << "Failed to save " << filename << ": " << e.GetMessage();
+				error = e.GetMessage();
+			}
+		}
+
+		agi::dispatch::Main().Async([=] {
+			if (!catalog.empty()) {
+				auto it = catalog_cache.pending.find(catalog);
+				if (it != catalog_cache.pending.end())
+					catalog_cache.pending.erase(it);
+				// The catalog may have been deleted while this completion
+				// was waiting to run
+				if (error.empty() && *generation == id
+					&& catalog_cache.deletions[catalog] == deletions
+					&& agi::fs::FileExists(filename))
+					catalog_cache.saved.insert(catalog);
+			}
+
+			if (!error.empty())
+				wxMessageBox(fmt_tl("Could not save the styles to \"%s\":\n%s", filename, error), _("Error saving styles"), wxOK | wxICON_ERROR | wxCENTER);
+		});
+	});
+}
+
+void AssStyleStorage::Flush() {
+	write_queue().Sync([]{});
 }
 
 void AssStyleStorage::Load(agi::fs::path const& filename) {
+	// The file may have a write pending
+	Flush();
+
 	file = filename;
 	clear();
 
@@ -70,7 +207,7 @@ void AssStyleStorage::Load(agi::fs::path const& filename) {
 		auto in = agi::io::Open(file);
 		for (auto const& line : agi::line_iterator<std::string>(*in)) {
 			try {
-				style.emplace_back(agi::make_unique<AssStyle>(line));
+				push_back(agi::make_unique<AssStyle>(line));
 			} catch(...) {
 				/* just ignore invalid lines for now */
 			}
@@ -82,40 +219,59 @@ void AssStyleStorage::Load(agi::fs::path const& filename) {
 }
 
 void AssStyleStorage::LoadCatalog(std::string const& catalogname) {
-	auto filename = config::path->Decode("?user/catalog/" + catalogname + ".sty");
-	Load(filename);
+	Load(catalog_path(catalogname));
 }
 
 void AssStyleStorage::Delete(int idx) {
+	auto it = index.find(boost::to_lower_copy(style[idx]->name));
+	bool indexed = it != index.end() && it->second == style[idx].get();
+	std::string name = style[idx]->name;
 	style.erase(style.begin() + idx);
+
+	if (indexed) {
+		// Promote the next style with the same name, if any
+		index.erase(it);
+		for (auto const& cur : style) {
+			if (boost::iequals(cur->name, name)) {
+				AddToIndex(cur.get());
+				break;
+			}
+		}
+	}
 }
 
 std::vector<std::string> AssStyleStorage::GetNames() {
 	std::vector<std::string> names;
+	names.reserve(style.size());
 	for (auto const& cur : style)
 		names.emplace_back(cur->name);
 	return names;
 }
 
 AssStyle *AssStyleStorage::GetStyle(std::string const& name) {
-	for (auto& cur : style) {
-		if (boost::iequals(cur->name, name))
-			return cur.get();
-	}
-	return nullptr;
+	auto it = index.find(boost::to_lower_copy(name));
+	return it == index.end() ? nullptr : it->second;
 }
 
 std::vector<std::string> AssStyleStorage::GetCatalogs() {
-	std::vector<std::string> catalogs;
-	for (auto const& file : agi::fs::DirectoryIterator(config::path->Decode("?user/catalog/"), "*.sty"))
-		catalogs.push_back(agi::fs::path(file).stem().string());
-	return catalogs;
+	scan_catalogs();
+	std::set<std::string> catalogs(catalog_cache.scanned);
+	catalogs.insert(begin(catalog_cache.saved), end(catalog_cache.saved));
+	catalogs.insert(begin(catalog_cache.pending), end(catalog_cache.pending));
+	return std::vector<std::string>(begin(catalogs), end(catalogs));
 }
 
 bool AssStyleStorage::CatalogExists(std::string const& catalogname) {
 	if (catalogname.empty()) return false;
-	auto filename = config::path->Decode("?user/catalog/" + catalogname + ".sty");
-	return agi::fs::FileExists(filename);
+	return catalog_cache.saved.count(catalogname) || catalog_cache.pending.count(catalogname) || agi::fs::FileExists(catalog_path(catalogname));
+}
+
+void AssStyleStorage::DeleteCatalog(std::string const& catalogname) {
+	Flush();
+	agi::fs::Remove(catalog_path(catalogname));
+	catalog_cache.scanned.erase(catalogname);
+	catalog_cache.saved.erase(catalogname);
+	++catalog_cache.deletions[catalogname];
 }
 
 void AssStyleStorage::ReplaceIntoFile(AssFile &file) {
@@ -124,4 +280,3 @@ void AssStyleStorage::ReplaceIntoFile(AssFile &file) {
 		file.Styles.push_back(*new AssStyle(*s));
 	}
 }
-
@@ -35,8 +35,10 @@
 #include <libaegisub/fs_fwd.h>
 
 #include <boost/filesystem/path.hpp>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class AssFile;
@@ -46,7 +48,17 @@ class AssStyleStorage {
 	agi::fs::path file;
 	std::vector<std::unique_ptr<AssStyle>> style;
 
+	/// Case-folded style name -> first style with that name
+	std::unordered_map<std::string, AssStyle*> index;
+
+	/// Incremented for each save so that queued writes which have been
+	/// superseded by a newer snapshot can be skipped
+	std::shared_ptr<std::atomic<unsigned>> save_generation;
+
+	void AddToIndex(AssStyle *new_style);
+
 public:
+	AssStyleStorage();
 	~AssStyleStorage();
 
 	typedef std::vector<std::unique_ptr<AssStyle>>::iterator iterator;
@@ -67,14 +79,27 @@ public:
 	/// Delete the style at the given index
 	void Delete(int idx);
 
+	/// Rebuild the name index
+	///
+	/// Must be called after a stored style has been renamed in place.
+	void Reindex();
+
 	/// Get the style with the given name
 	/// @param name Case-insensitive style name
 	/// @return Style or nullptr if the requested style is not found
 	AssStyle *GetStyle(std::string const& name);
 
 	/// Save stored styles to a file
+	///
+	/// The styles are serialized immediately, but the file is written on a
+	/// background queue, and consecutive saves which have not yet been
+	/// written are collapsed into a single write. If the write fails, an
+	/// error is shown once control returns to the main thread.
 	void Save() const;
 
+	/// Block until all queued catalog writes have completed
+	static void Flush();
+
 	/// Load stored styles from a file
 	/// @param filename Catalog filename. Does not have to exist.
 	void Load(agi::fs::path const& filename);
@@ -90,6 +115,10 @@ public:
 	/// @param catalogname Basename for the catalog file to check for.
 	static bool CatalogExists(std::string const& catalogname);
 
+	/// Delete the named catalog from the default location
+	/// @param catalogname Basename for the catalog file to delete.
+	static void DeleteCatalog(std::string const& catalogname);
+
 	/// Insert all styles into a file, replacing existing styles with the same names
 	/// @param file File to replace styles in
 	void ReplaceIntoFile(AssFile &file);
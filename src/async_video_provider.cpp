@@ -31,19 +31,9 @@ enum {
 };
 
 std::shared_ptr<VideoFrame> AsyncVideoProvider::ProcFrame(int frame_number, double time, bool raw) {
-	// Find an unused buffer to use or allocate a new one if needed
-	std::shared_ptr<VideoFrame> frame;
-	for (auto& buffer : buffers) {
-		if (buffer.use_count() == 1) {
-			frame = buffer;
-			break;
-		}
-	}
-
-	if (!frame) {
-		frame = std::make_shared<VideoFrame>();
-		buffers.push_back(frame);
-	}
+	// The pixels are shared with the source provider's cache until the
+	// subtitles provider asks to write to them, so raw frames are never copied
+	auto frame = std::make_shared<VideoFrame>();
 
 	try {
 		source_provider->GetFrame(frame_number, *frame);
@@ -92,7 +82,7 @@ static std::unique_ptr<SubtitlesProvider> get_subs_provider(wxEvtHandler *evt_ha
 }
 
 AsyncVideoProvider::AsyncVideoProvider(agi::fs::path const& video_filename, std::string const& colormatrix, wxEvtHandler *parent, agi::BackgroundRunner *br)
-: worker(agi::dispatch::Create())
+: worker(agi::dispatch::Create(agi::dispatch::PRIORITY_INTERACTIVE))
 , subs_provider(get_subs_provider(parent, br))
 , source_provider(VideoProviderFactory::GetProvider(video_filename, colormatrix, br))
 , parent(parent)
@@ -137,11 +127,13 @@ void AsyncVideoProvider::UpdateSubtitles(const AssFile *new_subs, const AssDialo
 void AsyncVideoProvider::RequestFrame(int new_frame, double new_time) throw() {
 	uint_fast32_t req_version = ++version;
 
+	frame_request.Cancel();
+	frame_request = agi::dispatch::CancellationToken();
 	worker->Async([=]{
 		time = new_time;
 		frame_number = new_frame;
 		ProcAsync(req_version, false);
-	});
+	}, frame_request);
 }
 
 bool AsyncVideoProvider::NeedUpdate(std::vector<AssDialogueBase const*> const& visible_lines) {
@@ -208,6 +200,21 @@ std::shared_ptr<VideoFrame> AsyncVideoProvider::GetFrame(int frame, double time,
 	return ret;
 }
 
+void AsyncVideoProvider::RequestThumbnail(int frame, size_t width, size_t height, std::function<void (std::vector<unsigned char>)> callback) {
+	worker->Async([=] {
+		// Thumbnails are requested all over the file, so read them past the
+		// frame cache rather than evicting the frames around the playhead
+		std::vector<unsigned char> thumbnail;
+		try {
+			VideoFrame source;
+			source_provider->GetFrameUncached(frame, source);
+			thumbnail = GetThumbnail(source, width, height);
+		}
+		catch (VideoProviderError const&) { }
+		callback(std::move(thumbnail));
+	});
+}
+
 void AsyncVideoProvider::SetColorSpace(std::string const& matrix) {
 	worker->Async([=] { source_provider->SetColorSpace(matrix); });
 }
@@ -17,9 +17,11 @@
 #include "include/aegisub/video_provider.h"
 
 #include <libaegisub/exception.h>
+#include <libaegisub/dispatch.h>
 #include <libaegisub/fs_fwd.h>
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <set>
 #include <wx/event.h>
@@ -33,13 +35,15 @@ struct AssDialogueBase;
 struct VideoFrame;
 namespace agi {
 	class BackgroundRunner;
-	namespace dispatch { class Queue; }
 }
 
 /// An asynchronous video decoding and subtitle rendering wrapper
 class AsyncVideoProvider {
 	/// Asynchronous work queue
 	std::unique_ptr<agi::dispatch::Queue> worker;
+	/// Token for the most recently requested frame, which is cancelled when
+	/// a newer frame is requested before the worker gets to it
+	agi::dispatch::CancellationToken frame_request;
 
 	/// Subtitles provider
 	std::unique_ptr<SubtitlesProvider> subs_provider;
@@ -76,8 +80,6 @@ class AsyncVideoProvider {
 	/// they can be rendered
 	std::atomic<uint_fast32_t> version{ 0 };
 
-	std::vector<std::shared_ptr<VideoFrame>> buffers;
-
 public:
 	/// @brief Load the passed subtitle file
 	/// @param subs File to load
@@ -108,6 +110,18 @@ public:
 	/// @brief raw   Get raw frame without subtitles
 	std::shared_ptr<VideoFrame> GetFrame(int frame, double time, bool raw = false);
 
+	/// @brief Queue a request for a small copy of a frame without subtitles
+	/// @param frame    Frame number
+	/// @param width    Width of the thumbnail
+	/// @param height   Height of the thumbnail
+	/// @param callback Called on the worker thread with the thumbnail as RGB
+	///                 pixels, or an empty vector if the frame couldn't be
+	///                 decoded
+	///
+	/// Unlike RequestFrame, requests are never dropped. Frames are read
+	/// without going through the frame cache.
+	void RequestThumbnail(int frame, size_t width, size_t height, std::function<void (std::vector<unsigned char>)> callback);
+
 	/// Ask the video provider to change YCbCr matricies
 	void SetColorSpace(std::string const& matrix);
 
@@ -140,6 +140,7 @@ void AudioController::PlayRange(const TimeRange &range)
 	playback_mode = PM_Range;
 	playback_timer.Start(20);
 
+	AnnouncePlaybackStart();
 	AnnouncePlaybackPosition(range.begin());
 }
 
@@ -166,6 +167,7 @@ void AudioController::PlayToEnd(int start_ms)
 	playback_mode = PM_ToEnd;
 	playback_timer.Start(20);
 
+	AnnouncePlaybackStart();
 	AnnouncePlaybackPosition(start_ms);
 }
 
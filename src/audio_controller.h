@@ -53,6 +53,9 @@ class AudioController final : public wxEvtHandler {
 	/// Slot for subtitles save signal
 	agi::signal::Connection subtitle_save_slot;
 
+	/// Playback has started
+	agi::signal::Signal<> AnnouncePlaybackStart;
+
 	/// Playback is in progress and the current position was updated
 	agi::signal::Signal<int> AnnouncePlaybackPosition;
 
@@ -184,6 +187,7 @@ public:
 	/// @param new_mode The new timing controller or nullptr
 	void SetTimingController(std::unique_ptr<AudioTimingController> new_controller);
 
+	DEFINE_SIGNAL_ADDERS(AnnouncePlaybackStart,           AddPlaybackStartListener)
 	DEFINE_SIGNAL_ADDERS(AnnouncePlaybackPosition,        AddPlaybackPositionListener)
 	DEFINE_SIGNAL_ADDERS(AnnouncePlaybackStop,            AddPlaybackStopListener)
 	DEFINE_SIGNAL_ADDERS(AnnounceTimingControllerChanged, AddTimingControllerListener)
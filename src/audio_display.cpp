@@ -43,14 +43,17 @@
 #include "project.h"
 #include "utils.h"
 #include "video_controller.h"
+#include "video_thumbnails.h"
 
 #include <libaegisub/ass/time.h>
 #include <libaegisub/audio/provider.h>
 #include <libaegisub/make_unique.h>
 
 #include <algorithm>
+#include <cstdlib>
 
 #include <wx/dcbuffer.h>
+#include <wx/dcmemory.h>
 #include <wx/mousestate.h>
 
 /// @class AudioDisplayInteractionObject
@@ -572,12 +575,23 @@ public:
 AudioDisplay::AudioDisplay(wxWindow *parent, AudioController *controller, agi::Context *context)
 : wxWindow(parent, -1, wxDefaultPosition, wxDefaultSize, wxWANTS_CHARS|wxBORDER_SIMPLE)
 , audio_open_connection(context->project->AddAudioProviderListener(&AudioDisplay::OnAudioOpen, this))
+, thumbnail_connections(agi::signal::make_vector({
+	context->thumbnails->AddThumbnailsListener(&AudioDisplay::OnThumbnailsChanged, this),
+	OPT_SUB("Audio/Display/Draw/Video Thumbnails", &AudioDisplay::OnThumbnailsChanged, this),
+}))
 , context(context)
 , audio_renderer(agi::make_unique<AudioRenderer>())
 , controller(controller)
 , scrollbar(agi::make_unique<AudioDisplayScrollbar>(this))
 , timeline(agi::make_unique<AudioDisplayTimeline>(this))
 , style_ranges({{0, 0}})
+, auto_scroll(OPT_CACHE(bool, "Audio/Auto/Scroll"))
+, draw_cursor_time(OPT_CACHE(bool, "Audio/Display/Draw/Cursor Time"))
+, start_drag_sensitivity(OPT_CACHE(int64_t, "Audio/Start Drag Sensitivity"))
+, snap_enabled(OPT_CACHE(bool, "Audio/Snap/Enable"))
+, snap_distance(OPT_CACHE(int64_t, "Audio/Snap/Distance"))
+, lock_scroll(OPT_CACHE(bool, "Audio/Lock Scroll on Cursor"))
+, smooth_scroll(OPT_CACHE(bool, "Audio/Smooth Scroll"))
 {
 	audio_renderer->SetAmplitudeScale(scale_amplitude);
 	SetZoomLevel(0);
@@ -626,7 +640,21 @@ void AudioDisplay::ScrollPixelToLeft(int pixel_position)
 	scroll_left = pixel_position;
 	scrollbar->SetPosition(scroll_left);
 	timeline->SetPosition(scroll_left);
-	Refresh();
+	// The audio bitmap is shifted rather than redrawn on the next paint
+	RefreshOverlay();
+}
+
+void AudioDisplay::Refresh(bool erase_background, const wxRect *rect)
+{
+	wxRect invalid = rect ? *rect : wxRect(GetClientSize());
+	invalid.x += scroll_left;
+	audio_bitmap_invalid.Union(invalid);
+	wxWindow::Refresh(erase_background, rect);
+}
+
+void AudioDisplay::RefreshOverlay(const wxRect *rect)
+{
+	wxWindow::Refresh(false, rect);
 }
 
 void AudioDisplay::ScrollTimeRangeInView(const TimeRange &range)
@@ -816,37 +844,111 @@ void AudioDisplay::OnPaint(wxPaintEvent&)
 	wxAutoBufferedPaintDC dc(this);
 
 	wxRect audio_bounds(0, audio_top, GetClientSize().GetWidth(), audio_height);
+	bool redraw_audio = false;
 	bool redraw_scrollbar = false;
 	bool redraw_timeline = false;
+	bool redraw_thumbnails = false;
+
+	wxRect thumbnails_bounds(0, audio_top + audio_height, audio_bounds.GetWidth(), thumbnails_height);
 
 	for (wxRegionIterator region(GetUpdateRegion()); region; ++region)
 	{
 		wxRect updrect = region.GetRect();
 
+		redraw_audio |= audio_bounds.Intersects(updrect);
+		redraw_thumbnails |= thumbnails_bounds.Intersects(updrect);
 		redraw_scrollbar |= scrollbar->GetBounds().Intersects(updrect);
 		redraw_timeline |= timeline->GetBounds().Intersects(updrect);
+	}
 
-		if (audio_bounds.Intersects(updrect))
-		{
-			TimeRange updtime(
-				std::max(0, TimeFromRelativeX(updrect.x - foot_size)),
-				std::max(0, TimeFromRelativeX(updrect.x + updrect.width + foot_size)));
-
-			PaintAudio(dc, updtime, updrect);
-			PaintMarkers(dc, updtime);
-			PaintLabels(dc, updtime);
-		}
+	if (redraw_audio && !audio_bounds.IsEmpty())
+	{
+		UpdateAudioBitmap(audio_bounds);
+		dc.DrawBitmap(audio_bitmap, audio_bounds.GetPosition());
 	}
 
 	if (track_cursor_pos >= 0)
 		PaintTrackCursor(dc);
 
+	if (redraw_thumbnails)
+		PaintThumbnails(dc);
+
 	if (redraw_scrollbar)
 		scrollbar->Paint(dc, HasFocus(), audio_load_position);
 	if (redraw_timeline)
 		timeline->Paint(dc);
 }
 
+void AudioDisplay::UpdateAudioBitmap(wxRect const& audio_bounds)
+{
+	const wxSize size = audio_bounds.GetSize();
+	// The part of the audio currently visible, in the same absolute
+	// coordinates as audio_bitmap_invalid
+	wxRect visible = audio_bounds;
+	visible.x += scroll_left;
+
+	if (!audio_bitmap.IsOk() || audio_bitmap_size != size)
+	{
+		audio_bitmap.CreateScaled(size.GetWidth(), size.GetHeight(), -1, GetContentScaleFactor());
+		audio_bitmap_size = size;
+		scroll_bitmap = wxBitmap();
+		audio_bitmap_invalid = wxRegion(visible);
+		audio_bitmap_scroll = scroll_left;
+	}
+	else if (audio_bitmap_scroll != scroll_left)
+	{
+		// Shift what was already drawn by the distance scrolled, so that only
+		// the part which has scrolled into view needs to be drawn
+		const int dx = audio_bitmap_scroll - scroll_left;
+		if (std::abs(dx) < size.GetWidth())
+		{
+			if (!scroll_bitmap.IsOk())
+				scroll_bitmap.CreateScaled(size.GetWidth(), size.GetHeight(), -1, GetContentScaleFactor());
+
+			{
+				wxMemoryDC src(audio_bitmap);
+				wxMemoryDC dst(scroll_bitmap);
+				dst.Blit(std::max(dx, 0), 0, size.GetWidth() - std::abs(dx), size.GetHeight(), &src, std::max(-dx, 0), 0);
+			}
+			std::swap(audio_bitmap, scroll_bitmap);
+
+			if (dx > 0)
+				audio_bitmap_invalid.Union(scroll_left, audio_top, dx, size.GetHeight());
+			else
+				audio_bitmap_invalid.Union(scroll_left + size.GetWidth() + dx, audio_top, -dx, size.GetHeight());
+		}
+		else
+			audio_bitmap_invalid = wxRegion(visible);
+		audio_bitmap_scroll = scroll_left;
+	}
+
+	// Anything invalidated while out of view will be drawn when it is
+	// scrolled back into view
+	audio_bitmap_invalid.Intersect(visible);
+	if (audio_bitmap_invalid.IsEmpty()) return;
+	audio_bitmap_invalid.Offset(-scroll_left, 0);
+
+	wxMemoryDC dc(audio_bitmap);
+	// Draw using client coordinates so that the painting code doesn't need to
+	// know about the bitmap
+	dc.SetDeviceOrigin(0, -audio_top);
+
+	for (wxRegionIterator region(audio_bitmap_invalid); region; ++region)
+	{
+		wxRect updrect = region.GetRect();
+		TimeRange updtime(
+			std::max(0, TimeFromRelativeX(updrect.x - foot_size)),
+			std::max(0, TimeFromRelativeX(updrect.x + updrect.width + foot_size)));
+
+		wxDCClipper clipper(dc, updrect);
+		PaintAudio(dc, updtime, updrect);
+		PaintMarkers(dc, updtime);
+		PaintLabels(dc, updtime, updrect);
+	}
+
+	audio_bitmap_invalid.Clear();
+}
+
 void AudioDisplay::PaintAudio(wxDC &dc, const TimeRange updtime, const wxRect updrect)
 {
 	auto pt = begin(style_ranges), pe = end(style_ranges);
@@ -901,7 +1003,7 @@ void AudioDisplay::PaintFoot(wxDC &dc, int marker_x, int dir)
 	dc.DrawPolygon(3, foot_bot, marker_x, audio_top+audio_height);
 }
 
-void AudioDisplay::PaintLabels(wxDC &dc, TimeRange updtime)
+void AudioDisplay::PaintLabels(wxDC &dc, TimeRange updtime, wxRect updrect)
 {
 	std::vector<AudioLabelProvider::AudioLabel> labels;
 	controller->GetTimingController()->GetLabels(updtime, labels);
@@ -924,6 +1026,7 @@ void AudioDisplay::PaintLabels(wxDC &dc, TimeRange updtime)
 			dc.SetClippingRegion(left, audio_top + 4, width, extent.GetHeight());
 			dc.DrawText(label.text, left, audio_top + 4);
 			dc.DestroyClippingRegion();
+			dc.SetClippingRegion(updrect);
 		}
 		// Otherwise center in the range
 		else
@@ -974,7 +1077,7 @@ void AudioDisplay::PaintTrackCursor(wxDC &dc) {
 	track_cursor_label_rect.SetPosition(label_pos);
 	track_cursor_label_rect.SetSize(label_size);
 	if (need_extra_redraw)
-		RefreshRect(track_cursor_label_rect, false);
+		RefreshOverlay(&track_cursor_label_rect);
 }
 
 void AudioDisplay::SetDraggedObject(AudioDisplayInteractionObject *new_obj)
@@ -990,6 +1093,49 @@ void AudioDisplay::SetDraggedObject(AudioDisplayInteractionObject *new_obj)
 		audio_marker.reset();
 }
 
+void AudioDisplay::PaintThumbnails(wxDC &dc)
+{
+	const int width = GetClientSize().GetWidth();
+	const int top = audio_top + audio_height;
+
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(*wxBLACK_BRUSH);
+	dc.DrawRectangle(0, top, width, thumbnails_height);
+
+	const int thumb_w = context->thumbnails->GetWidth();
+	if (thumb_w <= 0 || !context->project->Timecodes().IsLoaded()) return;
+
+	// Tiles are aligned to the audio rather than the window so that they
+	// scroll with it, and each shows the closest thumbnail at or before the
+	// frame in the middle of the tile
+	wxDCClipper clip(dc, wxRect(0, top + 1, width, VideoThumbnails::thumbnail_height));
+	for (int x = -(scroll_left % thumb_w); x < width; x += thumb_w)
+	{
+		int frame = context->videoController->FrameAtTime(TimeFromRelativeX(x + thumb_w / 2));
+		if (auto bmp = context->thumbnails->Get(frame))
+			dc.DrawBitmap(*bmp, x, top + 1);
+	}
+}
+
+void AudioDisplay::OnThumbnailsChanged()
+{
+	int height = 0;
+	if (OPT_GET("Audio/Display/Draw/Video Thumbnails")->GetBool() && context->thumbnails->GetWidth() > 0)
+		height = VideoThumbnails::thumbnail_height + 2;
+
+	if (height != thumbnails_height)
+	{
+		thumbnails_height = height;
+		wxSizeEvent evt;
+		OnSize(evt);
+	}
+	else if (thumbnails_height)
+	{
+		wxRect strip(0, audio_top + audio_height, GetClientSize().GetWidth(), thumbnails_height);
+		RefreshOverlay(&strip);
+	}
+}
+
 void AudioDisplay::SetTrackCursor(int new_pos, bool show_time)
 {
 	if (new_pos == track_cursor_pos) return;
@@ -997,18 +1143,20 @@ void AudioDisplay::SetTrackCursor(int new_pos, bool show_time)
 	int old_pos = track_cursor_pos;
 	track_cursor_pos = new_pos;
 
-	RefreshRect(wxRect(old_pos - scroll_left - 1, audio_top, 2, audio_height - 1), false);
-	RefreshRect(wxRect(new_pos - scroll_left - 1, audio_top, 2, audio_height - 1), false);
+	wxRect old_rect(old_pos - scroll_left - 1, audio_top, 2, audio_height - 1);
+	wxRect new_rect(new_pos - scroll_left - 1, audio_top, 2, audio_height - 1);
+	RefreshOverlay(&old_rect);
+	RefreshOverlay(&new_rect);
 
 	// Make sure the old label gets cleared away
-	RefreshRect(track_cursor_label_rect, false);
+	RefreshOverlay(&track_cursor_label_rect);
 
 	if (show_time)
 	{
 		agi::Time new_label_time = TimeFromAbsoluteX(track_cursor_pos);
 		track_cursor_label = to_wx(new_label_time.GetAssFormatted());
 		track_cursor_label_rect.x += new_pos - old_pos;
-		RefreshRect(track_cursor_label_rect, false);
+		RefreshOverlay(&track_cursor_label_rect);
 	}
 	else
 	{
@@ -1050,7 +1198,7 @@ void AudioDisplay::OnMouseEvent(wxMouseEvent& event)
 	const int mouse_x = event.GetPosition().x;
 
 	// Scroll the display after a mouse-up near one of the edges
-	if ((event.LeftUp() || event.RightUp()) && OPT_GET("Audio/Auto/Scroll")->GetBool())
+	if ((event.LeftUp() || event.RightUp()) && *auto_scroll)
 	{
 		const int width = GetClientSize().GetWidth();
 		if (mouse_x < width / 20) {
@@ -1072,13 +1220,13 @@ void AudioDisplay::OnMouseEvent(wxMouseEvent& event)
 
 	if (event.Moving() && !controller->IsPlaying())
 	{
-		SetTrackCursor(scroll_left + mouse_x, OPT_GET("Audio/Display/Draw/Cursor Time")->GetBool());
+		SetTrackCursor(scroll_left + mouse_x, *draw_cursor_time);
 	}
 
 	AudioTimingController *timing = controller->GetTimingController();
 	if (!timing) return;
-	const int drag_sensitivity = int(OPT_GET("Audio/Start Drag Sensitivity")->GetInt() * ms_per_pixel);
-	const int snap_sensitivity = OPT_GET("Audio/Snap/Enable")->GetBool() != event.ShiftDown() ? int(OPT_GET("Audio/Snap/Distance")->GetInt() * ms_per_pixel) : 0;
+	const int drag_sensitivity = int(*start_drag_sensitivity * ms_per_pixel);
+	const int snap_sensitivity = *snap_enabled != event.ShiftDown() ? int(*snap_distance * ms_per_pixel) : 0;
 
 	// Not scrollbar, not timeline, no button action
 	if (event.Moving())
@@ -1180,6 +1328,7 @@ void AudioDisplay::OnSize(wxSizeEvent &)
 	audio_height = size.GetHeight();
 	audio_height -= scrollbar->GetBounds().GetHeight();
 	audio_height -= timeline->GetHeight();
+	audio_height -= thumbnails_height;
 	audio_renderer->SetHeight(audio_height);
 
 	audio_top = timeline->GetHeight();
@@ -1226,6 +1375,7 @@ void AudioDisplay::OnAudioOpen(agi::AudioProvider *provider)
 				controller->AddTimingControllerListener(&AudioDisplay::OnTimingController, this),
 				OPT_SUB("Audio/Spectrum", &AudioDisplay::ReloadRenderingSettings, this),
 				OPT_SUB("Audio/Display/Waveform Style", &AudioDisplay::ReloadRenderingSettings, this),
+				OPT_SUB("Audio/Display/Separate Channels", &AudioDisplay::ReloadRenderingSettings, this),
 				OPT_SUB("Colour/Audio Display/Spectrum", &AudioDisplay::ReloadRenderingSettings, this),
 				OPT_SUB("Colour/Audio Display/Waveform", &AudioDisplay::ReloadRenderingSettings, this),
 				OPT_SUB("Audio/Renderer/Spectrum/Quality", &AudioDisplay::ReloadRenderingSettings, this),
@@ -1266,11 +1416,20 @@ void AudioDisplay::OnPlaybackPosition(int ms)
 	int pixel_position = AbsoluteXFromTime(ms);
 	SetTrackCursor(pixel_position, false);
 
-	if (OPT_GET("Audio/Lock Scroll on Cursor")->GetBool())
+	if (*lock_scroll)
 	{
 		int client_width = GetClientSize().GetWidth();
 		int edge_size = client_width / 20;
-		if (scroll_left > 0 && pixel_position < scroll_left + edge_size)
+		if (*smooth_scroll
+			&& pixel_position >= scroll_left && pixel_position < scroll_left + client_width)
+		{
+			// Once the cursor reaches the middle of the display keep it there,
+			// scrolling by the distance played since the last update rather
+			// than a page at a time
+			if (pixel_position > scroll_left + client_width / 2)
+				ScrollPixelToLeft(pixel_position - client_width / 2);
+		}
+		else if (scroll_left > 0 && pixel_position < scroll_left + edge_size)
 		{
 			ScrollPixelToLeft(std::max(pixel_position - edge_size, 0));
 		}
@@ -1301,7 +1460,7 @@ void AudioDisplay::OnSelectionChanged()
 			}
 		}
 	}
-	else if (OPT_GET("Audio/Auto/Scroll")->GetBool() && sel.end() != 0)
+	else if (*auto_scroll && sel.end() != 0)
 	{
 		ScrollTimeRangeInView(sel);
 	}
@@ -28,13 +28,16 @@
 //
 // Aegisub Project http://www.aegisub.org/
 //
+#include <libaegisub/option_value.h>
 #include <libaegisub/signal.h>
 
 #include <chrono>
 #include <cstdint>
 #include <memory>
 
+#include <wx/bitmap.h>
 #include <wx/gdicmn.h>
+#include <wx/region.h>
 #include <wx/string.h>
 #include <wx/timer.h>
 #include <wx/window.h>
@@ -63,6 +66,7 @@ class AudioMarkerInteractionObject;
 /// and the timing controller, using an audio renderer instance.
 class AudioDisplay: public wxWindow {
 	agi::signal::Connection audio_open_connection;
+	std::vector<agi::signal::Connection> thumbnail_connections;
 
 	std::vector<agi::signal::Connection> connections;
 	agi::Context *context;
@@ -124,6 +128,10 @@ class AudioDisplay: public wxWindow {
 	/// Height of main audio area in pixels
 	int audio_height = 0;
 
+	/// Height of the video thumbnail strip below the audio area in pixels, or
+	/// 0 if it isn't shown
+	int thumbnails_height = 0;
+
 	/// Width of the audio marker feet in pixels
 	static const int foot_size = 6;
 
@@ -146,6 +154,44 @@ class AudioDisplay: public wxWindow {
 	/// Previous style ranges for optimizing redraw when ranges change
 	std::vector<std::pair<int, int>> style_ranges;
 
+	/// Options read on every mouse event
+	agi::CachedOptionValue<bool> auto_scroll;
+	agi::CachedOptionValue<bool> draw_cursor_time;
+	agi::CachedOptionValue<int64_t> start_drag_sensitivity;
+	agi::CachedOptionValue<bool> snap_enabled;
+	agi::CachedOptionValue<int64_t> snap_distance;
+
+	/// Options read on every playback position update
+	agi::CachedOptionValue<bool> lock_scroll;
+	agi::CachedOptionValue<bool> smooth_scroll;
+
+	/// The audio area with the audio, markers and labels drawn on it, but not
+	/// the track cursor
+	///
+	/// Scrolling shifts the contents of this rather than redrawing all of it,
+	/// so that following playback only has to draw the newly visible part.
+	wxBitmap audio_bitmap;
+	/// Spare bitmap to shift the audio bitmap into when scrolling
+	wxBitmap scroll_bitmap;
+	/// Size of the audio bitmap in pixels
+	wxSize audio_bitmap_size;
+	/// Value of scroll_left the audio bitmap was drawn for
+	int audio_bitmap_scroll = 0;
+	/// Parts of the audio which need to be redrawn in the audio bitmap, with x
+	/// coordinates in absolute pixels rather than relative to the scroll
+	/// position, so that they stay put when the display is scrolled
+	wxRegion audio_bitmap_invalid;
+
+	/// Bring the audio bitmap up to date with the current scroll position
+	/// and redraw the parts of it which have been invalidated
+	/// @param audio_bounds Client area covered by the audio bitmap
+	void UpdateAudioBitmap(wxRect const& audio_bounds);
+
+	/// Repaint part of the window from the audio bitmap without redrawing
+	/// the bitmap, for things drawn on top of it such as the track cursor
+	/// @param rect Area to repaint, or nullptr for the entire window
+	void RefreshOverlay(const wxRect *rect = nullptr);
+
 	/// @brief Reload all rendering settings from Options and reset caches
 	///
 	/// This can be called if some rendering quality settings have been changed
@@ -172,12 +218,21 @@ class AudioDisplay: public wxWindow {
 	/// Paint the labels in a time range
 	/// @param dc DC to paint to
 	/// @param updtime Time range to repaint
-	void PaintLabels(wxDC &dc, TimeRange updtime);
+	/// @param updrect Pixel range to repaint
+	void PaintLabels(wxDC &dc, TimeRange updtime, wxRect updrect);
 
 	/// Paint the track cursor
 	/// @param dc DC to paint to
 	void PaintTrackCursor(wxDC &dc);
 
+	/// Paint the video thumbnail strip
+	/// @param dc DC to paint to
+	void PaintThumbnails(wxDC &dc);
+
+	/// Show or hide the video thumbnail strip, or repaint it if new
+	/// thumbnails are available
+	void OnThumbnailsChanged();
+
 	/// Forward the mouse event to the appropriate child control, if any
 	/// @return Was the mouse event forwarded somewhere?
 	bool ForwardMouseEvent(wxMouseEvent &event);
@@ -210,6 +265,9 @@ public:
 	AudioDisplay(wxWindow *parent, AudioController *controller, agi::Context *context);
 	~AudioDisplay();
 
+	/// Redraw part of the display, or all of it if rect is nullptr
+	void Refresh(bool erase_background = true, const wxRect *rect = nullptr) override;
+
 	/// @brief Scroll the audio display
 	/// @param pixel_amount Number of pixels to scroll the view
 	///
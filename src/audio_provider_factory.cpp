@@ -105,13 +105,23 @@ std::unique_ptr<agi::AudioProvider> GetAudioProvider(fs::path const& filename,
 
 	// Give it a converter if needed
 	if (provider->GetBytesPerSample() != 2 || provider->GetSampleRate() < 32000 || provider->GetChannels() != 1)
-		provider = CreateConvertAudioProvider(std::move(provider));
+		provider = CreateConvertAudioProvider(std::move(provider), OPT_GET("Audio/Channel")->GetInt() - 1);
 
 	// Change provider to RAM/HD cache if needed
 	int cache = OPT_GET("Audio/Cache/Type")->GetInt();
-	if (!cache || !needs_cache)
+	if (!needs_cache)
 		return CreateLockAudioProvider(std::move(provider));
 
+	// Without a cache every read goes to the decoder, so keep decoding a
+	// little way ahead of playback
+	if (!cache) {
+		int64_t decode_ahead = OPT_GET("Audio/Cache/Decode Ahead")->GetInt();
+		if (decode_ahead <= 0)
+			return CreateLockAudioProvider(std::move(provider));
+		int64_t window = decode_ahead * provider->GetSampleRate() / 1000;
+		return CreateDecodeAheadAudioProvider(std::move(provider), window);
+	}
+
 	// Convert to RAM
 	if (cache == 1) return CreateRAMAudioProvider(std::move(provider));
 
@@ -35,6 +35,7 @@
 #include <libaegisub/audio/provider.h>
 
 #include <algorithm>
+#include <vector>
 #include <wx/dcmemory.h>
 
 enum {
@@ -47,6 +48,7 @@ enum {
 
 AudioWaveformRenderer::AudioWaveformRenderer(std::string const& color_scheme_name)
 : render_averages(OPT_GET("Audio/Display/Waveform Style")->GetInt() == Waveform_MaxAvg)
+, separate_channels(OPT_GET("Audio/Display/Separate Channels")->GetBool())
 {
 	colors.reserve(AudioStyle_MAX);
 	for (int i = 0; i < AudioStyle_MAX; ++i)
@@ -70,6 +72,12 @@ void AudioWaveformRenderer::Render(wxBitmap &bmp, int start, AudioRenderingStyle
 	dc.SetPen(*wxTRANSPARENT_PEN);
 	dc.DrawRectangle(rect);
 
+	if (separate_channels && provider->GetChannelSummary())
+	{
+		RenderChannels(dc, rect, start, pal);
+		return;
+	}
+
 	// Make sure we've got a buffer to fill with audio data
 	if (!audio_buffer)
 	{
@@ -131,6 +139,58 @@ void AudioWaveformRenderer::Render(wxBitmap &bmp, int start, AudioRenderingStyle
 	dc.DrawLine(0, midpoint, rect.width, midpoint);
 }
 
+void AudioWaveformRenderer::RenderChannels(wxDC &dc, wxRect const& rect, int start, const AudioColorScheme *pal)
+{
+	auto const& summary = *provider->GetChannelSummary();
+	int channels = summary.GetChannels();
+	double pixel_samples = pixel_ms * summary.GetSampleRate() / 1000.0;
+	double cur_sample = start * pixel_samples;
+
+	// Without a cache the summary is only filled in as audio is read, so read
+	// the visible range if it's missing
+	int16_t min, max;
+	if (!summary.GetPeaks(0, (int64_t)cur_sample, (int64_t)(rect.width * pixel_samples), min, max))
+	{
+		double ratio = (double)provider->GetSampleRate() / summary.GetSampleRate();
+		int64_t count = std::max<int64_t>(rect.width * pixel_samples * ratio, 1);
+		std::vector<int16_t> buffer(count);
+		provider->GetAudio(buffer.data(), (int64_t)(cur_sample * ratio), count);
+	}
+
+	wxPen pen_peaks(pal->get(0.4f));
+	dc.SetPen(pen_peaks);
+
+	for (int x = 0; x < rect.width; ++x)
+	{
+		auto sample = (int64_t)cur_sample;
+		cur_sample += pixel_samples;
+		auto count = std::max<int64_t>((int64_t)cur_sample - sample, 1);
+
+		for (int c = 0; c < channels; ++c)
+		{
+			if (!summary.GetPeaks(c, sample, count, min, max)) continue;
+
+			int top = rect.height * c / channels;
+			int height = rect.height * (c + 1) / channels - top;
+			int midpoint = top + height / 2;
+			int half = height / 2;
+
+			int peak_min = std::max((int)(min * amplitude_scale * half) / 0x8000, -half);
+			int peak_max = std::min((int)(max * amplitude_scale * half) / 0x8000, half);
+			dc.DrawLine(x, midpoint - peak_max, x, midpoint - peak_min + 1);
+		}
+	}
+
+	// Zero-point line for each channel
+	dc.SetPen(wxPen(pal->get(1.0f)));
+	for (int c = 0; c < channels; ++c)
+	{
+		int top = rect.height * c / channels;
+		int midpoint = top + (rect.height * (c + 1) / channels - top) / 2;
+		dc.DrawLine(0, midpoint, rect.width, midpoint);
+	}
+}
+
 void AudioWaveformRenderer::RenderBlank(wxDC &dc, const wxRect &rect, AudioRenderingStyle style)
 {
 	const AudioColorScheme *pal = &colors[style];
@@ -46,6 +46,13 @@ class AudioWaveformRenderer final : public AudioRendererBitmapProvider {
 	/// Whether to render max+avg or just max
 	bool render_averages;
 
+	/// Whether to draw each channel of multichannel audio separately
+	bool separate_channels;
+
+	/// Draw the peaks of each channel in its own lane from the provider's
+	/// channel summary
+	void RenderChannels(wxDC &dc, wxRect const& rect, int start, const AudioColorScheme *pal);
+
 	void OnSetProvider() override { audio_buffer.reset(); }
 	void OnSetMillisecondsPerPixel() override { audio_buffer.reset(); }
 
@@ -63,7 +63,18 @@
 namespace Automation4 {
 	bool CalculateTextExtents(AssStyle *style, std::string const& text, double &width, double &height, double &descent, double &extlead)
 	{
-		width = height = descent = extlead = 0;
+		std::vector<TextExtents> extents;
+		bool ok = CalculateTextExtents(style, std::vector<std::string>{text}, extents);
+		width = extents[0].width;
+		height = extents[0].height;
+		descent = extents[0].descent;
+		extlead = extents[0].extlead;
+		return ok;
+	}
+
+	bool CalculateTextExtents(AssStyle *style, std::vector<std::string> const& texts, std::vector<TextExtents> &extents)
+	{
+		extents.assign(texts.size(), TextExtents());
 
 		double fontsize = style->fontsize * 64;
 		double spacing = style->spacing * 64;
@@ -93,27 +104,30 @@ namespace Automation4 {
 
 		auto old_font = SelectObject(dc, font);
 
-		std::wstring wtext(agi::charset::ConvertW(text));
-		if (spacing != 0 ) {
-			width = 0;
-			for (auto c : wtext) {
+		TEXTMETRIC tm;
+		GetTextMetrics(dc, &tm);
+
+		for (size_t i = 0; i < texts.size(); ++i) {
+			auto& e = extents[i];
+			std::wstring wtext(agi::charset::ConvertW(texts[i]));
+			if (spacing != 0 ) {
+				for (auto c : wtext) {
+					SIZE sz;
+					GetTextExtentPoint32(dc, &c, 1, &sz);
+					e.width += sz.cx + spacing;
+					e.height = sz.cy;
+				}
+			}
+			else {
 				SIZE sz;
-				GetTextExtentPoint32(dc, &c, 1, &sz);
-				width += sz.cx + spacing;
-				height = sz.cy;
+				GetTextExtentPoint32(dc, &wtext[0], (int)wtext.size(), &sz);
+				e.width = sz.cx;
+				e.height = sz.cy;
 			}
-		}
-		else {
-			SIZE sz;
-			GetTextExtentPoint32(dc, &wtext[0], (int)wtext.size(), &sz);
-			width = sz.cx;
-			height = sz.cy;
-		}
 
-		TEXTMETRIC tm;
-		GetTextMetrics(dc, &tm);
-		descent = tm.tmDescent;
-		extlead = tm.tmExternalLeading;
+			e.descent = tm.tmDescent;
+			e.extlead = tm.tmExternalLeading;
+		}
 
 		SelectObject(dc, old_font);
 		DeleteObject(font);
@@ -139,33 +153,38 @@ namespace Automation4 {
 			wxFONTENCODING_SYSTEM); // FIXME! make sure to get the right encoding here, make some translation table between windows and wx encodings
 		thedc.SetFont(thefont);
 
-		wxString wtext(to_wx(text));
-		if (spacing) {
-			// If there's inter-character spacing, kerning info must not be used, so calculate width per character
-			// NOTE: Is kerning actually done either way?!
-			for (auto const& wc : wtext) {
-				int a, b, c, d;
-				thedc.GetTextExtent(wc, &a, &b, &c, &d);
-				double scaling = fontsize / (double)(b > 0 ? b : 1); // semi-workaround for missing OS/2 table data for scaling
-				width += (a + spacing)*scaling;
-				height = b > height ? b*scaling : height;
-				descent = c > descent ? c*scaling : descent;
-				extlead = d > extlead ? d*scaling : extlead;
+		for (size_t i = 0; i < texts.size(); ++i) {
+			auto& e = extents[i];
+			wxString wtext(to_wx(texts[i]));
+			if (spacing) {
+				// If there's inter-character spacing, kerning info must not be used, so calculate width per character
+				// NOTE: Is kerning actually done either way?!
+				for (auto const& wc : wtext) {
+					int a, b, c, d;
+					thedc.GetTextExtent(wc, &a, &b, &c, &d);
+					double scaling = fontsize / (double)(b > 0 ? b : 1); // semi-workaround for missing OS/2 table data for scaling
+					e.width += (a + spacing)*scaling;
+					e.height = b > e.height ? b*scaling : e.height;
+					e.descent = c > e.descent ? c*scaling : e.descent;
+					e.extlead = d > e.extlead ? d*scaling : e.extlead;
+				}
+			} else {
+				// If the inter-character spacing should be zero, kerning info can (and must) be used, so calculate everything in one go
+				wxCoord lwidth, lheight, ldescent, lextlead;
+				thedc.GetTextExtent(wtext, &lwidth, &lheight, &ldescent, &lextlead);
+				double scaling = fontsize / (double)(lheight > 0 ? lheight : 1); // semi-workaround for missing OS/2 table data for scaling
+				e.width = lwidth*scaling; e.height = lheight*scaling; e.descent = ldescent*scaling; e.extlead = lextlead*scaling;
 			}
-		} else {
-			// If the inter-character spacing should be zero, kerning info can (and must) be used, so calculate everything in one go
-			wxCoord lwidth, lheight, ldescent, lextlead;
-			thedc.GetTextExtent(wtext, &lwidth, &lheight, &ldescent, &lextlead);
-			double scaling = fontsize / (double)(lheight > 0 ? lheight : 1); // semi-workaround for missing OS/2 table data for scaling
-			width = lwidth*scaling; height = lheight*scaling; descent = ldescent*scaling; extlead = lextlead*scaling;
 		}
 #endif
 
 		// Compensate for scaling
-		width = style->scalex / 100 * width / 64;
-		height = style->scaley / 100 * height / 64;
-		descent = style->scaley / 100 * descent / 64;
-		extlead = style->scaley / 100 * extlead / 64;
+		for (auto& e : extents) {
+			e.width = style->scalex / 100 * e.width / 64;
+			e.height = style->scaley / 100 * e.height / 64;
+			e.descent = style->scaley / 100 * e.descent / 64;
+			e.extlead = style->scaley / 100 * e.extlead / 64;
+		}
 
 		return true;
 	}
@@ -58,8 +58,18 @@ namespace Automation4 {
 	DEFINE_EXCEPTION(ScriptLoadError, AutomationError);
 	DEFINE_EXCEPTION(MacroRunError, AutomationError);
 
+	struct TextExtents {
+		double width = 0;
+		double height = 0;
+		double descent = 0;
+		double extlead = 0;
+	};
+
 	// Calculate the extents of a text string given a style
 	bool CalculateTextExtents(AssStyle *style, std::string const& text, double &width, double &height, double &descent, double &extlead);
+	// Calculate the extents of several text strings given a style, only
+	// setting up the font once
+	bool CalculateTextExtents(AssStyle *style, std::vector<std::string> const& texts, std::vector<TextExtents> &extents);
 
 	class ScriptDialog;
 
@@ -175,6 +185,9 @@ namespace Automation4 {
 		virtual std::vector<cmd::Command*> GetMacros() const=0;
 		/// Get a list of export filters provided by this script
 		virtual std::vector<ExportFilter*> GetFilters() const=0;
+		/// Get a description of each macro whose validation functions are
+		/// slow enough to delay updating menus and toolbars
+		virtual std::vector<std::string> GetSlowValidators() const { return {}; }
 	};
 
 	/// A manager of loaded automation scripts
@@ -53,6 +53,7 @@
 #include "utils.h"
 
 #include <libaegisub/format.h>
+#include <libaegisub/log.h>
 #include <libaegisub/lua/ffi.h>
 #include <libaegisub/lua/modules.h>
 #include <libaegisub/lua/script_reader.h>
@@ -66,6 +67,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/scope_exit.hpp>
 #include <cassert>
+#include <chrono>
 #include <mutex>
 #include <wx/clipbrd.h>
 #include <wx/log.h>
@@ -326,6 +328,45 @@ namespace {
 		wxString help;
 		int cmd_type;
 
+		/// The result of the last call to a validation function and the
+		/// state of the file it was called with
+		struct CachedResult {
+			const agi::Context *c = nullptr;
+			uint64_t commit_version = 0;
+			uint64_t selection_version = 0;
+			bool result = false;
+
+			bool Matches(const agi::Context *c) const;
+			void Store(const agi::Context *c, bool result);
+			void Clear() { c = nullptr; }
+		};
+		CachedResult validate_cache;
+		CachedResult active_cache;
+
+		/// Serial number of the context whose changes are being listened for
+		/// to clear the caches. A pointer isn't enough, as a new context can
+		/// be allocated at a destroyed one's address.
+		uint64_t watched_context = 0;
+		/// Clear the caches on anything a validation function could look at
+		/// changing: the file, selection, video, audio, playback state and
+		/// any command being run (including macros, which may change state
+		/// on the Lua side)
+		std::vector<agi::signal::Connection> cache_connections;
+
+		/// Start clearing the caches on changes to the given context
+		void WatchContext(const agi::Context *c);
+		void ClearCaches();
+
+		/// Slowest call to either validation function, in milliseconds
+		int slowest_validation = 0;
+		/// Number of validation calls which were cut off for running too long
+		int budget_overruns = 0;
+
+		/// Call a validation function and its three arguments from the top of
+		/// the stack with the time limit applied, recording how long it took
+		/// @return The error code from lua_pcall
+		int CallValidator(int nresults, int errfunc, bool *timed_out);
+
 	public:
 		LuaCommand(lua_State *L);
 		~LuaCommand();
@@ -342,6 +383,9 @@ namespace {
 		virtual bool IsActive(const agi::Context *c) override;
 
 		static int LuaRegister(lua_State *L);
+
+		/// Get a description of this macro's validation performance if it is slow
+		std::string GetSlowValidatorDescription() const;
 	};
 
 	class LuaExportFilter final : public ExportFilter, private LuaFeature {
@@ -396,6 +440,7 @@ namespace {
 
 		std::vector<cmd::Command*> GetMacros() const override { return macros; }
 		std::vector<ExportFilter*> GetFilters() const override;
+		std::vector<std::string> GetSlowValidators() const override;
 	};
 
 	LuaScript::LuaScript(agi::fs::path const& filename)
@@ -545,6 +590,17 @@ namespace {
 		return ret;
 	}
 
+	std::vector<std::string> LuaScript::GetSlowValidators() const
+	{
+		std::vector<std::string> ret;
+		for (auto macro : macros) {
+			auto desc = static_cast<LuaCommand *>(macro)->GetSlowValidatorDescription();
+			if (!desc.empty())
+				ret.push_back(std::move(desc));
+		}
+		return ret;
+	}
+
 	void LuaScript::RegisterCommand(LuaCommand *command)
 	{
 		for (auto macro : macros) {
@@ -716,21 +772,144 @@ namespace {
 		LuaScript::GetScriptObject(L)->UnregisterCommand(this);
 	}
 
-	static std::vector<int> selected_rows(const agi::Context *c)
+	static std::vector<int> const& selected_rows(const agi::Context *c)
 	{
+		// Every macro's validation function is called with the same selection
+		// when a menu is opened, so only build it once per change. Commit and
+		// selection versions are unique across files and controllers, so a new
+		// context at a freed one's address never matches the cached rows.
+		static const agi::Context *cached_context = nullptr;
+		static uint64_t cached_commit = 0, cached_selection = 0;
+		static std::vector<int> rows;
+
+		uint64_t commit = c->ass->GetCommitVersion();
+		uint64_t selection = c->selectionController->GetVersion();
+		if (c == cached_context && commit == cached_commit && selection == cached_selection)
+			return rows;
+
 		auto const& sel = c->selectionController->GetSelectedSet();
 		int offset = c->ass->Info.size() + c->ass->Styles.size();
-		std::vector<int> rows;
+		rows.clear();
 		rows.reserve(sel.size());
 		for (auto line : sel)
 			rows.push_back(line->Row + offset + 1);
 		sort(begin(rows), end(rows));
+
+		cached_context = c;
+		cached_commit = commit;
+		cached_selection = selection;
 		return rows;
 	}
 
+	bool LuaCommand::CachedResult::Matches(const agi::Context *ctx) const
+	{
+		return c == ctx
+			&& commit_version == ctx->ass->GetCommitVersion()
+			&& selection_version == ctx->selectionController->GetVersion();
+	}
+
+	void LuaCommand::CachedResult::Store(const agi::Context *ctx, bool new_result)
+	{
+		c = ctx;
+		commit_version = ctx->ass->GetCommitVersion();
+		selection_version = ctx->selectionController->GetVersion();
+		result = new_result;
+	}
+
+	void LuaCommand::WatchContext(const agi::Context *c)
+	{
+		if (c->serial == watched_context) return;
+		ClearCaches();
+		cache_connections = cmd::listen(c, cmd::DEPENDS_ALL, [=](int) { ClearCaches(); });
+		watched_context = c->serial;
+	}
+
+	void LuaCommand::ClearCaches()
+	{
+		validate_cache.Clear();
+		active_cache.Clear();
+	}
+
+	std::chrono::steady_clock::time_point validation_deadline;
+	bool validation_timed_out = false;
+
+	void validation_budget_hook(lua_State *L, lua_Debug *)
+	{
+		if (std::chrono::steady_clock::now() < validation_deadline) return;
+		validation_timed_out = true;
+		luaL_error(L, "Validation function exceeded its time limit");
+	}
+
+	/// Check if the JIT compiler is currently enabled, as scripts can turn it off themselves
+	bool jit_enabled(lua_State *L)
+	{
+		lua_getglobal(L, "jit");
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			return true;
+		}
+		lua_getfield(L, -1, "status");
+		if (!lua_isfunction(L, -1)) {
+			lua_pop(L, 2);
+			return true;
+		}
+		lua_call(L, 0, 1);
+		bool enabled = !!lua_toboolean(L, -1);
+		lua_pop(L, 2);
+		return enabled;
+	}
+
+	int LuaCommand::CallValidator(int nresults, int errfunc, bool *timed_out)
+	{
+		using namespace std::chrono;
+		auto budget = milliseconds(OPT_GET("Automation/Validation Budget")->GetInt());
+		auto start = steady_clock::now();
+
+		// Validation functions are only ever run on the GUI thread, so the
+		// deadline can be shared by all scripts
+		validation_deadline = start + budget;
+		validation_timed_out = false;
+
+		// Count hooks aren't run inside compiled traces, so the validator
+		// has to be interpreted for the time limit to work. Turning the JIT
+		// off doesn't stop existing traces from being entered, so any which
+		// were compiled from the validator are also flushed.
+		bool jit_was_enabled = jit_enabled(L);
+		luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE|LUAJIT_MODE_OFF);
+		luaJIT_setmode(L, -4, LUAJIT_MODE_ALLFUNC|LUAJIT_MODE_OFF);
+
+		lua_sethook(L, validation_budget_hook, LUA_MASKCOUNT, 1000);
+		int err = lua_pcall(L, 3, nresults, errfunc);
+		lua_sethook(L, nullptr, 0, 0);
+
+		if (jit_was_enabled)
+			luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE|LUAJIT_MODE_ON);
+
+		int elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+		slowest_validation = std::max(slowest_validation, elapsed);
+
+		*timed_out = err && validation_timed_out;
+		if (*timed_out) {
+			++budget_overruns;
+			LOG_W("automation/lua") << cmd_name << ": validation function took over " << budget.count() << " ms and was stopped";
+		}
+		return err;
+	}
+
+	std::string LuaCommand::GetSlowValidatorDescription() const
+	{
+		int budget = OPT_GET("Automation/Validation Budget")->GetInt();
+		if (!budget_overruns && slowest_validation * 2 < budget)
+			return "";
+		return agi::format("%s: slowest validation took %d ms, stopped %d times for exceeding the %d ms limit",
+			from_wx(display), slowest_validation, budget_overruns, budget);
+	}
+
 	bool LuaCommand::Validate(const agi::Context *c)
 	{
 		if (!(cmd_type & cmd::COMMAND_VALIDATE)) return true;
+		WatchContext(c);
+		if (validate_cache.Matches(c)) return validate_cache.result;
 
 		set_context(L, c);
 
@@ -746,12 +925,18 @@ namespace {
 		else
 			lua_pushnil(L);
 
-		int err = lua_pcall(L, 3, 2, -5 /* three args, function, error handler */);
+		bool timed_out;
+		int err = CallValidator(2, -5 /* three args, function, error handler */, &timed_out);
 		subsobj->ProcessingComplete();
 
 		if (err) {
-			wxLogWarning("Runtime error in Lua macro validation function:\n%s", get_wxstring(L, -1));
+			// Macros whose validation functions run too long are disabled
+			// along with ones which fail, as running them could just as
+			// easily hang
+			if (!timed_out)
+				wxLogWarning("Runtime error in Lua macro validation function:\n%s", get_wxstring(L, -1));
 			lua_pop(L, 2);
+			validate_cache.Store(c, false);
 			return false;
 		}
 
@@ -765,11 +950,17 @@ namespace {
 
 		lua_pop(L, 3); // two return values and error handler
 
+		validate_cache.Store(c, result);
 		return result;
 	}
 
 	void LuaCommand::operator()(agi::Context *c)
 	{
+		// The macro may change state its validation functions look at
+		// without touching the file, so they have to be rerun afterwards
+		// however it was run
+		ClearCaches();
+
 		LuaStackcheck stackcheck(L);
 		set_context(L, c);
 		stackcheck.check_stack(0);
@@ -874,6 +1065,8 @@ namespace {
 	bool LuaCommand::IsActive(const agi::Context *c)
 	{
 		if (!(cmd_type & cmd::COMMAND_TOGGLE)) return false;
+		WatchContext(c);
+		if (active_cache.Matches(c)) return active_cache.result;
 
 		LuaStackcheck stackcheck(L);
 
@@ -885,20 +1078,24 @@ namespace {
 		push_value(L, selected_rows(c));
 		if (auto active_line = c->selectionController->GetActiveLine())
 			push_value(L, active_line->Row + c->ass->Info.size() + c->ass->Styles.size() + 1);
+		else
+			lua_pushnil(L);
 
-		int err = lua_pcall(L, 3, 1, 0);
+		bool timed_out;
+		int err = CallValidator(1, 0, &timed_out);
 		subsobj->ProcessingComplete();
 
 		bool result = false;
-		if (err)
+		if (err && !timed_out)
 			wxLogWarning("Runtime error in Lua macro IsActive function:\n%s", get_wxstring(L, -1));
-		else
+		else if (!err)
 			result = !!lua_toboolean(L, -1);
 
 		// clean up stack (result or error message)
 		stackcheck.check_stack(1);
 		lua_pop(L, 1);
 
+		active_cache.Store(c, result);
 		return result;
 	}
 
@@ -48,8 +48,10 @@
 
 #include <algorithm>
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <cassert>
 #include <memory>
+#include <unordered_map>
 
 namespace {
 	using namespace agi::lua;
@@ -128,6 +130,373 @@ namespace {
 	const T *check_cast_constptr(const U *value) {
 		return typeid(const T) == typeid(*value) ? static_cast<const T *>(value) : nullptr;
 	}
+
+	/// Get the first character of a UTF-8 string the same way as karaskel's
+	/// str:sub(1, unicode.charwidth(str, 1))
+	std::string first_char(std::string const& str)
+	{
+		if (str.empty()) return str;
+		auto b = static_cast<unsigned char>(str[0]);
+		return str.substr(0, b < 128 ? 1 : b < 224 ? 2 : b < 240 ? 3 : 4);
+	}
+
+	/// Get the name of the last inline-fx tag in some text, matching karaskel's
+	/// %{.*\\%-([^}\\]+) pattern
+	std::string find_inline_fx(std::string const& text)
+	{
+		auto brace = text.find('{');
+		if (brace == std::string::npos) return "";
+
+		for (size_t pos = text.size(); pos-- > brace + 1; ) {
+			if (text[pos] != '\\' || pos + 2 >= text.size() || text[pos + 1] != '-')
+				continue;
+			auto end = text.find_first_of("}\\", pos + 2);
+			if (end != pos + 2)
+				return text.substr(pos + 2, end == std::string::npos ? std::string::npos : end - pos - 2);
+		}
+		return "";
+	}
+
+	std::string get_string_or_empty(lua_State *L, int idx, const char *name)
+	{
+		lua_getfield(L, idx, name);
+		std::string ret(lua_isstring(L, -1) ? lua_tostring(L, -1) : "");
+		lua_pop(L, 1);
+		return ret;
+	}
+
+	/// Set a field of the table on the top of the stack to the value at idx
+	void set_field_to(lua_State *L, const char *name, int idx)
+	{
+		lua_pushvalue(L, idx);
+		lua_setfield(L, -2, name);
+	}
+
+	/// Push an empty karaskel list (a table with an explicit count)
+	void push_list(lua_State *L)
+	{
+		lua_createtable(L, 0, 1);
+		set_field(L, "n", 0);
+	}
+
+	std::unique_ptr<AssStyle> check_style(lua_State *L, int idx)
+	{
+		lua_getfield(L, idx, "class");
+		std::string actual_class{lua_isstring(L, -1) ? lua_tostring(L, -1) : ""};
+		boost::to_lower(actual_class);
+		if (actual_class != "style")
+			error(L, "Not a style entry");
+		lua_pop(L, 1);
+
+		lua_pushvalue(L, idx);
+		auto e = LuaAssFile::LuaToAssEntry(L);
+		lua_pop(L, 1);
+		if (typeid(*e) != typeid(AssStyle))
+			error(L, "Not a style entry");
+		return std::unique_ptr<AssStyle>(static_cast<AssStyle *>(e.release()));
+	}
+
+	/// Split the dialogue line at index 1 into karaskel's syllable and
+	/// furigana tables, as karaskel.preproc_line_text does
+	void karaskel_text(lua_State *L, AssDialogue const& dia)
+	{
+		struct Syllable {
+			int start_time;
+			int end_time;
+			int duration;
+			std::string tag;
+			std::string text;
+			std::string text_stripped;
+		};
+
+		// As with parse_karaoke_data, syllable zero is always empty
+		std::vector<Syllable> syls(1, Syllable{0, 0, 0, "", "", ""});
+		AssKaraoke kara(&dia, false, false);
+		for (auto const& syl : kara) {
+			int start = syl.start_time - dia.Start;
+			syls.push_back(Syllable{start, start + syl.duration, syl.duration, syl.tag_type, syl.GetText(false), syl.text});
+		}
+
+		push_list(L);
+		int kara_list = lua_gettop(L);
+		push_list(L);
+		int furi_list = lua_gettop(L);
+		lua_pushvalue(L, kara_list);
+		lua_setfield(L, 1, "kara");
+		lua_pushvalue(L, furi_list);
+		lua_setfield(L, 1, "furi");
+
+		int kara_n = 0, furi_n = 0;
+		std::string line_text;
+		std::string cur_inline_fx;
+
+		// The output syllable being built, which may span several highlights
+		int worksyl = 0;
+		int highlights_n = 0, syl_furi_n = 0, duration = 0;
+		double kdur = 0;
+		bool has_text = false;
+		auto new_worksyl = [&] {
+			lua_createtable(L, 0, 16);
+			push_list(L);
+			lua_setfield(L, -2, "highlights");
+			push_list(L);
+			lua_setfield(L, -2, "furi");
+			if (worksyl)
+				lua_replace(L, worksyl);
+			else
+				worksyl = lua_gettop(L);
+			highlights_n = syl_furi_n = 0;
+			has_text = false;
+		};
+		new_worksyl();
+
+		for (size_t i = 0; i < syls.size(); ++i) {
+			auto const& syl = syls[i];
+
+			auto inline_fx = find_inline_fx(syl.text);
+			if (!inline_fx.empty())
+				cur_inline_fx = inline_fx;
+
+			// Strip spaces (only basic ones, no fullwidth etc.)
+			std::string prespace, syltext, postspace;
+			auto first = syl.text_stripped.find_first_not_of(" \t");
+			if (first == std::string::npos)
+				prespace = syl.text_stripped;
+			else {
+				auto last = syl.text_stripped.find_last_not_of(" \t") + 1;
+				prespace = syl.text_stripped.substr(0, first);
+				syltext = syl.text_stripped.substr(first, last - first);
+				postspace = syl.text_stripped.substr(last);
+			}
+
+			// Syllables starting with # are extra highlights of the previous one
+			auto prefix = first_char(syltext);
+			bool extra_highlight = prefix == "#" || prefix == "\xEF\xBC\x83"; // fullwidth #
+			if (!extra_highlight && i > 0) {
+				lua_pushvalue(L, worksyl);
+				lua_rawseti(L, kara_list, kara_n++);
+				new_worksyl();
+			}
+
+			lua_createtable(L, 0, 3);
+			set_field(L, "start_time", syl.start_time);
+			set_field(L, "end_time", syl.end_time);
+			set_field(L, "duration", syl.duration);
+			int hl = lua_gettop(L);
+
+			lua_getfield(L, worksyl, "highlights");
+			lua_pushvalue(L, hl);
+			lua_rawseti(L, -2, ++highlights_n);
+			set_field(L, "n", highlights_n);
+			lua_pop(L, 1);
+
+			// Detect furigana (both regular and fullwidth pipes work)
+			boost::replace_all(syltext, "\xEF\xBD\x9C", "|"); // fullwidth |
+			auto pipe = syltext.find('|');
+			if (pipe != std::string::npos) {
+				auto furitext = syltext.substr(pipe + 1);
+				syltext.erase(pipe);
+
+				// isbreak = Don't join this furi visually with previous furi
+				// spillback = Allow this furi text to spill over the left edge of the main text
+				auto furi_prefix = first_char(furitext);
+				bool spillback = furi_prefix == "<" || furi_prefix == "\xEF\xBC\x9C"; // fullwidth <
+				bool isbreak = spillback || furi_prefix == "!" || furi_prefix == "\xEF\xBC\x81"; // fullwidth !
+				if (isbreak)
+					furitext.erase(0, furi_prefix.size());
+
+				lua_createtable(L, 0, 20);
+				set_field_to(L, "syl", worksyl);
+				set_field(L, "isbreak", isbreak);
+				set_field(L, "spillback", spillback);
+				set_field(L, "start_time", syl.start_time);
+				set_field(L, "end_time", syl.end_time);
+				set_field(L, "duration", syl.duration);
+				set_field(L, "kdur", syl.duration / 10.0);
+				set_field(L, "text", furitext);
+				set_field(L, "text_stripped", furitext);
+				set_field(L, "text_spacestripped", furitext);
+				set_field_to(L, "line", 1);
+				set_field(L, "tag", syl.tag);
+				set_field(L, "inline_fx", cur_inline_fx);
+				set_field(L, "i", kara_n);
+				set_field(L, "prespace", "");
+				set_field(L, "postspace", "");
+				set_field(L, "isfuri", true);
+
+				lua_createtable(L, 1, 1);
+				set_field(L, "n", 1);
+				lua_pushvalue(L, hl);
+				lua_rawseti(L, -2, 1);
+				lua_setfield(L, -2, "highlights");
+
+				lua_pushvalue(L, -1);
+				lua_rawseti(L, furi_list, ++furi_n);
+				lua_getfield(L, worksyl, "furi");
+				lua_pushvalue(L, -2);
+				lua_rawseti(L, -2, ++syl_furi_n);
+				set_field(L, "n", syl_furi_n);
+				lua_pop(L, 2);
+			}
+			lua_pop(L, 1);
+
+			lua_pushvalue(L, worksyl);
+			if (!has_text || !extra_highlight) {
+				auto text_stripped = prespace + syltext + postspace;
+				line_text += text_stripped;
+
+				has_text = true;
+				duration = syl.duration;
+				kdur = syl.duration / 10.0;
+				set_field(L, "text", syl.text);
+				set_field(L, "duration", duration);
+				set_field(L, "kdur", kdur);
+				set_field(L, "start_time", syl.start_time);
+				set_field(L, "end_time", syl.end_time);
+				set_field(L, "tag", syl.tag);
+				set_field_to(L, "line", 1);
+				set_field(L, "i", kara_n);
+				set_field(L, "text_stripped", text_stripped);
+				set_field(L, "inline_fx", cur_inline_fx);
+				set_field(L, "text_spacestripped", syltext);
+				set_field(L, "prespace", prespace);
+				set_field(L, "postspace", postspace);
+			}
+			else {
+				duration += syl.duration;
+				kdur += syl.duration / 10.0;
+				set_field(L, "duration", duration);
+				set_field(L, "kdur", kdur);
+				set_field(L, "end_time", syl.end_time);
+			}
+			lua_pop(L, 1);
+		}
+
+		// n is the index of the last syllable, not the count, since syllable
+		// zero doesn't count
+		lua_pushvalue(L, worksyl);
+		lua_rawseti(L, kara_list, kara_n);
+		push_value(L, kara_n);
+		lua_setfield(L, kara_list, "n");
+		push_value(L, furi_n);
+		lua_setfield(L, furi_list, "n");
+
+		push_value(L, line_text);
+		lua_setfield(L, 1, "text_stripped");
+		lua_getfield(L, 1, "end_time");
+		lua_getfield(L, 1, "start_time");
+		push_value(L, lua_tonumber(L, -2) - lua_tonumber(L, -1));
+		lua_setfield(L, 1, "duration");
+		lua_pop(L, 5);
+	}
+
+	/// Measure every distinct string in a set of karaskel tables with a single
+	/// text extents call
+	class KaraskelExtents {
+		std::vector<std::string> texts;
+		std::unordered_map<std::string, size_t> index;
+		std::vector<TextExtents> extents;
+
+	public:
+		/// Queue a string field of the table at idx to be measured
+		size_t Add(lua_State *L, int idx, const char *name)
+		{
+			auto text = get_string_or_empty(L, idx, name);
+			auto it = index.emplace(text, texts.size());
+			if (it.second)
+				texts.push_back(std::move(text));
+			return it.first->second;
+		}
+
+		void Calculate(lua_State *L, AssStyle *style)
+		{
+			if (!CalculateTextExtents(style, texts, extents))
+				error(L, "Some internal error occurred calculating text_extents");
+		}
+
+		TextExtents const& operator[](size_t i) const { return extents[i]; }
+	};
+
+	/// Calculate the sizes of the line at index 1 and its syllables and
+	/// furigana, as karaskel.preproc_line_size does
+	void karaskel_size(lua_State *L, int style_idx, int furistyle_idx, double x_factor)
+	{
+		auto style = check_style(L, style_idx);
+
+		lua_getfield(L, 1, "kara");
+		int kara_list = lua_gettop(L);
+		lua_getfield(L, kara_list, "n");
+		int kara_n = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+
+		struct SyllableTexts {
+			size_t text;
+			size_t prespace;
+			size_t postspace;
+		};
+
+		KaraskelExtents extents;
+		size_t line_text = extents.Add(L, 1, "text_stripped");
+		std::vector<SyllableTexts> syls;
+		for (int s = 0; s <= kara_n; ++s) {
+			lua_rawgeti(L, kara_list, s);
+			int syl = lua_gettop(L);
+			size_t text = extents.Add(L, syl, "text_spacestripped");
+			size_t prespace = extents.Add(L, syl, "prespace");
+			size_t postspace = extents.Add(L, syl, "postspace");
+			syls.push_back(SyllableTexts{text, prespace, postspace});
+			lua_pop(L, 1);
+		}
+		extents.Calculate(L, style.get());
+
+		lua_pushvalue(L, 1);
+		set_field(L, "width", extents[line_text].width * x_factor);
+		set_field(L, "height", extents[line_text].height);
+		set_field(L, "descent", extents[line_text].descent);
+		set_field(L, "extlead", extents[line_text].extlead);
+		lua_pop(L, 1);
+
+		for (int s = 0; s <= kara_n; ++s) {
+			lua_rawgeti(L, kara_list, s);
+			set_field_to(L, "style", style_idx);
+			set_field(L, "width", extents[syls[s].text].width * x_factor);
+			set_field(L, "height", extents[syls[s].text].height);
+			set_field(L, "prespacewidth", extents[syls[s].prespace].width * x_factor);
+			set_field(L, "postspacewidth", extents[syls[s].postspace].width * x_factor);
+			lua_pop(L, 1);
+		}
+		lua_pop(L, 1);
+
+		if (!furistyle_idx) return;
+
+		auto furistyle = check_style(L, furistyle_idx);
+
+		lua_getfield(L, 1, "furi");
+		int furi_list = lua_gettop(L);
+		lua_getfield(L, furi_list, "n");
+		int furi_n = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+
+		KaraskelExtents furi_extents;
+		std::vector<size_t> furis;
+		for (int f = 1; f <= furi_n; ++f) {
+			lua_rawgeti(L, furi_list, f);
+			furis.push_back(furi_extents.Add(L, lua_gettop(L), "text"));
+			lua_pop(L, 1);
+		}
+		furi_extents.Calculate(L, furistyle.get());
+
+		for (int f = 1; f <= furi_n; ++f) {
+			lua_rawgeti(L, furi_list, f);
+			set_field_to(L, "style", furistyle_idx);
+			set_field(L, "width", furi_extents[furis[f - 1]].width * x_factor);
+			set_field(L, "height", furi_extents[furis[f - 1]].height);
+			set_field(L, "prespacewidth", 0);
+			set_field(L, "postspacewidth", 0);
+			lua_pop(L, 1);
+		}
+		lua_pop(L, 1);
+	}
 }
 
 namespace Automation4 {
@@ -658,6 +1027,29 @@ namespace Automation4 {
 		return 1;
 	}
 
+	int LuaAssFile::LuaKaraskelLayout(lua_State *L)
+	{
+		argcheck(L, !!lua_istable(L, 1), 1, "");
+		lua_settop(L, 4);
+
+		// Lines which have already been split up only need to be measured
+		lua_getfield(L, 1, "kara");
+		bool has_kara = lua_istable(L, -1);
+		lua_pop(L, 1);
+		if (!has_kara) {
+			lua_pushvalue(L, 1);
+			auto e = LuaToAssEntry(L, ass);
+			lua_pop(L, 1);
+			auto dia = check_cast_constptr<AssDialogue>(e.get());
+			argcheck(L, !!dia, 1, "Subtitle line must be a dialogue line");
+			karaskel_text(L, *dia);
+		}
+
+		if (lua_istable(L, 2))
+			karaskel_size(L, 2, lua_istable(L, 3) ? 3 : 0, lua_isnumber(L, 4) ? lua_tonumber(L, 4) : 1.0);
+		return 0;
+	}
+
 	int LuaAssFile::LuaGetScriptResolution(lua_State *L)
 	{
 		int w, h;
@@ -768,6 +1160,7 @@ namespace Automation4 {
 		lua_getglobal(L, "aegisub");
 
 		set_field<closure_wrapper<&LuaAssFile::LuaParseKaraokeData>>(L, "parse_karaoke_data");
+		set_field<closure_wrapper<&LuaAssFile::LuaKaraskelLayout>>(L, "karaskel_layout");
 		set_field<closure_wrapper_v<&LuaAssFile::LuaSetUndoPoint, false>>(L, "set_undo_point");
 
 		lua_pop(L, 1); // pop "aegisub" table
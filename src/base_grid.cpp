@@ -39,6 +39,7 @@
 #include "compat.h"
 #include "grid_column.h"
 #include "options.h"
+#include "overlap_index.h"
 #include "project.h"
 #include "utils.h"
 #include "selection_controller.h"
@@ -49,6 +50,7 @@
 #include <libaegisub/util.h>
 
 #include <algorithm>
+#include <unordered_set>
 
 #include <wx/dcbuffer.h>
 #include <wx/menu.h>
@@ -63,9 +65,16 @@ enum {
 BaseGrid::BaseGrid(wxWindow* parent, agi::Context *context)
 : wxWindow(parent, -1, wxDefaultPosition, wxDefaultSize, wxWANTS_CHARS | wxSUNKEN_BORDER)
 , scrollBar(new wxScrollBar(this, GRID_SCROLLBAR, wxDefaultPosition, wxDefaultSize, wxSB_VERTICAL))
+, row_frames(agi::make_unique<GridRowFrames>())
 , context(context)
 , columns(GetGridColumns())
 , columns_visible(OPT_GET("Subtitle/Grid/Column")->GetListBool())
+, standard_colour(OPT_CACHE(agi::Color, "Colour/Subtitle Grid/Standard"))
+, selection_colour(OPT_CACHE(agi::Color, "Colour/Subtitle Grid/Selection"))
+, collision_colour(OPT_CACHE(agi::Color, "Colour/Subtitle Grid/Collision"))
+, lines_colour(OPT_CACHE(agi::Color, "Colour/Subtitle Grid/Lines"))
+, active_border_colour(OPT_CACHE(agi::Color, "Colour/Subtitle Grid/Active Border"))
+, highlight_visible(OPT_CACHE(bool, "Subtitle/Grid/Highlight Subtitles in Frame"))
 , seek_listener(context->videoController->AddSeekListener(&BaseGrid::OnSeek, this))
 {
 	scrollBar->SetScrollbar(0,10,100,10);
@@ -82,6 +91,8 @@ BaseGrid::BaseGrid(wxWindow* parent, agi::Context *context)
 		if (!columns_visible[i])
 			columns[i]->SetVisible(false);
 	}
+	for (auto& column : columns)
+		column->SetRowFrames(row_frames.get());
 
 	UpdateStyle();
 	OnHighlightVisibleChange(*OPT_GET("Subtitle/Grid/Highlight Subtitles in Frame"));
@@ -91,6 +102,7 @@ BaseGrid::BaseGrid(wxWindow* parent, agi::Context *context)
 
 		context->selectionController->AddActiveLineListener(&BaseGrid::OnActiveLineChanged, this),
 		context->selectionController->AddSelectionListener([&]{ Refresh(false); }),
+		context->subsController->AddFileOpenListener([&](agi::fs::path const&) { ClearFilter(); }),
 
 		OPT_SUB("Subtitle/Grid/Font Face", &BaseGrid::UpdateStyle, this),
 		OPT_SUB("Subtitle/Grid/Font Size", &BaseGrid::UpdateStyle, this),
@@ -194,9 +206,16 @@ void BaseGrid::UpdateStyle() {
 
 void BaseGrid::UpdateMaps() {
 	index_line_map.clear();
+	line_index_map.clear();
 
-	for (auto& curdiag : context->ass->Events)
+	for (auto& curdiag : context->ass->Events) {
+		if (filtered) {
+			if (FieldValueIndex::Get(&curdiag, filter_field).get() != filter_value)
+				continue;
+			line_index_map[&curdiag] = index_line_map.size();
+		}
 		index_line_map.push_back(&curdiag);
+	}
 
 	SetColumnWidths();
 	AdjustScrollbar();
@@ -204,14 +223,75 @@ void BaseGrid::UpdateMaps() {
 }
 
 void BaseGrid::OnActiveLineChanged(AssDialogue *new_active) {
-	if (new_active) {
-		if (new_active->Row != active_row)
-			MakeRowVisible(new_active->Row);
-		extendRow = active_row = new_active->Row;
+	int row = new_active ? GetRow(new_active) : -1;
+	if (row >= 0) {
+		if (row != active_row)
+			MakeRowVisible(row);
+		extendRow = active_row = row;
 		Refresh(false);
 	}
-	else
+	else {
 		active_row = -1;
+		if (new_active)
+			Refresh(false);
+	}
+}
+
+int BaseGrid::GetRow(const AssDialogue *line) const {
+	if (!filtered) return line->Row;
+	auto it = line_index_map.find(line);
+	return it == line_index_map.end() ? -1 : it->second;
+}
+
+void BaseGrid::SetFilter(FieldValueIndex::Field field, std::string const& value) {
+	filtered = true;
+	filter_field = field;
+	filter_value = value;
+	UpdateMaps();
+
+	// Commands act on the selection and active line, so don't leave them on
+	// lines which can no longer be seen
+	auto sel = context->selectionController->GetSelectedSet();
+	auto active_line = context->selectionController->GetActiveLine();
+	bool changed = false;
+	for (auto it = sel.begin(); it != sel.end(); ) {
+		if (GetRow(*it) < 0) {
+			it = sel.erase(it);
+			changed = true;
+		}
+		else
+			++it;
+	}
+
+	if (active_line && GetRow(active_line) < 0 && !index_line_map.empty()) {
+		// Move to whichever of the visible lines on either side is closer
+		auto next = lower_bound(index_line_map.begin(), index_line_map.end(), active_line->Row,
+			[](const AssDialogue *line, int row) { return line->Row < row; });
+		if (next == index_line_map.end())
+			--next;
+		else if (next != index_line_map.begin()) {
+			auto before = std::prev(next);
+			if (active_line->Row - (*before)->Row <= (*next)->Row - active_line->Row)
+				next = before;
+		}
+		active_line = *next;
+		if (sel.empty())
+			sel.insert(active_line);
+		changed = true;
+	}
+
+	if (changed)
+		context->selectionController->SetSelectionAndActive(std::move(sel), active_line);
+	if (active_line)
+		OnActiveLineChanged(active_line);
+}
+
+void BaseGrid::ClearFilter() {
+	if (!filtered) return;
+	filtered = false;
+	UpdateMaps();
+	if (auto active_line = context->selectionController->GetActiveLine())
+		OnActiveLineChanged(active_line);
 }
 
 void BaseGrid::MakeRowVisible(int row) {
@@ -247,6 +327,7 @@ void BaseGrid::SelectRow(int row, bool addToSelected, bool select) {
 void BaseGrid::OnSeek() {
 	int lines = GetClientSize().GetHeight() / lineHeight + 1;
 	lines = mid(0, lines, GetRows() - yPos);
+	UpdateRowFrames(yPos, lines);
 
 	auto it = begin(visible_rows);
 	for (int i : boost::irange(yPos, yPos + lines)) {
@@ -299,12 +380,12 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 	dc.DrawRectangle(0, lineHeight, columns[0]->Width(), h-lineHeight);
 
 	// Row colors
-	wxColour text_standard(to_wx(OPT_GET("Colour/Subtitle Grid/Standard")->GetColor()));
-	wxColour text_selection(to_wx(OPT_GET("Colour/Subtitle Grid/Selection")->GetColor()));
-	wxColour text_collision(to_wx(OPT_GET("Colour/Subtitle Grid/Collision")->GetColor()));
+	wxColour text_standard(to_wx(*standard_colour));
+	wxColour text_selection(to_wx(*selection_colour));
+	wxColour text_collision(to_wx(*collision_colour));
 
 	// First grid row
-	wxPen grid_pen(to_wx(OPT_GET("Colour/Subtitle Grid/Lines")->GetColor()));
+	wxPen grid_pen(to_wx(*lines_colour));
 	dc.SetPen(grid_pen);
 	dc.DrawLine(0, 0, w, 0);
 	dc.SetPen(*wxTRANSPARENT_PEN);
@@ -345,6 +426,11 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 	auto const& selection = context->selectionController->GetSelectedSet();
 	visible_rows.clear();
 
+	auto colliding_lines = context->overlaps->GetColliding(active_line);
+	std::unordered_set<AssDialogue *> colliding(begin(colliding_lines), end(colliding_lines));
+
+	UpdateRowFrames(yPos, nDraw);
+
 	for (int i : agi::util::range(nDraw)) {
 		wxBrush color = row_colors.Default;
 		AssDialogue *curDiag = index_line_map[i + yPos];
@@ -357,7 +443,7 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 		else if (curDiag->Comment)
 			color = row_colors.Comment;
 
-		if (OPT_GET("Subtitle/Grid/Highlight Subtitles in Frame")->GetBool() && IsDisplayed(curDiag)) {
+		if (*highlight_visible && IsDisplayed(curDiag)) {
 			if (color == row_colors.Default)
 				color = row_colors.Visible;
 			visible_rows.push_back(i + yPos);
@@ -370,7 +456,7 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 			dc.DrawRectangle(grid_x, (i + 1) * lineHeight + 1, w, lineHeight);
 		}
 
-		if (active_line != curDiag && curDiag->CollidesWith(active_line))
+		if (colliding.count(curDiag))
 			dc.SetTextForeground(text_collision);
 		else if (inSel)
 			dc.SetTextForeground(text_selection);
@@ -406,10 +492,11 @@ void BaseGrid::OnPaint(wxPaintEvent &) {
 		dc.DrawLine(w, 0, w, maxH);
 	}
 
-	if (active_line && active_line->Row >= yPos && active_line->Row < yPos + nDraw) {
-		dc.SetPen(wxPen(to_wx(OPT_GET("Colour/Subtitle Grid/Active Border")->GetColor())));
+	const int active_grid_row = active_line ? GetRow(active_line) : -1;
+	if (active_grid_row >= 0 && active_grid_row >= yPos && active_grid_row < yPos + nDraw) {
+		dc.SetPen(wxPen(to_wx(*active_border_colour)));
 		dc.SetBrush(*wxTRANSPARENT_BRUSH);
-		dc.DrawRectangle(0, (active_line->Row - yPos + 1) * lineHeight, w, lineHeight + 1);
+		dc.DrawRectangle(0, (active_grid_row - yPos + 1) * lineHeight, w, lineHeight + 1);
 	}
 }
 
@@ -621,10 +708,18 @@ AssDialogue *BaseGrid::GetDialogue(int n) const {
 bool BaseGrid::IsDisplayed(const AssDialogue *line) const {
 	if (!context->project->VideoProvider()) return false;
 	int frame = context->videoController->GetFrameN();
+	int index = row_frames->Index(line);
+	if (index >= 0)
+		return row_frames->start[index] <= frame && row_frames->end[index] >= frame;
 	return context->project->Timecodes().FrameAtTime(line->Start, agi::vfr::START) <= frame
 		&& context->project->Timecodes().FrameAtTime(line->End, agi::vfr::END) >= frame;
 }
 
+void BaseGrid::UpdateRowFrames(int first, int count) {
+	std::vector<AssDialogue *> lines(index_line_map.begin() + first, index_line_map.begin() + first + count);
+	row_frames->Update(lines, context->project->Timecodes());
+}
+
 void BaseGrid::OnCharHook(wxKeyEvent &event) {
 	if (hotkey::check("Subtitle Grid", context, event))
 		return;
@@ -679,7 +774,7 @@ void BaseGrid::OnKeyDown(wxKeyEvent &event) {
 
 	auto active_line = context->selectionController->GetActiveLine();
 	int old_extend = extendRow;
-	int next = mid(0, (active_line ? active_line->Row : 0) + dir * step, GetRows() - 1);
+	int next = mid(0, std::max(active_line ? GetRow(active_line) : 0, 0) + dir * step, GetRows() - 1);
 	context->selectionController->SetActiveLine(GetDialogue(next));
 
 	// Move selection
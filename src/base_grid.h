@@ -27,19 +27,21 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include "field_value_index.h"
+
+#include <libaegisub/option_value.h>
 #include <libaegisub/signal.h>
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <wx/window.h>
 
-namespace agi {
-	struct Context;
-	class OptionValue;
-}
+namespace agi { struct Context; }
 class AssDialogue;
 class GridColumn;
+struct GridRowFrames;
 class WidthHelper;
 
 class BaseGrid final : public wxWindow {
@@ -64,11 +66,22 @@ class BaseGrid final : public wxWindow {
 	/// Rows which are visible on the current video frame
 	std::vector<int> visible_rows;
 
+	/// Frame numbers of the rows on screen
+	std::unique_ptr<GridRowFrames> row_frames;
+
 	agi::Context *context; ///< Associated project context
 
 	std::vector<std::unique_ptr<GridColumn>> columns;
 	std::vector<bool> columns_visible;
 
+	/// Options read on every paint
+	agi::CachedOptionValue<agi::Color> standard_colour;
+	agi::CachedOptionValue<agi::Color> selection_colour;
+	agi::CachedOptionValue<agi::Color> collision_colour;
+	agi::CachedOptionValue<agi::Color> lines_colour;
+	agi::CachedOptionValue<agi::Color> active_border_colour;
+	agi::CachedOptionValue<bool> highlight_visible;
+
 	std::vector<wxRect> text_refresh_rects;
 
 	/// Cached brushes used for row backgrounds
@@ -83,6 +96,13 @@ class BaseGrid final : public wxWindow {
 	} row_colors;
 
 	std::vector<AssDialogue*> index_line_map;  ///< Row number -> dialogue line
+	/// Dialogue line -> row number, when filtered
+	std::unordered_map<const AssDialogue *, int> line_index_map;
+
+	/// Are only the lines matching a field value shown?
+	bool filtered = false;
+	FieldValueIndex::Field filter_field = FieldValueIndex::ACTOR;
+	std::string filter_value;
 
 	/// Connection for video seek event. Stored explicitly so that it can be
 	/// blocked if the relevant option is disabled
@@ -108,8 +128,12 @@ class BaseGrid final : public wxWindow {
 	void SetColumnWidths();
 
 	bool IsDisplayed(const AssDialogue *line) const;
+	/// Convert the times of rows [first, first + count) to frames
+	void UpdateRowFrames(int first, int count);
 
 	void UpdateMaps();
+	/// Get the row a line is shown on, or -1 if it's hidden by the filter
+	int GetRow(const AssDialogue *line) const;
 	void UpdateStyle();
 
 	void SelectRow(int row, bool addToSelected = false, bool select=true);
@@ -127,6 +151,15 @@ public:
 	~BaseGrid();
 
 	void SetByFrame(bool state);
+
+	/// @brief Show only the lines with the given value for a field
+	///
+	/// The filter is applied when it is set and when lines are added,
+	/// removed or reordered, so lines don't vanish while they're being edited
+	void SetFilter(FieldValueIndex::Field field, std::string const& value);
+	/// Show all lines again
+	void ClearFilter();
+	bool IsFiltered() const { return filtered; }
 	void ScrollTo(int y);
 
 	DECLARE_EVENT_TABLE()
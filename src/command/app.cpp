@@ -222,6 +222,8 @@ struct app_toggle_global_hotkeys final : public Command {
 	STR_DISP("Toggle global hotkey overrides")
 	STR_HELP("Toggle global hotkey overrides (Medusa Mode)")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Medusa Timing Hotkeys")
 
 	bool IsActive(const agi::Context *c) override {
 		return OPT_GET("Audio/Medusa Timing Hotkeys")->GetBool();
@@ -55,6 +55,7 @@ namespace {
 
 	struct validate_audio_open : public Command {
 		CMD_TYPE(COMMAND_VALIDATE)
+		CMD_DEPENDS(DEPENDS_AUDIO)
 		bool Validate(const agi::Context *c) override {
 			return !!c->project->AudioProvider();
 		}
@@ -118,6 +119,7 @@ struct audio_open_video final : public Command {
 	STR_DISP("Open Audio from Video")
 	STR_HELP("Open the audio from the current video file")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	bool Validate(const agi::Context *c) override {
 		return c->project->VideoProvider() && c->project->VideoProvider()->HasAudio();
@@ -134,6 +136,8 @@ struct audio_view_spectrum final : public Command {
 	STR_DISP("Spectrum Display")
 	STR_HELP("Display audio as a frequency-power spectrograph")
 	CMD_TYPE(COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Spectrum")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Spectrum")->GetBool();
@@ -150,6 +154,8 @@ struct audio_view_waveform final : public Command {
 	STR_DISP("Waveform Display")
 	STR_HELP("Display audio as a linear amplitude graph")
 	CMD_TYPE(COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Spectrum")
 
 	bool IsActive(const agi::Context *) override {
 		return !OPT_GET("Audio/Spectrum")->GetBool();
@@ -166,6 +172,7 @@ struct audio_save_clip final : public Command {
 	STR_DISP("Create audio clip")
 	STR_HELP("Save an audio clip of the selected line")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_AUDIO | DEPENDS_SELECTION)
 
 	bool Validate(const agi::Context *c) override {
 		return c->project->AudioProvider() && !c->selectionController->GetSelectedSet().empty();
@@ -251,6 +258,7 @@ struct audio_stop final : public Command {
 	STR_DISP("Stop playing")
 	STR_HELP("Stop audio and video playback")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_AUDIO | DEPENDS_PLAYBACK)
 
 	bool Validate(const agi::Context *c) override {
 		return c->audioController->IsPlaying();
@@ -437,6 +445,8 @@ struct audio_autoscroll final : public Command {
 	STR_DISP("Auto scroll audio display to selected line")
 	STR_HELP("Auto scroll audio display to selected line")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Auto/Scroll")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Auto/Scroll")->GetBool();
@@ -447,6 +457,46 @@ struct audio_autoscroll final : public Command {
 	}
 };
 
+	struct validate_audio_multichannel : public Command {
+		bool Validate(const agi::Context *c) override {
+			auto provider = c->project->AudioProvider();
+			return provider && provider->GetChannelSummary();
+		}
+	};
+
+struct audio_view_channels final : public validate_audio_multichannel {
+	CMD_NAME("audio/view/channels")
+	STR_MENU("Separate &Channels")
+	STR_DISP("Separate Channels")
+	STR_HELP("Display each channel of the audio separately")
+	CMD_TYPE(COMMAND_VALIDATE | COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_AUDIO | DEPENDS_OPTION)
+	CMD_OPTION("Audio/Display/Separate Channels")
+
+	bool IsActive(const agi::Context *) override {
+		return OPT_GET("Audio/Display/Separate Channels")->GetBool();
+	}
+
+	void operator()(agi::Context *) override {
+		toggle("Audio/Display/Separate Channels");
+	}
+};
+
+struct audio_channel_next final : public validate_audio_multichannel {
+	CMD_NAME("audio/channel/next")
+	STR_MENU("Play &Next Channel")
+	STR_DISP("Play Next Channel")
+	STR_HELP("Cycle playback through each channel of the audio and then all of them mixed together")
+	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_AUDIO)
+
+	void operator()(agi::Context *c) override {
+		int channels = c->project->AudioProvider()->GetChannelSummary()->GetChannels();
+		auto channel = OPT_GET("Audio/Channel")->GetInt();
+		OPT_SET("Audio/Channel")->SetInt(channel >= channels ? 0 : channel + 1);
+	}
+};
+
 struct audio_autocommit final : public Command {
 	CMD_NAME("audio/opt/autocommit")
 	CMD_ICON(toggle_audio_autocommit)
@@ -454,6 +504,8 @@ struct audio_autocommit final : public Command {
 	STR_DISP("Automatically commit all changes")
 	STR_HELP("Automatically commit all changes")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Auto/Commit")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Auto/Commit")->GetBool();
@@ -471,6 +523,8 @@ struct audio_autonext final : public Command {
 	STR_DISP("Auto go to next line on commit")
 	STR_HELP("Automatically go to next line on commit")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Next Line on Commit")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Next Line on Commit")->GetBool();
@@ -488,6 +542,8 @@ struct audio_toggle_spectrum final : public Command {
 	STR_DISP("Spectrum analyzer mode")
 	STR_HELP("Spectrum analyzer mode")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Spectrum")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Spectrum")->GetBool();
@@ -505,6 +561,8 @@ struct audio_vertical_link final : public Command {
 	STR_DISP("Link vertical zoom and volume sliders")
 	STR_HELP("Link vertical zoom and volume sliders")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Audio/Link")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Audio/Link")->GetBool();
@@ -538,6 +596,7 @@ namespace cmd {
 		reg(agi::make_unique<audio_autocommit>());
 		reg(agi::make_unique<audio_autonext>());
 		reg(agi::make_unique<audio_autoscroll>());
+		reg(agi::make_unique<audio_channel_next>());
 		reg(agi::make_unique<audio_close>());
 		reg(agi::make_unique<audio_commit>());
 		reg(agi::make_unique<audio_commit_default>());
@@ -564,6 +623,7 @@ namespace cmd {
 		reg(agi::make_unique<audio_stop>());
 		reg(agi::make_unique<audio_toggle_spectrum>());
 		reg(agi::make_unique<audio_vertical_link>());
+		reg(agi::make_unique<audio_view_channels>());
 		reg(agi::make_unique<audio_view_spectrum>());
 		reg(agi::make_unique<audio_view_waveform>());
 	}
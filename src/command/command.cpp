@@ -14,8 +14,14 @@
 
 #include "command.h"
 
+#include "../ass_file.h"
+#include "../audio_controller.h"
 #include "../compat.h"
 #include "../format.h"
+#include "../include/aegisub/context.h"
+#include "../project.h"
+#include "../selection_controller.h"
+#include "../subs_controller.h"
 
 #include <libaegisub/log.h>
 
@@ -25,6 +31,9 @@ namespace cmd {
 	static std::map<std::string, std::unique_ptr<Command>> cmd_map;
 	typedef std::map<std::string, std::unique_ptr<Command>>::iterator iterator;
 
+	/// Announced after any command is run via call()
+	static agi::signal::Signal<> command_run;
+
 	static iterator find_command(std::string const& name) {
 		auto it = cmd_map.find(name);
 		if (it == cmd_map.end())
@@ -46,8 +55,40 @@ namespace cmd {
 
 	void call(std::string const& name, agi::Context*c) {
 		Command &cmd = *find_command(name)->second;
-		if (cmd.Validate(c))
+		if (cmd.Validate(c)) {
 			cmd(c);
+			command_run();
+		}
+	}
+
+	std::vector<agi::signal::Connection> listen(const agi::Context *c, int dependencies, std::function<void (int)> on_change) {
+		std::vector<agi::signal::Connection> connections;
+		auto notify = [=](int dependency) { return [=] { on_change(dependency); }; };
+
+		if (dependencies & DEPENDS_SELECTION)
+			connections.push_back(c->selectionController->AddSelectionListener(notify(DEPENDS_SELECTION)));
+		if (dependencies & DEPENDS_ACTIVE_LINE)
+			connections.push_back(c->selectionController->AddActiveLineListener([=](AssDialogue *) { on_change(DEPENDS_ACTIVE_LINE); }));
+		if (dependencies & DEPENDS_SUBTITLES) {
+			connections.push_back(c->ass->AddCommitListener([=](int, const AssDialogue *) { on_change(DEPENDS_SUBTITLES); }));
+			connections.push_back(c->subsController->AddFileOpenListener([=](agi::fs::path const&) { on_change(DEPENDS_SUBTITLES); }));
+			connections.push_back(c->subsController->AddFileSaveListener(notify(DEPENDS_SUBTITLES)));
+		}
+		if (dependencies & DEPENDS_VIDEO) {
+			connections.push_back(c->project->AddVideoProviderListener([=](AsyncVideoProvider *) { on_change(DEPENDS_VIDEO); }));
+			connections.push_back(c->project->AddTimecodesListener([=](agi::vfr::Framerate const&) { on_change(DEPENDS_VIDEO); }));
+			connections.push_back(c->project->AddKeyframesListener([=](std::vector<int> const&) { on_change(DEPENDS_VIDEO); }));
+		}
+		if (dependencies & DEPENDS_AUDIO)
+			connections.push_back(c->project->AddAudioProviderListener([=](agi::AudioProvider *) { on_change(DEPENDS_AUDIO); }));
+		if (dependencies & DEPENDS_PLAYBACK) {
+			connections.push_back(c->audioController->AddPlaybackStartListener(notify(DEPENDS_PLAYBACK)));
+			connections.push_back(c->audioController->AddPlaybackStopListener(notify(DEPENDS_PLAYBACK)));
+		}
+		if (dependencies & DEPENDS_COMMAND)
+			connections.push_back(command_run.Connect(notify(DEPENDS_COMMAND)));
+
+		return connections;
 	}
 
 	std::vector<std::string> get_registered_commands() {
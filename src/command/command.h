@@ -16,6 +16,7 @@
 /// @brief Command base class and main header.
 /// @ingroup command
 
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -25,6 +26,7 @@
 #include <wx/string.h>
 
 #include <libaegisub/exception.h>
+#include <libaegisub/signal.h>
 
 namespace agi { struct Context; }
 
@@ -33,6 +35,8 @@ namespace agi { struct Context; }
 #define STR_DISP(a) wxString StrDisplay(const agi::Context *) const override { return _(a); }
 #define STR_HELP(a) wxString StrHelp() const override { return _(a); }
 #define CMD_TYPE(a) int Type() const override { using namespace cmd; return a; }
+#define CMD_DEPENDS(a) int Dependencies() const override { using namespace cmd; return a; }
+#define CMD_OPTION(a) const char *Option() const override { return a; }
 
 #define CMD_ICON(icon) wxBitmap Icon(int size, wxLayoutDirection dir = wxLayout_LeftToRight) const override { \
 	if (size == 64) return GETIMAGEDIR(icon##_64, dir); \
@@ -88,6 +92,44 @@ DEFINE_EXCEPTION(CommandNotFound, CommandError);
 		COMMAND_DYNAMIC_ICON = 32
 	};
 
+	/// Things which a command's Validate, IsActive and dynamic name/help can
+	/// depend on, so that toolbars and menus only have to recheck a command
+	/// when one of them has changed
+	enum CommandDependency {
+		/// The set of selected lines
+		DEPENDS_SELECTION   = 1,
+
+		/// The active line
+		DEPENDS_ACTIVE_LINE = 2,
+
+		/// The contents of the subtitles file or the undo stack: any commit,
+		/// undo, redo, open or save
+		DEPENDS_SUBTITLES   = 4,
+
+		/// The open video, timecodes or keyframes
+		DEPENDS_VIDEO       = 8,
+
+		/// The open audio
+		DEPENDS_AUDIO       = 16,
+
+		/// Whether audio is playing
+		DEPENDS_PLAYBACK    = 32,
+
+		/// Something which is only changed by running a command, such as
+		/// the current visual tool
+		DEPENDS_COMMAND     = 64,
+
+		/// The option named by Option()
+		DEPENDS_OPTION      = 128,
+
+		/// State not covered by any of the above, such as whether a dialog is
+		/// open. Commands with this are rechecked whenever they are displayed.
+		DEPENDS_UNKNOWN     = 1 << 30,
+
+		/// Everything which can be listened for
+		DEPENDS_ALL         = DEPENDS_OPTION * 2 - 1
+	};
+
 	/// Holds an individual Command
 	class Command {
 	public:
@@ -105,6 +147,18 @@ DEFINE_EXCEPTION(CommandNotFound, CommandError);
 		/// @return Bitmask of CommandFlags
 		virtual int Type() const { return COMMAND_NORMAL; }
 
+		/// Get what this command's dynamic state depends on
+		/// @return Bitmask of CommandDependency
+		///
+		/// This is only meaningful for commands with a type other than
+		/// COMMAND_NORMAL, and should be overridden along with Validate and
+		/// IsActive so that the command is not rechecked needlessly
+		virtual int Dependencies() const { return DEPENDS_UNKNOWN; }
+
+		/// Name of the option this command's state depends on, if
+		/// Dependencies() includes DEPENDS_OPTION
+		virtual const char *Option() const { return nullptr; }
+
 		/// Request icon.
 		/// @param size Icon size.
 		virtual wxBitmap Icon(int size, wxLayoutDirection = wxLayout_LeftToRight) const { return wxBitmap{}; }
@@ -155,6 +209,16 @@ DEFINE_EXCEPTION(CommandNotFound, CommandError);
 	/// @param c  Current Context.
 	void call(std::string const& name, agi::Context *c);
 
+	/// Listen for changes to the things a command can depend on
+	/// @param c Project context
+	/// @param dependencies Bitmask of CommandDependency to listen for
+	/// @param on_change Called with the DEPENDS_* flag of each change
+	/// @return Connections which stop listening when destroyed
+	///
+	/// DEPENDS_OPTION is not handled here, as each command depends on a
+	/// different option.
+	std::vector<agi::signal::Connection> listen(const agi::Context *c, int dependencies, std::function<void (int)> on_change);
+
 	/// Retrieve a Command object.
 	/// @param Command object.
 	Command* get(std::string const& name);
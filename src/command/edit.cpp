@@ -75,6 +75,7 @@ namespace {
 
 struct validate_sel_nonempty : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() > 0;
 	}
@@ -82,6 +83,7 @@ struct validate_sel_nonempty : public Command {
 
 struct validate_video_and_sel_nonempty : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SELECTION)
 	bool Validate(const agi::Context *c) override {
 		return c->project->VideoProvider() && !c->selectionController->GetSelectedSet().empty();
 	}
@@ -89,6 +91,7 @@ struct validate_video_and_sel_nonempty : public Command {
 
 struct validate_sel_multiple : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() > 1;
 	}
@@ -1157,6 +1160,7 @@ struct edit_redo final : public Command {
 	CMD_ICON(redo_button)
 	STR_HELP("Redo last undone action")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_DYNAMIC_NAME)
+	CMD_DEPENDS(DEPENDS_SUBTITLES)
 
 	wxString StrMenu(const agi::Context *c) const override {
 		return c->subsController->IsRedoStackEmpty() ?
@@ -1183,6 +1187,7 @@ struct edit_undo final : public Command {
 	CMD_ICON(undo_button)
 	STR_HELP("Undo last action")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_DYNAMIC_NAME)
+	CMD_DEPENDS(DEPENDS_SUBTITLES)
 
 	wxString StrMenu(const agi::Context *c) const override {
 		return c->subsController->IsUndoStackEmpty() ?
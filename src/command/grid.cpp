@@ -35,6 +35,9 @@
 #include "../ass_file.h"
 #include "../audio_controller.h"
 #include "../audio_timing.h"
+#include "../base_grid.h"
+#include "../field_value_index.h"
+#include "../format.h"
 #include "../frame_main.h"
 #include "../include/aegisub/context.h"
 #include "../libresrc/libresrc.h"
@@ -43,6 +46,8 @@
 
 #include <libaegisub/make_unique.h>
 
+#include <wx/choicdlg.h>
+
 namespace {
 	using cmd::Command;
 
@@ -110,6 +115,7 @@ struct grid_sort_actor final : public Command {
 
 struct validate_sel_multiple : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() > 1;
@@ -279,6 +285,8 @@ struct grid_tags_hide final : public Command {
 	STR_DISP("Hide Tags")
 	STR_HELP("Hide override tags in the subtitle grid")
 	CMD_TYPE(COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Subtitle/Grid/Hide Overrides")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Subtitle/Grid/Hide Overrides")->GetInt() == 2;
@@ -295,6 +303,8 @@ struct grid_tags_show final : public Command {
 	STR_DISP("Show Tags")
 	STR_HELP("Show full override tags in the subtitle grid")
 	CMD_TYPE(COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Subtitle/Grid/Hide Overrides")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Subtitle/Grid/Hide Overrides")->GetInt() == 0;
@@ -311,6 +321,8 @@ struct grid_tags_simplify final : public Command {
 	STR_DISP("Simplify Tags")
 	STR_HELP("Replace override tags in the subtitle grid with a simplified placeholder")
 	CMD_TYPE(COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Subtitle/Grid/Hide Overrides")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Subtitle/Grid/Hide Overrides")->GetInt() == 1;
@@ -349,6 +361,7 @@ struct grid_move_up final : public Command {
 	STR_DISP("Move line up")
 	STR_HELP("Move the selected lines up one row")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() != 0;
@@ -366,6 +379,7 @@ struct grid_move_down final : public Command {
 	STR_DISP("Move line down")
 	STR_HELP("Move the selected lines down one row")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() != 0;
@@ -377,6 +391,72 @@ struct grid_move_down final : public Command {
 	}
 };
 
+void filter_by(agi::Context *c, FieldValueIndex::Field field, wxString const& message) {
+	auto const& counts = c->fieldValues->GetCounts(field);
+	if (counts.empty()) {
+		c->frame->StatusTimeout(_("No lines have a value to filter by"));
+		return;
+	}
+
+	auto active_line = c->selectionController->GetActiveLine();
+	std::string const& active_value = active_line ? FieldValueIndex::Get(active_line, field).get() : std::string();
+
+	std::vector<std::string> values;
+	wxArrayString choices;
+	int initial = 0;
+	values.reserve(counts.size());
+	choices.reserve(counts.size());
+	for (auto const& value : counts) {
+		if (value.first == active_value)
+			initial = (int)values.size();
+		values.push_back(value.first);
+		choices.push_back(fmt_wx("%s (%d)", value.first, value.second));
+	}
+
+	int choice = wxGetSingleChoiceIndex(message, _("Filter Lines"), choices, initial, c->parent);
+	if (choice >= 0)
+		c->subsGrid->SetFilter(field, values[choice]);
+}
+
+struct grid_filter_actor final : public Command {
+	CMD_NAME("grid/filter/actor")
+	STR_MENU("By &Actor...")
+	STR_DISP("Filter by Actor")
+	STR_HELP("Show only the lines with a chosen actor in the grid")
+
+	void operator()(agi::Context *c) override {
+		filter_by(c, FieldValueIndex::ACTOR, _("Show only the lines with the actor:"));
+	}
+};
+
+struct grid_filter_effect final : public Command {
+	CMD_NAME("grid/filter/effect")
+	STR_MENU("By &Effect...")
+	STR_DISP("Filter by Effect")
+	STR_HELP("Show only the lines with a chosen effect in the grid")
+
+	void operator()(agi::Context *c) override {
+		filter_by(c, FieldValueIndex::EFFECT, _("Show only the lines with the effect:"));
+	}
+};
+
+struct grid_filter_clear final : public Command {
+	CMD_NAME("grid/filter/clear")
+	STR_MENU("&Show All Lines")
+	STR_DISP("Show All Lines")
+	STR_HELP("Remove the grid filter and show all lines")
+	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_COMMAND | DEPENDS_SUBTITLES)
+
+	bool Validate(const agi::Context *c) override {
+		return c->subsGrid && c->subsGrid->IsFiltered();
+	}
+
+	void operator()(agi::Context *c) override {
+		c->subsGrid->ClearFilter();
+	}
+};
+
 struct grid_swap final : public Command {
 	CMD_NAME("grid/swap")
 	CMD_ICON(arrow_sort)
@@ -384,6 +464,7 @@ struct grid_swap final : public Command {
 	STR_DISP("Swap Lines")
 	STR_HELP("Swap the two selected lines")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 
 	bool Validate(const agi::Context *c) override {
 		return c->selectionController->GetSelectedSet().size() == 2;
@@ -402,6 +483,9 @@ struct grid_swap final : public Command {
 
 namespace cmd {
 	void init_grid() {
+		reg(agi::make_unique<grid_filter_actor>());
+		reg(agi::make_unique<grid_filter_clear>());
+		reg(agi::make_unique<grid_filter_effect>());
 		reg(agi::make_unique<grid_line_next>());
 		reg(agi::make_unique<grid_line_next_create>());
 		reg(agi::make_unique<grid_line_prev>());
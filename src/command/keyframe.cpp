@@ -51,6 +51,7 @@ struct keyframe_close final : public Command {
 	STR_DISP("Close Keyframes")
 	STR_HELP("Discard the currently loaded keyframes and use those from the video, if any")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	bool Validate(const agi::Context *c) override {
 		return c->project->CanCloseKeyframes();
@@ -89,6 +90,7 @@ struct keyframe_save final : public Command {
 	STR_DISP("Save Keyframes")
 	STR_HELP("Save the current list of keyframes to a file")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	bool Validate(const agi::Context *c) override {
 		return !c->project->Keyframes().empty();
@@ -36,11 +36,13 @@
 #include "../compat.h"
 #include "../dialog_search_replace.h"
 #include "../dialogs.h"
+#include "../format.h"
 #include "../frame_main.h"
 #include "../include/aegisub/context.h"
 #include "../libresrc/libresrc.h"
 #include "../main.h"
 #include "../options.h"
+#include "../overlap_index.h"
 #include "../project.h"
 #include "../search_replace_engine.h"
 #include "../selection_controller.h"
@@ -62,6 +64,7 @@ namespace {
 
 struct validate_nonempty_selection : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION)
 	bool Validate(const agi::Context *c) override {
 		return !c->selectionController->GetSelectedSet().empty();
 	}
@@ -69,6 +72,7 @@ struct validate_nonempty_selection : public Command {
 
 struct validate_nonempty_selection_video_loaded : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SELECTION)
 	bool Validate(const agi::Context *c) override {
 		return c->project->VideoProvider() && !c->selectionController->GetSelectedSet().empty();
 	}
@@ -87,6 +91,18 @@ struct subtitle_attachment final : public Command {
 	}
 };
 
+struct subtitle_compare final : public Command {
+	CMD_NAME("subtitle/compare")
+	STR_MENU("Co&mpare With File...")
+	STR_DISP("Compare With File")
+	STR_HELP("Show the lines and styles which differ between the current subtitles and another file")
+
+	void operator()(agi::Context *c) override {
+		c->videoController->Stop();
+		ShowCompareDialog(c);
+	}
+};
+
 struct subtitle_find final : public Command {
 	CMD_NAME("subtitle/find")
 	CMD_ICON(find_button)
@@ -233,6 +249,18 @@ void load_subtitles(agi::Context *c, agi::fs::path const& path, std::string cons
 #endif
 }
 
+struct subtitle_merge final : public Command {
+	CMD_NAME("subtitle/merge")
+	STR_MENU("Mer&ge Changes...")
+	STR_DISP("Merge Changes")
+	STR_HELP("Merge the changes made in another version of the subtitles since a common original into the current subtitles")
+
+	void operator()(agi::Context *c) override {
+		c->videoController->Stop();
+		ShowMergeDialog(c);
+	}
+};
+
 struct subtitle_new final : public Command {
 	CMD_NAME("subtitle/new")
 	CMD_ICON(new_toolbutton)
@@ -318,6 +346,7 @@ struct subtitle_open_video final : public Command {
 	STR_DISP("Open Subtitles from Video")
 	STR_HELP("Open the subtitles from the current video file")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	void operator()(agi::Context *c) override {
 		if (c->subsController->TryToClose() == wxCANCEL) return;
@@ -369,6 +398,7 @@ struct subtitle_save final : public Command {
 	STR_DISP("Save Subtitles")
 	STR_HELP("Save the current subtitles")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SUBTITLES)
 
 	void operator()(agi::Context *c) override {
 		save_subtitles(c, c->subsController->CanSave() ? c->subsController->Filename() : "");
@@ -404,6 +434,42 @@ struct subtitle_select_all final : public Command {
 	}
 };
 
+struct subtitle_select_overlaps final : public Command {
+	CMD_NAME("subtitle/select/overlaps")
+	STR_MENU("Select &Overlapping Lines")
+	STR_DISP("Select Overlapping Lines")
+	STR_HELP("Select all lines which overlap another line with the same style and layer")
+
+	void operator()(agi::Context *c) override {
+		Selection sel;
+		size_t count = 0;
+		for (auto const& pair : c->overlaps->GetAllOverlaps()) {
+			// Commented lines aren't displayed, so can't overlap anything
+			if (pair.first->Comment || pair.second->Comment) continue;
+			sel.insert(pair.first);
+			sel.insert(pair.second);
+			++count;
+		}
+
+		if (!count) {
+			c->frame->StatusTimeout(_("No overlapping lines found"));
+			return;
+		}
+
+		// Make the first of the lines in the file active
+		AssDialogue *active = nullptr;
+		for (auto& line : c->ass->Events) {
+			if (sel.count(&line)) {
+				active = &line;
+				break;
+			}
+		}
+
+		c->frame->StatusTimeout(fmt_plural(count, "Found %d overlapping pair", "Found %d overlapping pairs", count));
+		c->selectionController->SetSelectionAndActive(std::move(sel), active);
+	}
+};
+
 struct subtitle_select_visible final : public Command {
 	CMD_NAME("subtitle/select/visible")
 	CMD_ICON(select_visible_button)
@@ -411,6 +477,7 @@ struct subtitle_select_visible final : public Command {
 	STR_DISP("Select Visible")
 	STR_HELP("Select all dialogue lines that are visible on the current video frame")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	void operator()(agi::Context *c) override {
 		c->videoController->Stop();
@@ -453,12 +520,14 @@ struct subtitle_spellcheck final : public Command {
 namespace cmd {
 	void init_subtitle() {
 		reg(agi::make_unique<subtitle_attachment>());
+		reg(agi::make_unique<subtitle_compare>());
 		reg(agi::make_unique<subtitle_find>());
 		reg(agi::make_unique<subtitle_find_next>());
 		reg(agi::make_unique<subtitle_insert_after>());
 		reg(agi::make_unique<subtitle_insert_after_videotime>());
 		reg(agi::make_unique<subtitle_insert_before>());
 		reg(agi::make_unique<subtitle_insert_before_videotime>());
+		reg(agi::make_unique<subtitle_merge>());
 		reg(agi::make_unique<subtitle_new>());
 		reg(agi::make_unique<subtitle_close>());
 		reg(agi::make_unique<subtitle_open>());
@@ -469,6 +538,7 @@ namespace cmd {
 		reg(agi::make_unique<subtitle_save>());
 		reg(agi::make_unique<subtitle_save_as>());
 		reg(agi::make_unique<subtitle_select_all>());
+		reg(agi::make_unique<subtitle_select_overlaps>());
 		reg(agi::make_unique<subtitle_select_visible>());
 		reg(agi::make_unique<subtitle_spellcheck>());
 	}
@@ -52,6 +52,7 @@ using cmd::Command;
 
 struct validate_video_loaded : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 	bool Validate(const agi::Context *c) override {
 		return !!c->project->VideoProvider();
 	}
@@ -59,6 +60,7 @@ struct validate_video_loaded : public Command {
 
 struct validate_adjoinable : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_SELECTION | DEPENDS_SUBTITLES)
 	bool Validate(const agi::Context *c) override {
 		size_t sel_size = c->selectionController->GetSelectedSet().size();
 		if (sel_size == 0) return false;
@@ -53,6 +53,7 @@ struct timecode_close final : public Command {
 	STR_DISP("Close Timecodes File")
 	STR_HELP("Close the currently open timecodes file")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	bool Validate(const agi::Context *c) override {
 		return c->project->CanCloseTimecodes();
@@ -85,6 +86,7 @@ struct timecode_save final : public Command {
 	STR_DISP("Save Timecodes File")
 	STR_HELP("Save a VFR timecodes v2 file")
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 
 	bool Validate(const agi::Context *c) override {
 		return c->project->Timecodes().IsLoaded();
@@ -67,6 +67,7 @@ namespace {
 
 struct validator_video_loaded : public Command {
 	CMD_TYPE(COMMAND_VALIDATE)
+	CMD_DEPENDS(DEPENDS_VIDEO)
 	bool Validate(const agi::Context *c) override {
 		return !!c->project->VideoProvider();
 	}
@@ -85,6 +86,7 @@ struct video_aspect_cinematic final : public validator_video_loaded {
 	STR_DISP("Cinematic (2.35)")
 	STR_HELP("Force video to 2.35 aspect ratio")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SUBTITLES | DEPENDS_COMMAND)
 
 	bool IsActive(const agi::Context *c) override {
 		return c->videoController->GetAspectRatioType() == AspectRatio::Cinematic;
@@ -103,6 +105,7 @@ struct video_aspect_custom final : public validator_video_loaded {
 	STR_DISP("Custom")
 	STR_HELP("Force video to a custom aspect ratio")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SUBTITLES | DEPENDS_COMMAND)
 
 	bool IsActive(const agi::Context *c) override {
 		return c->videoController->GetAspectRatioType() == AspectRatio::Custom;
@@ -146,6 +149,7 @@ struct video_aspect_default final : public validator_video_loaded {
 	STR_DISP("Default")
 	STR_HELP("Use video's original aspect ratio")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SUBTITLES | DEPENDS_COMMAND)
 
 	bool IsActive(const agi::Context *c) override {
 		return c->videoController->GetAspectRatioType() == AspectRatio::Default;
@@ -164,6 +168,7 @@ struct video_aspect_full final : public validator_video_loaded {
 	STR_DISP("Fullscreen (4:3)")
 	STR_HELP("Force video to 4:3 aspect ratio")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SUBTITLES | DEPENDS_COMMAND)
 
 	bool IsActive(const agi::Context *c) override {
 		return c->videoController->GetAspectRatioType() == AspectRatio::Fullscreen;
@@ -182,6 +187,7 @@ struct video_aspect_wide final : public validator_video_loaded {
 	STR_DISP("Widescreen (16:9)")
 	STR_HELP("Force video to 16:9 aspect ratio")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_SUBTITLES | DEPENDS_COMMAND)
 
 	bool IsActive(const agi::Context *c) override {
 		return c->videoController->GetAspectRatioType() == AspectRatio::Widescreen;
@@ -243,6 +249,7 @@ struct video_detach final : public validator_video_loaded {
 	STR_DISP("Detach Video")
 	STR_HELP("Detach the video display from the main window, displaying it in a separate Window")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_UNKNOWN)
 
 	bool IsActive(const agi::Context *c) override {
 		return !!c->dialog->Get<DialogDetachedVideo>();
@@ -593,6 +600,8 @@ struct video_opt_autoscroll final : public Command {
 	STR_DISP("Toggle autoscroll of video")
 	STR_HELP("Toggle automatically seeking video to the start time of selected lines")
 	CMD_TYPE(COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_OPTION)
+	CMD_OPTION("Video/Subtitle Sync")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Video/Subtitle Sync")->GetBool();
@@ -633,6 +642,8 @@ struct video_show_overscan final : public validator_video_loaded {
 	STR_DISP("Show Overscan Mask")
 	STR_HELP("Show a mask over the video, indicating areas that might get cropped off by overscan on televisions")
 	CMD_TYPE(COMMAND_VALIDATE | COMMAND_TOGGLE)
+	CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_OPTION)
+	CMD_OPTION("Video/Overscan Mask")
 
 	bool IsActive(const agi::Context *) override {
 		return OPT_GET("Video/Overscan Mask")->GetBool();
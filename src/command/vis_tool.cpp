@@ -36,6 +36,7 @@ namespace {
 	template<class T>
 	struct visual_tool_command : public Command {
 		CMD_TYPE(COMMAND_VALIDATE | COMMAND_RADIO)
+		CMD_DEPENDS(DEPENDS_VIDEO | DEPENDS_COMMAND)
 
 		bool Validate(const agi::Context *c) override {
 			return !!c->project->VideoProvider();
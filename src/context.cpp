@@ -20,18 +20,27 @@
 #include "audio_controller.h"
 #include "auto4_base.h"
 #include "dialog_manager.h"
+#include "field_value_index.h"
 #include "initial_line_state.h"
 #include "options.h"
+#include "overlap_index.h"
 #include "project.h"
 #include "search_replace_engine.h"
 #include "selection_controller.h"
 #include "subs_controller.h"
 #include "text_selection_controller.h"
 #include "video_controller.h"
+#include "video_thumbnails.h"
 
 #include <libaegisub/make_unique.h>
 #include <libaegisub/path.h>
 
+#include <atomic>
+
+namespace {
+std::atomic<uint64_t> next_serial{0};
+}
+
 namespace agi {
 Context::Context()
 : ass(make_unique<AssFile>())
@@ -44,8 +53,12 @@ Context::Context()
 , audioController(make_unique<AudioController>(this))
 , initialLineState(make_unique<InitialLineState>(this))
 , search(make_unique<SearchReplaceEngine>(this))
+, overlaps(make_unique<OverlapIndex>(this))
+, fieldValues(make_unique<FieldValueIndex>(this))
+, thumbnails(make_unique<VideoThumbnails>(this))
 , path(make_unique<Path>(*config::path))
 , dialog(make_unique<DialogManager>())
+, serial(++next_serial)
 {
 	subsController->SetSelectionController(selectionController.get());
 }
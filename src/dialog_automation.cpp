@@ -300,6 +300,14 @@ void DialogAutomation::OnInfo(wxCommandEvent &)
 		boost::transform(ei->script->GetFilters(), append_info, [](const Automation4::ExportFilter* f) {
 			return fmt_tl("    Export filter: %s", f->GetName());
 		});
+
+		auto slow = ei->script->GetSlowValidators();
+		if (!slow.empty()) {
+			info.push_back(_("\nMacros with slow validation functions:"));
+			boost::transform(slow, append_info, [](std::string const& desc) {
+				return to_wx("    " + desc);
+			});
+		}
 	}
 
 	wxMessageBox(wxJoin(info, '\n', 0), _("Automation Script Info"));
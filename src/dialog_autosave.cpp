@@ -18,7 +18,10 @@
 #include "format.h"
 #include "libresrc/libresrc.h"
 #include "options.h"
+#include "subs_journal.h"
 
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
 #include <libaegisub/path.h>
 
 #include <boost/range/adaptor/map.hpp>
@@ -30,6 +33,7 @@
 #include <wx/dir.h>
 #include <wx/filename.h>
 #include <wx/listbox.h>
+#include <wx/msgdlg.h>
 #include <wx/sizer.h>
 #include <wx/string.h>
 
@@ -91,6 +95,7 @@ DialogAutosave::DialogAutosave(wxWindow *parent)
 
 	std::map<wxString, AutosaveFile> files_map;
 	Populate(files_map, OPT_GET("Path/Auto/Save")->GetString(), ".AUTOSAVE.ass", "%s");
+	Populate(files_map, OPT_GET("Path/Auto/Save")->GetString(), ".JOURNAL", _("%s [JOURNAL]"));
 	Populate(files_map, OPT_GET("Path/Auto/Backup")->GetString(), ".ORIGINAL.ass", _("%s [ORIGINAL BACKUP]"));
 	Populate(files_map, "?user/recovered", ".ass", _("%s [RECOVERED]"));
 
@@ -171,7 +176,19 @@ std::string DialogAutosave::ChosenFile() const {
 
 std::string PickAutosaveFile(wxWindow *parent) {
 	DialogAutosave dialog(parent);
-	if (dialog.ShowModal() == wxID_OK)
-		return dialog.ChosenFile();
-	return "";
+	if (dialog.ShowModal() != wxID_OK)
+		return "";
+
+	auto filename = dialog.ChosenFile();
+	if (!agi::fs::HasExtension(filename, "journal"))
+		return filename;
+
+	// Journals have to be replayed into a normal file before they can be opened
+	try {
+		return SubsJournal::Recover(filename).string();
+	}
+	catch (agi::Exception const& e) {
+		wxMessageBox(to_wx(e.GetMessage()), _("Error"), wxOK | wxICON_ERROR | wxCENTER, parent);
+		return "";
+	}
 }
@@ -37,6 +37,7 @@
 #include "utils.h"
 
 #include <libaegisub/charset_conv.h>
+#include <libaegisub/fs.h>
 #include <libaegisub/split.h>
 
 #include <algorithm>
@@ -67,6 +68,9 @@ class DialogExport {
 	/// A list of available target charsets
 	wxChoice *charset_list;
 
+	/// Other formats to write alongside the chosen file in the same pass
+	wxCheckListBox *extra_formats;
+
 	wxSizer *opt_sizer;
 
 	void OnProcess(wxCommandEvent &);
@@ -146,11 +150,20 @@ DialogExport::DialogExport(agi::Context *c)
 	if (!charset_list->SetStringSelection(to_wx(c->ass->Properties.export_encoding)))
 		charset_list->SetStringSelection("Unicode (UTF-8)");
 
+	// Additional formats, each written next to the chosen file
+	wxStaticText *extra_formats_label = new wxStaticText(&d, -1, _("Also export as:"));
+	wxArrayString extensions;
+	for (auto const& ext : SubtitleFormat::GetWriteExtensions())
+		extensions.push_back(to_wx("*." + ext));
+	extra_formats = new wxCheckListBox(&d, -1, wxDefaultPosition, wxSize(200, 80), extensions);
+
 	wxSizer *top_sizer = new wxStaticBoxSizer(wxVERTICAL, &d, _("Filters"));
 	top_sizer->Add(filter_list, wxSizerFlags(1).Expand());
 	top_sizer->Add(top_buttons, wxSizerFlags(0).Expand());
 	top_sizer->Add(filter_description, wxSizerFlags(0).Expand().Border(wxTOP));
 	top_sizer->Add(charset_list_sizer, wxSizerFlags(0).Expand().Border(wxTOP));
+	top_sizer->Add(extra_formats_label, wxSizerFlags(0).Border(wxTOP));
+	top_sizer->Add(extra_formats, wxSizerFlags(0).Expand());
 
 	auto btn_sizer = d.CreateStdDialogButtonSizer(wxOK | wxCANCEL | wxHELP);
 	btn_sizer->GetAffirmativeButton()->SetLabelText(_("Export..."));
@@ -193,10 +206,29 @@ void DialogExport::OnProcess(wxCommandEvent &) {
 			exporter.AddFilter(from_wx(filter_list->GetString(i)));
 	}
 
+	// Write each additional format next to the chosen file, replacing the
+	// chosen format's extension with the other format's
+	std::vector<agi::fs::path> filenames{filename};
+	auto const& extensions = SubtitleFormat::GetWriteExtensions();
+	std::string stem = filename.string();
+	size_t ext_len = 0;
+	for (auto const& ext : extensions) {
+		if (agi::fs::HasExtension(filename, ext))
+			ext_len = std::max(ext_len, ext.size() + 1);
+	}
+	if (ext_len)
+		stem.erase(stem.size() - ext_len);
+	for (size_t i = 0; i < extra_formats->GetCount(); ++i) {
+		if (!extra_formats->IsChecked(i)) continue;
+		agi::fs::path extra = stem + "." + extensions[i];
+		if (find(begin(filenames), end(filenames), extra) == end(filenames))
+			filenames.push_back(extra);
+	}
+
 	try {
 		wxBusyCursor busy;
 		c->ass->Properties.export_encoding = from_wx(charset_list->GetStringSelection());
-		exporter.Export(filename, from_wx(charset_list->GetStringSelection()), &d);
+		exporter.Export(filenames, from_wx(charset_list->GetStringSelection()), &d);
 	}
 	catch (agi::UserCancelException const&) { }
 	catch (agi::Exception const& err) {
@@ -215,19 +215,22 @@ agi::vfr::Framerate EbuExportSettings::GetFramerate() const {
 	}
 }
 
-std::unique_ptr<agi::charset::IconvWrapper> EbuExportSettings::GetTextEncoder() const {
-	using namespace agi;
+const char *EbuExportSettings::GetTextEncodingName() const {
 	switch (text_encoding) {
-		case iso6937_2: return make_unique<charset::IconvWrapper>("utf-8", "ISO-6937-2");
-		case iso8859_5: return make_unique<charset::IconvWrapper>("utf-8", "ISO-8859-5");
-		case iso8859_6: return make_unique<charset::IconvWrapper>("utf-8", "ISO-8859-6");
-		case iso8859_7: return make_unique<charset::IconvWrapper>("utf-8", "ISO-8859-7");
-		case iso8859_8: return make_unique<charset::IconvWrapper>("utf-8", "ISO-8859-8");
-		case utf8:      return make_unique<charset::IconvWrapper>("utf-8", "utf-8");
-		default:        return make_unique<charset::IconvWrapper>("utf-8", "ISO-8859-1");
+		case iso6937_2: return "ISO-6937-2";
+		case iso8859_5: return "ISO-8859-5";
+		case iso8859_6: return "ISO-8859-6";
+		case iso8859_7: return "ISO-8859-7";
+		case iso8859_8: return "ISO-8859-8";
+		case utf8:      return "utf-8";
+		default:        return "ISO-8859-1";
 	}
 }
 
+std::unique_ptr<agi::charset::IconvWrapper> EbuExportSettings::GetTextEncoder() const {
+	return agi::make_unique<agi::charset::IconvWrapper>("utf-8", GetTextEncodingName());
+}
+
 EbuExportSettings::EbuExportSettings(std::string const& prefix)
 : prefix(prefix)
 , tv_standard((TvStandard)OPT_GET(prefix + "/TV Standard")->GetInt())
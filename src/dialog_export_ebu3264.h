@@ -100,6 +100,9 @@ public:
 	/// Get the frame rate for the current TV Standard
 	agi::vfr::Framerate GetFramerate() const;
 
+	/// Get the iconv name of the charset for the current text encoding
+	const char *GetTextEncodingName() const;
+
 	/// Get a charset encoder for the current text encoding
 	std::unique_ptr<agi::charset::IconvWrapper> GetTextEncoder() const;
 
@@ -32,15 +32,23 @@
 #include "ass_file.h"
 #include "ass_karaoke.h"
 #include "compat.h"
+#include "dialog_progress.h"
 #include "help_button.h"
 #include "include/aegisub/context.h"
 #include "libresrc/libresrc.h"
 #include "options.h"
 
+#include <libaegisub/dispatch.h>
+#include <libaegisub/exception.h>
 #include <libaegisub/karaoke_matcher.h>
 
+#include <atomic>
 #include <boost/locale/boundary.hpp>
+#include <condition_variable>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <wx/checkbox.h>
 #include <wx/combobox.h>
@@ -454,6 +462,7 @@ class DialogKanjiTimer final : public wxDialog {
 	void OnSkipDest(wxCommandEvent &event);
 	void OnGoBack(wxCommandEvent &event);
 	void OnAccept(wxCommandEvent &event);
+	void OnMatchAll(wxCommandEvent &event);
 	void OnKeyDown(wxKeyEvent &event);
 
 	void ResetForNewLine();
@@ -501,6 +510,7 @@ DialogKanjiTimer::DialogKanjiTimer(agi::Context *c)
 	wxButton *SkipDestLine = new wxButton(this, -1,_("Skip &Dest Line"));
 	wxButton *GoBackLine = new wxButton(this, -1,_("&Go Back a Line"));
 	wxButton *AcceptLine = new wxButton(this, -1,_("&Accept Line"));
+	wxButton *MatchAll = new wxButton(this, -1,_("&Match All Lines"));
 	wxButton *CloseKT = new wxButton(this,wxID_CLOSE,_("&Close"));
 
 	//Frame: Text
@@ -523,6 +533,7 @@ DialogKanjiTimer::DialogKanjiTimer(agi::Context *c)
 	ButtonsBoxSizer->Add(SkipDestLine, 0, wxEXPAND|(wxALL&~wxTOP), 6);
 	ButtonsBoxSizer->Add(GoBackLine, 0, wxEXPAND|(wxALL&~wxTOP), 6);
 	ButtonsBoxSizer->Add(AcceptLine, 0, wxEXPAND|(wxALL&~wxTOP), 6);
+	ButtonsBoxSizer->Add(MatchAll, 0, wxEXPAND|(wxALL&~wxTOP), 6);
 	ButtonsBoxSizer->AddStretchSpacer(1);
 
 	// Button sizer
@@ -554,6 +565,7 @@ DialogKanjiTimer::DialogKanjiTimer(agi::Context *c)
 	SkipDestLine->Bind(wxEVT_BUTTON, &DialogKanjiTimer::OnSkipDest, this);
 	GoBackLine->Bind(wxEVT_BUTTON, &DialogKanjiTimer::OnGoBack, this);
 	AcceptLine->Bind(wxEVT_BUTTON, &DialogKanjiTimer::OnAccept, this);
+	MatchAll->Bind(wxEVT_BUTTON, &DialogKanjiTimer::OnMatchAll, this);
 }
 
 void DialogKanjiTimer::OnClose(wxCommandEvent &) {
@@ -633,6 +645,117 @@ void DialogKanjiTimer::OnAccept(wxCommandEvent &) {
 	}
 }
 
+void DialogKanjiTimer::OnMatchAll(wxCommandEvent &) {
+	if (!currentSourceLine || !currentDestinationLine) {
+		wxBell();
+		return;
+	}
+
+	struct LinePair {
+		AssDialogue *source;
+		AssDialogue *destination;
+		std::vector<AssKaraoke::Syllable> syls;
+		std::vector<std::string> source_text;
+		std::string destination_text;
+		agi::karaoke_line_match_result match;
+	};
+
+	// Everything which touches the file is done up front on this thread so
+	// that the workers only have to run the matcher
+	auto sourceStyle = from_wx(SourceStyle->GetValue());
+	auto destStyle = from_wx(DestStyle->GetValue());
+	std::vector<LinePair> pairs;
+	for (auto src = currentSourceLine, dst = currentDestinationLine; src && dst;
+		src = FindNextStyleMatch(src, sourceStyle), dst = FindNextStyleMatch(dst, destStyle))
+	{
+		LinePair pair;
+		pair.source = src;
+		pair.destination = dst;
+		AssKaraoke kara(src);
+		pair.syls.assign(kara.begin(), kara.end());
+		for (auto const& syl : pair.syls)
+			pair.source_text.push_back(syl.text);
+		pair.destination_text = dst->GetStrippedText();
+		pairs.emplace_back(std::move(pair));
+	}
+
+	DialogProgress progress(this, _("Kanji timing"), _("Matching lines..."));
+	try {
+		progress.Run([&](agi::ProgressSink *ps) {
+			struct MatchState {
+				std::atomic<size_t> next{0};
+				std::atomic<bool> cancelled{false};
+				std::mutex lock;
+				std::condition_variable helpers_done;
+				size_t helpers_running = 0;
+				bool finished = false;
+			};
+			auto state = std::make_shared<MatchState>();
+
+			auto match_lines = [&pairs, ps](MatchState &s, bool report) {
+				for (size_t i; !s.cancelled && (i = s.next++) < pairs.size(); ) {
+					pairs[i].match = agi::auto_match_karaoke_line(pairs[i].source_text, pairs[i].destination_text);
+					if (!report) continue;
+					ps->SetProgress(i + 1, pairs.size());
+					if (ps->IsCancelled())
+						s.cancelled = true;
+				}
+			};
+
+			// This task claims lines too, so it never has to wait for a helper
+			// to be scheduled, and helpers which only start once every line has
+			// been matched return without touching the lines
+			for (unsigned i = 1; i < std::thread::hardware_concurrency(); ++i) {
+				agi::dispatch::Background().Async([state, match_lines] {
+					{
+						std::lock_guard<std::mutex> lock(state->lock);
+						if (state->finished) return;
+						++state->helpers_running;
+					}
+					match_lines(*state, false);
+					std::lock_guard<std::mutex> lock(state->lock);
+					--state->helpers_running;
+					state->helpers_done.notify_all();
+				});
+			}
+
+			match_lines(*state, true);
+			std::unique_lock<std::mutex> lock(state->lock);
+			state->finished = true;
+			state->helpers_done.wait(lock, [&] { return state->helpers_running == 0; });
+		});
+	}
+	catch (agi::UserCancelException const&) {
+		return;
+	}
+
+	// Accept every line up to the first one which the matcher isn't sure
+	// about, and then leave that one for the user to fix by hand
+	const double threshold = OPT_GET("Tool/Kanji Timer/Batch Confidence")->GetDouble();
+	for (auto const& pair : pairs) {
+		if (pair.match.confidence < threshold) {
+			currentSourceLine = pair.source;
+			currentDestinationLine = pair.destination;
+			ResetForNewLine();
+			return;
+		}
+
+		std::string output;
+		auto syl = pair.syls.begin();
+		for (auto const& group : pair.match.groups) {
+			int duration = 0;
+			for (size_t i = 0; i < group.source_length; ++i, ++syl)
+				duration += syl->duration;
+			output += "{\\k" + std::to_string(duration / 10) + "}" + group.destination;
+		}
+		LinesToChange.emplace_back(pair.destination, std::move(output));
+	}
+
+	currentSourceLine = FindNextStyleMatch(pairs.back().source, sourceStyle);
+	currentDestinationLine = FindNextStyleMatch(pairs.back().destination, destStyle);
+	ResetForNewLine();
+}
+
 void DialogKanjiTimer::OnKeyDown(wxKeyEvent &event) {
 	wxCommandEvent evt;
 	switch(event.GetKeyCode()) {
@@ -324,7 +324,9 @@ void DialogShiftTimes::SaveHistory(json::Array shifted_blocks) {
 		history.resize(50);
 
 	try {
-		agi::JsonWriter::Write(history, agi::io::Save(history_filename).Get());
+		agi::io::Save file(history_filename);
+		agi::JsonWriter::Write(history, file.Get());
+		file.Commit();
 	}
 	catch (agi::fs::FileSystemError const& e) {
 		LOG_E("dialog_shift_times/save_history") << "Cannot save shift times history: " << e.GetMessage();
@@ -73,9 +73,11 @@ class DialogSpellChecker final : public wxDialog {
 	AssDialogue *start_line = nullptr;  ///< The first line checked
 	AssDialogue *active_line = nullptr; ///< The most recently checked line
 	bool has_looped = false;            ///< Has the search already looped from the end to beginning?
+	bool waiting_for_dictionary = false; ///< Is the search waiting for the dictionary to finish loading?
 
 	/// Find the next misspelled word and close the dialog if there are none
-	/// @return Are there any more misspelled words?
+	/// @return Are there any more misspelled words? True while the dictionary
+	///         is still loading, as the search resumes once it has loaded.
 	bool FindNext();
 
 	/// Check a single line for misspellings
@@ -223,6 +225,13 @@ DialogSpellChecker::DialogSpellChecker(agi::Context *context)
 	SetSizerAndFit(main_sizer);
 	CenterOnParent();
 
+	spellchecker->AddDictionaryChangedListener([=] {
+		if (waiting_for_dictionary && !spellchecker->IsLoading()) {
+			waiting_for_dictionary = false;
+			FindNext();
+		}
+	});
+
 	if (FindNext())
 		Show();
 }
@@ -234,6 +243,7 @@ void DialogSpellChecker::OnReplace(wxCommandEvent&) {
 
 void DialogSpellChecker::OnChangeLanguage(wxCommandEvent&) {
 	wxString code = dictionary_lang_codes[language->GetSelection()];
+	waiting_for_dictionary = false;
 	OPT_SET("Tool/Spell Checker/Language")->SetString(from_wx(code));
 
 	FindNext();
@@ -244,6 +254,18 @@ void DialogSpellChecker::OnChangeSuggestion(wxCommandEvent&) {
 }
 
 bool DialogSpellChecker::FindNext() {
+	// Every word counts as correct until the dictionary has loaded, so wait
+	// for it rather than reporting that there are no mistakes
+	if (spellchecker->IsLoading()) {
+		waiting_for_dictionary = true;
+		orig_word->SetValue(_("Loading dictionary..."));
+		replace_word->Clear();
+		suggest_list->Clear();
+		add_button->Enable(false);
+		remove_button->Enable(false);
+		return true;
+	}
+
 	AssDialogue *real_active_line = context->selectionController->GetActiveLine();
 	// User has changed the active line; restart search from this position
 	if (real_active_line != active_line) {
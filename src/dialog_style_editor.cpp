@@ -40,6 +40,7 @@
 #include "ass_style_storage.h"
 #include "colour_button.h"
 #include "compat.h"
+#include "field_value_index.h"
 #include "help_button.h"
 #include "include/aegisub/context.h"
 #include "libresrc/libresrc.h"
@@ -114,6 +115,10 @@ public:
 
 	/// Check if there are any uses of the original style name in the file
 	bool NeedsReplace() {
+		// Lines using the style directly are found without parsing anything,
+		// so only the \r overrides need a walk over the file
+		if (c->fieldValues->GetCount(FieldValueIndex::STYLE, source_name))
+			return true;
 		Walk(false);
 		return found_any;
 	}
@@ -417,7 +422,8 @@ void DialogStyleEditor::Apply(bool apply, bool close) {
 
 		// Style name change
 		bool did_rename = false;
-		if (work->name != new_name) {
+		bool name_changed = work->name != new_name;
+		if (name_changed) {
 			if (!store && !is_new) {
 				StyleRenamer renamer(c, work->name, new_name);
 				if (renamer.NeedsReplace()) {
@@ -450,6 +456,8 @@ void DialogStyleEditor::Apply(bool apply, bool close) {
 				c->ass->Styles.push_back(*style);
 			is_new = false;
 		}
+		else if (store && name_changed)
+			store->Reindex();
 		if (!store)
 			c->ass->Commit(_("style change"), AssFile::COMMIT_STYLES | (did_rename ? AssFile::COMMIT_DIAG_FULL : 0));
 
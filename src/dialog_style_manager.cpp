@@ -256,6 +256,48 @@ int get_single_sel(wxListBox *lb) {
 	return n == 1 ? selections[0] : -1;
 }
 
+/// Make a list box show the given items, touching only the rows between the
+/// first and last which differ so that large lists stay fast to update
+void update_list(wxListBox *list, std::vector<std::string> const& items) {
+	list->DeselectAll();
+
+	size_t old_count = list->GetCount();
+	size_t new_count = items.size();
+
+	size_t prefix = 0;
+	while (prefix < old_count && prefix < new_count && list->GetString(prefix) == to_wx(items[prefix]))
+		++prefix;
+
+	size_t suffix = 0;
+	while (suffix < old_count - prefix && suffix < new_count - prefix
+		&& list->GetString(old_count - suffix - 1) == to_wx(items[new_count - suffix - 1]))
+		++suffix;
+
+	size_t old_changed = old_count - prefix - suffix;
+	size_t new_changed = new_count - prefix - suffix;
+	if (!old_changed && !new_changed) return;
+
+	list->Freeze();
+
+	size_t replaced = std::min(old_changed, new_changed);
+	for (size_t i = prefix; i < prefix + replaced; ++i)
+		list->SetString(i, to_wx(items[i]));
+
+	if (new_changed > old_changed) {
+		wxArrayString added;
+		added.reserve(new_changed - replaced);
+		for (size_t i = prefix + replaced; i < prefix + new_changed; ++i)
+			added.push_back(to_wx(items[i]));
+		list->Insert(added, prefix + replaced);
+	}
+	else {
+		for (size_t i = replaced; i < old_changed; ++i)
+			list->Delete(prefix + replaced);
+	}
+
+	list->Thaw();
+}
+
 DialogStyleManager::DialogStyleManager(agi::Context *context)
 : wxDialog(context->parent, -1, _("Styles Manager"))
 , c(context)
@@ -378,14 +420,17 @@ DialogStyleManager::DialogStyleManager(agi::Context *context)
 }
 
 void DialogStyleManager::LoadCurrentStyles(int commit_type) {
+	if (!(commit_type & (AssFile::COMMIT_STYLES | AssFile::COMMIT_DIAG_META)) && commit_type != AssFile::COMMIT_NEW)
+		return;
+
 	if (commit_type & AssFile::COMMIT_STYLES || commit_type == AssFile::COMMIT_NEW) {
-		CurrentList->Clear();
 		styleMap.clear();
-
+		std::vector<std::string> names;
 		for (auto& style : c->ass->Styles) {
-			CurrentList->Append(to_wx(style.name));
+			names.push_back(style.name);
 			styleMap.push_back(&style);
 		}
+		update_list(CurrentList, names);
 	}
 
 	if (commit_type & AssFile::COMMIT_DIAG_META) {
@@ -410,9 +455,7 @@ void DialogStyleManager::OnActiveLineChanged(AssDialogue *new_line) {
 
 void DialogStyleManager::UpdateStorage() {
 	Store.Save();
-
-	StorageList->Clear();
-	StorageList->Append(to_wx(Store.GetNames()));
+	update_list(StorageList, Store.GetNames());
 
 	UpdateButtons();
 }
@@ -491,7 +534,7 @@ void DialogStyleManager::OnCatalogDelete() {
 	wxString message = fmt_tl("Are you sure you want to delete the storage \"%s\" from the catalog?", name);
 	int option = wxMessageBox(message, _("Confirm delete"), wxYES_NO | wxICON_EXCLAMATION , this);
 	if (option == wxYES) {
-		agi::fs::Remove(config::path->Decode("?user/catalog/" + from_wx(name) + ".sty"));
+		AssStyleStorage::DeleteCatalog(from_wx(name));
 		CatalogList->Delete(CatalogList->GetSelection());
 		CatalogList->SetSelection(0);
 		OnChangeCatalog();
@@ -864,6 +907,9 @@ void DialogStyleManager::MoveStyles(bool storage, int type) {
 
 	if (storage) {
 		do_move(Store, type, first, last, true);
+		// Which of several styles with the same name comes first may have
+		// changed
+		Store.Reindex();
 		UpdateStorage();
 	}
 	else {
@@ -0,0 +1,340 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+/// @file dialog_subs_diff.cpp
+/// @brief Comparing the open subtitles with another file and merging in its changes
+
+#include "ass_diff.h"
+#include "ass_dialogue.h"
+#include "ass_file.h"
+#include "ass_style.h"
+#include "charset_detect.h"
+#include "compat.h"
+#include "dialogs.h"
+#include "format.h"
+#include "include/aegisub/context.h"
+#include "project.h"
+#include "selection_controller.h"
+#include "subtitle_format.h"
+#include "utils.h"
+
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
+
+#include <vector>
+#include <wx/button.h>
+#include <wx/dialog.h>
+#include <wx/listctrl.h>
+#include <wx/msgdlg.h>
+#include <wx/sizer.h>
+#include <wx/stattext.h>
+
+namespace {
+bool load_file(agi::Context *c, wxString const& title, AssFile &file) {
+	auto filename = OpenFileSelector(title, "Path/Last/Subtitles", "", "", SubtitleFormat::GetWildcards(0), c->parent);
+	if (filename.empty()) return false;
+
+	try {
+		auto charset = CharSetDetect::GetEncoding(filename);
+		auto reader = SubtitleFormat::GetReader(filename, charset);
+		if (!reader) {
+			wxMessageBox(_("Unsupported subtitle format"), _("Error"), wxOK | wxICON_ERROR | wxCENTER, c->parent);
+			return false;
+		}
+		reader->ReadFile(&file, filename, c->project->Timecodes(), charset);
+		return true;
+	}
+	catch (agi::UserCancelException const&) {
+		return false;
+	}
+	catch (agi::Exception const& err) {
+		wxMessageBox(to_wx(err.GetMessage()), _("Error"), wxOK | wxICON_ERROR | wxCENTER, c->parent);
+		return false;
+	}
+}
+
+wxString line_number(const AssDialogue *line) {
+	return line ? std::to_wstring(line->Row + 1) : wxString();
+}
+
+wxString line_text(const AssDialogue *line) {
+	return line ? to_wx(line->Text.get()) : _("(deleted)");
+}
+
+wxString change_name(ass_diff::ChangeType type) {
+	switch (type) {
+		case ass_diff::ADDED:   return _("Added");
+		case ass_diff::REMOVED: return _("Removed");
+		default:                return _("Modified");
+	}
+}
+
+wxString conflict_name(ass_diff::ConflictType type) {
+	switch (type) {
+		case ass_diff::CONFLICT_DELETED_BY_US:   return _("Deleted by us");
+		case ass_diff::CONFLICT_DELETED_BY_THEM: return _("Deleted by them");
+		default:                                 return _("Both changed");
+	}
+}
+
+wxListView *make_list(wxDialog *d, wxString const& old_label, wxString const& new_label) {
+	auto list = new wxListView(d, -1, wxDefaultPosition, wxSize(760, 400));
+	list->InsertColumn(0, _("Line"), wxLIST_FORMAT_RIGHT, 50);
+	list->InsertColumn(1, _("Change"), wxLIST_FORMAT_LEFT, 110);
+	list->InsertColumn(2, _("Fields"), wxLIST_FORMAT_LEFT, 120);
+	list->InsertColumn(3, old_label, wxLIST_FORMAT_LEFT, 240);
+	list->InsertColumn(4, new_label, wxLIST_FORMAT_LEFT, 240);
+	return list;
+}
+
+void add_row(wxListView *list, wxString const& line, wxString const& change, wxString const& fields, wxString const& old_value, wxString const& new_value) {
+	int row = list->GetItemCount();
+	list->InsertItem(row, line);
+	list->SetItem(row, 1, change);
+	list->SetItem(row, 2, fields);
+	list->SetItem(row, 3, old_value);
+	list->SetItem(row, 4, new_value);
+}
+
+/// Select a line in the grid, as the diff lines point into the open file
+void select_line(agi::Context *c, AssDialogue *line) {
+	if (line)
+		c->selectionController->SetSelectionAndActive({ line }, line);
+}
+
+class DialogSubsCompare {
+	wxDialog d;
+	agi::Context *c;
+	ass_diff::FileDiff diff;
+
+public:
+	DialogSubsCompare(agi::Context *c, ass_diff::FileDiff file_diff);
+	void ShowModal() { d.ShowModal(); }
+};
+
+DialogSubsCompare::DialogSubsCompare(agi::Context *c, ass_diff::FileDiff file_diff)
+: d(c->parent, -1, _("Compare Subtitles"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+, c(c)
+, diff(std::move(file_diff))
+{
+	auto list = make_list(&d, _("Other file"), _("Current file"));
+	for (auto const& change : diff.lines) {
+		add_row(list, std::to_wstring(change.new_number ? change.new_number : change.old_number),
+			change_name(change.type), to_wx(ass_diff::DescribeFields(change.fields)),
+			change.old_line ? to_wx(change.old_line->Text.get()) : wxString(),
+			change.new_line ? to_wx(change.new_line->Text.get()) : wxString());
+	}
+	for (auto const& change : diff.styles) {
+		add_row(list, wxString(), change_name(change.type), _("Style"),
+			change.old_style ? to_wx(change.old_style->name) : wxString(),
+			change.new_style ? to_wx(change.new_style->name) : wxString());
+	}
+
+	list->Bind(wxEVT_LIST_ITEM_ACTIVATED, [=](wxListEvent &evt) {
+		size_t i = evt.GetIndex();
+		if (i < diff.lines.size())
+			select_line(this->c, const_cast<AssDialogue *>(diff.lines[i].new_line));
+	});
+
+	auto main_sizer = new wxBoxSizer(wxVERTICAL);
+	auto summary = fmt_tl("%d changed lines and %d changed styles", diff.lines.size(), diff.styles.size());
+	main_sizer->Add(new wxStaticText(&d, -1, summary), 0, wxALL, 5);
+	main_sizer->Add(list, 1, wxLEFT | wxRIGHT | wxEXPAND, 5);
+	main_sizer->Add(d.CreateStdDialogButtonSizer(wxOK), 0, wxALL | wxEXPAND, 5);
+	d.SetSizerAndFit(main_sizer);
+	d.CenterOnParent();
+}
+
+class DialogMergeConflicts {
+	wxDialog d;
+	agi::Context *c;
+	ass_diff::MergeResult result;
+
+	wxListView *list;
+	wxButton *keep_ours;
+	wxButton *keep_theirs;
+
+	/// Indices into result.lines of the unresolved conflicts, in list order
+	std::vector<size_t> unresolved;
+
+	void UpdateList();
+	void UpdateButtons();
+	void OnResolve(bool theirs);
+
+public:
+	DialogMergeConflicts(agi::Context *c, ass_diff::MergeResult result);
+	void ShowModal() { d.ShowModal(); }
+};
+
+DialogMergeConflicts::DialogMergeConflicts(agi::Context *c, ass_diff::MergeResult result)
+: d(c->parent, -1, _("Merge Conflicts"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+, c(c)
+, result(std::move(result))
+{
+	list = make_list(&d, _("Ours"), _("Theirs"));
+	for (size_t i = 0; i < this->result.lines.size(); ++i)
+		unresolved.push_back(i);
+	UpdateList();
+
+	keep_ours = new wxButton(&d, -1, _("Keep &Ours"));
+	keep_theirs = new wxButton(&d, -1, _("Keep &Theirs"));
+
+	auto button_sizer = new wxBoxSizer(wxHORIZONTAL);
+	button_sizer->Add(keep_ours, 1);
+	button_sizer->Add(keep_theirs, 1);
+	button_sizer->AddStretchSpacer(1);
+	button_sizer->Add(new wxButton(&d, wxID_CANCEL, _("&Close")), 1);
+
+	auto main_sizer = new wxBoxSizer(wxVERTICAL);
+	main_sizer->Add(new wxStaticText(&d, -1, _("Our version of each conflicting line has been kept. Double-click a conflict to select its line in the grid.")), 0, wxALL, 5);
+	main_sizer->Add(list, 1, wxLEFT | wxRIGHT | wxEXPAND, 5);
+	main_sizer->Add(button_sizer, 0, wxALL | wxEXPAND, 5);
+	d.SetSizerAndFit(main_sizer);
+	d.CenterOnParent();
+	UpdateButtons();
+
+	keep_ours->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { OnResolve(false); });
+	keep_theirs->Bind(wxEVT_BUTTON, [=](wxCommandEvent&) { OnResolve(true); });
+	list->Bind(wxEVT_LIST_ITEM_SELECTED, [=](wxListEvent&) { UpdateButtons(); });
+	list->Bind(wxEVT_LIST_ITEM_DESELECTED, [=](wxListEvent&) { UpdateButtons(); });
+	list->Bind(wxEVT_LIST_ITEM_ACTIVATED, [=](wxListEvent &evt) {
+		size_t i = evt.GetIndex();
+		if (i < unresolved.size())
+			select_line(this->c, this->result.lines[unresolved[i]].line);
+	});
+}
+
+void DialogMergeConflicts::UpdateList() {
+	list->DeleteAllItems();
+	for (size_t i : unresolved) {
+		auto const& conflict = result.lines[i];
+		bool ours_deleted = conflict.type == ass_diff::CONFLICT_DELETED_BY_US;
+		bool theirs_deleted = conflict.type == ass_diff::CONFLICT_DELETED_BY_THEM;
+		add_row(list, line_number(conflict.line), conflict_name(conflict.type),
+			to_wx(ass_diff::DescribeFields(conflict.fields)),
+			line_text(ours_deleted ? nullptr : conflict.line),
+			theirs_deleted ? line_text(nullptr) : to_wx(conflict.theirs.Text.get()));
+	}
+
+	// Style conflicts can't be resolved here, but are listed so that the
+	// user knows to check them in the style manager
+	for (auto const& name : result.styles)
+		add_row(list, wxString(), conflict_name(ass_diff::CONFLICT_FIELDS), _("Style"), to_wx(name), to_wx(name));
+}
+
+void DialogMergeConflicts::UpdateButtons() {
+	bool has_sel = false;
+	for (long i = list->GetFirstSelected(); i != -1; i = list->GetNextSelected(i))
+		has_sel = has_sel || (size_t)i < unresolved.size();
+	keep_ours->Enable(has_sel);
+	keep_theirs->Enable(has_sel);
+}
+
+void DialogMergeConflicts::OnResolve(bool theirs) {
+	std::vector<size_t> selected;
+	for (long i = list->GetFirstSelected(); i != -1; i = list->GetNextSelected(i)) {
+		if ((size_t)i < unresolved.size())
+			selected.push_back(i);
+	}
+	if (selected.empty()) return;
+
+	auto sel = c->selectionController->GetSelectedSet();
+	auto active = c->selectionController->GetActiveLine();
+	bool deleted = false;
+
+	// Erase from the back so that the earlier indices stay valid
+	for (auto it = selected.rbegin(); it != selected.rend(); ++it) {
+		auto const& conflict = result.lines[unresolved[*it]];
+		auto line = conflict.line;
+		if (ass_diff::Resolve(conflict, theirs)) {
+			deleted = true;
+			sel.erase(line);
+			if (line == active)
+				active = nullptr;
+		}
+		unresolved.erase(unresolved.begin() + *it);
+	}
+
+	if (deleted && !active) {
+		if (c->ass->Events.empty())
+			c->ass->Events.push_back(*new AssDialogue);
+		active = sel.empty() ? &c->ass->Events.front() : *sel.begin();
+	}
+
+	c->ass->Commit(_("resolve merge conflict"), deleted ? AssFile::COMMIT_DIAG_ADDREM | AssFile::COMMIT_DIAG_FULL : AssFile::COMMIT_DIAG_FULL);
+	if (deleted) {
+		if (sel.empty()) sel.insert(active);
+		c->selectionController->SetSelectionAndActive(std::move(sel), active);
+	}
+
+	UpdateList();
+	UpdateButtons();
+}
+}
+
+void ShowCompareDialog(agi::Context *c) {
+	AssFile other;
+	if (!load_file(c, _("Compare with subtitles file"), other)) return;
+
+	auto diff = ass_diff::Diff(other, *c->ass);
+	if (diff.lines.empty() && diff.styles.empty()) {
+		wxMessageBox(_("The events and styles of the two files are identical."), _("Compare Subtitles"), wxOK | wxCENTER, c->parent);
+		return;
+	}
+
+	DialogSubsCompare(c, std::move(diff)).ShowModal();
+}
+
+void ShowMergeDialog(agi::Context *c) {
+	AssFile base, theirs;
+	if (!load_file(c, _("Open the original version the changes are based on"), base)) return;
+	if (!load_file(c, _("Open the changed version to merge in"), theirs)) return;
+
+	auto old_sel = c->selectionController->GetSelectedSet();
+	auto old_active = c->selectionController->GetActiveLine();
+
+	auto result = ass_diff::Merge(base, *c->ass, theirs);
+
+	// Merging may have deleted some of the selected lines, so rebuild the
+	// selection from the lines which are still in the file
+	Selection sel;
+	AssDialogue *active = nullptr;
+	if (c->ass->Events.empty())
+		c->ass->Events.push_back(*new AssDialogue);
+	for (auto& line : c->ass->Events) {
+		if (old_sel.count(&line)) sel.insert(&line);
+		if (&line == old_active) active = &line;
+	}
+
+	c->ass->Commit(_("merge changes"), AssFile::COMMIT_ORDER | AssFile::COMMIT_STYLES | AssFile::COMMIT_EXTRADATA | AssFile::COMMIT_DIAG_ADDREM | AssFile::COMMIT_DIAG_FULL);
+
+	if (!result.lines.empty()) {
+		sel.clear();
+		for (auto const& conflict : result.lines)
+			sel.insert(conflict.line);
+		active = result.lines.front().line;
+	}
+	if (!active)
+		active = sel.empty() ? &c->ass->Events.front() : *sel.begin();
+	if (sel.empty())
+		sel.insert(active);
+	c->selectionController->SetSelectionAndActive(std::move(sel), active);
+
+	if (result.lines.empty() && result.styles.empty())
+		wxMessageBox(_("All changes were merged without conflicts."), _("Merge Changes"), wxOK | wxCENTER, c->parent);
+	else
+		DialogMergeConflicts(c, std::move(result)).ShowModal();
+}
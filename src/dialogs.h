@@ -61,10 +61,12 @@ bool ShowPlainTextImportDialog();
 void ShowAboutDialog(wxWindow *parent);
 void ShowAttachmentsDialog(wxWindow *parent, AssFile *file);
 void ShowAutomationDialog(agi::Context *c);
+void ShowCompareDialog(agi::Context *c);
 void ShowExportDialog(agi::Context *c);
 void ShowFontsCollectorDialog(agi::Context *c);
 void ShowJumpToDialog(agi::Context *c);
 void ShowKanjiTimerDialog(agi::Context *c);
+void ShowMergeDialog(agi::Context *c);
 void ShowLogWindow(agi::Context *c);
 void ShowPreferences(wxWindow *parent);
 void ShowPropertiesDialog(agi::Context *c);
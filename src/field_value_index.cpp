@@ -0,0 +1,148 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "field_value_index.h"
+
+#include "ass_dialogue.h"
+#include "ass_file.h"
+#include "include/aegisub/context.h"
+
+FieldValueIndex::FieldValueIndex(agi::Context *c)
+: c(c)
+, commit_connection(c->ass->AddCommitListener(&FieldValueIndex::OnCommit, this))
+{
+	versions.fill(0);
+}
+
+boost::flyweight<std::string> const& FieldValueIndex::Get(const AssDialogue *line, Field field) {
+	switch (field) {
+		case STYLE:  return line->Style;
+		case ACTOR:  return line->Actor;
+		default:     return line->Effect;
+	}
+}
+
+void FieldValueIndex::OnCommit(int type, const AssDialogue *single_line) {
+	if (dirty) return;
+
+	if (type == AssFile::COMMIT_NEW || type & AssFile::COMMIT_DIAG_ADDREM) {
+		dirty = true;
+		dirty_lines.clear();
+	}
+	else if (type & AssFile::COMMIT_DIAG_META) {
+		if (single_line)
+			dirty_lines.push_back(single_line);
+		else {
+			dirty = true;
+			dirty_lines.clear();
+		}
+	}
+}
+
+void FieldValueIndex::Add(Field field, boost::flyweight<std::string> const& value) {
+	if (value.get().empty()) return;
+	if (++counts[field][value.get()] == 1)
+		++versions[field];
+}
+
+void FieldValueIndex::Remove(Field field, boost::flyweight<std::string> const& value) {
+	if (value.get().empty()) return;
+	auto it = counts[field].find(value.get());
+	if (it == counts[field].end()) return;
+	if (--it->second == 0) {
+		counts[field].erase(it);
+		++versions[field];
+	}
+}
+
+void FieldValueIndex::Update(entry& e, const AssDialogue *line) {
+	for (size_t i = 0; i < FIELD_COUNT; ++i) {
+		Field field = static_cast<Field>(i);
+		auto const& value = Get(line, field);
+		// Flyweights with the same value share storage, so this is a
+		// pointer comparison
+		if (e.values[i] == value) continue;
+		Remove(field, e.values[i]);
+		Add(field, value);
+		e.values[i] = value;
+	}
+}
+
+void FieldValueIndex::Sync() {
+	if (!dirty) {
+		for (auto line : dirty_lines) {
+			auto it = lines.find(line);
+			if (it != lines.end())
+				Update(it->second, line);
+		}
+		dirty_lines.clear();
+		return;
+	}
+
+	generation = !generation;
+	for (auto const& line : c->ass->Events) {
+		auto it = lines.find(&line);
+		// A line which has been deleted may have had its memory reused
+		if (it != lines.end() && it->second.id != line.Id) {
+			for (size_t i = 0; i < FIELD_COUNT; ++i)
+				Remove(static_cast<Field>(i), it->second.values[i]);
+			lines.erase(it);
+			it = lines.end();
+		}
+		if (it == lines.end())
+			it = lines.emplace(&line, entry{line.Id, line_values(), generation}).first;
+
+		it->second.seen = generation;
+		Update(it->second, &line);
+	}
+
+	for (auto it = lines.begin(); it != lines.end(); ) {
+		if (it->second.seen != generation) {
+			for (size_t i = 0; i < FIELD_COUNT; ++i)
+				Remove(static_cast<Field>(i), it->second.values[i]);
+			it = lines.erase(it);
+		}
+		else
+			++it;
+	}
+
+	dirty = false;
+}
+
+FieldValueIndex::value_counts const& FieldValueIndex::GetCounts(Field field) {
+	Sync();
+	return counts[field];
+}
+
+std::vector<std::string> FieldValueIndex::GetValues(Field field) {
+	Sync();
+	std::vector<std::string> ret;
+	ret.reserve(counts[field].size());
+	for (auto const& value : counts[field])
+		ret.push_back(value.first);
+	return ret;
+}
+
+size_t FieldValueIndex::GetCount(Field field, std::string const& value) {
+	Sync();
+	auto it = counts[field].find(value);
+	return it == counts[field].end() ? 0 : it->second;
+}
+
+uint64_t FieldValueIndex::GetVersion(Field field) {
+	Sync();
+	return versions[field];
+}
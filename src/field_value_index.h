@@ -0,0 +1,100 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/signal.h>
+
+#include <array>
+#include <boost/flyweight.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace agi { struct Context; }
+class AssDialogue;
+
+/// @class FieldValueIndex
+/// @brief Number of lines using each distinct style, actor and effect
+///
+/// Like OverlapIndex, this is updated lazily from the commits since it was
+/// last queried: single-line commits adjust the counts for just that line,
+/// and other commits compare each line's values against the ones it had
+/// last time rather than rebuilding the sets. Lines with an empty value are
+/// not counted.
+class FieldValueIndex {
+public:
+	enum Field {
+		STYLE,
+		ACTOR,
+		EFFECT,
+		FIELD_COUNT
+	};
+
+	typedef std::map<std::string, size_t> value_counts;
+
+private:
+	typedef std::array<boost::flyweight<std::string>, FIELD_COUNT> line_values;
+
+	struct entry {
+		int id;
+		line_values values;
+		bool seen;
+	};
+
+	agi::Context *c;
+	agi::signal::Connection commit_connection;
+
+	std::array<value_counts, FIELD_COUNT> counts;
+	/// Incremented for a field whenever a value is added to or removed from
+	/// its set of distinct values
+	std::array<uint64_t, FIELD_COUNT> versions;
+	std::unordered_map<const AssDialogue *, entry> lines;
+
+	/// Lines which have changed since the last sync
+	std::vector<const AssDialogue *> dirty_lines;
+	/// Has something other than individual lines changed since the last sync?
+	bool dirty = true;
+	/// Flipped on each full sync to find the lines which have gone away
+	bool generation = false;
+
+	void OnCommit(int type, const AssDialogue *single_line);
+	void Sync();
+	void Update(entry& e, const AssDialogue *line);
+	void Add(Field field, boost::flyweight<std::string> const& value);
+	void Remove(Field field, boost::flyweight<std::string> const& value);
+
+public:
+	FieldValueIndex(agi::Context *c);
+
+	/// Get the number of lines using each value of a field, sorted by value
+	value_counts const& GetCounts(Field field);
+
+	/// Get the distinct values of a field, sorted
+	std::vector<std::string> GetValues(Field field);
+
+	/// Get the number of lines with the given value for a field
+	size_t GetCount(Field field, std::string const& value);
+
+	/// Get a number which changes whenever the set of distinct values of a
+	/// field changes, for skipping work when it hasn't
+	uint64_t GetVersion(Field field);
+
+	/// Get the value of a field for a line
+	static boost::flyweight<std::string> const& Get(const AssDialogue *line, Field field);
+};
@@ -24,6 +24,9 @@
 #include "video_controller.h"
 
 #include <libaegisub/character_count.h>
+#include <libaegisub/vfr.h>
+
+#include <algorithm>
 
 #include <wx/dc.h>
 
@@ -75,6 +78,32 @@ int WidthHelper::operator()(const wchar_t *str) {
 	return dc->GetTextExtent(str).GetWidth();
 }
 
+void GridRowFrames::Update(std::vector<AssDialogue *> const& lines, agi::vfr::Framerate const& fps) {
+	this->lines.clear();
+	start.clear();
+	end.clear();
+	if (lines.empty() || !fps.IsLoaded()) return;
+
+	this->lines = lines;
+	std::vector<int> times;
+	times.reserve(lines.size());
+	for (auto line : lines)
+		times.push_back(line->Start);
+	start = fps.FramesAtTimes(times, agi::vfr::START);
+
+	times.clear();
+	for (auto line : lines)
+		times.push_back(line->End);
+	end = fps.FramesAtTimes(times, agi::vfr::END);
+}
+
+int GridRowFrames::Index(const AssDialogue *d) const {
+	auto it = std::lower_bound(lines.begin(), lines.end(), d, [](const AssDialogue *a, const AssDialogue *b) {
+		return a->Row < b->Row;
+	});
+	return it != lines.end() && *it == d ? (int)distance(lines.begin(), it) : -1;
+}
+
 void GridColumn::UpdateWidth(const agi::Context *c, WidthHelper &helper) {
 	if (!visible) {
 		width = 0;
@@ -142,9 +171,11 @@ struct GridColumnLayer final : GridColumn {
 
 struct GridColumnTime : GridColumn {
 	bool by_frame = false;
+	GridRowFrames const* frames = nullptr;
 
 	bool Centered() const override { return true; }
 	void SetByFrame(bool by_frame) override { this->by_frame = by_frame; }
+	void SetRowFrames(GridRowFrames const* frames) override { this->frames = frames; }
 };
 
 struct GridColumnStartTime final : GridColumnTime {
@@ -152,8 +183,10 @@ struct GridColumnStartTime final : GridColumnTime {
 	COLUMN_DESCRIPTION(_("Start Time"))
 
 	wxString Value(const AssDialogue *d, const agi::Context *c) const override {
-		if (by_frame)
-			return std::to_wstring(c->videoController->FrameAtTime(d->Start, agi::vfr::START));
+		if (by_frame) {
+			int index = frames ? frames->Index(d) : -1;
+			return std::to_wstring(index >= 0 ? frames->start[index] : c->videoController->FrameAtTime(d->Start, agi::vfr::START));
+		}
 		return to_wx(d->Start.GetAssFormatted());
 	}
 
@@ -170,8 +203,10 @@ struct GridColumnEndTime final : GridColumnTime {
 	COLUMN_DESCRIPTION(_("End Time"))
 
 	wxString Value(const AssDialogue *d, const agi::Context *c) const override {
-		if (by_frame)
-			return std::to_wstring(c->videoController->FrameAtTime(d->End, agi::vfr::END));
+		if (by_frame) {
+			int index = frames ? frames->Index(d) : -1;
+			return std::to_wstring(index >= 0 ? frames->end[index] : c->videoController->FrameAtTime(d->End, agi::vfr::END));
+		}
 		return to_wx(d->End.GetAssFormatted());
 	}
 
@@ -284,11 +319,11 @@ wxColor blend(wxColor fg, wxColor bg, double alpha) {
 }
 
 class GridColumnCPS final : public GridColumn {
-	const agi::OptionValue *ignore_whitespace = OPT_GET("Subtitle/Character Counter/Ignore Whitespace");
-	const agi::OptionValue *ignore_punctuation = OPT_GET("Subtitle/Character Counter/Ignore Punctuation");
-	const agi::OptionValue *cps_warn = OPT_GET("Subtitle/Character Counter/CPS Warning Threshold");
-	const agi::OptionValue *cps_error = OPT_GET("Subtitle/Character Counter/CPS Error Threshold");
-	const agi::OptionValue *bg_color = OPT_GET("Colour/Subtitle Grid/CPS Error");
+	agi::CachedOptionValue<bool> ignore_whitespace = OPT_CACHE(bool, "Subtitle/Character Counter/Ignore Whitespace");
+	agi::CachedOptionValue<bool> ignore_punctuation = OPT_CACHE(bool, "Subtitle/Character Counter/Ignore Punctuation");
+	agi::CachedOptionValue<int64_t> cps_warn = OPT_CACHE(int64_t, "Subtitle/Character Counter/CPS Warning Threshold");
+	agi::CachedOptionValue<int64_t> cps_error = OPT_CACHE(int64_t, "Subtitle/Character Counter/CPS Error Threshold");
+	agi::CachedOptionValue<agi::Color> bg_color = OPT_CACHE(agi::Color, "Colour/Subtitle Grid/CPS Error");
 
 public:
 	COLUMN_HEADER(_("CPS"))
@@ -308,9 +343,9 @@ public:
 			return -1;
 
 		int ignore = agi::IGNORE_BLOCKS;
-		if (ignore_whitespace->GetBool())
+		if (*ignore_whitespace)
 			ignore |= agi::IGNORE_WHITESPACE;
-		if (ignore_punctuation->GetBool())
+		if (*ignore_punctuation)
 			ignore |= agi::IGNORE_PUNCTUATION;
 
 		return agi::CharacterCount(text, ignore) * 1000 / duration;
@@ -328,11 +363,11 @@ public:
 		wxSize ext = dc.GetTextExtent(str);
 		auto tc = dc.GetTextForeground();
 
-		int cps_min = cps_warn->GetInt();
-		int cps_max = std::max<int>(cps_min, cps_error->GetInt());
+		int cps_min = *cps_warn;
+		int cps_max = std::max<int>(cps_min, *cps_error);
 		if (cps > cps_min) {
 			double alpha = std::min((double)(cps - cps_min + 1) / (cps_max - cps_min + 1), 1.0);
-			dc.SetBrush(wxBrush(blend(to_wx(bg_color->GetColor()), dc.GetBrush().GetColour(), alpha)));
+			dc.SetBrush(wxBrush(blend(to_wx(*bg_color), dc.GetBrush().GetColour(), alpha)));
 			dc.SetPen(*wxTRANSPARENT_PEN);
 			dc.DrawRectangle(x, y + 1, width, ext.GetHeight() + 3);
 			dc.SetTextForeground(blend(*wxBLACK, tc, alpha));
@@ -345,14 +380,14 @@ public:
 };
 
 class GridColumnText final : public GridColumn {
-	const agi::OptionValue *override_mode;
+	agi::CachedOptionValue<int64_t> override_mode;
 	wxString replace_char;
 
 	agi::signal::Connection replace_char_connection;
 
 public:
 	GridColumnText()
-	: override_mode(OPT_GET("Subtitle/Grid/Hide Overrides"))
+	: override_mode(OPT_CACHE(int64_t, "Subtitle/Grid/Hide Overrides"))
 	, replace_char(to_wx(OPT_GET("Subtitle/Grid/Hide Overrides Char")->GetString()))
 	, replace_char_connection(OPT_SUB("Subtitle/Grid/Hide Overrides Char",
 		[&](agi::OptionValue const& v) { replace_char = to_wx(v.GetString()); }))
@@ -367,7 +402,7 @@ public:
 
 	wxString Value(const AssDialogue *d, const agi::Context *) const override {
 		wxString str;
-		int mode = override_mode->GetInt();
+		int mode = *override_mode;
 
 		// Show overrides
 		if (mode == 0)
@@ -24,7 +24,10 @@
 class AssDialogue;
 class wxDC;
 class wxString;
-namespace agi { struct Context; }
+namespace agi {
+	struct Context;
+	namespace vfr { class Framerate; }
+}
 
 class WidthHelper {
 	struct Entry {
@@ -49,6 +52,21 @@ public:
 	int operator()(const wchar_t *str);
 };
 
+/// Frame numbers of the start and end times of a range of rows, converted
+/// together so that painting the grid doesn't search the timecodes per line
+struct GridRowFrames {
+	std::vector<AssDialogue *> lines;
+	std::vector<int> start;
+	std::vector<int> end;
+
+	/// Convert the times of the given lines, which must be in file order, or
+	/// clear the frames if the timecodes are not loaded
+	void Update(std::vector<AssDialogue *> const& lines, agi::vfr::Framerate const& fps);
+
+	/// Get the index in start and end of a line, or -1 if it isn't included
+	int Index(const AssDialogue *d) const;
+};
+
 class GridColumn {
 protected:
 	int width = 0;
@@ -73,6 +91,7 @@ public:
 
 	virtual void UpdateWidth(const agi::Context *c, WidthHelper &helper);
 	virtual void SetByFrame(bool /* by_frame */) { }
+	virtual void SetRowFrames(GridRowFrames const* /* frames */) { }
 	void SetVisible(bool new_value) { visible = new_value; }
 };
 
@@ -14,6 +14,7 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include <cstdint>
 #include <memory>
 
 class AssFile;
@@ -22,16 +23,19 @@ class AudioController;
 class AssDialogue;
 class AudioKaraoke;
 class DialogManager;
+class FieldValueIndex;
 class FrameMain;
 class Project;
 class SearchReplaceEngine;
 class InitialLineState;
+class OverlapIndex;
 class SelectionController;
 class SubsController;
 class BaseGrid;
 class TextSelectionController;
 class VideoController;
 class VideoDisplay;
+class VideoThumbnails;
 class wxWindow;
 namespace Automation4 { class ScriptManager; }
 
@@ -51,6 +55,9 @@ struct Context {
 	std::unique_ptr<AudioController> audioController;
 	std::unique_ptr<InitialLineState> initialLineState;
 	std::unique_ptr<SearchReplaceEngine> search;
+	std::unique_ptr<OverlapIndex> overlaps;
+	std::unique_ptr<FieldValueIndex> fieldValues;
+	std::unique_ptr<VideoThumbnails> thumbnails;
 	std::unique_ptr<Path> path;
 
 	// Things that should probably be in some sort of UI-context-model
@@ -66,6 +73,10 @@ struct Context {
 	FrameMain *frame = nullptr;
 	VideoDisplay *videoDisplay = nullptr;
 
+	/// Never shared with any other context, even one later allocated at the
+	/// same address, so it can be used to tell contexts apart in caches
+	const uint64_t serial;
+
 	Context();
 	~Context();
 };
@@ -48,6 +48,12 @@ public:
 	/// Override this method to actually get frames
 	virtual void GetFrame(int n, VideoFrame &frame)=0;
 
+	/// Get a frame without storing it in any cache or starting any read-ahead
+	///
+	/// Used for one-off reads such as thumbnails, which should not push out
+	/// the frames around the current position.
+	virtual void GetFrameUncached(int n, VideoFrame &frame) { GetFrame(n, frame); }
+
 	/// Set the YCbCr matrix to the specified one
 	///
 	/// Providers are free to disregard this, and should if the requested
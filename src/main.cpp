@@ -63,8 +63,10 @@
 #include <libaegisub/log.h>
 #include <libaegisub/make_unique.h>
 #include <libaegisub/path.h>
+#include <libaegisub/split.h>
 #include <libaegisub/util.h>
 
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/interprocess/streams/bufferstream.hpp>
 #include <boost/locale.hpp>
 #include <locale>
@@ -102,6 +104,46 @@ AegisubApp::AegisubApp() {
 
 namespace {
 wxDEFINE_EVENT(EVT_CALL_THUNK, ValueEvent<agi::dispatch::Thunk>);
+
+void SetLogLevel(agi::OptionValue const& opt) {
+	agi::log::log->SetLevel(static_cast<agi::log::Severity>(mid<int64_t>(agi::log::Exception, opt.GetInt(), agi::log::Debug)));
+}
+
+/// Disable logging for the comma-separated list of sections in the option
+void SetLogDisabledSections(agi::OptionValue const& opt) {
+	std::vector<std::string> sections;
+	for (auto const& section : agi::Split(opt.GetString(), ',')) {
+		auto trimmed = agi::str(boost::trim_copy(section));
+		if (!trimmed.empty())
+			sections.push_back(std::move(trimmed));
+	}
+	agi::log::log->SetDisabledSections(std::move(sections));
+}
+
+/// Emitter currently writing the log file
+agi::log::Emitter *log_file_emitter = nullptr;
+bool log_file_binary = false;
+
+/// Switch the log file between json and the compact binary format, which
+/// has to be converted to json with aegisub-convert-binary-log to be read
+void SetLogFormat(bool binary) {
+	if (log_file_emitter && binary == log_file_binary) return;
+	log_file_binary = binary;
+
+	auto path_log = config::path->Decode("?user/log/");
+	std::unique_ptr<agi::log::Emitter> emitter;
+	if (log_file_binary)
+		emitter = agi::make_unique<agi::log::BinaryEmitter>(path_log);
+	else
+		emitter = agi::make_unique<agi::log::JsonEmitter>(path_log);
+
+	// Subscribe the new emitter first so that nothing is lost in between
+	auto old_emitter = log_file_emitter;
+	log_file_emitter = emitter.get();
+	agi::log::log->Subscribe(std::move(emitter));
+	if (old_emitter)
+		agi::log::log->Unsubscribe(old_emitter);
+}
 }
 
 /// Message displayed when an exception has occurred.
@@ -192,8 +234,10 @@ bool AegisubApp::OnInit() {
 	StartupLog("Create log writer");
 	auto path_log = config::path->Decode("?user/log/");
 	agi::fs::CreateDirectory(path_log);
-	agi::log::log->Subscribe(agi::make_unique<agi::log::JsonEmitter>(path_log));
+	// The log format is an option, so json is used until the config is loaded
+	SetLogFormat(false);
 	CleanCache(path_log, "*.json", 10, 100);
+	CleanCache(path_log, "*.agilog", 10, 100);
 
 	StartupLog("Load user configuration");
 	try {
@@ -230,6 +274,14 @@ bool AegisubApp::OnInit() {
 	// Init hotkeys
 	hotkey::init();
 
+	StartupLog("Apply log settings");
+	SetLogLevel(*OPT_GET("App/Log/Level"));
+	SetLogDisabledSections(*OPT_GET("App/Log/Disabled Sections"));
+	OPT_SUB("App/Log/Level", SetLogLevel);
+	OPT_SUB("App/Log/Disabled Sections", SetLogDisabledSections);
+	SetLogFormat(OPT_GET("App/Log/Binary Format")->GetBool());
+	OPT_SUB("App/Log/Binary Format", [](agi::OptionValue const& opt) { SetLogFormat(opt.GetBool()); });
+
 	StartupLog("Load MRU");
 	config::mru = new agi::MRUManager(config::path->Decode("?user/mru.json"), GET_DEFAULT_CONFIG(default_mru), config::opt);
 
@@ -338,6 +390,7 @@ bool AegisubApp::OnInit() {
 
 	StartupLog("Clean old autosave files");
 	CleanCache(config::path->Decode(OPT_GET("Path/Auto/Save")->GetString()), "*.AUTOSAVE.ass", 100, 1000);
+	CleanCache(config::path->Decode(OPT_GET("Path/Auto/Save")->GetString()), "*.JOURNAL", 100, 1000);
 
 	StartupLog("Initialization complete");
 	return true;
@@ -41,6 +41,8 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/locale/collator.hpp>
+#include <map>
+#include <set>
 #include <vector>
 #include <wx/frame.h>
 #include <wx/menu.h>
@@ -133,6 +135,36 @@ class CommandManager {
 	/// Connection for hotkey change signal
 	agi::signal::Connection hotkeys_changed;
 
+	/// Things the dynamic items can depend on which have changed since the
+	/// menu was last opened
+	int changed = cmd::DEPENDS_ALL;
+	/// Options which dynamic items depend on which have changed since the menu
+	/// was last opened
+	std::set<std::string> changed_options;
+	/// Dynamic items which have not been updated since they were added
+	std::set<wxMenuItem*> new_items;
+	/// Listeners for the things the dynamic items depend on
+	std::vector<agi::signal::Connection> dependency_slots;
+	/// Listeners for the options the dynamic items depend on
+	std::map<std::string, agi::signal::Connection> option_slots;
+
+	/// Start listening for changes to the current context
+	void ListenForChanges() {
+		dependency_slots.clear();
+		changed = cmd::DEPENDS_ALL;
+		if (context)
+			dependency_slots = cmd::listen(context, cmd::DEPENDS_ALL, [=](int dependency) { changed |= dependency; });
+	}
+
+	/// Does a dynamic item need to be updated on menu open?
+	bool NeedsUpdate(std::pair<std::string, wxMenuItem*> const& item) {
+		cmd::Command *c = cmd::get(item.first);
+		int depends = c->Dependencies();
+		return depends & (cmd::DEPENDS_UNKNOWN | changed)
+			|| (depends & cmd::DEPENDS_OPTION && c->Option() && changed_options.count(c->Option()))
+			|| new_items.count(item.second);
+	}
+
 	/// Update a single dynamic menu item
 	void UpdateItem(std::pair<std::string, wxMenuItem*> const& item) {
 		cmd::Command *c = cmd::get(item.first);
@@ -169,10 +201,13 @@ public:
 	: context(context)
 	, hotkeys_changed(hotkey::inst->AddHotkeyChangeListener(&CommandManager::OnHotkeysChanged, this))
 	{
+		ListenForChanges();
 	}
 
 	void SetContext(agi::Context *c) {
+		if (c == context) return;
 		context = c;
+		ListenForChanges();
 	}
 
 	int AddCommand(cmd::Command *co, wxMenu *parent, std::string const& text = "") {
@@ -203,8 +238,16 @@ public:
 		parent->Append(item);
 		items.push_back(co->name());
 
-		if (flags != cmd::COMMAND_NORMAL)
+		if (flags != cmd::COMMAND_NORMAL) {
 			dynamic_items.emplace_back(co->name(), item);
+			new_items.insert(item);
+
+			const char *option = co->Option();
+			if (co->Dependencies() & cmd::DEPENDS_OPTION && option && !option_slots.count(option)) {
+				std::string name = option;
+				option_slots[name] = OPT_SUB(name, [=](agi::OptionValue const&) { changed_options.insert(name); });
+			}
+		}
 		else
 			static_items.emplace_back(co->name(), item);
 
@@ -217,6 +260,7 @@ public:
 			return o.second == item;
 		};
 
+		new_items.erase(item);
 		auto it = find_if(dynamic_items.begin(), dynamic_items.end(), pred);
 		if (it != dynamic_items.end())
 			dynamic_items.erase(it);
@@ -236,7 +280,13 @@ public:
 	void OnMenuOpen(wxMenuEvent &) {
 		if (!context)
 			return;
-		for (auto const& item : dynamic_items) UpdateItem(item);
+		for (auto const& item : dynamic_items) {
+			if (NeedsUpdate(item))
+				UpdateItem(item);
+		}
+		changed = 0;
+		changed_options.clear();
+		new_items.clear();
 		for (auto item : mru) item->Update();
 	}
 
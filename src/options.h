@@ -37,3 +37,7 @@ namespace config {
 
 /// Macro to subscribe to OptionValue changes
 #define OPT_SUB(x, ...) config::opt->Get(x)->Subscribe(__VA_ARGS__)
+
+/// Macro to get a copy of an option's value which is kept up to date, for
+/// options read on every paint or keystroke
+#define OPT_CACHE(type, x) agi::CachedOptionValue<type>(config::opt->Get(x))
@@ -0,0 +1,163 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "overlap_index.h"
+
+#include "ass_dialogue.h"
+#include "ass_file.h"
+#include "include/aegisub/context.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+OverlapIndex::OverlapIndex(agi::Context *c)
+: c(c)
+, commit_connection(c->ass->AddCommitListener(&OverlapIndex::OnCommit, this))
+{
+}
+
+void OverlapIndex::OnCommit(int type, const AssDialogue *single_line) {
+	if (dirty) return;
+
+	if (type == AssFile::COMMIT_NEW || type & AssFile::COMMIT_DIAG_ADDREM) {
+		dirty = true;
+		dirty_lines.clear();
+	}
+	else if (type & (AssFile::COMMIT_DIAG_META | AssFile::COMMIT_DIAG_TIME)) {
+		if (single_line)
+			dirty_lines.push_back(single_line);
+		else {
+			dirty = true;
+			dirty_lines.clear();
+		}
+	}
+}
+
+void OverlapIndex::Update(entry& e) {
+	AssDialogue *line = e.line;
+	group_key key(boost::to_lower_copy(line->Style.get()), line->Layer);
+	int start = line->Start;
+	int end = line->End;
+
+	if (e.indexed && e.key == key && e.start == start && e.end == end)
+		return;
+
+	Remove(e);
+	e.key = std::move(key);
+	e.start = start;
+	e.end = end;
+	e.indexed = true;
+	if (start < end)
+		groups[e.key].insert(start, end, line);
+	else
+		points.emplace(start, line);
+}
+
+void OverlapIndex::Remove(entry const& e) {
+	if (!e.indexed) return;
+
+	if (e.start >= e.end) {
+		auto range = points.equal_range(e.start);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == e.line) {
+				points.erase(it);
+				break;
+			}
+		}
+		return;
+	}
+
+	auto it = groups.find(e.key);
+	if (it == groups.end()) return;
+	it->second.erase(e.start, e.end, e.line);
+	if (it->second.empty())
+		groups.erase(it);
+}
+
+void OverlapIndex::Sync() {
+	if (!dirty) {
+		for (auto line : dirty_lines) {
+			auto it = lines.find(line);
+			if (it != lines.end())
+				Update(it->second);
+		}
+		dirty_lines.clear();
+		return;
+	}
+
+	generation = !generation;
+	for (auto& line : c->ass->Events) {
+		auto it = lines.find(&line);
+		// A line which has been deleted may have had its memory reused
+		if (it != lines.end() && it->second.id != line.Id) {
+			Remove(it->second);
+			lines.erase(it);
+			it = lines.end();
+		}
+		if (it == lines.end())
+			it = lines.emplace(&line, entry{&line, line.Id, group_key(), 0, 0, false, generation}).first;
+
+		it->second.seen = generation;
+		Update(it->second);
+	}
+
+	for (auto it = lines.begin(); it != lines.end(); ) {
+		if (it->second.seen != generation) {
+			Remove(it->second);
+			it = lines.erase(it);
+		}
+		else
+			++it;
+	}
+
+	dirty = false;
+}
+
+std::vector<AssDialogue *> OverlapIndex::GetColliding(const AssDialogue *line) {
+	std::vector<AssDialogue *> ret;
+	if (!line) return ret;
+	Sync();
+
+	int start = line->Start;
+	int end = line->End;
+	auto add = [&](AssDialogue *d) { if (d != line) ret.push_back(d); };
+
+	if (start < end) {
+		for (auto const& g : groups)
+			g.second.for_each_overlapping(start, end, add);
+		for (auto it = points.lower_bound(start), last = points.lower_bound(end); it != last; ++it)
+			add(it->second);
+	}
+	else {
+		for (auto const& g : groups) {
+			g.second.for_each_overlapping(start, start + 1, [&](AssDialogue *d) {
+				if (d->Start < start) add(d);
+			});
+		}
+	}
+	return ret;
+}
+
+std::vector<std::pair<AssDialogue *, AssDialogue *>> OverlapIndex::GetAllOverlaps() {
+	Sync();
+
+	std::vector<std::pair<AssDialogue *, AssDialogue *>> ret;
+	for (auto const& g : groups) {
+		g.second.for_each_overlapping_pair([&](AssDialogue *a, AssDialogue *b) {
+			ret.emplace_back(a, b);
+		});
+	}
+	return ret;
+}
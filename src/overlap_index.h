@@ -0,0 +1,87 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/interval_tree.h>
+#include <libaegisub/signal.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace agi { struct Context; }
+class AssDialogue;
+
+/// @class OverlapIndex
+/// @brief Index of the time ranges of all lines in the file
+///
+/// Lines are grouped by style and layer, as lines in different groups can
+/// overlap without colliding on screen. Commented lines are included, so
+/// callers which only care about visible lines have to skip them. The index
+/// is updated lazily from the commits since it was last queried, so
+/// single-line commits cost O(log n) and other commits a walk over the lines
+/// without any re-sorting.
+class OverlapIndex {
+	typedef std::pair<std::string, int> group_key;
+	typedef agi::interval_tree<AssDialogue *> group;
+
+	struct entry {
+		AssDialogue *line;
+		int id;
+		group_key key;
+		int start;
+		int end;
+		/// Is the line currently in groups or points?
+		bool indexed;
+		bool seen;
+	};
+
+	agi::Context *c;
+	agi::signal::Connection commit_connection;
+
+	/// Lines with a non-zero duration
+	std::map<group_key, group> groups;
+	/// Lines with a zero (or negative) duration by start time, which the
+	/// interval trees can't hold as they never overlap anything
+	std::multimap<int, AssDialogue *> points;
+	std::unordered_map<const AssDialogue *, entry> lines;
+
+	/// Lines which have changed since the last sync
+	std::vector<const AssDialogue *> dirty_lines;
+	/// Has something other than individual lines changed since the last sync?
+	bool dirty = true;
+	/// Flipped on each full sync to find the lines which have gone away
+	bool generation = false;
+
+	void OnCommit(int type, const AssDialogue *single_line);
+	void Sync();
+	void Update(entry& e);
+	void Remove(entry const& e);
+
+public:
+	OverlapIndex(agi::Context *c);
+
+	/// Get every line which overlaps the given line in time, regardless of
+	/// style and layer. A zero-length line collides with the lines it falls
+	/// within, excluding their start time when it's the one being tested.
+	std::vector<AssDialogue *> GetColliding(const AssDialogue *line);
+
+	/// Get every pair of lines with the same style and layer which overlap
+	std::vector<std::pair<AssDialogue *, AssDialogue *>> GetAllOverlaps();
+};
@@ -128,6 +128,7 @@ void Audio(wxTreebook *book, Preferences *parent) {
 	auto general = p->PageSizer(_("Options"));
 	p->OptionAdd(general, _("Default mouse wheel to zoom"), "Audio/Wheel Default to Zoom");
 	p->OptionAdd(general, _("Lock scroll on cursor"), "Audio/Lock Scroll on Cursor");
+	p->OptionAdd(general, _("Scroll smoothly when following playback"), "Audio/Smooth Scroll");
 	p->OptionAdd(general, _("Snap markers by default"), "Audio/Snap/Enable");
 	p->OptionAdd(general, _("Auto-focus on mouse over"), "Audio/Auto/Focus");
 	p->OptionAdd(general, _("Play audio when stepping in video"), "Audio/Plays When Stepping Video");
@@ -135,6 +136,7 @@ void Audio(wxTreebook *book, Preferences *parent) {
 	p->OptionAdd(general, _("Default timing length (ms)"), "Timing/Default Duration", 0, 36000);
 	p->OptionAdd(general, _("Default lead-in length (ms)"), "Audio/Lead/IN", 0, 36000);
 	p->OptionAdd(general, _("Default lead-out length (ms)"), "Audio/Lead/OUT", 0, 36000);
+	p->OptionAdd(general, _("Playback channel (0 for all)"), "Audio/Channel", 0, 64);
 
 	p->OptionAdd(general, _("Marker drag-start sensitivity (px)"), "Audio/Start Drag Sensitivity", 1, 15);
 	p->OptionAdd(general, _("Line boundary thickness (px)"), "Audio/Line Boundaries Thickness", 1, 5);
@@ -151,7 +153,9 @@ void Audio(wxTreebook *book, Preferences *parent) {
 	p->OptionAdd(display, _("Keyframes in karaoke mode"), "Audio/Display/Draw/Keyframes in Karaoke Mode");
 	p->OptionAdd(display, _("Cursor time"), "Audio/Display/Draw/Cursor Time");
 	p->OptionAdd(display, _("Video position"), "Audio/Display/Draw/Video Position");
+	p->OptionAdd(display, _("Video thumbnails"), "Audio/Display/Draw/Video Thumbnails");
 	p->OptionAdd(display, _("Seconds boundaries"), "Audio/Display/Draw/Seconds");
+	p->OptionAdd(display, _("Separate channels"), "Audio/Display/Separate Channels");
 	p->CellSkip(display);
 	p->OptionChoice(display, _("Waveform Style"), AudioWaveformRenderer::GetWaveformStyles(), "Audio/Display/Waveform Style");
 
@@ -167,7 +171,7 @@ void Video(wxTreebook *book, Preferences *parent) {
 
 	auto general = p->PageSizer(_("Options"));
 	p->OptionAdd(general, _("Show keyframes in slider"), "Video/Slider/Show Keyframes");
-	p->CellSkip(general);
+	p->OptionAdd(general, _("Show thumbnails in slider"), "Video/Slider/Show Thumbnails");
 	p->OptionAdd(general, _("Only show visual tools when mouse is over video"), "Tool/Visual/Autohide");
 	p->CellSkip(general);
 	p->OptionAdd(general, _("Seek video to line start on selection change"), "Video/Subtitle Sync");
@@ -301,6 +305,7 @@ void Backup(wxTreebook *book, Preferences *parent) {
 		p->OptionAdd(save, _("Interval in seconds"), "App/Auto/Save Every Seconds", 1));
 	p->OptionBrowse(save, _("Path"), "Path/Auto/Save", cb, true);
 	p->OptionAdd(save, _("Autosave after every change"), "App/Auto/Save on Every Change");
+	p->OptionAdd(save, _("Journal changes instead of autosaving"), "App/Auto/Journal");
 
 	auto backup = p->PageSizer(_("Automatic Backup"));
 	cb = p->OptionAdd(backup, _("Enable"), "App/Auto/Backup");
@@ -328,6 +333,8 @@ void Automation(wxTreebook *book, Preferences *parent) {
 	wxArrayString ar_choice(4, ar_arr);
 	p->OptionChoice(general, _("Autoreload on Export"), ar_choice, "Automation/Autoreload Mode");
 
+	p->OptionAdd(general, _("Macro validation time limit (ms)"), "Automation/Validation Budget", 1, 10000);
+
 	p->SetSizerAndFit(p->sizer);
 }
 
@@ -343,6 +350,13 @@ void Advanced(wxTreebook *book, Preferences *parent) {
 	warning->Wrap(400);
 	general->Add(warning, 0, wxALL, 5);
 
+	auto log = p->PageSizer(_("Logging"));
+	const wxString level_arr[5] = { _("Exceptions"), _("Asserts"), _("Warnings"), _("Information"), _("Debug") };
+	wxArrayString level_choice(5, level_arr);
+	p->OptionChoice(log, _("Least severe messages to log"), level_choice, "App/Log/Level");
+	p->OptionAdd(log, _("Sections not to log (comma-separated)"), "App/Log/Disabled Sections");
+	p->OptionAdd(log, _("Write logs in compact binary format"), "App/Log/Binary Format");
+
 	p->SetSizerAndFit(p->sizer);
 }
 
@@ -363,6 +377,7 @@ void Advanced_Audio(wxTreebook *book, Preferences *parent) {
 	wxArrayString ct_choice(3, ct_arr);
 	p->OptionChoice(cache, _("Cache type"), ct_choice, "Audio/Cache/Type");
 	p->OptionBrowse(cache, _("Path"), "Audio/Cache/HD/Location");
+	p->OptionAdd(cache, _("Decode ahead without cache (ms)"), "Audio/Cache/Decode Ahead", 0, 30000, 100);
 
 	auto spectrum = p->PageSizer(_("Spectrum"));
 
@@ -442,6 +457,14 @@ void Advanced_Video(wxTreebook *book, Preferences *parent) {
 	p->OptionAdd(ffms, _("Enable unsafe seeking"), "Provider/Video/FFmpegSource/Unsafe Seeking");
 #endif
 
+	auto raw = p->PageSizer(_("Raw YUV and image sequences"));
+	p->OptionAdd(raw, _("Frame rate"), "Provider/Video/Raw/FPS", 1, 1000, 0.001);
+	p->OptionAdd(raw, _("Default width"), "Provider/Video/Raw/Width", 1, 16384);
+	p->OptionAdd(raw, _("Default height"), "Provider/Video/Raw/Height", 1, 16384);
+	const wxString subsampling_arr[3] = { "4:2:0", "4:2:2", "4:4:4" };
+	wxArrayString subsampling_choice(3, subsampling_arr);
+	p->OptionChoice(raw, _("Default chroma subsampling"), subsampling_choice, "Provider/Video/Raw/Chroma Subsampling");
+
 	p->SetSizerAndFit(p->sizer);
 }
 
@@ -36,6 +36,7 @@
 #include "utils.h"
 #include "video_controller.h"
 #include "video_display.h"
+#include "video_frame.h"
 
 #include <libaegisub/audio/provider.h>
 #include <libaegisub/format_path.h>
@@ -51,6 +52,7 @@
 
 Project::Project(agi::Context *c) : context(c) {
 	OPT_SUB("Audio/Cache/Type", &Project::ReloadAudio, this);
+	OPT_SUB("Audio/Channel", &Project::ReloadAudio, this);
 	OPT_SUB("Audio/Provider", &Project::ReloadAudio, this);
 	OPT_SUB("Provider/Audio/FFmpegSource/Decode Error Handling", &Project::ReloadAudio, this);
 	OPT_SUB("Provider/Avisynth/Allow Ancient", &Project::ReloadVideo, this);
@@ -303,6 +305,8 @@ bool Project::DoLoadVideo(agi::fs::path const& path) {
 		return false;
 	}
 
+	// Anything pooled is sized for the previous video
+	ReleaseFrameBuffers();
 	AnnounceVideoProviderModified(video_provider.get());
 
 	UpdateVideoProperties(context->ass.get(), video_provider.get(), context->parent);
@@ -345,6 +349,7 @@ void Project::LoadVideo(agi::fs::path path) {
 void Project::CloseVideo() {
 	AnnounceVideoProviderModified(nullptr);
 	video_provider.reset();
+	ReleaseFrameBuffers();
 	SetPath(video_file, "?video", "", "");
 	video_has_subtitles = false;
 	context->ass->Properties.ar_mode = 0;
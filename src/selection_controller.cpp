@@ -22,17 +22,28 @@
 #include "subs_controller.h"
 
 #include <algorithm>
+#include <atomic>
 
-SelectionController::SelectionController(agi::Context *c) : context(c) { }
+namespace {
+std::atomic<uint64_t> next_version{0};
+}
+
+SelectionController::SelectionController(agi::Context *c)
+: context(c)
+, version(++next_version)
+{
+}
 
 void SelectionController::SetSelectedSet(Selection new_selection) {
 	selection = std::move(new_selection);
+	version = ++next_version;
 	AnnounceSelectedSetChanged();
 }
 
 void SelectionController::SetActiveLine(AssDialogue *new_line) {
 	if (new_line != active_line) {
 		active_line = new_line;
+		version = ++next_version;
 		if (active_line)
 			context->ass->Properties.active_row = active_line->Row;
 		AnnounceActiveLineChanged(new_line);
@@ -43,6 +54,7 @@ void SelectionController::SetSelectionAndActive(Selection new_selection, AssDial
 	bool active_line_changed = new_line != active_line;
 	selection = std::move(new_selection);
 	active_line = new_line;
+	version = ++next_version;
 	if (active_line)
 		context->ass->Properties.active_row = active_line->Row;
 
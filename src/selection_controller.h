@@ -29,6 +29,7 @@
 
 #include <libaegisub/signal.h>
 
+#include <cstdint>
 #include <set>
 #include <vector>
 
@@ -45,6 +46,7 @@ class SelectionController {
 
 	Selection selection; ///< Currently selected lines
 	AssDialogue *active_line = nullptr; ///< The currently active line or 0 if none
+	uint64_t version; ///< Changed whenever the selection or active line changes; never shared with another controller
 
 public:
 	SelectionController(agi::Context *context);
@@ -81,6 +83,10 @@ public:
 	/// @return The selected set
 	Selection const& GetSelectedSet() const { return selection; }
 
+	/// Get a counter which changes whenever the selected set or active line
+	/// changes, for caching things derived from the selection
+	uint64_t GetVersion() const { return version; }
+
 	/// Get the selection sorted by row number
 	std::vector<AssDialogue *> GetSortedSelection() const;
 
@@ -19,6 +19,7 @@
 #include "options.h"
 
 #include <libaegisub/charset_conv.h>
+#include <libaegisub/dispatch.h>
 #include <libaegisub/format.h>
 #include <libaegisub/fs.h>
 #include <libaegisub/io.h>
@@ -28,11 +29,175 @@
 #include <libaegisub/make_unique.h>
 
 #include <boost/range/algorithm.hpp>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 #define HUNSPELL_STATIC
 #undef near
 #include <hunspell/hunspell.hxx>
 
+namespace {
+/// Number of words to remember the suggestions for
+const size_t suggestion_cache_size = 100;
+
+/// The parts of a dictionary which are built on the loading thread
+struct LoadedDictionary {
+	std::unique_ptr<Hunspell> hunspell;
+	std::unique_ptr<agi::charset::IconvWrapper> conv;
+	std::unique_ptr<agi::charset::IconvWrapper> rconv;
+	std::set<std::string> customWords;
+};
+
+std::set<std::string> read_user_dictionary(agi::fs::path const& path) {
+	std::set<std::string> words;
+	try {
+		auto stream = agi::io::Open(path);
+		copy_if(
+			++agi::line_iterator<std::string>(*stream), agi::line_iterator<std::string>(),
+			inserter(words, words.end()),
+			[](std::string const& str) { return !str.empty(); });
+	}
+	catch (agi::fs::FileNotFound const&) {
+		// Not an error; user dictionary just doesn't exist
+	}
+	return words;
+}
+
+std::unique_ptr<LoadedDictionary> load_dictionary(agi::fs::path const& aff, agi::fs::path const& dic, agi::fs::path const& user_dic) {
+	auto loaded = agi::make_unique<LoadedDictionary>();
+
+#ifdef _WIN32
+	// The prefix makes hunspell assume the paths are UTF-8 and use _wfopen
+	loaded->hunspell = agi::make_unique<Hunspell>(("\\\\?\\" + aff.string()).c_str(), ("\\\\?\\" + dic.string()).c_str());
+#else
+	loaded->hunspell = agi::make_unique<Hunspell>(aff.string().c_str(), dic.string().c_str());
+#endif
+
+	loaded->conv = agi::make_unique<agi::charset::IconvWrapper>("utf-8", loaded->hunspell->get_dic_encoding());
+	loaded->rconv = agi::make_unique<agi::charset::IconvWrapper>(loaded->hunspell->get_dic_encoding(), "utf-8");
+
+	loaded->customWords = read_user_dictionary(user_dic);
+	for (auto const& word : loaded->customWords) {
+		try {
+			loaded->hunspell->add(loaded->conv->Convert(word).c_str());
+		}
+		catch (agi::charset::ConvError const&) {
+			// Normally this shouldn't happen, but some versions of Aegisub
+			// wrote words in the wrong charset
+		}
+	}
+
+	return loaded;
+}
+}
+
+/// A dictionary plus the user's additions to it. Only touched on the main
+/// thread; the loading thread builds a LoadedDictionary which is moved in
+/// once it's done.
+struct HunspellSpellChecker::Dictionary {
+	/// Hunspell instance, or nullptr until loading has finished
+	std::unique_ptr<Hunspell> hunspell;
+
+	/// Conversions between the dictionary charset and utf-8
+	std::unique_ptr<agi::charset::IconvWrapper> conv;
+	std::unique_ptr<agi::charset::IconvWrapper> rconv;
+
+	/// Path to user-local dictionary.
+	agi::fs::path userDicPath;
+
+	/// Words in the custom user dictionary
+	std::set<std::string> customWords;
+
+	/// Is the dictionary still being loaded?
+	bool loading = true;
+
+	/// Recently requested suggestions, most recently used first
+	std::list<std::pair<std::string, std::vector<std::string>>> suggestions;
+	std::unordered_map<std::string, decltype(suggestions)::iterator> suggestion_index;
+
+	/// Signal for when loading finishes or the custom words change
+	agi::signal::Signal<> Changed;
+
+	/// Save words to custom dictionary
+	void WriteUserDictionary() {
+		// Ensure that the path exists
+		agi::fs::CreateDirectory(userDicPath.parent_path());
+
+		// Write the new dictionary
+		agi::io::Save writer(userDicPath);
+		writer.Get() << customWords.size() << "\n";
+		copy(customWords.begin(), customWords.end(), std::ostream_iterator<std::string>(writer.Get(), "\n"));
+		writer.Commit();
+	}
+
+	/// The custom words have changed, so cached suggestions may be wrong
+	void WordsChanged() {
+		suggestions.clear();
+		suggestion_index.clear();
+		Changed();
+	}
+
+	typedef std::map<std::string, std::weak_ptr<Dictionary>> dictionary_map;
+
+	/// Dictionaries in use by any spell checker, by the path to the .dic file.
+	/// Never destroyed, as a spell checker could outlive static destruction.
+	static dictionary_map& InUse() {
+		static auto dictionaries = new dictionary_map;
+		return *dictionaries;
+	}
+
+	/// Get the dictionary for the given files, loading it if no other spell
+	/// checker is already using it
+	static std::shared_ptr<Dictionary> Get(agi::fs::path const& aff, agi::fs::path const& dic, agi::fs::path const& user_dic) {
+		auto key = dic.string();
+		auto& cached = InUse()[key];
+		if (auto dict = cached.lock())
+			return dict;
+
+		// Drop the map entry along with the dictionary once the last spell
+		// checker using it lets go, so that dictionaries for every language
+		// ever selected don't pile up
+		std::shared_ptr<Dictionary> dict(new Dictionary, [=](Dictionary *d) {
+			auto& dictionaries = InUse();
+			auto it = dictionaries.find(key);
+			if (it != dictionaries.end() && it->second.expired())
+				dictionaries.erase(it);
+			delete d;
+		});
+		dict->userDicPath = user_dic;
+		cached = dict;
+
+		std::weak_ptr<Dictionary> weak_dict = dict;
+		agi::dispatch::Background().Async([=] {
+			std::shared_ptr<LoadedDictionary> loaded;
+			try {
+				loaded = load_dictionary(aff, dic, user_dic);
+			}
+			catch (agi::Exception const& e) {
+				LOG_E("dictionary/file") << "Failed to load " << dic << ": " << e.GetMessage();
+			}
+
+			agi::dispatch::Main().Async([=] {
+				auto dict = weak_dict.lock();
+				if (!dict) return;
+
+				dict->loading = false;
+				if (loaded) {
+					dict->hunspell = std::move(loaded->hunspell);
+					dict->conv = std::move(loaded->conv);
+					dict->rconv = std::move(loaded->rconv);
+					dict->customWords = std::move(loaded->customWords);
+				}
+				dict->WordsChanged();
+			});
+		});
+
+		return dict;
+	}
+};
+
 HunspellSpellChecker::HunspellSpellChecker()
 : lang_listener(OPT_SUB("Tool/Spell Checker/Language", &HunspellSpellChecker::OnLanguageChanged, this))
 , dict_path_listener(OPT_SUB("Path/Dictionary", &HunspellSpellChecker::OnPathChanged, this))
@@ -43,10 +208,19 @@ HunspellSpellChecker::HunspellSpellChecker()
 HunspellSpellChecker::~HunspellSpellChecker() {
 }
 
+HunspellSpellChecker::Dictionary *HunspellSpellChecker::Loaded() const {
+	return dictionary && dictionary->hunspell ? dictionary.get() : nullptr;
+}
+
+bool HunspellSpellChecker::IsLoading() {
+	return dictionary && dictionary->loading;
+}
+
 bool HunspellSpellChecker::CanAddWord(std::string const& word) {
-	if (!hunspell) return false;
+	auto dict = Loaded();
+	if (!dict) return false;
 	try {
-		conv->Convert(word);
+		dict->conv->Convert(word);
 		return true;
 	}
 	catch (agi::charset::ConvError const&) {
@@ -55,72 +229,47 @@ bool HunspellSpellChecker::CanAddWord(std::string const& word) {
 }
 
 bool HunspellSpellChecker::CanRemoveWord(std::string const& word) {
-	return !!customWords.count(word);
+	return dictionary && dictionary->customWords.count(word);
 }
 
 void HunspellSpellChecker::AddWord(std::string const& word) {
-	if (!hunspell) return;
+	auto dict = Loaded();
+	if (!dict) return;
 
 	// Add it to the in-memory dictionary
-	hunspell->add(conv->Convert(word).c_str());
+	dict->hunspell->add(dict->conv->Convert(word).c_str());
 
 	// Add the word
-	if (customWords.insert(word).second)
-		WriteUserDictionary();
+	if (dict->customWords.insert(word).second)
+		dict->WriteUserDictionary();
+
+	// Let everything using the dictionary know, including any other spell
+	// checkers, so that they can recheck words
+	dict->WordsChanged();
 }
 
 void HunspellSpellChecker::RemoveWord(std::string const& word) {
-	if (!hunspell) return;
+	auto dict = Loaded();
+	if (!dict) return;
 
 	// Remove it from the in-memory dictionary
-	hunspell->remove(conv->Convert(word).c_str());
-
-	auto word_iter = customWords.find(word);
-	if (word_iter != customWords.end()) {
-		customWords.erase(word_iter);
-
-		WriteUserDictionary();
-	}
-}
-
-void HunspellSpellChecker::ReadUserDictionary() {
-	customWords.clear();
-
-	// Read the old contents of the user's dictionary
-	try {
-		auto stream = agi::io::Open(userDicPath);
-		copy_if(
-			++agi::line_iterator<std::string>(*stream), agi::line_iterator<std::string>(),
-			inserter(customWords, customWords.end()),
-			[](std::string const& str) { return !str.empty(); });
-	}
-	catch (agi::fs::FileNotFound const&) {
-		// Not an error; user dictionary just doesn't exist
-	}
-}
+	dict->hunspell->remove(dict->conv->Convert(word).c_str());
 
-void HunspellSpellChecker::WriteUserDictionary() {
-	// Ensure that the path exists
-	agi::fs::CreateDirectory(userDicPath.parent_path());
+	auto word_iter = dict->customWords.find(word);
+	if (word_iter != dict->customWords.end()) {
+		dict->customWords.erase(word_iter);
 
-	// Write the new dictionary
-	{
-		agi::io::Save writer(userDicPath);
-		writer.Get() << customWords.size() << "\n";
-		copy(customWords.begin(), customWords.end(), std::ostream_iterator<std::string>(writer.Get(), "\n"));
+		dict->WriteUserDictionary();
 	}
 
-	// Announce a language change so that any other spellcheckers reload the
-	// current dictionary to get the addition/removal
-	lang_listener.Block();
-	OPT_SET("Tool/Spell Checker/Language")->SetString(OPT_GET("Tool/Spell Checker/Language")->GetString());
-	lang_listener.Unblock();
+	dict->WordsChanged();
 }
 
 bool HunspellSpellChecker::CheckWord(std::string const& word) {
-	if (!hunspell) return true;
+	auto dict = Loaded();
+	if (!dict) return true;
 	try {
-		return hunspell->spell(conv->Convert(word).c_str()) == 1;
+		return dict->hunspell->spell(dict->conv->Convert(word).c_str()) == 1;
 	}
 	catch (agi::charset::ConvError const&) {
 		return false;
@@ -129,16 +278,25 @@ bool HunspellSpellChecker::CheckWord(std::string const& word) {
 
 std::vector<std::string> HunspellSpellChecker::GetSuggestions(std::string const& word) {
 	std::vector<std::string> suggestions;
-	if (!hunspell) return suggestions;
+	auto dict = Loaded();
+	if (!dict) return suggestions;
+
+	// Suggestions are slow to generate, and the same word is often asked
+	// for repeatedly by the spell checker dialog and context menu
+	auto cached = dict->suggestion_index.find(word);
+	if (cached != dict->suggestion_index.end()) {
+		dict->suggestions.splice(dict->suggestions.begin(), dict->suggestions, cached->second);
+		return cached->second->second;
+	}
 
 	char **results;
-	int n = hunspell->suggest(&results, conv->Convert(word).c_str());
+	int n = dict->hunspell->suggest(&results, dict->conv->Convert(word).c_str());
 
 	suggestions.reserve(n);
 	// Convert suggestions to UTF-8
 	for (int i = 0; i < n; ++i) {
 		try {
-			suggestions.push_back(rconv->Convert(results[i]));
+			suggestions.push_back(dict->rconv->Convert(results[i]));
 		}
 		catch (agi::charset::ConvError const&) {
 			// Shouldn't ever actually happen...
@@ -148,6 +306,13 @@ std::vector<std::string> HunspellSpellChecker::GetSuggestions(std::string const&
 
 	free(results);
 
+	dict->suggestions.emplace_front(word, suggestions);
+	dict->suggestion_index[word] = dict->suggestions.begin();
+	if (dict->suggestions.size() > suggestion_cache_size) {
+		dict->suggestion_index.erase(dict->suggestions.back().first);
+		dict->suggestions.pop_back();
+	}
+
 	return suggestions;
 }
 
@@ -181,44 +346,29 @@ static bool check_path(agi::fs::path const& path, std::string const& language, a
 }
 
 void HunspellSpellChecker::OnLanguageChanged() {
-	hunspell.reset();
+	dictionary_listener.Disconnect();
+	dictionary.reset();
 
 	auto language = OPT_GET("Tool/Spell Checker/Language")->GetString();
-	if (language.empty()) return;
-
-	agi::fs::path aff, dic;
-	auto path = config::path->Decode(OPT_GET("Path/Dictionary")->GetString() + "/");
-	if (!check_path(path, language, aff, dic)) {
-		path = config::path->Decode("?dictionary/");
-		if (!check_path(path, language, aff, dic))
-			return;
-	}
-
-	LOG_I("dictionary/file") << dic;
-
-#ifdef _WIN32
-	// The prefix makes hunspell assume the paths are UTF-8 and use _wfopen
-	hunspell = agi::make_unique<Hunspell>(("\\\\?\\" + aff.string()).c_str(), ("\\\\?\\" + dic.string()).c_str());
-#else
-	hunspell = agi::make_unique<Hunspell>(aff.string().c_str(), dic.string().c_str());
-#endif
-	if (!hunspell) return;
-
-	conv = agi::make_unique<agi::charset::IconvWrapper>("utf-8", hunspell->get_dic_encoding());
-	rconv = agi::make_unique<agi::charset::IconvWrapper>(hunspell->get_dic_encoding(), "utf-8");
+	if (!language.empty()) {
+		agi::fs::path aff, dic;
+		auto path = config::path->Decode(OPT_GET("Path/Dictionary")->GetString() + "/");
+		bool found = check_path(path, language, aff, dic);
+		if (!found) {
+			path = config::path->Decode("?dictionary/");
+			found = check_path(path, language, aff, dic);
+		}
 
-	userDicPath = config::path->Decode("?user/dictionaries")/agi::format("user_%s.dic", language);
-	ReadUserDictionary();
+		if (found) {
+			LOG_I("dictionary/file") << dic;
 
-	for (auto const& word : customWords) {
-		try {
-			hunspell->add(conv->Convert(word).c_str());
-		}
-		catch (agi::charset::ConvError const&) {
-			// Normally this shouldn't happen, but some versions of Aegisub
-			// wrote words in the wrong charset
+			auto userDicPath = config::path->Decode("?user/dictionaries")/agi::format("user_%s.dic", language);
+			dictionary = Dictionary::Get(aff, dic, userDicPath);
+			dictionary_listener = dictionary->Changed.Connect([=] { DictionaryChanged(); });
 		}
 	}
+
+	DictionaryChanged();
 }
 
 void HunspellSpellChecker::OnPathChanged() {
@@ -22,34 +22,29 @@
 #ifdef WITH_HUNSPELL
 #include <libaegisub/spellchecker.h>
 
-#include <libaegisub/fs_fwd.h>
 #include <libaegisub/signal.h>
 
-#include <boost/filesystem/path.hpp>
 #include <memory>
-#include <set>
-
-namespace agi { namespace charset { class IconvWrapper; } }
-class Hunspell;
+#include <string>
+#include <vector>
 
 /// @brief Hunspell-based spell checker implementation
+///
+/// Dictionaries are loaded on a background thread and shared by all of the
+/// spell checkers using the same one, so opening the spell checker dialog
+/// doesn't load the dictionary a second time.
 class HunspellSpellChecker final : public agi::SpellChecker {
-	/// Hunspell instance
-	std::unique_ptr<Hunspell> hunspell;
+	struct Dictionary;
+
+	/// Dictionary for the current language, or nullptr if there isn't one
+	std::shared_ptr<Dictionary> dictionary;
 
-	/// Conversions between the dictionary charset and utf-8
-	std::unique_ptr<agi::charset::IconvWrapper> conv;
-	std::unique_ptr<agi::charset::IconvWrapper> rconv;
+	/// Connection to the dictionary's change signal
+	agi::signal::Connection dictionary_listener;
 
 	/// Languages which we have dictionaries for
 	std::vector<std::string> languages;
 
-	/// Path to user-local dictionary.
-	agi::fs::path userDicPath;
-
-	/// Words in the custom user dictionary
-	std::set<std::string> customWords;
-
 	/// Dictionary language change connection
 	agi::signal::Connection lang_listener;
 	/// Dictionary language change handler
@@ -60,10 +55,8 @@ class HunspellSpellChecker final : public agi::SpellChecker {
 	/// Dictionary path change handler
 	void OnPathChanged();
 
-	/// Load words from custom dictionary
-	void ReadUserDictionary();
-	/// Save words to custom dictionary
-	void WriteUserDictionary();
+	/// Get the current dictionary if it has finished loading
+	Dictionary *Loaded() const;
 
 public:
 	HunspellSpellChecker();
@@ -76,6 +69,7 @@ public:
 	bool CheckWord(std::string const& word) override;
 	std::vector<std::string> GetSuggestions(std::string const& word) override;
 	std::vector<std::string> GetLanguageList() override;
+	bool IsLoading() override;
 };
 
 #endif
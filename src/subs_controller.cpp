@@ -29,12 +29,14 @@
 #include "options.h"
 #include "project.h"
 #include "selection_controller.h"
+#include "subs_journal.h"
 #include "subtitle_format.h"
 #include "text_selection_controller.h"
 
 #include <libaegisub/dispatch.h>
 #include <libaegisub/format_path.h>
 #include <libaegisub/fs.h>
+#include <libaegisub/make_unique.h>
 #include <libaegisub/path.h>
 #include <libaegisub/util.h>
 
@@ -68,7 +70,7 @@ struct SubsController::UndoInfo {
 	: undo_description(d)
 	, commit_id(commit_id)
 	, attachments(c->ass->Attachments)
-	, extradata(c->ass->Extradata)
+	, extradata(c->ass->Extradata.Entries())
 	{
 		script_info.reserve(c->ass->Info.size());
 		for (auto const& info : c->ass->Info)
@@ -113,7 +115,7 @@ struct SubsController::UndoInfo {
 			if (binary_search(begin(selection), end(selection), copy->Id))
 				new_sel.insert(copy);
 		}
-		c->ass->Extradata = extradata;
+		c->ass->Extradata.Assign(extradata);
 
 		c->ass->Commit("", AssFile::COMMIT_NEW);
 		c->selectionController->SetSelectionAndActive(std::move(new_sel), active_line);
@@ -147,7 +149,8 @@ SubsController::SubsController(agi::Context *context)
 : context(context)
 , undo_connection(context->ass->AddUndoManager(&SubsController::OnCommit, this))
 , text_selection_connection(context->textSelectionController->AddSelectionListener(&SubsController::OnTextSelectionChanged, this))
-, autosave_queue(agi::dispatch::Create())
+, autosave_queue(agi::dispatch::Create(agi::dispatch::PRIORITY_BACKGROUND))
+, journal(agi::make_unique<SubsJournal>(context, *autosave_queue))
 {
 	autosave_timer_changed(&autosave_timer);
 	OPT_SUB("App/Auto/Save", [=] { autosave_timer_changed(&autosave_timer); });
@@ -174,6 +177,7 @@ ProjectProperties SubsController::Load(agi::fs::path const& filename, std::strin
 	auto props = context->ass->Properties;
 
 	SetFileName(filename);
+	journal->Reset(filename);
 
 	// Push the initial state of the file onto the undo stack
 	undo_stack.clear();
@@ -222,6 +226,7 @@ void SubsController::Save(agi::fs::path const& filename, std::string const& enco
 	}
 
 	SetFileName(filename);
+	journal->Reset(filename);
 }
 
 void SubsController::Close() {
@@ -232,6 +237,7 @@ void SubsController::Close() {
 	AssFile blank;
 	blank.swap(*context->ass);
 	context->ass->LoadDefault(true, OPT_GET("Subtitle Format/ASS/Default Style Catalog")->GetString());
+	journal->Reset(filename);
 	context->ass->Commit("", AssFile::COMMIT_NEW);
 	FileOpen(filename);
 }
@@ -253,7 +259,7 @@ int SubsController::TryToClose(bool allow_cancel) const {
 }
 
 void SubsController::AutoSave() {
-	if (commit_id == autosaved_commit_id)
+	if (commit_id == autosaved_commit_id || journal->IsActive())
 		return;
 
 	auto directory = context->path->Decode(OPT_GET("Path/Auto/Save")->GetString());
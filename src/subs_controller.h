@@ -22,6 +22,7 @@
 #include <wx/timer.h>
 
 class SelectionController;
+class SubsJournal;
 namespace agi {
 	namespace dispatch {
 		class Queue;
@@ -59,6 +60,9 @@ class SubsController {
 	/// Queue which autosaves are performed on
 	std::unique_ptr<agi::dispatch::Queue> autosave_queue;
 
+	/// Journal of changes for crash recovery, written on the autosave queue
+	std::unique_ptr<SubsJournal> journal;
+
 	/// A new file has been opened (filename)
 	agi::signal::Signal<agi::fs::path> FileOpen;
 	/// The file has been saved
@@ -71,6 +75,7 @@ class SubsController {
 	void SetFileName(agi::fs::path const& file);
 
 	/// Autosave the file if there have been any chances since the last autosave
+	/// and the changes aren't already being journaled
 	void AutoSave();
 
 	void OnCommit(AssFileCommit c);
@@ -40,7 +40,6 @@
 #include "command/command.h"
 #include "compat.h"
 #include "dialog_style_editor.h"
-#include "flyweight_hash.h"
 #include "include/aegisub/context.h"
 #include "include/aegisub/hotkey.h"
 #include "initial_line_state.h"
@@ -59,7 +58,6 @@
 #include <libaegisub/util.h>
 
 #include <functional>
-#include <unordered_set>
 
 #include <wx/bmpbuttn.h>
 #include <wx/button.h>
@@ -105,6 +103,10 @@ const auto AssDialogue_Effect = &AssDialogue::Effect;
 SubsEditBox::SubsEditBox(wxWindow *parent, agi::Context *context)
 : wxPanel(parent, -1, wxDefaultPosition, wxDefaultSize, wxTAB_TRAVERSAL | wxRAISED_BORDER, "SubsEditBox")
 , c(context)
+, ignore_whitespace(OPT_CACHE(bool, "Subtitle/Character Counter/Ignore Whitespace"))
+, ignore_punctuation(OPT_CACHE(bool, "Subtitle/Character Counter/Ignore Punctuation"))
+, character_limit(OPT_CACHE(int64_t, "Subtitle/Character Limit"))
+, error_colour(OPT_CACHE(agi::Color, "Colour/Subtitle/Syntax/Background/Error"))
 , undo_timer(GetEventHandler())
 {
 	using std::bind;
@@ -321,8 +323,8 @@ void SubsEditBox::OnCommit(int type) {
 	}
 
 	if (type == AssFile::COMMIT_NEW) {
-		PopulateList(effect_box, AssDialogue_Effect);
-		PopulateList(actor_box, AssDialogue_Actor);
+		PopulateList(effect_box, FieldValueIndex::EFFECT);
+		PopulateList(actor_box, FieldValueIndex::ACTOR);
 		return;
 	}
 	else if (type & AssFile::COMMIT_STYLES)
@@ -357,32 +359,29 @@ void SubsEditBox::UpdateFields(int type, bool repopulate_lists) {
 		active_style = line ? c->ass->GetStyle(line->Style) : nullptr;
 		style_edit_button->Enable(active_style != nullptr);
 
-		if (repopulate_lists) PopulateList(effect_box, AssDialogue_Effect);
+		if (repopulate_lists) PopulateList(effect_box, FieldValueIndex::EFFECT);
 		effect_box->ChangeValue(to_wx(line->Effect));
 		effect_box->SetStringSelection(to_wx(line->Effect));
 
-		if (repopulate_lists) PopulateList(actor_box, AssDialogue_Actor);
+		if (repopulate_lists) PopulateList(actor_box, FieldValueIndex::ACTOR);
 		actor_box->ChangeValue(to_wx(line->Actor));
 		actor_box->SetStringSelection(to_wx(line->Actor));
 	}
 }
 
-void SubsEditBox::PopulateList(wxComboBox *combo, boost::flyweight<std::string> AssDialogue::*field) {
-	wxEventBlocker blocker(this);
+void SubsEditBox::PopulateList(wxComboBox *combo, FieldValueIndex::Field field) {
+	uint64_t version = c->fieldValues->GetVersion(field);
+	if (list_versions[field] == version) return;
+	list_versions[field] = version;
 
-	std::unordered_set<boost::flyweight<std::string>> values;
-	for (auto const& line : c->ass->Events) {
-		auto const& value = line.*field;
-		if (!value.get().empty())
-			values.insert(value);
-	}
+	wxEventBlocker blocker(this);
 
+	// The index keeps the values sorted by code point
+	auto const& values = c->fieldValues->GetCounts(field);
 	wxArrayString arrstr;
 	arrstr.reserve(values.size());
-	transform(values.begin(), values.end(), std::back_inserter(arrstr),
-		(wxString (*)(std::string const&))to_wx);
-
-	arrstr.Sort();
+	for (auto const& value : values)
+		arrstr.push_back(to_wx(value.first));
 
 	combo->Freeze();
 	long pos = combo->GetInsertionPoint();
@@ -432,6 +431,8 @@ void SubsEditBox::OnKeyDown(wxKeyEvent &event) {
 }
 
 void SubsEditBox::OnChange(wxStyledTextEvent &event) {
+	// The edit control also tracks what was edited for restyling
+	event.Skip();
 	if (line && edit_ctrl->GetTextRaw().data() != line->Text.get()) {
 		if (event.GetModificationType() & wxSTC_STARTACTION)
 			commit_id = -1;
@@ -594,7 +595,7 @@ void SubsEditBox::OnStyleChange(wxCommandEvent &evt) {
 void SubsEditBox::OnActorChange(wxCommandEvent &evt) {
 	bool amend = evt.GetEventType() == wxEVT_TEXT;
 	SetSelectedRows(AssDialogue_Actor, new_value(actor_box, evt), _("actor change"), AssFile::COMMIT_DIAG_META, amend);
-	PopulateList(actor_box, AssDialogue_Actor);
+	PopulateList(actor_box, FieldValueIndex::ACTOR);
 }
 
 void SubsEditBox::OnLayerEnter(wxCommandEvent &evt) {
@@ -604,7 +605,7 @@ void SubsEditBox::OnLayerEnter(wxCommandEvent &evt) {
 void SubsEditBox::OnEffectChange(wxCommandEvent &evt) {
 	bool amend = evt.GetEventType() == wxEVT_TEXT;
 	SetSelectedRows(AssDialogue_Effect, new_value(effect_box, evt), _("effect change"), AssFile::COMMIT_DIAG_META, amend);
-	PopulateList(effect_box, AssDialogue_Effect);
+	PopulateList(effect_box, FieldValueIndex::EFFECT);
 }
 
 void SubsEditBox::OnCommentChange(wxCommandEvent &evt) {
@@ -618,15 +619,15 @@ void SubsEditBox::CallCommand(const char *cmd_name) {
 
 void SubsEditBox::UpdateCharacterCount(std::string const& text) {
 	int ignore = agi::IGNORE_BLOCKS;
-	if (OPT_GET("Subtitle/Character Counter/Ignore Whitespace")->GetBool())
+	if (*ignore_whitespace)
 		ignore |= agi::IGNORE_WHITESPACE;
-	if (OPT_GET("Subtitle/Character Counter/Ignore Punctuation")->GetBool())
+	if (*ignore_punctuation)
 		ignore |= agi::IGNORE_PUNCTUATION;
 	size_t length = agi::MaxLineLength(text, ignore);
 	char_count->SetValue(std::to_wstring(length));
-	size_t limit = (size_t)OPT_GET("Subtitle/Character Limit")->GetInt();
+	size_t limit = (size_t)*character_limit;
 	if (limit && length > limit)
-		char_count->SetBackgroundColour(to_wx(OPT_GET("Colour/Subtitle/Syntax/Background/Error")->GetColor()));
+		char_count->SetBackgroundColour(to_wx(*error_colour));
 	else
 		char_count->SetBackgroundColour(wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOW));
 }
@@ -36,6 +36,9 @@
 #include <wx/panel.h>
 #include <wx/timer.h>
 
+#include "field_value_index.h"
+
+#include <libaegisub/option_value.h>
 #include <libaegisub/signal.h>
 
 namespace agi { namespace vfr { class Framerate; } }
@@ -80,6 +83,12 @@ class SubsEditBox final : public wxPanel {
 
 	agi::Context *c;
 
+	/// Options read by UpdateCharacterCount on every keystroke
+	agi::CachedOptionValue<bool> ignore_whitespace;
+	agi::CachedOptionValue<bool> ignore_punctuation;
+	agi::CachedOptionValue<int64_t> character_limit;
+	agi::CachedOptionValue<agi::Color> error_colour;
+
 	agi::signal::Connection file_changed_slot;
 
 	// Box controls
@@ -115,6 +124,10 @@ class SubsEditBox final : public wxPanel {
 	/// Last commit ID for undo coalescing
 	int commit_id = -1;
 
+	/// FieldValueIndex versions the actor and effect lists were last
+	/// populated from
+	std::array<uint64_t, FieldValueIndex::FIELD_COUNT> list_versions = {{0, 0, 0}};
+
 	/// Last used commit message to avoid coalescing different types of changes
 	wxString last_commit_type;
 
@@ -181,8 +194,9 @@ class SubsEditBox final : public wxPanel {
 
 	void UpdateFields(int type, bool repopulate_lists);
 
-	/// Regenerate a dropdown list with the unique values of a dialogue field
-	void PopulateList(wxComboBox *combo, boost::flyweight<std::string> AssDialogue::*field);
+	/// Regenerate a dropdown list with the unique values of a dialogue field,
+	/// if they have changed since the list was last populated
+	void PopulateList(wxComboBox *combo, FieldValueIndex::Field field);
 
 	/// @brief Enable or disable frame timing mode
 	void UpdateFrameTiming(agi::vfr::Framerate const& fps);
@@ -122,14 +122,24 @@ SubsTextEditCtrl::SubsTextEditCtrl(wxWindow* parent, wxSize wsize, long style, a
 	Bind(wxEVT_CONTEXT_MENU, &SubsTextEditCtrl::OnContextMenu, this);
 	Bind(wxEVT_IDLE, std::bind(&SubsTextEditCtrl::UpdateCallTip, this));
 	Bind(wxEVT_STC_DOUBLECLICK, &SubsTextEditCtrl::OnDoubleClick, this);
+	Bind(wxEVT_STC_MODIFIED, [=](wxStyledTextEvent &evt) {
+		evt.Skip();
+		int type = evt.GetModificationType();
+		if (!(type & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))) return;
+
+		size_t pos = evt.GetPosition();
+		size_t end = type & wxSTC_MOD_INSERTTEXT ? pos + evt.GetLength() : pos;
+		edit_start = std::min(edit_start, pos);
+		edit_tail = std::min(edit_tail, static_cast<size_t>(GetLength()) - end);
+	});
 	Bind(wxEVT_STC_STYLENEEDED, [=](wxStyledTextEvent&) {
 		{
 			std::string text = GetTextRaw().data();
-			if (text == line_text) return;
+			if (text == line_text && edit_start >= text.size()) return;
 			line_text = move(text);
 		}
 
-		UpdateStyle();
+		UpdateEditedStyle();
 	});
 
 	OPT_SUB("Subtitle/Edit Box/Font Face", &SubsTextEditCtrl::SetStyles, this);
@@ -150,6 +160,11 @@ SubsTextEditCtrl::SubsTextEditCtrl(wxWindow* parent, wxSize wsize, long style, a
 	OPT_SUB("Subtitle/Highlight/Syntax", &SubsTextEditCtrl::UpdateStyle, this);
 	OPT_SUB("App/Call Tips", &SubsTextEditCtrl::UpdateCallTip, this);
 
+	// Dictionaries load in the background and may be shared with other
+	// controls, so restyle whenever the dictionary says its words changed
+	if (spellchecker)
+		spellchecker->AddDictionaryChangedListener(&SubsTextEditCtrl::UpdateStyle, this);
+
 	Bind(wxEVT_MENU, [=](wxCommandEvent&) {
 		if (spellchecker) spellchecker->AddWord(currentWord);
 		UpdateStyle();
@@ -252,37 +267,64 @@ void SubsTextEditCtrl::SetStyles() {
 }
 
 void SubsTextEditCtrl::UpdateStyle() {
+	highlighter.Reset();
+	edit_start = edit_tail = 0;
+	UpdateEditedStyle();
+}
+
+void SubsTextEditCtrl::UpdateEditedStyle() {
 	AssDialogue *diag = context ? context->selectionController->GetActiveLine() : nullptr;
 	bool template_line = diag && diag->Comment && boost::istarts_with(diag->Effect.get(), "template");
 
-	tokenized_line = agi::ass::TokenizeDialogueBody(line_text, template_line);
-	agi::ass::SplitWords(line_text, tokenized_line);
+	// Scintilla keeps the styles of the text around an edit, so only the
+	// styles which the highlighter recalculated need to be set
+	auto range = highlighter.Update(line_text, template_line, spellchecker.get(), edit_start, edit_tail);
+	edit_start = edit_tail = line_text.size();
 
 	cursor_pos = -1;
 	UpdateCallTip();
 
-	StartStyling(0,255);
-
 	if (!OPT_GET("Subtitle/Highlight/Syntax")->GetBool()) {
+		StartStyling(0,255);
 		SetStyling(line_text.size(), 0);
 		return;
 	}
 
-	if (line_text.empty()) return;
+	ApplyStyles(range.first, range.second);
+	StartStyling(line_text.size(), 255);
+}
+
+void SubsTextEditCtrl::ApplyStyles(size_t begin, size_t end) {
+	if (begin >= end) return;
 
+	StartStyling(begin, 255);
 	SetIndicatorCurrent(0);
+
 	size_t pos = 0;
-	for (auto const& style_range : agi::ass::SyntaxHighlight(line_text, tokenized_line, spellchecker.get())) {
-		if (style_range.type == agi::ass::SyntaxStyle::SPELLING) {
-			SetStyling(style_range.length, agi::ass::SyntaxStyle::NORMAL);
-			IndicatorFillRange(pos, style_range.length);
+	size_t run_start = begin;
+	int run_style = -1;
+	auto flush = [&] {
+		if (run_start == pos) return;
+		if (run_style == agi::ass::SyntaxStyle::SPELLING) {
+			SetStyling(pos - run_start, agi::ass::SyntaxStyle::NORMAL);
+			IndicatorFillRange(run_start, pos - run_start);
 		}
 		else {
-			SetStyling(style_range.length, style_range.type);
-			IndicatorClearRange(pos, style_range.length);
+			SetStyling(pos - run_start, run_style);
+			IndicatorClearRange(run_start, pos - run_start);
+		}
+		run_start = pos;
+	};
+
+	for (auto const& style : highlighter.GetStyles()) {
+		if (pos >= end) break;
+		if (pos >= begin && style.type != run_style) {
+			flush();
+			run_style = style.type;
 		}
-		pos += style_range.length;
+		pos += style.length;
 	}
+	flush();
 }
 
 void SubsTextEditCtrl::UpdateCallTip() {
@@ -292,7 +334,7 @@ void SubsTextEditCtrl::UpdateCallTip() {
 	if (pos == cursor_pos) return;
 	cursor_pos = pos;
 
-	agi::Calltip new_calltip = agi::GetCalltip(tokenized_line, line_text, pos);
+	agi::Calltip new_calltip = agi::GetCalltip(highlighter.GetTokens(), line_text, pos);
 
 	if (!new_calltip.text) {
 		CallTipCancel();
@@ -318,6 +360,8 @@ void SubsTextEditCtrl::SetTextTo(std::string const& text) {
 		line_text = GetTextRaw().data();
 	auto old_pos = agi::CharacterCount(line_text.begin(), line_text.begin() + insertion_point, 0);
 	line_text.clear();
+	// Modification events aren't seen while the event handler is disabled
+	edit_start = edit_tail = 0;
 
 	if (context) {
 		context->textSelectionController->SetSelection(0, 0);
@@ -399,8 +443,9 @@ void SubsTextEditCtrl::OnContextMenu(wxContextMenuEvent &event) {
 
 void SubsTextEditCtrl::OnDoubleClick(wxStyledTextEvent &evt) {
 	int pos = evt.GetPosition();
-	if (pos == -1 && !tokenized_line.empty()) {
-		auto tok = tokenized_line.back();
+	auto const& tokens = highlighter.GetTokens();
+	if (pos == -1 && !tokens.empty()) {
+		auto tok = tokens.back();
 		SetSelection(line_text.size() - tok.length, line_text.size());
 	}
 	else {
@@ -415,6 +460,11 @@ void SubsTextEditCtrl::OnDoubleClick(wxStyledTextEvent &evt) {
 void SubsTextEditCtrl::AddSpellCheckerEntries(wxMenu &menu) {
 	if (currentWord.empty()) return;
 
+	if (spellchecker->IsLoading()) {
+		menu.Append(EDIT_MENU_SUGGESTION, _("Loading dictionary..."))->Enable(false);
+		return;
+	}
+
 	if (spellchecker->CanRemoveWord(currentWord))
 		menu.Append(EDIT_MENU_REMOVE_FROM_DICT, fmt_tl("Remove \"%s\" from dictionary", currentWord));
 
@@ -559,7 +609,7 @@ void SubsTextEditCtrl::OnSetThesLanguage(wxCommandEvent &event) {
 
 std::pair<int, int> SubsTextEditCtrl::GetBoundsOfWordAtPosition(int pos) {
 	int len = 0;
-	for (auto const& tok : tokenized_line) {
+	for (auto const& tok : highlighter.GetTokens()) {
 		if (len + (int)tok.length > pos) {
 			if (tok.type == agi::ass::DialogueTokenType::WORD)
 				return {len, tok.length};
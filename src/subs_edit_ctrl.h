@@ -27,6 +27,8 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#include <libaegisub/ass/dialogue_parser.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,7 +38,6 @@ class Thesaurus;
 namespace agi {
 	class SpellChecker;
 	struct Context;
-	namespace ass { struct DialogueToken; }
 }
 
 /// @class SubsTextEditCtrl
@@ -77,8 +78,15 @@ class SubsTextEditCtrl final : public wxStyledTextCtrl {
 	/// highlighting when possible
 	std::string line_text;
 
-	/// Tokenized version of line_text
-	std::vector<agi::ass::DialogueToken> tokenized_line;
+	/// Tokens and styles of line_text
+	agi::ass::DialogueHighlighter highlighter;
+
+	/// Position of the earliest edit since the line was last styled
+	size_t edit_start = 0;
+
+	/// Number of bytes at the end of the line which have not been edited
+	/// since the line was last styled
+	size_t edit_tail = 0;
 
 	void OnContextMenu(wxContextMenuEvent &);
 	void OnDoubleClick(wxStyledTextEvent&);
@@ -95,8 +103,15 @@ class SubsTextEditCtrl final : public wxStyledTextCtrl {
 	void UpdateCallTip();
 	void SetStyles();
 
+	/// Restyle the entire line
 	void UpdateStyle();
 
+	/// Restyle the parts of the line which have been edited
+	void UpdateEditedStyle();
+
+	/// Apply the highlighter's styles to a range of the line
+	void ApplyStyles(size_t begin, size_t end);
+
 	/// Add the thesaurus suggestions to a menu
 	void AddThesaurusEntries(wxMenu &menu);
 
@@ -0,0 +1,403 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "subs_journal.h"
+
+#include "ass_attachment.h"
+#include "ass_dialogue.h"
+#include "ass_file.h"
+#include "ass_info.h"
+#include "ass_parser.h"
+#include "ass_style.h"
+#include "charset_detect.h"
+#include "include/aegisub/context.h"
+#include "options.h"
+#include "string_codec.h"
+#include "subtitle_format.h"
+
+#include <libaegisub/ass/journal.h>
+#include <libaegisub/dispatch.h>
+#include <libaegisub/format.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/log.h>
+#include <libaegisub/make_unique.h>
+#include <libaegisub/path.h>
+#include <libaegisub/util.h>
+#include <libaegisub/vfr.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/// Once the journal is this much larger than its checkpoint it's cheaper to
+/// replay a fresh checkpoint than all the records, so start a new journal
+const uint64_t compact_ratio = 4;
+/// Don't bother compacting small journals
+const uint64_t compact_min_size = 1024 * 1024;
+
+bool same_line(AssDialogueBase const& a, AssDialogueBase const& b) {
+	return a.Comment == b.Comment
+		&& a.Layer == b.Layer
+		&& a.Margin == b.Margin
+		&& a.Start == b.Start
+		&& a.End == b.End
+		&& a.Style == b.Style
+		&& a.Actor == b.Actor
+		&& a.Effect == b.Effect
+		&& a.ExtradataIds == b.ExtradataIds
+		&& a.Text == b.Text;
+}
+
+bool same_extradata(std::vector<ExtradataEntry> const& a, std::vector<ExtradataEntry> const& b) {
+	return a.size() == b.size() && std::equal(begin(a), end(a), begin(b),
+		[](ExtradataEntry const& x, ExtradataEntry const& y) {
+			return x.id == y.id && x.key == y.key && x.value == y.value;
+		});
+}
+
+/// Cheap check for entries being added or removed, relying on entries
+/// being immutable and sorted by id
+bool same_extradata_ids(std::vector<ExtradataEntry> const& a, std::vector<ExtradataEntry> const& b) {
+	return a.size() == b.size() && (a.empty() || a.back().id == b.back().id);
+}
+
+template<typename Container>
+std::vector<std::string> entry_data(Container const& entries) {
+	std::vector<std::string> ret;
+	ret.reserve(entries.size());
+	for (auto const& entry : entries)
+		ret.push_back(entry.GetEntryData());
+	return ret;
+}
+}
+
+struct SubsJournal::Snapshot {
+	std::vector<std::string> info;
+	std::vector<std::string> styles;
+	std::vector<ExtradataEntry> extradata;
+	std::vector<AssDialogueBase> events;
+	/// Index in events of each line ID
+	std::unordered_map<int, size_t> event_index;
+
+	std::vector<std::string> ExtradataLines() const {
+		// Always use the escaped encoding rather than picking the smaller of
+		// it and uuencoding as saving does, as the journal is rarely read
+		std::vector<std::string> lines;
+		lines.reserve(extradata.size());
+		for (auto const& entry : extradata)
+			lines.push_back("Data: " + std::to_string(entry.id) + "," + inline_string_encode(entry.key) + ",e" + inline_string_encode(entry.value));
+		return lines;
+	}
+};
+
+struct SubsJournal::Output {
+	std::unique_ptr<agi::ass::JournalWriter> writer;
+	/// Set when writing fails, so that callers can fall back to autosaving
+	std::atomic<bool> failed{false};
+};
+
+SubsJournal::SubsJournal(agi::Context *c, agi::dispatch::Queue& queue)
+: c(c)
+, queue(queue)
+, output(std::make_shared<Output>())
+, last(agi::make_unique<Snapshot>())
+{
+	connections.push_back(c->ass->AddCommitListener(&SubsJournal::OnCommit, this));
+	connections.push_back(OPT_SUB("App/Auto/Journal", &SubsJournal::OnEnabledChanged, this));
+}
+
+SubsJournal::~SubsJournal() {
+	// Nothing needs recovering after a clean exit
+	Stop();
+	queue.Sync([]{ });
+}
+
+bool SubsJournal::IsActive() const {
+	return !path.empty() && !output->failed;
+}
+
+void SubsJournal::Reset(agi::fs::path const& filename) {
+	source = filename;
+	if (!OPT_GET("App/Auto/Journal")->GetBool()) {
+		Stop();
+		return;
+	}
+
+	auto directory = c->path->Decode(OPT_GET("Path/Auto/Save")->GetString());
+	if (directory.empty())
+		directory = filename.parent_path();
+	if (directory.empty()) {
+		Stop();
+		return;
+	}
+
+	auto name = filename.filename();
+	if (name.empty())
+		name = "Untitled";
+
+	auto old_path = path;
+	path = directory / agi::format("%s.%s.JOURNAL", name.string(),
+	                               agi::util::strftime("%Y-%m-%d-%H-%M-%S"));
+	Checkpoint();
+
+	if (!old_path.empty() && old_path != path)
+		queue.Async([=] { agi::fs::Remove(old_path); });
+}
+
+void SubsJournal::Stop() {
+	if (path.empty()) return;
+
+	auto output = this->output;
+	auto old_path = path;
+	queue.Async([=] {
+		output->writer.reset();
+		agi::fs::Remove(old_path);
+	});
+
+	path.clear();
+	last = agi::make_unique<Snapshot>();
+}
+
+void SubsJournal::OnEnabledChanged() {
+	if (OPT_GET("App/Auto/Journal")->GetBool())
+		Reset(source);
+	else
+		Stop();
+}
+
+void SubsJournal::Checkpoint() {
+	auto record = std::make_shared<agi::ass::JournalRecord>();
+
+	last->info = entry_data(c->ass->Info);
+	record->SetInfo(last->info);
+	last->styles = entry_data(c->ass->Styles);
+	record->SetStyles(last->styles);
+	last->extradata = c->ass->Extradata.Entries();
+	record->SetExtradata(last->ExtradataLines());
+
+	auto& events = last->events;
+	events.clear();
+	last->event_index.clear();
+	record->ClearEvents();
+	int prev_id = 0;
+	for (auto const& line : c->ass->Events) {
+		last->event_index[line.Id] = events.size();
+		events.push_back(line);
+		record->SetEvent(line.Id, prev_id, line.GetEntryData());
+		prev_id = line.Id;
+	}
+
+	checkpoint_size = journal_size = record->size();
+
+	auto output = this->output;
+	auto path = this->path;
+	auto source = this->source.string();
+	queue.Async([=] {
+		try {
+			output->writer.reset();
+			output->writer = agi::make_unique<agi::ass::JournalWriter>(path, source, *record);
+			output->failed = false;
+		}
+		catch (agi::Exception const& e) {
+			LOG_E("subs/journal") << "Failed to start journal: " << e.GetMessage();
+			output->failed = true;
+		}
+	});
+}
+
+void SubsJournal::OnCommit(int type, const AssDialogue *single_line) {
+	if (path.empty()) return;
+
+	agi::ass::JournalRecord record;
+
+	// Only look at the header sections when the commit may have changed
+	// them, so that the per-keystroke commits cost time proportional to the
+	// edit rather than to the size of the file
+	bool full = type == AssFile::COMMIT_NEW;
+	if (full || (type & AssFile::COMMIT_SCRIPTINFO)) {
+		auto new_info = entry_data(c->ass->Info);
+		if (new_info != last->info) {
+			last->info = std::move(new_info);
+			record.SetInfo(last->info);
+		}
+	}
+
+	if (full || (type & AssFile::COMMIT_STYLES)) {
+		auto new_styles = entry_data(c->ass->Styles);
+		if (new_styles != last->styles) {
+			last->styles = std::move(new_styles);
+			record.SetStyles(last->styles);
+		}
+	}
+
+	// Line edits can add extradata (e.g. from macros) without saying so, but
+	// entries are never modified and new ones always get the largest id, so
+	// the count and last id are enough to notice that
+	auto const& extradata = c->ass->Extradata.Entries();
+	bool extradata_changed = full || (type & AssFile::COMMIT_EXTRADATA)
+		? !same_extradata(last->extradata, extradata)
+		: !same_extradata_ids(last->extradata, extradata);
+	if (extradata_changed) {
+		last->extradata = extradata;
+		record.SetExtradata(last->ExtradataLines());
+	}
+
+	bool reordered = type == AssFile::COMMIT_NEW || (type & (AssFile::COMMIT_DIAG_ADDREM | AssFile::COMMIT_ORDER));
+	if (single_line && !reordered)
+		DiffLine(record, *single_line);
+	else if (reordered || (type & AssFile::COMMIT_DIAG_FULL))
+		DiffEvents(record, reordered);
+
+	if (record.empty()) return;
+
+	journal_size += record.size();
+	if (journal_size > std::max(compact_min_size, checkpoint_size * compact_ratio)) {
+		Checkpoint();
+		return;
+	}
+
+	auto output = this->output;
+	auto shared_record = std::make_shared<agi::ass::JournalRecord>(std::move(record));
+	queue.Async([=] {
+		if (!output->writer) return;
+		try {
+			output->writer->Write(*shared_record);
+		}
+		catch (agi::Exception const& e) {
+			LOG_E("subs/journal") << "Failed to write to journal: " << e.GetMessage();
+			output->writer.reset();
+			output->failed = true;
+		}
+	});
+}
+
+void SubsJournal::DiffLine(agi::ass::JournalRecord& record, AssDialogue const& line) {
+	auto& events = last->events;
+	auto it = last->event_index.find(line.Id);
+	if (it == last->event_index.end()) {
+		DiffEvents(record, true);
+		return;
+	}
+
+	auto& old_line = events[it->second];
+	if (same_line(old_line, line)) return;
+	old_line = line;
+	record.SetEvent(line.Id, it->second ? events[it->second - 1].Id : 0, line.GetEntryData());
+}
+
+void SubsJournal::DiffEvents(agi::ass::JournalRecord& record, bool reordered) {
+	auto& events = last->events;
+	auto& event_index = last->event_index;
+
+	// Lines haven't moved, so they can be compared in place
+	if (!reordered) {
+		size_t i = 0;
+		for (auto const& line : c->ass->Events) {
+			if (i >= events.size() || events[i].Id != line.Id) {
+				reordered = true;
+				break;
+			}
+			if (!same_line(events[i], line)) {
+				events[i] = line;
+				record.SetEvent(line.Id, i ? events[i - 1].Id : 0, line.GetEntryData());
+			}
+			++i;
+		}
+		if (!reordered && i == events.size())
+			return;
+	}
+
+	// Record every line which is new, changed, or follows a different line
+	// than it used to; a line whose predecessor is unchanged stays put when
+	// the journal is replayed even if lines elsewhere moved
+	std::vector<AssDialogueBase> new_events;
+	std::unordered_map<int, size_t> new_index;
+	new_index.reserve(event_index.size());
+	std::vector<bool> kept(events.size());
+
+	int prev_id = 0;
+	for (auto const& line : c->ass->Events) {
+		auto it = event_index.find(line.Id);
+		if (it == event_index.end())
+			record.SetEvent(line.Id, prev_id, line.GetEntryData());
+		else {
+			size_t old_pos = it->second;
+			kept[old_pos] = true;
+			int old_prev_id = old_pos ? events[old_pos - 1].Id : 0;
+			if (old_prev_id != prev_id || !same_line(events[old_pos], line))
+				record.SetEvent(line.Id, prev_id, line.GetEntryData());
+		}
+
+		new_index[line.Id] = new_events.size();
+		new_events.push_back(line);
+		prev_id = line.Id;
+	}
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		if (!kept[i])
+			record.RemoveEvent(events[i].Id);
+	}
+
+	events = std::move(new_events);
+	event_index = std::move(new_index);
+}
+
+agi::fs::path SubsJournal::Recover(agi::fs::path const& journal) {
+	auto state = agi::ass::ReadJournal(journal);
+
+	AssFile subs;
+	{
+		AssParser parser(&subs, 1);
+		parser.AddLine("[Script Info]");
+		for (auto const& line : state.info)
+			parser.AddLine(line);
+		parser.AddLine("[V4+ Styles]");
+		for (auto const& line : state.styles)
+			parser.AddLine(line);
+		parser.AddLine("[Events]");
+		for (auto const& line : state.events)
+			parser.AddLine(line.second);
+		parser.AddLine("[Aegisub Extradata]");
+		for (auto const& line : state.extradata)
+			parser.AddLine(line);
+	}
+
+	// Attachments and project properties aren't journaled as they rarely
+	// change, so take them from the file the script came from if it's
+	// still around
+	agi::fs::path source(state.source);
+	if (!source.empty() && agi::fs::FileExists(source)) {
+		try {
+			AssFile original;
+			auto charset = CharSetDetect::GetEncoding(source);
+			SubtitleFormat::GetReader(source, charset)->ReadFile(&original, source, agi::vfr::Framerate(), charset);
+			subs.Attachments = std::move(original.Attachments);
+			subs.Properties = original.Properties;
+		}
+		catch (agi::Exception const& e) {
+			LOG_W("subs/journal") << "Could not read attachments from " << source.string() << ": " << e.GetMessage();
+		}
+	}
+
+	auto path = config::path->Decode("?user/recovered");
+	agi::fs::CreateDirectory(path);
+	path /= journal.stem().string() + ".ass";
+	SubtitleFormat::GetWriter(path)->WriteFile(&subs, path, 0);
+	return path;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/fs_fwd.h>
+#include <libaegisub/signal.h>
+
+#include <boost/filesystem/path.hpp>
+#include <memory>
+
+class AssDialogue;
+namespace agi {
+	namespace ass { class JournalRecord; }
+	namespace dispatch { class Queue; }
+	struct Context;
+}
+
+/// @class SubsJournal
+/// @brief Records every change made to the open file so that it can be
+///        recovered after a crash
+///
+/// Rather than periodically writing out the entire file, each commit appends
+/// only the lines which it changed to a journal file in the autosave
+/// directory. The journal is found by comparing the file against a copy of
+/// what was last written, as commits don't say which lines they touched,
+/// but that's cheap compared to formatting and writing every line.
+///
+/// All file access happens on the queue passed in, and a write failure just
+/// turns the journal off until the next checkpoint.
+class SubsJournal {
+	agi::Context *c;
+	agi::dispatch::Queue& queue;
+	std::vector<agi::signal::Connection> connections;
+
+	/// State shared with the queue
+	struct Output;
+	std::shared_ptr<Output> output;
+
+	/// Path to the current journal, or empty if there isn't one
+	agi::fs::path path;
+	/// File which the journal's script was loaded from
+	agi::fs::path source;
+
+	/// Estimated size of the journal file, for deciding when to compact it
+	uint64_t journal_size = 0;
+	/// Size of the checkpoint which started the journal
+	uint64_t checkpoint_size = 0;
+
+	/// The script as of the last record written
+	struct Snapshot;
+	std::unique_ptr<Snapshot> last;
+
+	void OnCommit(int type, const AssDialogue *single_line);
+	void OnEnabledChanged();
+
+	/// Start a new journal at path with the current state of the file
+	void Checkpoint();
+	/// Stop journaling, deleting the current journal
+	void Stop();
+
+	/// Add the dialogue lines which changed since the last record
+	/// @param reordered Lines may have been added, removed or moved
+	void DiffEvents(agi::ass::JournalRecord& record, bool reordered);
+	/// Add a single line if it changed since the last record
+	void DiffLine(agi::ass::JournalRecord& record, AssDialogue const& line);
+
+public:
+	SubsJournal(agi::Context *c, agi::dispatch::Queue& queue);
+	~SubsJournal();
+
+	/// Start a new journal for the file, replacing the previous one
+	/// @param filename File the script was loaded from or saved to, if any
+	///
+	/// The previous journal is no longer needed once the file has been
+	/// saved, or the changes in it have been discarded.
+	void Reset(agi::fs::path const& filename);
+
+	/// Is the journal currently recording changes?
+	bool IsActive() const;
+
+	/// Rebuild the script recorded in a journal
+	/// @param journal Journal file to recover
+	/// @return Path to the recovered script
+	static agi::fs::path Recover(agi::fs::path const& journal);
+};
@@ -55,7 +55,7 @@
 
 #include <algorithm>
 #include <boost/algorithm/string/join.hpp>
-#include <boost/algorithm/string/replace.hpp>
+#include <list>
 #include <wx/choicdlg.h>
 
 namespace {
@@ -154,110 +154,119 @@ agi::vfr::Framerate SubtitleFormat::AskForFPS(bool allow_vfr, bool show_smpte, a
 	throw agi::InternalError("Out of bounds result from wxGetSingleChoiceIndex?");
 }
 
-void SubtitleFormat::StripTags(AssFile &file) {
-	for (auto& current : file.Events)
-		current.StripTags();
-}
-
-void SubtitleFormat::ConvertNewlines(AssFile &file, std::string const& newline, bool mergeLineBreaks) {
-	for (auto& current : file.Events) {
-		std::string repl = current.Text;
-		boost::replace_all(repl, "\\h", " ");
-		boost::ireplace_all(repl, "\\n", newline);
-		if (mergeLineBreaks) {
-			std::string dbl(newline + newline);
-			size_t pos = 0;
-			while ((pos = repl.find(dbl, pos)) != std::string::npos)
-				boost::replace_all(repl, dbl, newline);
-		}
-		current.Text = repl;
+ExportView::ExportView(const AssFile *file)
+: file(file)
+{
+	std::vector<const AssDialogue *> sorted;
+	sorted.reserve(file->Events.size());
+	for (auto const& line : file->Events) {
+		if (!line.Comment && !line.Text.get().empty())
+			sorted.push_back(&line);
 	}
-}
-
-void SubtitleFormat::StripComments(AssFile &file) {
-	file.Events.remove_and_dispose_if([](AssDialogue const& diag) {
-		return diag.Comment || diag.Text.get().empty();
-	}, [](AssDialogue *e) { delete e; });
-}
-
-/// @brief Split and merge lines so there are no overlapping lines
-///
-/// Algorithm described at http://devel.aegisub.org/wiki/Technical/SplitMerge
-void SubtitleFormat::RecombineOverlaps(AssFile &file) {
-	auto cur = file.Events.begin();
-	for (auto next = std::next(cur); next != file.Events.end(); cur = std::prev(next)) {
-		if (next == file.Events.begin() || cur->End <= next->Start) {
-			++next;
-			continue;
-		}
-
-		std::unique_ptr<AssDialogue> prevdlg(&*cur);
-		std::unique_ptr<AssDialogue> curdlg(&*next);
-		++next;
-
-		auto insert_line = [&](AssDialogue *newdlg) {
-			file.Events.insert(std::find_if(next, file.Events.end(), [&](AssDialogue const& pos) {
-				return pos.Start >= newdlg->Start;
-			}), *newdlg);
-		};
-
-		//Is there an A part before the overlap?
-		if (curdlg->Start > prevdlg->Start) {
-			// Produce new entry with correct values
-			auto newdlg = new AssDialogue(*prevdlg);
-			newdlg->Start = prevdlg->Start;
-			newdlg->End = curdlg->Start;
-			newdlg->Text = prevdlg->Text;
-			insert_line(newdlg);
-		}
-
-		// Overlapping A+B part
-		{
-			auto newdlg = new AssDialogue(*prevdlg);
-			newdlg->Start = curdlg->Start;
-			newdlg->End = (prevdlg->End < curdlg->End) ? prevdlg->End : curdlg->End;
-			// Put an ASS format hard linewrap between lines
-			newdlg->Text = curdlg->Text.get() + "\\N" + prevdlg->Text.get();
-			insert_line(newdlg);
-		}
+	std::stable_sort(begin(sorted), end(sorted), [](const AssDialogue *a, const AssDialogue *b) {
+		return a->Start < b->Start;
+	});
 
-		// Is there an A part after the overlap?
-		if (prevdlg->End > curdlg->End) {
-			// Produce new entry with correct values
-			auto newdlg = new AssDialogue(*prevdlg);
-			newdlg->Start = curdlg->End;
-			newdlg->End = prevdlg->End;
-			newdlg->Text = prevdlg->Text;
-			insert_line(newdlg);
+	std::list<ExportLine> list;
+	for (auto line : sorted)
+		list.push_back(ExportLine{line->Start, line->End, line->Text, line});
+
+	// Split and merge lines so there are no overlapping lines, as described
+	// at http://devel.aegisub.org/wiki/Technical/SplitMerge
+	if (list.size() > 1) {
+		auto cur = list.begin();
+		for (auto next = std::next(cur); next != list.end(); ) {
+			if (cur->End <= next->Start) {
+				cur = next++;
+				continue;
+			}
+
+			ExportLine prev = *cur;
+			ExportLine curline = *next;
+			list.erase(cur);
+			next = list.erase(next);
+
+			auto insert_line = [&](agi::Time start, agi::Time end, boost::flyweight<std::string> const& text) {
+				list.insert(std::find_if(next, list.end(), [&](ExportLine const& pos) {
+					return pos.Start >= start;
+				}), ExportLine{start, end, text, prev.Source});
+			};
+
+			// Is there an A part before the overlap?
+			if (curline.Start > prev.Start)
+				insert_line(prev.Start, curline.Start, prev.Text);
+
+			// Overlapping A+B part, with an ASS format hard linewrap between lines
+			insert_line(curline.Start, std::min(prev.End, curline.End),
+				boost::flyweight<std::string>(curline.Text.get() + "\\N" + prev.Text.get()));
+
+			// Is there an A part after the overlap?
+			if (prev.End > curline.End)
+				insert_line(curline.End, prev.End, prev.Text);
+
+			// Is there a B part after the overlap?
+			if (curline.End > prev.End)
+				insert_line(prev.End, curline.End, curline.Text);
+
+			if (next == list.begin())
+				cur = next++;
+			else
+				cur = std::prev(next);
 		}
+	}
 
-		// Is there a B part after the overlap?
-		if (curdlg->End > prevdlg->End) {
-			// Produce new entry with correct values
-			auto newdlg = new AssDialogue(*prevdlg);
-			newdlg->Start = prevdlg->End;
-			newdlg->End = curdlg->End;
-			newdlg->Text = curdlg->Text;
-			insert_line(newdlg);
+	// Merge identical lines that follow each other
+	if (!list.empty()) {
+		auto next = list.begin();
+		auto cur = next++;
+		for (; next != list.end(); cur = next++) {
+			if (cur->End == next->Start && cur->Text == next->Text) {
+				next->Start = std::min(next->Start, cur->Start);
+				next->End = std::max(next->End, cur->End);
+				list.erase(cur);
+			}
 		}
 	}
-}
-
-/// @brief Merge identical lines that follow each other
-void SubtitleFormat::MergeIdentical(AssFile &file) {
-	auto next = file.Events.begin();
-	auto cur = next++;
 
-	for (; next != file.Events.end(); cur = next++) {
-		if (cur->End == next->Start && cur->Text == next->Text) {
-			// Merge timing
-			next->Start = std::min(next->Start, cur->Start);
-			next->End = std::max(next->End, cur->End);
+	lines.assign(std::make_move_iterator(list.begin()), std::make_move_iterator(list.end()));
+}
 
-			// Remove duplicate line
-			delete &*cur;
+std::string ExportView::ConvertText(ExportLine const& line, bool strip_tags, std::string const& newline, bool merge_line_breaks) {
+	std::string stripped;
+	if (strip_tags)
+		stripped = AssDialogue::GetStrippedText(line.Text.get());
+	std::string const& text = strip_tags ? stripped : line.Text.get();
+
+	std::string dbl = newline + newline;
+	auto ends_with_double = [&](std::string const& str) {
+		return merge_line_breaks && !newline.empty() && str.size() >= dbl.size()
+			&& str.compare(str.size() - dbl.size(), dbl.size(), dbl) == 0;
+	};
+
+	std::string out;
+	out.reserve(text.size());
+	for (size_t i = 0, len = text.size(); i < len; ++i) {
+		if (text[i] == '\\' && i + 1 < len) {
+			char next = text[i + 1];
+			if (next == 'h') {
+				out += ' ';
+				++i;
+				continue;
+			}
+			if (next == 'n' || next == 'N') {
+				out += newline;
+				if (ends_with_double(out))
+					out.resize(out.size() - newline.size());
+				++i;
+				continue;
+			}
 		}
+
+		out += text[i];
+		if (ends_with_double(out))
+			out.resize(out.size() - newline.size());
 	}
+	return out;
 }
 
 void SubtitleFormat::LoadFormats() {
@@ -297,6 +306,41 @@ const SubtitleFormat *SubtitleFormat::GetWriter(agi::fs::path const& filename) {
 	});
 }
 
+void SubtitleFormat::ExportMultiple(const AssFile *src, std::vector<agi::fs::path> const& filenames, agi::vfr::Framerate const& fps, std::string const& encoding) {
+	// Find every writer before writing anything, so that an unsupported
+	// target throws before the others are half-exported
+	std::vector<const SubtitleFormat *> writers;
+	writers.reserve(filenames.size());
+	for (auto const& filename : filenames)
+		writers.push_back(GetWriter(filename));
+
+	std::unique_ptr<ExportView> view;
+	for (size_t i = 0; i < filenames.size(); ++i) {
+		auto const& filename = filenames[i];
+		auto writer = writers[i];
+		if (!writer->UsesExportView()) {
+			writer->ExportFile(src, filename, fps, encoding);
+			continue;
+		}
+
+		if (!view)
+			view = agi::make_unique<ExportView>(src);
+		writer->WriteView(*view, filename, fps, encoding);
+	}
+}
+
+std::vector<std::string> SubtitleFormat::GetWriteExtensions() {
+	LoadFormats();
+
+	std::vector<std::string> extensions;
+	for (auto const& format : formats) {
+		auto cur = format->GetWriteWildcards();
+		if (!cur.empty())
+			extensions.push_back(cur.front());
+	}
+	return extensions;
+}
+
 std::string SubtitleFormat::GetWildcards(int mode) {
 	LoadFormats();
 
@@ -29,15 +29,58 @@
 
 #pragma once
 
+#include <libaegisub/ass/time.h>
 #include <libaegisub/exception.h>
 #include <libaegisub/fs_fwd.h>
 
+#include <boost/flyweight.hpp>
 #include <string>
 #include <vector>
 
+class AssDialogue;
 class AssFile;
 namespace agi { namespace vfr { class Framerate; } }
 
+/// A dialogue line as seen by the writers for formats without ASS's features
+struct ExportLine {
+	agi::Time Start;
+	agi::Time End;
+	/// Text of the line, shared with the source line unless lines were
+	/// combined to remove an overlap
+	boost::flyweight<std::string> Text;
+	/// The line this was derived from, for any fields other than the times
+	/// and text. For combined lines this is the earlier of the two.
+	const AssDialogue *Source;
+};
+
+/// @class ExportView
+/// @brief The lines of a file prepared for writing to a simple format
+///
+/// Holds the uncommented, non-empty lines of a file sorted by start time,
+/// with overlapping lines split and recombined and identical adjacent lines
+/// merged, which is what every format that cannot represent overlapping
+/// lines needs. Building it does not copy the file, and the text transforms
+/// which only some formats need are applied per line by ConvertText as the
+/// lines are written, so one view can be shared by several writers.
+class ExportView {
+	const AssFile *file;
+	std::vector<ExportLine> lines;
+
+public:
+	ExportView(const AssFile *file);
+
+	/// The file the view was built from, for the header and styles
+	const AssFile *File() const { return file; }
+	std::vector<ExportLine> const& Lines() const { return lines; }
+
+	/// Get the text of a line with tags stripped and newlines converted in
+	/// a single pass
+	/// @param strip_tags Remove override and comment blocks
+	/// @param newline String to replace \N and \n with
+	/// @param merge_line_breaks Collapse consecutive line breaks into one
+	static std::string ConvertText(ExportLine const& line, bool strip_tags, std::string const& newline, bool merge_line_breaks = true);
+};
+
 class SubtitleFormat {
 	std::string name;
 
@@ -47,20 +90,6 @@ class SubtitleFormat {
 	virtual std::vector<std::string> GetWriteWildcards() const { return {}; }
 
 public:
-	/// Strip override tags
-	static void StripTags(AssFile &file);
-	/// Convert newlines to the specified character(s)
-	/// @param lineEnd newline character(s)
-	/// @param mergeLineBreaks Should multiple consecutive line breaks be merged into one?
-	static void ConvertNewlines(AssFile &file, std::string const& newline, bool mergeLineBreaks = true);
-	/// Remove All commented and empty lines
-	static void StripComments(AssFile &file);
-	/// @brief Split and merge lines so there are no overlapping lines
-	///
-	/// Algorithm described at http://devel.aegisub.org/wiki/Technical/SplitMerge
-	static void RecombineOverlaps(AssFile &file);
-	/// Merge sequential identical lines
-	static void MergeIdentical(AssFile &file);
 
 	/// Prompt the user for a frame rate to use
 	/// @param allow_vfr Include video frame rate as an option even if it's vfr
@@ -115,10 +144,30 @@ public:
 		WriteFile(src, filename, fps, encoding);
 	}
 
+	/// Does this format write from an ExportView rather than the full file?
+	virtual bool UsesExportView() const { return false; }
+
+	/// Write a file from lines which have already been prepared for export
+	///
+	/// Only called for formats which return true from UsesExportView.
+	virtual void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const { }
+
+	/// Export a file to several formats at once
+	///
+	/// All of the formats which use an ExportView share a single one, so
+	/// the lines are only sorted and recombined once.
+	/// @param src Data to write
+	/// @param filenames Files to write to, with the format picked from each file's name
+	static void ExportMultiple(const AssFile *src, std::vector<agi::fs::path> const& filenames, agi::vfr::Framerate const& fps, std::string const& encoding="");
+
 	/// Get the wildcards for a save or load dialog
 	/// @param mode 0: load 1: save
 	static std::string GetWildcards(int mode);
 
+	/// Get the main extension of each format which can write files, for
+	/// picking the targets of ExportMultiple
+	static std::vector<std::string> GetWriteExtensions();
+
 	/// Get a subtitle format that can read the given file or nullptr if none can
 	static const SubtitleFormat *GetReader(agi::fs::path const& filename, std::string const& encoding);
 	/// Get a subtitle format that can write the given file or nullptr if none can
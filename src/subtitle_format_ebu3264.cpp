@@ -37,7 +37,14 @@
 #include <libaegisub/io.h>
 #include <libaegisub/line_wrap.h>
 
+#include <atomic>
 #include <boost/algorithm/string/replace.hpp>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <wx/utils.h>
 
 namespace
@@ -244,7 +251,7 @@ namespace
 			return true;
 		}
 
-		void SetTextFromAss(AssDialogue *line, bool style_underline, bool style_italic, int align, int wrap_mode)
+		void SetTextFromAss(std::string const& text, bool style_underline, bool style_italic, int align, int wrap_mode)
 		{
 			text_rows.clear();
 			text_rows.emplace_back();
@@ -257,7 +264,7 @@ namespace
 
 			bool underline = style_underline, italic = style_italic;
 
-			for (auto& b : line->ParseTags())
+			for (auto& b : AssDialogue::ParseTags(text))
 			{
 				switch (b->GetType())
 				{
@@ -341,77 +348,138 @@ namespace
 		}
 	};
 
-	std::vector<EbuSubtitle> convert_subtitles(AssFile &copy, EbuExportSettings const& export_settings)
+	/// Precomputed encodings of the characters the subtitle text encoding can
+	/// represent, so that the common case doesn't need an iconv call per block
+	class CodepageTable
 	{
-		SubtitleFormat::StripComments(copy);
-		copy.Sort();
-		SubtitleFormat::RecombineOverlaps(copy);
-		SubtitleFormat::MergeIdentical(copy);
+		/// Encoded bytes of each character, keyed by its UTF-8 bytes
+		std::unordered_map<uint32_t, std::string> chars;
+		bool passthrough;
 
-		int line_wrap_type = copy.GetScriptInfoAsInt("WrapStyle");
-
-		agi::vfr::Framerate fps = export_settings.GetFramerate();
-		EbuTimecode tcofs = export_settings.timecode_offset;
-		int timecode_bias = fps.FrameAtSmpte(tcofs.h, tcofs.m, tcofs.s, tcofs.s);
+		static size_t utf8_length(unsigned char lead)
+		{
+			if (lead < 0x80) return 1;
+			if (lead >= 0xC0 && lead < 0xE0) return 2;
+			if (lead >= 0xE0 && lead < 0xF0) return 3;
+			if (lead >= 0xF0 && lead < 0xF8) return 4;
+			return 0;
+		}
 
-		AssStyle default_style;
-		std::vector<EbuSubtitle> subs_list;
-		subs_list.reserve(copy.Events.size());
+		static uint32_t make_key(const char *str, size_t len)
+		{
+			uint32_t key = 0;
+			for (size_t i = 0; i < len; ++i)
+				key = key << 8 | static_cast<unsigned char>(str[i]);
+			return key;
+		}
 
-		// convert to intermediate format
-		for (auto& line : copy.Events)
+		/// Add the character which the given bytes decode to, if encoding it
+		/// again gives the same bytes
+		void AddChar(std::string const& encoded, agi::charset::IconvWrapper &decoder, agi::charset::IconvWrapper &encoder)
 		{
-			// add a new subtitle and work on it
-			subs_list.emplace_back();
-			EbuSubtitle &imline = subs_list.back();
+			try
+			{
+				std::string utf8 = decoder.Convert(encoded);
+				if (utf8.empty() || utf8_length(utf8[0]) != utf8.size())
+					return;
+				// Leave combining marks to iconv as they could be merged with
+				// the preceding character
+				auto lead = static_cast<unsigned char>(utf8[0]);
+				if (lead == 0xCC || (lead == 0xCD && static_cast<unsigned char>(utf8[1]) < 0xB0))
+					return;
+				if (encoder.Convert(utf8) == encoded)
+					chars.emplace(make_key(utf8.data(), utf8.size()), encoded);
+			}
+			catch (agi::charset::ConvError const&)
+			{
+			}
+		}
 
-			// some defaults for compatibility
-			imline.group_number = 0;
-			imline.comment_flag = false;
-			imline.cumulative_status = EbuSubtitle::NotCumulative;
+	public:
+		CodepageTable(EbuExportSettings const& export_settings)
+		: passthrough(export_settings.text_encoding == EbuExportSettings::utf8)
+		{
+			if (passthrough) return;
 
-			// convert times
-			imline.time_in = fps.FrameAtTime(line.Start) + timecode_bias;
-			imline.time_out = fps.FrameAtTime(line.End) + timecode_bias;
-			if (export_settings.inclusive_end_times)
-				// cheap and possibly wrong way to ensure exclusive times, subtract one frame from end time
-				imline.time_out -= 1;
+			try
+			{
+				const char *charset = export_settings.GetTextEncodingName();
+				agi::charset::IconvWrapper decoder(charset, "utf-8", false);
+				agi::charset::IconvWrapper encoder("utf-8", charset, false);
 
-			// convert alignment from style
-			AssStyle *style = copy.GetStyle(line.Style);
-			if (!style)
-				style = &default_style;
+				bool iso6937 = export_settings.text_encoding == EbuExportSettings::iso6937_2;
+				for (int c = 1; c < 256; ++c)
+				{
+					// ISO 6937 writes accented letters as a non-spacing
+					// diacritic followed by the base letter
+					if (iso6937 && c >= 0xC1 && c <= 0xCF)
+					{
+						for (int base = 0x20; base < 0x80; ++base)
+							AddChar(std::string{static_cast<char>(c), static_cast<char>(base)}, decoder, encoder);
+					}
+					else
+						AddChar(std::string(1, static_cast<char>(c)), decoder, encoder);
+				}
+			}
+			catch (agi::charset::UnsupportedConversion const&)
+			{
+				// Everything will go through iconv, which reports the error
+			}
+		}
 
-			// add text, translate formatting
-			imline.SetTextFromAss(&line, style->underline, style->italic, style->alignment, line_wrap_type);
+		/// Append the encoded text to out using only the table
+		/// @return false, with out unchanged, if the text has a character not in the table
+		bool Convert(std::string const& text, std::string &out) const
+		{
+			if (passthrough)
+			{
+				out += text;
+				return true;
+			}
 
-			// line breaking handling
-			if (export_settings.line_wrapping_mode == EbuExportSettings::AutoWrap)
-				imline.SplitLines(export_settings.max_line_length, line_wrap_type);
-			else if (export_settings.line_wrapping_mode == EbuExportSettings::AutoWrapBalance)
-				imline.SplitLines(export_settings.max_line_length, agi::Wrap_Balanced);
-			else if (!imline.CheckLineLengths(export_settings.max_line_length))
+			const size_t old_size = out.size();
+			for (size_t i = 0; i < text.size(); )
 			{
-				if (export_settings.line_wrapping_mode == EbuExportSettings::AbortOverLength)
-					throw Ebu3264SubtitleFormat::ConversionFailed(agi::format(_("Line over maximum length: %s"), line.Text));
-				else // skip over-long lines
-					subs_list.pop_back();
+				size_t len = utf8_length(text[i]);
+				auto it = len && i + len <= text.size() ? chars.find(make_key(&text[i], len)) : chars.end();
+				if (it == chars.end())
+				{
+					out.resize(old_size);
+					return false;
+				}
+				out += it->second;
+				i += len;
 			}
+			return true;
 		}
+	};
+
+	/// Converts subtitle text with the shared codepage table, falling back to
+	/// iconv for text with characters which aren't in it. Each thread needs
+	/// its own, as iconv converters can't be shared.
+	class EbuTextEncoder
+	{
+		CodepageTable const& table;
+		EbuExportSettings const& export_settings;
+		std::unique_ptr<agi::charset::IconvWrapper> iconv;
 
-		// produce an empty line if there are none
-		// (it still has to contain a space to not get ignored)
-		if (subs_list.empty())
+	public:
+		EbuTextEncoder(CodepageTable const& table, EbuExportSettings const& export_settings)
+		: table(table)
+		, export_settings(export_settings)
 		{
-			subs_list.emplace_back();
-			subs_list.back().text_rows.emplace_back();
-			subs_list.back().text_rows.back().emplace_back(" ");
 		}
 
-		return subs_list;
-	}
+		void Convert(std::string const& text, std::string &out)
+		{
+			if (table.Convert(text, out)) return;
+			if (!iconv)
+				iconv = export_settings.GetTextEncoder();
+			iconv->Convert(text, out);
+		}
+	};
 
-	std::string convert_subtitle_line(EbuSubtitle const& sub, agi::charset::IconvWrapper *encoder, bool enable_formatting)
+	std::string convert_subtitle_line(EbuSubtitle const& sub, EbuTextEncoder &encoder, bool enable_formatting)
 	{
 		std::string fullstring;
 		for (auto const& row : sub.text_rows)
@@ -436,7 +504,7 @@ namespace
 				}
 
 				// convert text to specified encoding
-				fullstring += encoder->Convert(block.text);
+				encoder.Convert(block.text, fullstring);
 			}
 		}
 		return fullstring;
@@ -452,9 +520,10 @@ namespace
 		tc.f = f;
 	}
 
-	std::vector<BlockTTI> create_blocks(std::vector<EbuSubtitle> const& subs_list, EbuExportSettings const& export_settings)
+	/// Create the TTI blocks for a subtitle. The subtitle number is left for
+	/// the caller to fill in.
+	std::vector<BlockTTI> create_blocks(EbuSubtitle const& sub, EbuTextEncoder &encoder, EbuExportSettings const& export_settings)
 	{
-		auto encoder = export_settings.GetTextEncoder();
 		auto fps = export_settings.GetFramerate();
 
 		// Teletext captions are 1-23; Open subtitles are 0-99
@@ -465,66 +534,234 @@ namespace
 			max_row = 24;
 		}
 
-		uint16_t subtitle_number = 0;
+		std::string fullstring = convert_subtitle_line(sub, encoder,
+			export_settings.display_standard == EbuExportSettings::DSC_Open);
+
+		// construct a base block that can be copied and filled
+		BlockTTI base;
+		base.sgn = sub.group_number;
+		base.sn = 0;
+		base.ebn = 255;
+		base.cf = sub.comment_flag;
+		memset(base.tf, EBU_FORMAT_UNUSED_SPACE, sizeof(base.tf));
+		smpte_at_frame(fps, sub.time_in, base.tci);
+		smpte_at_frame(fps, sub.time_out, base.tco);
+		base.cs = sub.cumulative_status;
+
+		if (export_settings.translate_alignments)
+		{
+			// vertical position
+			if (sub.vertical_position == EbuSubtitle::PositionTop)
+				base.vp = min_row;
+			else if (sub.vertical_position == EbuSubtitle::PositionMiddle)
+				base.vp = std::min<uint8_t>(min_row, max_row / 2 - (max_row / 5 * sub.text_rows.size()));
+			else //if (sub.vertical_position == EbuSubtitle::PositionBottom)
+				base.vp = max_row - 1;
+
+			base.jc = sub.justification_code;
+		}
+		else
+		{
+			base.vp = max_row - 1;
+			base.jc = EbuSubtitle::JustifyCentre;
+		}
 
+		// produce blocks from string
 		std::vector<BlockTTI> tti;
-		tti.reserve(subs_list.size());
-		for (auto const& sub : subs_list)
+		static const size_t block_size = sizeof(((BlockTTI*)nullptr)->tf);
+		uint8_t num_blocks = 0;
+		for (size_t pos = 0; pos < fullstring.size(); pos += block_size)
+		{
+			size_t bytes_remaining = fullstring.size() - pos;
+
+			tti.push_back(base);
+			// write an extension block number if the remaining text doesn't fit in the block
+			tti.back().ebn = bytes_remaining >= block_size ? num_blocks++ : 255;
+
+			std::copy(&fullstring[pos], &fullstring[pos + std::min(block_size, bytes_remaining)], tti.back().tf);
+
+			// Write another block for the terminator if we exactly used up
+			// the last block
+			if (bytes_remaining == block_size)
+				tti.push_back(base);
+		}
+
+		return tti;
+	}
+
+	/// A line converted by a worker thread, waiting to be written
+	struct ConvertedLine
+	{
+		enum Status
+		{
+			Converted,
+			Skipped,   ///< Over-length line which is being left out
+			OverLength ///< Over-length line which should abort the export
+		};
+
+		bool ready = false;
+		Status status = Converted;
+		std::vector<BlockTTI> blocks;
+		std::exception_ptr error;
+	};
+
+	/// Converts lines to TTI blocks on worker threads. The converted lines are
+	/// passed back in file order through a reorder buffer which is bounded so
+	/// that workers which get ahead of the writer wait rather than holding
+	/// the converted blocks for the whole file.
+	class ParallelLineConverter
+	{
+		/// Number of lines which can be converted ahead of the writer
+		static const size_t window = 256;
+
+		ExportView const& view;
+		EbuExportSettings const& export_settings;
+		CodepageTable table;
+		agi::vfr::Framerate fps;
+		int timecode_bias;
+		int line_wrap_type;
+		/// Style used for lines whose style doesn't exist
+		const AssStyle default_style;
+
+		std::vector<ConvertedLine> slots;
+		std::mutex mutex;
+		std::condition_variable slot_ready;
+		std::condition_variable slot_free;
+		std::atomic<size_t> next_line{0};
+		size_t written = 0;
+		bool cancelled = false;
+		std::vector<std::thread> workers;
+
+		void ConvertLine(ExportLine const& line, EbuTextEncoder &encoder, ConvertedLine &out) const
 		{
-			std::string fullstring = convert_subtitle_line(sub, encoder.get(),
-				export_settings.display_standard == EbuExportSettings::DSC_Open);
-
-			// construct a base block that can be copied and filled
-			BlockTTI base;
-			base.sgn = sub.group_number;
-			base.sn = subtitle_number++;
-			base.ebn = 255;
-			base.cf = sub.comment_flag;
-			memset(base.tf, EBU_FORMAT_UNUSED_SPACE, sizeof(base.tf));
-			smpte_at_frame(fps, sub.time_in, base.tci);
-			smpte_at_frame(fps, sub.time_out, base.tco);
-			base.cs = sub.cumulative_status;
-
-			if (export_settings.translate_alignments)
+			EbuSubtitle imline;
+
+			// some defaults for compatibility
+			imline.group_number = 0;
+			imline.comment_flag = false;
+			imline.cumulative_status = EbuSubtitle::NotCumulative;
+
+			// convert times
+			imline.time_in = fps.FrameAtTime(line.Start) + timecode_bias;
+			imline.time_out = fps.FrameAtTime(line.End) + timecode_bias;
+			if (export_settings.inclusive_end_times)
+				// cheap and possibly wrong way to ensure exclusive times, subtract one frame from end time
+				imline.time_out -= 1;
+
+			// convert alignment from style
+			const AssStyle *style = view.File()->GetStyle(line.Source->Style);
+			if (!style)
+				style = &default_style;
+
+			// add text, translate formatting
+			imline.SetTextFromAss(line.Text, style->underline, style->italic, style->alignment, line_wrap_type);
+
+			// line breaking handling
+			if (export_settings.line_wrapping_mode == EbuExportSettings::AutoWrap)
+				imline.SplitLines(export_settings.max_line_length, line_wrap_type);
+			else if (export_settings.line_wrapping_mode == EbuExportSettings::AutoWrapBalance)
+				imline.SplitLines(export_settings.max_line_length, agi::Wrap_Balanced);
+			else if (!imline.CheckLineLengths(export_settings.max_line_length))
 			{
-				// vertical position
-				if (sub.vertical_position == EbuSubtitle::PositionTop)
-					base.vp = min_row;
-				else if (sub.vertical_position == EbuSubtitle::PositionMiddle)
-					base.vp = std::min<uint8_t>(min_row, max_row / 2 - (max_row / 5 * sub.text_rows.size()));
-				else //if (sub.vertical_position == EbuSubtitle::PositionBottom)
-					base.vp = max_row - 1;
-
-				base.jc = sub.justification_code;
+				// The message is formatted by the writer, as translation
+				// lookups aren't safe off the main thread
+				out.status = export_settings.line_wrapping_mode == EbuExportSettings::AbortOverLength
+					? ConvertedLine::OverLength : ConvertedLine::Skipped;
+				return;
 			}
-			else
+
+			out.blocks = create_blocks(imline, encoder, export_settings);
+		}
+
+		void Work()
+		{
+			EbuTextEncoder encoder(table, export_settings);
+			auto const& lines = view.Lines();
+			for (size_t i; (i = next_line++) < lines.size(); )
 			{
-				base.vp = max_row - 1;
-				base.jc = EbuSubtitle::JustifyCentre;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					slot_free.wait(lock, [&] { return cancelled || i < written + window; });
+					if (cancelled) return;
+				}
+
+				ConvertedLine converted;
+				try
+				{
+					ConvertLine(lines[i], encoder, converted);
+				}
+				catch (...)
+				{
+					converted.error = std::current_exception();
+				}
+				converted.ready = true;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					slots[i % window] = std::move(converted);
+				}
+				slot_ready.notify_one();
 			}
+		}
 
-			// produce blocks from string
-			static const size_t block_size = sizeof(((BlockTTI*)nullptr)->tf);
-			uint8_t num_blocks = 0;
-			for (size_t pos = 0; pos < fullstring.size(); pos += block_size)
-			{
-				size_t bytes_remaining = fullstring.size() - pos;
+	public:
+		ParallelLineConverter(ExportView const& view, EbuExportSettings const& export_settings)
+		: view(view)
+		, export_settings(export_settings)
+		, table(export_settings)
+		, fps(export_settings.GetFramerate())
+		, line_wrap_type(view.File()->GetScriptInfoAsInt("WrapStyle"))
+		, slots(window)
+		{
+			EbuTimecode tcofs = export_settings.timecode_offset;
+			timecode_bias = fps.FrameAtSmpte(tcofs.h, tcofs.m, tcofs.s, tcofs.s);
 
-				tti.push_back(base);
-				// write an extension block number if the remaining text doesn't fit in the block
-				tti.back().ebn = bytes_remaining >= block_size ? num_blocks++ : 255;
+			unsigned thread_count = std::max(1u, std::thread::hardware_concurrency());
+			for (unsigned i = 0; i < thread_count && i < view.Lines().size(); ++i)
+				workers.emplace_back([=] { Work(); });
+		}
 
-				std::copy(&fullstring[pos], &fullstring[pos + std::min(block_size, bytes_remaining)], tti.back().tf);
+		~ParallelLineConverter()
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cancelled = true;
+			}
+			slot_free.notify_all();
+			for (auto& worker : workers)
+				worker.join();
+		}
 
-				// Write another block for the terminator if we exactly used up
-				// the last block
-				if (bytes_remaining == block_size)
-					tti.push_back(base);
+		/// Get the blocks for each line in order
+		/// @param write Called with the blocks of each line which isn't skipped
+		void Run(std::function<void (std::vector<BlockTTI>&)> const& write)
+		{
+			auto const& lines = view.Lines();
+			for (size_t i = 0; i < lines.size(); ++i)
+			{
+				ConvertedLine converted;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					ConvertedLine &slot = slots[i % window];
+					slot_ready.wait(lock, [&] { return slot.ready; });
+					converted = std::move(slot);
+					slot.ready = false;
+					++written;
+				}
+				slot_free.notify_all();
+
+				if (converted.error)
+					std::rethrow_exception(converted.error);
+				if (converted.status == ConvertedLine::OverLength)
+					throw Ebu3264SubtitleFormat::ConversionFailed(agi::format(_("Line over maximum length: %s"), lines[i].Text));
+				if (converted.status == ConvertedLine::Converted)
+					write(converted.blocks);
 			}
 		}
 
-		return tti;
-	}
+		/// Get an encoder for converting text on the calling thread
+		EbuTextEncoder MakeEncoder() const { return EbuTextEncoder(table, export_settings); }
+	};
 
 	void fieldprintf(char *field, size_t fieldlen, const char *format, ...)
 	{
@@ -536,11 +773,11 @@ namespace
 		memcpy(field, buf, fieldlen);
 	}
 
-	BlockGSI create_header(AssFile const& copy, EbuExportSettings const& export_settings)
+	BlockGSI create_header(const AssFile *file, EbuExportSettings const& export_settings)
 	{
-		std::string scriptinfo_title = copy.GetScriptInfo("Title");
-		std::string scriptinfo_translation = copy.GetScriptInfo("Original Translation");
-		std::string scriptinfo_editing = copy.GetScriptInfo("Original Editing");
+		std::string scriptinfo_title = file->GetScriptInfo("Title");
+		std::string scriptinfo_translation = file->GetScriptInfo("Original Translation");
+		std::string scriptinfo_editing = file->GetScriptInfo("Original Editing");
 
 		agi::charset::IconvWrapper gsi_encoder("UTF-8", "CP850");
 
@@ -622,24 +859,62 @@ Ebu3264SubtitleFormat::Ebu3264SubtitleFormat()
 {
 }
 
-void Ebu3264SubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const&) const
+void Ebu3264SubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const
+{
+	WriteView(ExportView(src), filename, fps, encoding);
+}
+
+void Ebu3264SubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const&, std::string const&) const
 {
 	// collect data from user
 	EbuExportSettings export_settings = get_export_config(nullptr);
-	AssFile copy(*src);
-
-	std::vector<EbuSubtitle> subs_list = convert_subtitles(copy, export_settings);
-	std::vector<BlockTTI> tti = create_blocks(subs_list, export_settings);
-	BlockGSI gsi = create_header(copy, export_settings);
 
-	BlockTTI &block0 = tti.front();
-	fieldprintf(gsi.tcf, 8, "%02u%02u%02u%02u", (unsigned int)block0.tci.h, (unsigned int)block0.tci.m, (unsigned int)block0.tci.s, (unsigned int)block0.tci.f);
-	fieldprintf(gsi.tnb, 5, "%5u", (unsigned int)tti.size());
-	fieldprintf(gsi.tns, 5, "%5u", (unsigned int)subs_list.size());
+	BlockGSI gsi = create_header(view.File(), export_settings);
 
-	// write file
+	// The header has the block counts and the first timecode, so it's
+	// written again once the blocks have been streamed out after it. If the
+	// conversion fails partway through, the Save is never committed, so what
+	// was written is discarded and the existing file is left alone.
 	agi::io::Save f(filename, true);
-	f.Get().write((const char *)&gsi, sizeof(gsi));
-	for (auto const& block : tti)
-		f.Get().write((const char *)&block, sizeof(block));
+	std::ostream &out = f.Get();
+	out.write((const char *)&gsi, sizeof(gsi));
+
+	uint16_t subtitle_number = 0;
+	size_t block_count = 0;
+	EbuTimecode first_tci = EbuTimecode();
+	auto write_blocks = [&](std::vector<BlockTTI> &blocks)
+	{
+		if (block_count == 0 && !blocks.empty())
+			first_tci = blocks.front().tci;
+		for (auto& block : blocks)
+		{
+			block.sn = subtitle_number;
+			out.write((const char *)&block, sizeof(block));
+		}
+		++subtitle_number;
+		block_count += blocks.size();
+	};
+
+	ParallelLineConverter converter(view, export_settings);
+	converter.Run(write_blocks);
+
+	// produce an empty line if there are none
+	// (it still has to contain a space to not get ignored)
+	if (subtitle_number == 0)
+	{
+		EbuSubtitle blank;
+		blank.text_rows.emplace_back();
+		blank.text_rows.back().emplace_back(" ");
+		auto encoder = converter.MakeEncoder();
+		auto blocks = create_blocks(blank, encoder, export_settings);
+		write_blocks(blocks);
+	}
+
+	fieldprintf(gsi.tcf, 8, "%02u%02u%02u%02u", (unsigned int)first_tci.h, (unsigned int)first_tci.m, (unsigned int)first_tci.s, (unsigned int)first_tci.f);
+	fieldprintf(gsi.tnb, 5, "%5u", (unsigned int)block_count);
+	fieldprintf(gsi.tns, 5, "%5u", (unsigned int)subtitle_number);
+
+	out.seekp(0);
+	out.write((const char *)&gsi, sizeof(gsi));
+	f.Commit();
 }
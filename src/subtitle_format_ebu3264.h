@@ -30,5 +30,8 @@ public:
 	std::vector<std::string> GetWriteWildcards() const override { return {"stl"}; }
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
 
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
+
 	DEFINE_EXCEPTION(ConversionFailed, agi::InvalidInputException);
 };
@@ -50,19 +50,14 @@ std::vector<std::string> EncoreSubtitleFormat::GetWriteWildcards() const {
 	return {"encore.txt"};
 }
 
-void EncoreSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& video_fps, std::string const&) const {
+void EncoreSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& video_fps, std::string const& encoding) const {
+	WriteView(ExportView(src), filename, video_fps, encoding);
+}
+
+void EncoreSubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& video_fps, std::string const&) const {
 	agi::vfr::Framerate fps = AskForFPS(false, true, video_fps);
 	if (!fps.IsLoaded()) return;
 
-	// Convert to encore
-	AssFile copy(*src);
-	copy.Sort();
-	StripComments(copy);
-	RecombineOverlaps(copy);
-	MergeIdentical(copy);
-	StripTags(copy);
-	ConvertNewlines(copy, "\r\n");
-
 	// Encore wants ; for NTSC and : for PAL
 	// The manual suggests no other frame rates are supported
 	agi::SmpteFormatter ft(fps, fps.NeedsDropFrames() ? ';' : ':');
@@ -70,6 +65,7 @@ void EncoreSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& fi
 	// Write lines
 	int i = 0;
 	TextFileWriter file(filename, "UTF-8");
-	for (auto const& current : copy.Events)
-		file.WriteLineToFile(agi::format("%i %s %s %s", ++i, ft.ToSMPTE(current.Start), ft.ToSMPTE(current.End), current.Text));
+	for (auto const& current : view.Lines())
+		file.WriteLineToFile(agi::format("%i %s %s %s", ++i, ft.ToSMPTE(current.Start), ft.ToSMPTE(current.End), ExportView::ConvertText(current, true, "\r\n")));
+	file.Commit();
 }
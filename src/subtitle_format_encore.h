@@ -39,4 +39,7 @@ public:
 	EncoreSubtitleFormat();
 	std::vector<std::string> GetWriteWildcards() const override;
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const&) const override;
+
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const&) const override;
 };
@@ -121,17 +121,13 @@ void MicroDVDSubtitleFormat::ReadFile(AssFile *target, agi::fs::path const& file
 }
 
 void MicroDVDSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& vfps, std::string const& encoding) const {
+	WriteView(ExportView(src), filename, vfps, encoding);
+}
+
+void MicroDVDSubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& vfps, std::string const& encoding) const {
 	agi::vfr::Framerate fps = AskForFPS(true, false, vfps);
 	if (!fps.IsLoaded()) return;
 
-	AssFile copy(*src);
-	copy.Sort();
-	StripComments(copy);
-	RecombineOverlaps(copy);
-	MergeIdentical(copy);
-	StripTags(copy);
-	ConvertNewlines(copy, "|");
-
 	TextFileWriter file(filename, encoding);
 
 	// Write FPS line
@@ -139,10 +135,11 @@ void MicroDVDSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const&
 		file.WriteLineToFile(agi::format("{1}{1}%.6f", fps.FPS()));
 
 	// Write lines
-	for (auto const& current : copy.Events) {
+	for (auto const& current : view.Lines()) {
 		int start = fps.FrameAtTime(current.Start, agi::vfr::START);
 		int end = fps.FrameAtTime(current.End, agi::vfr::END);
 
-		file.WriteLineToFile(agi::format("{%i}{%i}%s", start, end, boost::replace_all_copy(current.Text.get(), "\\N", "|")));
+		file.WriteLineToFile(agi::format("{%i}{%i}%s", start, end, ExportView::ConvertText(current, true, "|")));
 	}
+	file.Commit();
 }
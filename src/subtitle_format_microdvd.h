@@ -45,4 +45,7 @@ public:
 	void ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& forceEncoding) const override;
 
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
+
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
 };
@@ -426,28 +426,27 @@ void SRTSubtitleFormat::ReadFile(AssFile *target, agi::fs::path const& filename,
 }
 
 void SRTSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const {
+	WriteView(ExportView(src), filename, fps, encoding);
+}
+
+void SRTSubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const&, std::string const& encoding) const {
 	TextFileWriter file(filename, encoding);
 
-	// Convert to SRT
-	AssFile copy(*src);
-	copy.Sort();
-	StripComments(copy);
-	RecombineOverlaps(copy);
-	MergeIdentical(copy);
 #ifdef _WIN32
-	ConvertNewlines(copy, "\r\n", false);
+	const std::string newline = "\r\n";
 #else
-	ConvertNewlines(copy, "\n", false);
+	const std::string newline = "\n";
 #endif
 
 	// Write lines
 	int i=0;
-	for (auto const& current : copy.Events) {
+	for (auto const& current : view.Lines()) {
 		file.WriteLineToFile(std::to_string(++i));
 		file.WriteLineToFile(WriteSRTTime(current.Start) + " --> " + WriteSRTTime(current.End));
-		file.WriteLineToFile(ConvertTags(&current));
+		file.WriteLineToFile(ConvertTags(ExportView::ConvertText(current, false, newline, false)));
 		file.WriteLineToFile("");
 	}
+	file.Commit();
 }
 
 bool SRTSubtitleFormat::CanSave(const AssFile *file) const {
@@ -474,7 +473,7 @@ bool SRTSubtitleFormat::CanSave(const AssFile *file) const {
 	return true;
 }
 
-std::string SRTSubtitleFormat::ConvertTags(const AssDialogue *diag) const {
+std::string SRTSubtitleFormat::ConvertTags(std::string const& text) const {
 	struct tag_state { char tag; bool value; };
 	tag_state tag_states[] = {
 		{'b', false},
@@ -484,7 +483,7 @@ std::string SRTSubtitleFormat::ConvertTags(const AssDialogue *diag) const {
 	};
 
 	std::string final;
-	for (auto& block : diag->ParseTags()) {
+	for (auto& block : AssDialogue::ParseTags(text)) {
 		switch (block->GetType()) {
 		case AssBlockType::OVERRIDE:
 			for (auto const& tag : static_cast<AssDialogueBlockOverride&>(*block).Tags) {
@@ -34,10 +34,8 @@
 
 #include "subtitle_format.h"
 
-class AssDialogue;
-
 class SRTSubtitleFormat final : public SubtitleFormat {
-	std::string ConvertTags(const AssDialogue *diag) const;
+	std::string ConvertTags(std::string const& text) const;
 public:
 	SRTSubtitleFormat();
 	std::vector<std::string> GetReadWildcards() const override;
@@ -47,4 +45,7 @@ public:
 
 	void ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& forceEncoding) const override;
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
+
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
 };
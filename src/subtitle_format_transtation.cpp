@@ -48,24 +48,19 @@ std::vector<std::string> TranStationSubtitleFormat::GetWriteWildcards() const {
 }
 
 void TranStationSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& vfps, std::string const& encoding) const {
+	WriteView(ExportView(src), filename, vfps, encoding);
+}
+
+void TranStationSubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& vfps, std::string const& encoding) const {
 	auto fps = AskForFPS(false, true, vfps);
 	if (!fps.IsLoaded()) return;
 
-	// Convert to TranStation
-	AssFile copy(*src);
-	copy.Sort();
-	StripComments(copy);
-	RecombineOverlaps(copy);
-	MergeIdentical(copy);
-	StripTags(copy);
-	ConvertNewlines(copy, "\r\n");
-
 	agi::SmpteFormatter ft(fps);
 	TextFileWriter file(filename, encoding);
-	const AssDialogue *prev = nullptr;
-	for (auto const& cur : copy.Events) {
+	const ExportLine *prev = nullptr;
+	for (auto const& cur : view.Lines()) {
 		if (prev) {
-			file.WriteLineToFile(ConvertLine(&copy, prev, fps, ft, cur.Start));
+			file.WriteLineToFile(ConvertLine(view.File(), *prev, fps, ft, cur.Start));
 			file.WriteLineToFile("");
 		}
 
@@ -74,17 +69,18 @@ void TranStationSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path cons
 
 	// flush last line
 	if (prev)
-		file.WriteLineToFile(ConvertLine(&copy, prev, fps, ft, -1));
+		file.WriteLineToFile(ConvertLine(view.File(), *prev, fps, ft, -1));
 
 	// Every file must end with this line
 	file.WriteLineToFile("SUB[");
+	file.Commit();
 }
 
-std::string TranStationSubtitleFormat::ConvertLine(AssFile *file, const AssDialogue *current, agi::vfr::Framerate const& fps, agi::SmpteFormatter const& ft, int nextl_start) const {
+std::string TranStationSubtitleFormat::ConvertLine(const AssFile *file, ExportLine const& current, agi::vfr::Framerate const& fps, agi::SmpteFormatter const& ft, int nextl_start) const {
 	int valign = 0;
 	const char *halign = " "; // default is centered
 	const char *type = "N"; // no special style
-	if (AssStyle *style = file->GetStyle(current->Style)) {
+	if (const AssStyle *style = file->GetStyle(current.Source->Style)) {
 		if (style->alignment >= 4) valign = 4;
 		if (style->alignment >= 7) valign = 9;
 		if (style->alignment == 1 || style->alignment == 4 || style->alignment == 7) halign = "L";
@@ -94,10 +90,11 @@ std::string TranStationSubtitleFormat::ConvertLine(AssFile *file, const AssDialo
 
 	// Hack: If an italics-tag (\i1) appears anywhere in the line,
 	// make it all italics
-	if (current->Text.get().find("\\i1") != std::string::npos) type = "I";
+	std::string text = ExportView::ConvertText(current, true, "\r\n");
+	if (text.find("\\i1") != std::string::npos) type = "I";
 
 	// Write header
-	agi::Time end = current->End;
+	agi::Time end = current.End;
 
 	// Subtract one frame if the end time of the current line is equal to the
 	// start of next one, since the end timestamp is inclusive and the lines
@@ -105,6 +102,6 @@ std::string TranStationSubtitleFormat::ConvertLine(AssFile *file, const AssDialo
 	if (nextl_start > 0 && end == nextl_start)
 		end = fps.TimeAtFrame(fps.FrameAtTime(end, agi::vfr::END) - 1, agi::vfr::END);
 
-	std::string header = agi::format("SUB[%i%s%s %s>%s]\r\n", valign, halign, type, ft.ToSMPTE(current->Start), ft.ToSMPTE(end));
-	return header + current->Text.get();
+	std::string header = agi::format("SUB[%i%s%s %s>%s]\r\n", valign, halign, type, ft.ToSMPTE(current.Start), ft.ToSMPTE(end));
+	return header + text;
 }
@@ -29,14 +29,16 @@
 
 #include "subtitle_format.h"
 
-class AssDialogue;
 namespace agi { class SmpteFormatter; }
 
 class TranStationSubtitleFormat final : public SubtitleFormat {
-	std::string ConvertLine(AssFile *file, const AssDialogue *line, agi::vfr::Framerate const& fps, agi::SmpteFormatter const& ft, int nextl_start) const;
+	std::string ConvertLine(const AssFile *file, ExportLine const& line, agi::vfr::Framerate const& fps, agi::SmpteFormatter const& ft, int nextl_start) const;
 
 public:
 	TranStationSubtitleFormat();
 	std::vector<std::string> GetWriteWildcards() const override;
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
+
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
 };
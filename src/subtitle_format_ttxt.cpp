@@ -156,10 +156,10 @@ void TTXTSubtitleFormat::ProcessHeader(wxXmlNode *node) const {
 }
 
 void TTXTSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const {
-	// Convert to TTXT
-	AssFile copy(*src);
-	ConvertToTTXT(copy);
+	WriteView(ExportView(src), filename, fps, encoding);
+}
 
+void TTXTSubtitleFormat::WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const&, std::string const&) const {
 	// Create XML structure
 	wxXmlDocument doc;
 	wxXmlNode *root = new wxXmlNode(nullptr, wxXML_ELEMENT_NODE, "TextStream");
@@ -170,12 +170,19 @@ void TTXTSubtitleFormat::WriteFile(const AssFile *src, agi::fs::path const& file
 	WriteHeader(root);
 
 	// Create lines
-	const AssDialogue *prev = nullptr;
-	for (auto const& current : copy.Events) {
-		WriteLine(root, prev, &current);
+	const ExportLine *prev = nullptr;
+	for (auto const& current : view.Lines()) {
+		WriteLine(root, prev, current);
 		prev = &current;
 	}
 
+	// Insert blank line at the end
+	agi::Time lastTime;
+	if (prev)
+		lastTime = prev->End;
+	ExportLine blank{lastTime, lastTime + OPT_GET("Timing/Default Duration")->GetInt(), boost::flyweight<std::string>(), nullptr};
+	WriteLine(root, prev, blank);
+
 	// Save XML
 	doc.Save(filename.wstring());
 }
@@ -230,9 +237,9 @@ void TTXTSubtitleFormat::WriteHeader(wxXmlNode *root) const {
 	root->AddChild(node);
 }
 
-void TTXTSubtitleFormat::WriteLine(wxXmlNode *root, const AssDialogue *prev, const AssDialogue *line) const {
+void TTXTSubtitleFormat::WriteLine(wxXmlNode *root, const ExportLine *prev, ExportLine const& line) const {
 	// If it doesn't start at the end of previous, add blank
-	if (prev && prev->End != line->Start) {
+	if (prev && prev->End != line.Start) {
 		wxXmlNode *node = new wxXmlNode(wxXML_ELEMENT_NODE, "TextSample");
 		node->AddAttribute("sampleTime", to_wx("0" + prev->End.GetAssFormatted(true)));
 		node->AddAttribute("xml:space", "preserve");
@@ -242,28 +249,8 @@ void TTXTSubtitleFormat::WriteLine(wxXmlNode *root, const AssDialogue *prev, con
 
 	// Generate and insert node
 	wxXmlNode *node = new wxXmlNode(wxXML_ELEMENT_NODE, "TextSample");
-	node->AddAttribute("sampleTime", to_wx("0" + line->Start.GetAssFormatted(true)));
+	node->AddAttribute("sampleTime", to_wx("0" + line.Start.GetAssFormatted(true)));
 	node->AddAttribute("xml:space", "preserve");
 	root->AddChild(node);
-	node->AddChild(new wxXmlNode(wxXML_TEXT_NODE, "", to_wx(line->Text)));
-}
-
-void TTXTSubtitleFormat::ConvertToTTXT(AssFile &file) const {
-	file.Sort();
-	StripComments(file);
-	RecombineOverlaps(file);
-	MergeIdentical(file);
-	StripTags(file);
-	ConvertNewlines(file, "\r\n");
-
-	// Find last line
-	agi::Time lastTime;
-	if (!file.Events.empty())
-		lastTime = file.Events.back().End;
-
-	// Insert blank line at the end
-	auto diag = new AssDialogue;
-	diag->Start = lastTime;
-	diag->End = lastTime+OPT_GET("Timing/Default Duration")->GetInt();
-	file.Events.push_back(*diag);
+	node->AddChild(new wxXmlNode(wxXML_TEXT_NODE, "", to_wx(ExportView::ConvertText(line, true, "\r\n"))));
 }
@@ -42,9 +42,7 @@ class TTXTSubtitleFormat final : public SubtitleFormat {
 	void ProcessHeader(wxXmlNode *node) const;
 
 	void WriteHeader(wxXmlNode *root) const;
-	void WriteLine(wxXmlNode *root, const AssDialogue *prev, const AssDialogue *line) const;
-
-	void ConvertToTTXT(AssFile &file) const;
+	void WriteLine(wxXmlNode *root, const ExportLine *prev, ExportLine const& line) const;
 
 public:
 	TTXTSubtitleFormat();
@@ -53,4 +51,7 @@ public:
 
 	void ReadFile(AssFile *target, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& forceEncoding) const override;
 	void WriteFile(const AssFile *src, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
+
+	bool UsesExportView() const override { return true; }
+	void WriteView(ExportView const& view, agi::fs::path const& filename, agi::vfr::Framerate const& fps, std::string const& encoding) const override;
 };
@@ -89,13 +89,15 @@ CSRISubtitlesProvider::CSRISubtitlesProvider(std::string type) {
 void CSRISubtitlesProvider::DrawSubtitles(VideoFrame &dst, double time) {
 	if (!instance) return;
 
+	unsigned char *data = dst.MakeWritable();
+
 	csri_frame frame;
 	if (dst.flipped) {
-		frame.planes[0] = dst.data.data() + (dst.height-1) * dst.width * 4;
+		frame.planes[0] = data + (dst.height-1) * dst.width * 4;
 		frame.strides[0] = -(signed)dst.width * 4;
 	}
 	else {
-		frame.planes[0] = dst.data.data();
+		frame.planes[0] = data;
 		frame.strides[0] = dst.width * 4;
 	}
 	frame.pixfmt = CSRI_F_BGR_;
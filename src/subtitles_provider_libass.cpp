@@ -45,10 +45,13 @@
 #include <libaegisub/make_unique.h>
 #include <libaegisub/util.h>
 
+#include <algorithm>
 #include <atomic>
 #include <boost/gil/gil_all.hpp>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <wx/intl.h>
 #include <wx/thread.h>
@@ -84,11 +87,39 @@ struct cache_thread_shared {
 	~cache_thread_shared() { if (renderer) ass_renderer_done(renderer); }
 };
 
+/// A rectangle of rendered subtitles with all of the images libass returned
+/// for it blended together, stored as premultiplied BGRA so that putting it
+/// on a frame is one multiply-add per channel
+struct overlay_box {
+	int x, y, w, h;
+	std::vector<uint8_t> pixels;
+
+	bool Intersects(overlay_box const& o) const {
+		return x < o.x + o.w && o.x < x + w && y < o.y + o.h && o.y < y + h;
+	}
+
+	bool Contains(ASS_Image const& img) const {
+		return img.dst_x >= x && img.dst_x + img.w <= x + w && img.dst_y >= y && img.dst_y + img.h <= y + h;
+	}
+};
+
 class LibassSubtitlesProvider final : public SubtitlesProvider {
 	agi::BackgroundRunner *br;
 	std::shared_ptr<cache_thread_shared> shared;
 	ASS_Track* ass_track = nullptr;
 
+	/// The subtitles rendered for the last frame drawn
+	std::vector<overlay_box> overlay;
+	/// Frame size the overlay was rendered for
+	size_t overlay_width = 0;
+	size_t overlay_height = 0;
+	/// Does the overlay need to be rebuilt even if libass says the images
+	/// haven't changed?
+	bool overlay_dirty = true;
+
+	/// Blend the images for a frame into the overlay
+	void BuildOverlay(ASS_Image *img);
+
 	ASS_Renderer *renderer() {
 		if (shared->ready)
 			return shared->renderer;
@@ -123,6 +154,7 @@ public:
 		if (ass_track) ass_free_track(ass_track);
 		ass_track = ass_read_memory(library, const_cast<char *>(data), len, nullptr);
 		if (!ass_track) throw agi::InternalError("libass failed to load subtitles.");
+		overlay_dirty = true;
 	}
 
 	void DrawSubtitles(VideoFrame &dst, double time) override;
@@ -136,6 +168,7 @@ public:
 		shared->renderer = ass_renderer_init(library);
 		ass_set_font_scale(shared->renderer, 1.);
 		ass_set_fonts(shared->renderer, nullptr, "Sans", 1, nullptr, true);
+		overlay_dirty = true;
 	}
 };
 
@@ -164,40 +197,106 @@ LibassSubtitlesProvider::~LibassSubtitlesProvider() {
 #define _b(c) (((c)>>8)&0xFF)
 #define _a(c) ((c)&0xFF)
 
-void LibassSubtitlesProvider::DrawSubtitles(VideoFrame &frame,double time) {
-	ass_set_frame_size(renderer(), frame.width, frame.height);
+void LibassSubtitlesProvider::BuildOverlay(ASS_Image *img) {
+	overlay.clear();
+
+	// The outline, shadow and fill of a line all overlap, so merge the
+	// images into disjoint boxes, each of which is blended into once
+	for (auto cur = img; cur; cur = cur->next) {
+		if (cur->w <= 0 || cur->h <= 0) continue;
+
+		overlay_box box{cur->dst_x, cur->dst_y, cur->w, cur->h, {}};
+		for (size_t i = 0; i < overlay.size(); ) {
+			if (!box.Intersects(overlay[i])) {
+				++i;
+				continue;
+			}
+
+			int right = std::max(box.x + box.w, overlay[i].x + overlay[i].w);
+			int bottom = std::max(box.y + box.h, overlay[i].y + overlay[i].h);
+			box.x = std::min(box.x, overlay[i].x);
+			box.y = std::min(box.y, overlay[i].y);
+			box.w = right - box.x;
+			box.h = bottom - box.y;
+			overlay[i] = std::move(overlay.back());
+			overlay.pop_back();
+			// The larger box may now overlap ones already checked
+			i = 0;
+		}
+		overlay.push_back(std::move(box));
+	}
 
-	ASS_Image* img = ass_render_frame(renderer(), ass_track, int(time * 1000), nullptr);
+	for (auto& box : overlay)
+		box.pixels.assign(box.w * box.h * 4, 0);
 
 	// libass actually returns several alpha-masked monochrome images.
-	// Here, we loop through their linked list, get the colour of the current, and blend into the frame.
+	// Here, we loop through their linked list, get the colour of the current, and blend into the overlay.
 	// This is repeated for all of them.
+	for (; img; img = img->next) {
+		if (img->w <= 0 || img->h <= 0) continue;
 
-	using namespace boost::gil;
-	auto dst = interleaved_view(frame.width, frame.height, (bgra8_pixel_t*)frame.data.data(), frame.width * 4);
-	if (frame.flipped)
-		dst = flipped_up_down_view(dst);
+		auto box = std::find_if(overlay.begin(), overlay.end(), [&](overlay_box const& b) { return b.Contains(*img); });
+		if (box == overlay.end()) continue;
 
-	for (; img; img = img->next) {
 		unsigned int opacity = 255 - ((unsigned int)_a(img->color));
 		unsigned int r = (unsigned int)_r(img->color);
 		unsigned int g = (unsigned int)_g(img->color);
 		unsigned int b = (unsigned int)_b(img->color);
 
-		auto srcview = interleaved_view(img->w, img->h, (gray8_pixel_t*)img->bitmap, img->stride);
-		auto dstview = subimage_view(dst, img->dst_x, img->dst_y, img->w, img->h);
+		for (int y = 0; y < img->h; ++y) {
+			const unsigned char *src = img->bitmap + y * img->stride;
+			uint8_t *dst = &box->pixels[((img->dst_y - box->y + y) * box->w + img->dst_x - box->x) * 4];
+			for (int x = 0; x < img->w; ++x, dst += 4) {
+				unsigned int k = ((unsigned)src[x]) * opacity / 255;
+				if (!k) continue;
+				unsigned int ck = 255 - k;
+
+				dst[0] = (k * b + ck * dst[0]) / 255;
+				dst[1] = (k * g + ck * dst[1]) / 255;
+				dst[2] = (k * r + ck * dst[2]) / 255;
+				dst[3] = k + ck * dst[3] / 255;
+			}
+		}
+	}
+}
 
-		transform_pixels(dstview, srcview, dstview, [=](const bgra8_pixel_t frame, const gray8_pixel_t src) -> bgra8_pixel_t {
-			unsigned int k = ((unsigned)src) * opacity / 255;
-			unsigned int ck = 255 - k;
+void LibassSubtitlesProvider::DrawSubtitles(VideoFrame &frame,double time) {
+	ass_set_frame_size(renderer(), frame.width, frame.height);
 
-			bgra8_pixel_t ret;
-			ret[0] = (k * b + ck * frame[0]) / 255;
-			ret[1] = (k * g + ck * frame[1]) / 255;
-			ret[2] = (k * r + ck * frame[2]) / 255;
-			ret[3] = 0;
-			return ret;
-		});
+	// During playback the same line is usually shown for many frames in a
+	// row, so only blend libass's images together again if they've changed
+	int changed = 0;
+	ASS_Image* img = ass_render_frame(renderer(), ass_track, int(time * 1000), &changed);
+	if (changed || overlay_dirty || overlay_width != frame.width || overlay_height != frame.height) {
+		BuildOverlay(img);
+		overlay_width = frame.width;
+		overlay_height = frame.height;
+		overlay_dirty = false;
+	}
+
+	if (overlay.empty()) return;
+
+	using namespace boost::gil;
+	auto dst = interleaved_view(frame.width, frame.height, (bgra8_pixel_t*)frame.MakeWritable(), frame.width * 4);
+	if (frame.flipped)
+		dst = flipped_up_down_view(dst);
+
+	for (auto const& box : overlay) {
+		const uint8_t *src = box.pixels.data();
+		for (int y = 0; y < box.h; ++y) {
+			auto row = dst.row_begin(box.y + y) + box.x;
+			for (int x = 0; x < box.w; ++x, ++row, src += 4) {
+				unsigned int a = src[3];
+				if (!a) continue;
+				unsigned int ca = 255 - a;
+
+				bgra8_pixel_t& px = *row;
+				px[0] = src[0] + ca * px[0] / 255;
+				px[1] = src[1] + ca * px[1] / 255;
+				px[2] = src[2] + ca * px[2] / 255;
+				px[3] = 0;
+			}
+		}
 	}
 }
 }
@@ -209,7 +308,7 @@ std::unique_ptr<SubtitlesProvider> Create(std::string const&, agi::BackgroundRun
 
 void CacheFonts() {
 	// Initialize the cache worker thread
-	cache_queue = agi::dispatch::Create();
+	cache_queue = agi::dispatch::Create(agi::dispatch::PRIORITY_BACKGROUND);
 
 	// Initialize libass
 	library = ass_library_init();
@@ -63,3 +63,7 @@ void TextFileWriter::WriteLineToFile(std::string const& line, bool addLineBreak)
 	if (addLineBreak)
 		file->Get().write(newline.data(), newline.size());
 }
+
+void TextFileWriter::Commit() {
+	file->Commit();
+}
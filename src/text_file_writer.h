@@ -43,4 +43,7 @@ public:
 	~TextFileWriter();
 
 	void WriteLineToFile(std::string const& line, bool addLineBreak=true);
+	/// Replace the target file with what was written. The file is left
+	/// untouched if this is never called.
+	void Commit();
 };
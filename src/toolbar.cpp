@@ -71,19 +71,61 @@ namespace {
 		/// Listener for hotkey change signal
 		agi::signal::Connection hotkeys_changed_slot;
 
-		/// Enable/disable the toolbar buttons
-		void OnIdle(wxIdleEvent &) {
+		/// Commands for each of the buttons which need to be rechecked because
+		/// something they depend on has changed
+		std::vector<bool> dirty;
+		/// Tools whose commands depend on things which can't be listened for
+		std::vector<size_t> polled_tools;
+		/// Listeners for the things the commands depend on
+		std::vector<agi::signal::Connection> dependency_slots;
+		/// Has an update of the dirty tools been queued?
+		bool update_queued = false;
+
+		/// Enable/disable and check/uncheck a single toolbar button
+		void UpdateTool(size_t i) {
+			if (commands[i]->Type() & cmd::COMMAND_VALIDATE)
+				EnableTool(TOOL_ID_BASE + i, commands[i]->Validate(context));
+			if (commands[i]->Type() & cmd::COMMAND_TOGGLE || commands[i]->Type() & cmd::COMMAND_RADIO)
+				ToggleTool(TOOL_ID_BASE + i, commands[i]->IsActive(context));
+		}
+
+		/// Mark the tools depending on something as needing an update
+		void OnDependencyChanged(int dependency) {
 			for (size_t i = 0; i < commands.size(); ++i) {
-				if (commands[i]->Type() & cmd::COMMAND_VALIDATE)
-					EnableTool(TOOL_ID_BASE + i, commands[i]->Validate(context));
-				if (commands[i]->Type() & cmd::COMMAND_TOGGLE || commands[i]->Type() & cmd::COMMAND_RADIO)
-					ToggleTool(TOOL_ID_BASE + i, commands[i]->IsActive(context));
+				if (commands[i]->Type() != cmd::COMMAND_NORMAL && commands[i]->Dependencies() & dependency)
+					dirty[i] = true;
 			}
+			QueueUpdate();
+		}
+
+		/// Update the dirty tools once the current event has been handled, so
+		/// that a burst of changes results in a single update
+		void QueueUpdate() {
+			if (update_queued) return;
+			update_queued = true;
+			CallAfter(&Toolbar::UpdateDirtyTools);
+		}
+
+		void UpdateDirtyTools() {
+			update_queued = false;
+			for (size_t i = 0; i < commands.size(); ++i) {
+				if (dirty[i]) {
+					dirty[i] = false;
+					UpdateTool(i);
+				}
+			}
+		}
+
+		/// Update the buttons whose state can't be tracked by listening for
+		/// changes
+		void OnIdle(wxIdleEvent &) {
+			for (size_t i : polled_tools)
+				UpdateTool(i);
 		}
 
 		/// Toolbar button click handler
 		void OnClick(wxCommandEvent &evt) {
-			(*commands[evt.GetId() - TOOL_ID_BASE])(context);
+			cmd::call(commands[evt.GetId() - TOOL_ID_BASE]->name(), context);
 		}
 
 		/// Regenerate the toolbar when the icon size changes
@@ -97,6 +139,9 @@ namespace {
 			Unbind(wxEVT_IDLE, &Toolbar::OnIdle, this);
 			ClearTools();
 			commands.clear();
+			dirty.clear();
+			polled_tools.clear();
+			dependency_slots.clear();
 			Populate();
 		}
 
@@ -111,7 +156,7 @@ namespace {
 
 			json::Array const& arr = root_it->second;
 			commands.reserve(arr.size());
-			bool needs_onidle = false;
+			int dependencies = 0;
 			bool last_was_sep = false;
 
 			for (json::String const& command_name : arr) {
@@ -142,16 +187,34 @@ namespace {
 				wxBitmap const& bitmap = command->Icon(icon_size, GetLayoutDirection());
 				AddTool(TOOL_ID_BASE + commands.size(), command->StrDisplay(context), bitmap, GetTooltip(command), kind);
 
+				size_t i = commands.size();
 				commands.push_back(command);
-				needs_onidle = needs_onidle || flags != cmd::COMMAND_NORMAL;
+				dirty.push_back(flags != cmd::COMMAND_NORMAL);
+				if (flags == cmd::COMMAND_NORMAL) continue;
+
+				int depends = command->Dependencies();
+				if (depends & cmd::DEPENDS_UNKNOWN)
+					polled_tools.push_back(i);
+				else if (depends & cmd::DEPENDS_OPTION && command->Option()) {
+					dependency_slots.push_back(OPT_SUB(command->Option(), [=](agi::OptionValue const&) {
+						dirty[i] = true;
+						QueueUpdate();
+					}));
+				}
+				dependencies |= depends;
 			}
 
-			// Only bind the update function if there are actually any dynamic tools
-			if (needs_onidle) {
+			for (auto& slot : cmd::listen(context, dependencies & cmd::DEPENDS_ALL, [=](int dependency) { OnDependencyChanged(dependency); }))
+				dependency_slots.push_back(std::move(slot));
+
+			// Only bind the update function if there are actually any tools
+			// which need polling
+			if (!polled_tools.empty()) {
 				Bind(wxEVT_IDLE, &Toolbar::OnIdle, this);
 			}
 
 			Realize();
+			QueueUpdate();
 		}
 
 		wxString GetTooltip(cmd::Command *command) {
@@ -158,7 +158,7 @@ void SetClipboard(wxBitmap const& new_data) {
 void CleanCache(agi::fs::path const& directory, std::string const& file_type, uint64_t max_size, uint64_t max_files) {
 	static std::unique_ptr<agi::dispatch::Queue> queue;
 	if (!queue)
-		queue = agi::dispatch::Create();
+		queue = agi::dispatch::Create(agi::dispatch::PRIORITY_BACKGROUND);
 
 	max_size <<= 20;
 	if (max_files == 0)
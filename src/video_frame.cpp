@@ -16,10 +16,84 @@
 
 #include "video_frame.h"
 
+#include <libaegisub/make_unique.h>
+
+#include <algorithm>
 #include <boost/gil/gil_all.hpp>
+#include <mutex>
 #include <wx/image.h>
 
 namespace {
+	typedef std::vector<unsigned char> buffer_type;
+
+	/// Recycles the buffers of frames which are no longer referenced, as
+	/// allocating and faulting in a new multi-megabyte buffer for every frame
+	/// is a significant part of the cost of seeking at high resolutions
+	class BufferPool final : public std::enable_shared_from_this<BufferPool> {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<buffer_type>> unused;
+		/// Total capacity in bytes of the buffers in unused
+		size_t unused_bytes = 0;
+
+		/// Maximum number of bytes of unused buffers to hold on to, which is
+		/// a handful of 1080p frames or two 4K frames
+		static const size_t max_unused_bytes = 72 * 1024 * 1024;
+
+		void Release(buffer_type *buf) {
+			std::unique_ptr<buffer_type> owned(buf);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (owned->capacity() > max_unused_bytes) return;
+
+			// Drop the oldest buffers so that buffers of a size which is no
+			// longer in use age out
+			unused_bytes += owned->capacity();
+			unused.push_back(std::move(owned));
+			while (unused_bytes > max_unused_bytes) {
+				unused_bytes -= unused.front()->capacity();
+				unused.erase(unused.begin());
+			}
+		}
+
+	public:
+		std::shared_ptr<buffer_type> Get(size_t size) {
+			std::unique_ptr<buffer_type> buf;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				auto it = std::find_if(unused.rbegin(), unused.rend(),
+					[=](std::unique_ptr<buffer_type> const& b) { return b->size() == size; });
+				// Reuse a larger buffer only if it isn't much larger, so that
+				// small frames don't each pin a full-sized frame's memory
+				if (it == unused.rend())
+					it = std::find_if(unused.rbegin(), unused.rend(),
+						[=](std::unique_ptr<buffer_type> const& b) { return b->capacity() >= size && b->capacity() <= size * 2; });
+				if (it != unused.rend()) {
+					buf = std::move(*it);
+					unused_bytes -= buf->capacity();
+					unused.erase(std::next(it).base());
+				}
+			}
+
+			if (!buf)
+				buf = agi::make_unique<buffer_type>();
+			buf->resize(size);
+
+			// The deleter keeps the pool alive until every buffer is gone
+			auto self = shared_from_this();
+			return std::shared_ptr<buffer_type>(buf.release(), [=](buffer_type *b) { self->Release(b); });
+		}
+
+		void Clear() {
+			std::lock_guard<std::mutex> lock(mutex);
+			unused.clear();
+			unused_bytes = 0;
+		}
+	};
+
+	std::shared_ptr<BufferPool> const& pool() {
+		static auto pool = std::make_shared<BufferPool>();
+		return pool;
+	}
+
 	// We actually have bgr_, not bgra, so we need a custom converter which ignores the alpha channel
 	struct color_converter {
 		template <typename P1, typename P2>
@@ -33,14 +107,70 @@ namespace {
 	};
 }
 
+unsigned char *VideoFrame::Allocate(size_t size) {
+	if (!buffer || buffer.use_count() != 1 || buffer->size() != size)
+		buffer = pool()->Get(size);
+	return buffer->data();
+}
+
+void VideoFrame::Assign(unsigned char const* begin, unsigned char const* end) {
+	std::copy(begin, end, Allocate(end - begin));
+}
+
+unsigned char *VideoFrame::MakeWritable() {
+	if (!buffer) return nullptr;
+	if (buffer.use_count() != 1) {
+		auto copy = pool()->Get(buffer->size());
+		std::copy(buffer->begin(), buffer->end(), copy->begin());
+		buffer = std::move(copy);
+	}
+	return buffer->data();
+}
+
+void ReleaseFrameBuffers() {
+	pool()->Clear();
+}
+
 wxImage GetImage(VideoFrame const& frame) {
 	using namespace boost::gil;
 
 	wxImage img(frame.width, frame.height);
-	auto src = interleaved_view(frame.width, frame.height, (bgra8_pixel_t*)frame.data.data(), frame.pitch);
+	auto src = interleaved_view(frame.width, frame.height, (bgra8_pixel_t*)frame.data(), frame.pitch);
 	auto dst = interleaved_view(frame.width, frame.height, (rgb8_pixel_t*)img.GetData(), 3 * frame.width);
 	if (frame.flipped)
 		src = flipped_up_down_view(src);
 	copy_and_convert_pixels(src, dst, color_converter());
 	return img;
 }
+
+std::vector<unsigned char> GetThumbnail(VideoFrame const& frame, size_t width, size_t height) {
+	std::vector<unsigned char> ret(width * height * 3);
+	if (!frame.data() || !width || !height) return ret;
+
+	auto out = ret.begin();
+	for (size_t y = 0; y < height; ++y) {
+		size_t y1 = y * frame.height / height;
+		size_t y2 = std::max(y1 + 1, (y + 1) * frame.height / height);
+		for (size_t x = 0; x < width; ++x) {
+			size_t x1 = x * frame.width / width;
+			size_t x2 = std::max(x1 + 1, (x + 1) * frame.width / width);
+
+			size_t sum[3] = {0, 0, 0};
+			for (size_t sy = y1; sy < y2; ++sy) {
+				size_t row = frame.flipped ? frame.height - 1 - sy : sy;
+				auto src = frame.data() + row * frame.pitch + x1 * 4;
+				for (size_t sx = x1; sx < x2; ++sx, src += 4) {
+					sum[0] += src[2];
+					sum[1] += src[1];
+					sum[2] += src[0];
+				}
+			}
+
+			size_t count = (y2 - y1) * (x2 - x1);
+			*out++ = sum[0] / count;
+			*out++ = sum[1] / count;
+			*out++ = sum[2] / count;
+		}
+	}
+	return ret;
+}
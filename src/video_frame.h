@@ -14,16 +14,53 @@
 //
 // Aegisub Project http://www.aegisub.org/
 
+#pragma once
+
+#include <memory>
 #include <vector>
 
 class wxImage;
 
+/// A decoded BGRA video frame
+///
+/// The pixel data is reference counted and shared by copies of the frame, so
+/// passing frames between providers, the cache and the display does not copy
+/// the pixels. Anything which wants to modify the pixels must go through
+/// MakeWritable(), which copies the data first if it is shared.
 struct VideoFrame {
-	std::vector<unsigned char> data;
-	size_t width;
-	size_t height;
-	size_t pitch;
-	bool flipped;
+	size_t width = 0;
+	size_t height = 0;
+	size_t pitch = 0;
+	bool flipped = false;
+
+	/// Read-only pointer to the pixel data
+	unsigned char const* data() const { return buffer ? buffer->data() : nullptr; }
+	/// Size of the pixel data in bytes
+	size_t size() const { return buffer ? buffer->size() : 0; }
+
+	/// Get a buffer of the given size which is not shared with any other frame
+	///
+	/// The contents of the returned buffer are unspecified, so this is only
+	/// suitable for when the entire frame is about to be overwritten.
+	unsigned char *Allocate(size_t size);
+
+	/// Replace the pixel data with a copy of [begin, end)
+	void Assign(unsigned char const* begin, unsigned char const* end);
+
+	/// Get a writable pointer to the pixel data, copying it first if it is
+	/// shared with any other frame
+	unsigned char *MakeWritable();
+
+private:
+	std::shared_ptr<std::vector<unsigned char>> buffer;
 };
 
+/// Free the buffers kept for reuse by future frames, for when the video they
+/// were decoded from has been closed
+void ReleaseFrameBuffers();
+
 wxImage GetImage(VideoFrame const& frame);
+
+/// Scale a frame down to the given size by averaging each block of pixels
+/// @return 24-bit RGB pixels, top row first
+std::vector<unsigned char> GetThumbnail(VideoFrame const& frame, size_t width, size_t height);
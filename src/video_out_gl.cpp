@@ -261,7 +261,7 @@ void VideoOutGL::UploadFrameData(VideoFrame const& frame) {
 	for (auto& ti : textureList) {
 		CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, ti.textureID));
 		CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ti.sourceW,
-			ti.sourceH, GL_BGRA_EXT, GL_UNSIGNED_BYTE, &frame.data[ti.dataOffset]));
+			ti.sourceH, GL_BGRA_EXT, GL_UNSIGNED_BYTE, frame.data() + ti.dataOffset));
 	}
 
 	CHECK_ERROR(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
@@ -314,7 +314,7 @@ void AvisynthVideoProvider::GetFrame(int n, VideoFrame &out) {
 
 	auto frame = RGB32Video->GetFrame(n, avs.GetEnv());
 	auto ptr = frame->GetReadPtr();
-	out.data.assign(ptr, ptr + frame->GetPitch() * frame->GetHeight());
+	out.Assign(ptr, ptr + frame->GetPitch() * frame->GetHeight());
 	out.flipped = true;
 	out.height = frame->GetHeight();
 	out.width = frame->GetRowSize() / 4;
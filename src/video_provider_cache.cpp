@@ -54,6 +54,7 @@ public:
 	VideoProviderCache(std::unique_ptr<VideoProvider> master) : master(std::move(master)) { }
 
 	void GetFrame(int n, VideoFrame &frame) override;
+	void GetFrameUncached(int n, VideoFrame &frame) override;
 
 	void SetColorSpace(std::string const& m) override {
 		cache.clear();
@@ -84,7 +85,7 @@ void VideoProviderCache::GetFrame(int n, VideoFrame &out) {
 			return;
 		}
 
-		total_size += cur->frame.data.size();
+		total_size += cur->frame.size();
 	}
 
 	master->GetFrame(n, out);
@@ -97,6 +98,18 @@ void VideoProviderCache::GetFrame(int n, VideoFrame &out) {
 	else
 		cache.emplace_front(out, n);
 }
+
+void VideoProviderCache::GetFrameUncached(int n, VideoFrame &out) {
+	// Use a cached copy if there is one, but leave the LRU order alone
+	for (auto const& cached : cache) {
+		if (cached.frame_number == n) {
+			out = cached.frame;
+			return;
+		}
+	}
+
+	master->GetFrameUncached(n, out);
+}
 }
 
 std::unique_ptr<VideoProvider> CreateCacheVideoProvider(std::unique_ptr<VideoProvider> parent) {
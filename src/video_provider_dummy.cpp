@@ -35,7 +35,6 @@
 #include "video_provider_dummy.h"
 
 #include "colorspace.h"
-#include "video_frame.h"
 
 #include <libaegisub/color.h>
 #include <libaegisub/make_unique.h>
@@ -53,14 +52,18 @@ DummyVideoProvider::DummyVideoProvider(double fps, int frames, int width, int he
 , width(width)
 , height(height)
 {
-	data.resize(width * height * 4);
+	frame.width = width;
+	frame.height = height;
+	frame.pitch = width * 4;
+	frame.flipped = false;
+	auto data = frame.Allocate(width * height * 4);
 
 	auto red = colour.r;
 	auto green = colour.g;
 	auto blue = colour.b;
 
 	using namespace boost::gil;
-	auto dst = interleaved_view(width, height, (bgra8_pixel_t*)data.data(), 4 * width);
+	auto dst = interleaved_view(width, height, (bgra8_pixel_t*)data, 4 * width);
 
 	bgra8_pixel_t colors[2] = {
 		bgra8_pixel_t(blue, green, red, 0),
@@ -91,12 +94,8 @@ std::string DummyVideoProvider::MakeFilename(double fps, int frames, int width,
 	return agi::format("?dummy:%f:%d:%d:%d:%d:%d:%d:%s", fps, frames, width, height, (int)colour.r, (int)colour.g, (int)colour.b, (pattern ? "c" : ""));
 }
 
-void DummyVideoProvider::GetFrame(int, VideoFrame &frame) {
-	frame.data    = data;
-	frame.width   = width;
-	frame.height  = height;
-	frame.pitch   = width * 4;
-	frame.flipped = false;
+void DummyVideoProvider::GetFrame(int, VideoFrame &out) {
+	out = frame;
 }
 
 namespace agi { class BackgroundRunner; }
@@ -313,7 +313,7 @@ void FFmpegSourceVideoProvider::GetFrame(int n, VideoFrame &out) {
 	if (!frame)
 		throw VideoDecodeError(std::string("Failed to retrieve frame: ") +  ErrInfo.Buffer);
 
-	out.data.assign(frame->Data[0], frame->Data[0] + frame->Linesize[0] * Height);
+	out.Assign(frame->Data[0], frame->Data[0] + frame->Linesize[0] * Height);
 	out.flipped = false;
 	out.width = Width;
 	out.height = Height;
@@ -0,0 +1,230 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+/// @file video_provider_image_sequence.cpp
+/// @brief Video provider reading numbered sequences of PNG or BMP images
+/// @ingroup video_input
+///
+
+#include "include/aegisub/video_provider.h"
+
+#include "options.h"
+#include "utils.h"
+#include "video_frame.h"
+#include "video_provider_read_ahead.h"
+
+#include <libaegisub/file_mapping.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/log.h>
+#include <libaegisub/make_unique.h>
+
+#include <algorithm>
+#include <boost/algorithm/string/predicate.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <wx/image.h>
+#include <wx/mstream.h>
+
+namespace {
+template<typename T>
+T read_le(const unsigned char *data) {
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); ++i)
+		value |= static_cast<T>(data[i]) << (8 * i);
+	return value;
+}
+
+/// Decode an uncompressed 24 or 32 bit BMP directly into the frame
+/// @return false if the file is some other sort of BMP
+bool decode_bmp(const unsigned char *data, uint64_t size, VideoFrame &frame) {
+	if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+
+	const uint32_t offset = read_le<uint32_t>(data + 10);
+	const int32_t width = static_cast<int32_t>(read_le<uint32_t>(data + 18));
+	const int32_t height = static_cast<int32_t>(read_le<uint32_t>(data + 22));
+	const uint16_t bpp = read_le<uint16_t>(data + 28);
+	const uint32_t compression = read_le<uint32_t>(data + 30);
+
+	if (compression != 0 || (bpp != 24 && bpp != 32) || width <= 0 || height == 0)
+		return false;
+
+	const size_t rows = std::abs(height);
+	const size_t stride = (size_t(width) * bpp / 8 + 3) & ~size_t(3);
+	if (offset + stride * rows > size)
+		throw VideoDecodeError("Truncated BMP file");
+
+	// Bottom-up BMPs are stored the same way as flipped frames, so the rows
+	// can be copied across in file order either way
+	auto src = data + offset;
+	auto dst = frame.Allocate(size_t(width) * rows * 4);
+	for (size_t y = 0; y < rows; ++y, src += stride) {
+		if (bpp == 32) {
+			memcpy(dst, src, width * 4);
+			dst += width * 4;
+		}
+		else {
+			for (int32_t x = 0; x < width; ++x) {
+				*dst++ = src[x * 3];
+				*dst++ = src[x * 3 + 1];
+				*dst++ = src[x * 3 + 2];
+				*dst++ = 0;
+			}
+		}
+	}
+
+	frame.flipped = height > 0;
+	frame.width = width;
+	frame.height = rows;
+	frame.pitch = width * 4;
+	return true;
+}
+
+/// Decode any other image format wx knows about
+void decode_wx(const unsigned char *data, uint64_t size, VideoFrame &frame) {
+	wxMemoryInputStream stream(data, size);
+	wxImage img;
+	if (!img.LoadFile(stream, wxBITMAP_TYPE_ANY))
+		throw VideoDecodeError("Could not decode image");
+
+	const size_t width = img.GetWidth(), height = img.GetHeight();
+	auto src = img.GetData();
+	auto dst = frame.Allocate(width * height * 4);
+	for (size_t i = 0; i < width * height; ++i, src += 3) {
+		*dst++ = src[2];
+		*dst++ = src[1];
+		*dst++ = src[0];
+		*dst++ = 0;
+	}
+
+	frame.flipped = false;
+	frame.width = width;
+	frame.height = height;
+	frame.pitch = width * 4;
+}
+
+/// @class ImageSequenceVideoProvider
+/// @brief Treats a directory of numbered images as a video
+///
+/// Opening any image in the sequence opens all of the images in the same
+/// directory with the same name apart from the number, ordered by number.
+/// Each image is memory mapped and decoded when needed, so there is no
+/// indexing step and seeking costs the same as decoding a single frame.
+class ImageSequenceVideoProvider final : public VideoProvider {
+	std::vector<agi::fs::path> files;
+	int w = 0, h = 0;
+	agi::vfr::Framerate fps;
+
+	std::unique_ptr<FrameReadAhead> read_ahead;
+
+	void DecodeFrame(int n, VideoFrame &frame);
+
+public:
+	ImageSequenceVideoProvider(std::vector<agi::fs::path> files);
+
+	void GetFrame(int n, VideoFrame &frame) override {
+		read_ahead->GetFrame(mid<int>(0, n, files.size() - 1), frame);
+	}
+	void GetFrameUncached(int n, VideoFrame &frame) override {
+		read_ahead->GetFrameUncached(mid<int>(0, n, files.size() - 1), frame);
+	}
+	// The images are already RGB, so there's no matrix to change
+	void SetColorSpace(std::string const&) override { }
+
+	int GetFrameCount() const override             { return files.size(); }
+	int GetWidth() const override                  { return w; }
+	int GetHeight() const override                 { return h; }
+	double GetDAR() const override                 { return 0; }
+	agi::vfr::Framerate GetFPS() const override    { return fps; }
+	std::vector<int> GetKeyFrames() const override { return {}; }
+	std::string GetColorSpace() const override     { return "None"; }
+	std::string GetDecoderName() const override    { return "Image sequence"; }
+	bool WantsCaching() const override             { return true; }
+};
+
+ImageSequenceVideoProvider::ImageSequenceVideoProvider(std::vector<agi::fs::path> files)
+: files(std::move(files))
+, fps(OPT_GET("Provider/Video/Raw/FPS")->GetDouble())
+{
+	VideoFrame first;
+	try {
+		DecodeFrame(0, first);
+	}
+	catch (VideoDecodeError const& e) {
+		throw VideoOpenError(e.GetMessage());
+	}
+	w = first.width;
+	h = first.height;
+
+	read_ahead = agi::make_unique<FrameReadAhead>(this->files.size(), [=](int n, VideoFrame &frame) { DecodeFrame(n, frame); });
+}
+
+void ImageSequenceVideoProvider::DecodeFrame(int n, VideoFrame &frame) {
+	agi::read_file_mapping file(files[n]);
+	auto data = reinterpret_cast<const unsigned char *>(file.read());
+
+	if (!decode_bmp(data, file.size(), frame))
+		decode_wx(data, file.size(), frame);
+
+	if (w && ((int)frame.width != w || (int)frame.height != h))
+		throw VideoDecodeError("Image " + files[n].filename().string() + " is not the same size as the first image in the sequence");
+}
+
+/// Longest frame number which is guaranteed to fit in a uint64_t
+const size_t max_frame_digits = 18;
+
+/// Find the other images in the sequence the given file belongs to
+std::vector<agi::fs::path> find_sequence(agi::fs::path const& filename) {
+	const auto ext = filename.extension().string();
+	const auto stem = filename.stem().string();
+
+	const size_t digits = stem.find_last_not_of("0123456789") + 1;
+	if (digits == stem.size() || stem.size() - digits > max_frame_digits)
+		return {};
+	const auto prefix = stem.substr(0, digits);
+
+	std::vector<std::pair<uint64_t, agi::fs::path>> numbered;
+	auto dir = filename.parent_path();
+	for (auto const& name : agi::fs::DirectoryIterator(dir, "")) {
+		if (name.size() <= prefix.size() + ext.size()) continue;
+		if (!boost::starts_with(name, prefix) || !boost::iends_with(name, ext)) continue;
+
+		auto number = name.substr(prefix.size(), name.size() - prefix.size() - ext.size());
+		if (number.size() > max_frame_digits) continue;
+		if (number.find_first_not_of("0123456789") != std::string::npos) continue;
+		numbered.emplace_back(std::stoull(number), dir/name);
+	}
+
+	std::sort(begin(numbered), end(numbered));
+	std::vector<agi::fs::path> files;
+	files.reserve(numbered.size());
+	for (auto& file : numbered)
+		files.push_back(std::move(file.second));
+	return files;
+}
+}
+
+namespace agi { class BackgroundRunner; }
+std::unique_ptr<VideoProvider> CreateImageSequenceVideoProvider(agi::fs::path const& path, std::string const&, agi::BackgroundRunner *) {
+	auto ext = path.extension().string();
+	if (!boost::iequals(ext, ".png") && !boost::iequals(ext, ".bmp"))
+		return {};
+	if (!agi::fs::FileExists(path))
+		throw agi::fs::FileNotFound(path);
+
+	auto files = find_sequence(path);
+	if (files.empty())
+		throw VideoNotSupported("Image file name has no frame number");
+	return agi::make_unique<ImageSequenceVideoProvider>(std::move(files));
+}
@@ -27,6 +27,8 @@
 
 std::unique_ptr<VideoProvider> CreateDummyVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
 std::unique_ptr<VideoProvider> CreateYUV4MPEGVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
+std::unique_ptr<VideoProvider> CreateRawYUVVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
+std::unique_ptr<VideoProvider> CreateImageSequenceVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
 std::unique_ptr<VideoProvider> CreateFFmpegSourceVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
 std::unique_ptr<VideoProvider> CreateAvisynthVideoProvider(agi::fs::path const&, std::string const&, agi::BackgroundRunner *);
 
@@ -42,6 +44,8 @@ namespace {
 	const factory providers[] = {
 		{"Dummy", CreateDummyVideoProvider, true},
 		{"YUV4MPEG", CreateYUV4MPEGVideoProvider, true},
+		{"Raw YUV", CreateRawYUVVideoProvider, true},
+		{"Image Sequence", CreateImageSequenceVideoProvider, true},
 #ifdef WITH_FFMS2
 		{"FFmpegSource", CreateFFmpegSourceVideoProvider, false},
 #endif
@@ -0,0 +1,232 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+/// @file video_provider_raw_yuv.cpp
+/// @brief Video provider reading headerless planar YUV files
+/// @ingroup video_input
+///
+
+#include "include/aegisub/video_provider.h"
+
+#include "options.h"
+#include "utils.h"
+#include "video_frame.h"
+#include "video_provider_read_ahead.h"
+
+#include <libaegisub/file_mapping.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/log.h>
+#include <libaegisub/make_unique.h>
+#include <libaegisub/util.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/regex.hpp>
+#include <climits>
+
+namespace {
+inline unsigned char clamp_channel(int fixed) {
+	return static_cast<unsigned char>(mid(0, fixed >> 16, 255));
+}
+
+/// @class RawYUVVideoProvider
+/// @brief Reads 8-bit planar YUV with no header
+///
+/// As the file has no header, the geometry is taken from the file name when it
+/// contains it in the usual form (e.g. clip_1920x1080_yuv422p.yuv), and from
+/// the options otherwise. Every frame is the same size, so seeking is just
+/// arithmetic on the file offset.
+class RawYUVVideoProvider final : public VideoProvider {
+	agi::read_file_mapping file;
+
+	int w = 0, h = 0;
+	int x_shift = 1, y_shift = 1; ///< log2 of the chroma subsampling factors
+	int chroma_w = 0, chroma_h = 0;
+	uint64_t luma_sz = 0, chroma_sz = 0, frame_sz = 0;
+	int num_frames = 0;
+	agi::vfr::Framerate fps;
+	std::string colorspace;
+
+	/// Contributions of each component to the output channels, in 16.16
+	/// fixed point, so that converting a pixel is just a few table lookups
+	struct {
+		int y[256];
+		int r_cr[256];
+		int g_cb[256];
+		int g_cr[256];
+		int b_cb[256];
+	} tables;
+
+	std::unique_ptr<FrameReadAhead> read_ahead;
+
+	/// Fill the conversion tables for the named matrix
+	/// @return false if the matrix isn't supported
+	bool SetTables(std::string const& matrix);
+	void DecodeFrame(int n, VideoFrame &frame);
+
+public:
+	RawYUVVideoProvider(agi::fs::path const& filename);
+
+	void GetFrame(int n, VideoFrame &frame) override {
+		read_ahead->GetFrame(mid(0, n, num_frames - 1), frame);
+	}
+	void GetFrameUncached(int n, VideoFrame &frame) override {
+		read_ahead->GetFrameUncached(mid(0, n, num_frames - 1), frame);
+	}
+	void SetColorSpace(std::string const& matrix) override;
+
+	int GetFrameCount() const override             { return num_frames; }
+	int GetWidth() const override                  { return w; }
+	int GetHeight() const override                 { return h; }
+	double GetDAR() const override                 { return 0; }
+	agi::vfr::Framerate GetFPS() const override    { return fps; }
+	std::vector<int> GetKeyFrames() const override { return {}; }
+	std::string GetColorSpace() const override     { return colorspace; }
+	std::string GetDecoderName() const override    { return "Raw YUV"; }
+	bool WantsCaching() const override             { return true; }
+};
+
+RawYUVVideoProvider::RawYUVVideoProvider(agi::fs::path const& filename)
+: file(filename)
+, fps(OPT_GET("Provider/Video/Raw/FPS")->GetDouble())
+{
+	auto name = boost::to_lower_copy(filename.stem().string());
+
+	boost::smatch geometry;
+	if (boost::regex_search(name, geometry, boost::regex("(\\d+)x(\\d+)"))) {
+		agi::util::try_parse(geometry[1].str(), &w);
+		agi::util::try_parse(geometry[2].str(), &h);
+	}
+	else {
+		w = OPT_GET("Provider/Video/Raw/Width")->GetInt();
+		h = OPT_GET("Provider/Video/Raw/Height")->GetInt();
+	}
+	if (w <= 0 || h <= 0)
+		throw VideoOpenError("Invalid resolution for raw video");
+
+	std::string subsampling = OPT_GET("Provider/Video/Raw/Chroma Subsampling")->GetString();
+	if (boost::contains(name, "420p"))
+		subsampling = "4:2:0";
+	else if (boost::contains(name, "422p"))
+		subsampling = "4:2:2";
+	else if (boost::contains(name, "444p"))
+		subsampling = "4:4:4";
+
+	if (subsampling == "4:2:0")
+		x_shift = y_shift = 1;
+	else if (subsampling == "4:2:2")
+		x_shift = 1, y_shift = 0;
+	else if (subsampling == "4:4:4")
+		x_shift = y_shift = 0;
+	else
+		throw VideoOpenError("Unsupported chroma subsampling: " + subsampling);
+
+	chroma_w = (w + (1 << x_shift) - 1) >> x_shift;
+	chroma_h = (h + (1 << y_shift) - 1) >> y_shift;
+	luma_sz = (uint64_t)w * h;
+	chroma_sz = (uint64_t)chroma_w * chroma_h;
+	frame_sz = luma_sz + chroma_sz * 2;
+
+	if (file.size() < frame_sz)
+		throw VideoOpenError("File is smaller than a single frame at the given resolution");
+	if (file.size() % frame_sz)
+		LOG_W("provider/video/raw_yuv") << "File size is not a multiple of the frame size; ignoring the partial frame at the end";
+	num_frames = mid<uint64_t>(1, file.size() / frame_sz, INT_MAX);
+
+	// Same heuristic as everything else for files which don't say
+	colorspace = w > 1024 || h >= 600 ? "TV.709" : "TV.601";
+	SetTables(colorspace);
+
+	read_ahead = agi::make_unique<FrameReadAhead>(num_frames, [=](int n, VideoFrame &frame) { DecodeFrame(n, frame); });
+}
+
+bool RawYUVVideoProvider::SetTables(std::string const& matrix) {
+	double kr, kb;
+	auto coefficients = matrix.size() > 3 ? matrix.substr(3) : "";
+	if (coefficients == "601")
+		kr = 0.299, kb = 0.114;
+	else if (coefficients == "709")
+		kr = 0.2126, kb = 0.0722;
+	else if (coefficients == "FCC")
+		kr = 0.30, kb = 0.11;
+	else if (coefficients == "240M")
+		kr = 0.212, kb = 0.087;
+	else
+		return false;
+
+	bool tv;
+	if (boost::starts_with(matrix, "TV."))
+		tv = true;
+	else if (boost::starts_with(matrix, "PC."))
+		tv = false;
+	else
+		return false;
+
+	const double kg = 1 - kr - kb;
+	const double y_scale = (tv ? 255. / 219. : 1.) * 65536;
+	const double c_scale = (tv ? 255. / 224. : 1.) * 65536;
+	const int y_offset = tv ? 16 : 0;
+	for (int i = 0; i < 256; ++i) {
+		tables.y[i] = static_cast<int>(y_scale * (i - y_offset) + 32768);
+		tables.r_cr[i] = static_cast<int>(c_scale * 2 * (1 - kr) * (i - 128));
+		tables.g_cb[i] = static_cast<int>(-c_scale * 2 * (1 - kb) * kb / kg * (i - 128));
+		tables.g_cr[i] = static_cast<int>(-c_scale * 2 * (1 - kr) * kr / kg * (i - 128));
+		tables.b_cb[i] = static_cast<int>(c_scale * 2 * (1 - kb) * (i - 128));
+	}
+	return true;
+}
+
+void RawYUVVideoProvider::SetColorSpace(std::string const& matrix) {
+	if (matrix == colorspace) return;
+	read_ahead->Reset([&] {
+		if (SetTables(matrix))
+			colorspace = matrix;
+	});
+}
+
+void RawYUVVideoProvider::DecodeFrame(int n, VideoFrame &frame) {
+	auto src = reinterpret_cast<const unsigned char *>(file.read(frame_sz * n, frame_sz));
+	auto src_u = src + luma_sz;
+	auto src_v = src_u + chroma_sz;
+	unsigned char *dst = frame.Allocate(size_t(w) * h * 4);
+
+	for (int py = 0; py < h; ++py) {
+		auto y_row = src + (size_t)py * w;
+		auto u_row = src_u + (size_t)(py >> y_shift) * chroma_w;
+		auto v_row = src_v + (size_t)(py >> y_shift) * chroma_w;
+		for (int px = 0; px < w; ++px) {
+			const int y = tables.y[y_row[px]];
+			const int cb = u_row[px >> x_shift];
+			const int cr = v_row[px >> x_shift];
+			*dst++ = clamp_channel(y + tables.b_cb[cb]);
+			*dst++ = clamp_channel(y + tables.g_cb[cb] + tables.g_cr[cr]);
+			*dst++ = clamp_channel(y + tables.r_cr[cr]);
+			*dst++ = 0;
+		}
+	}
+
+	frame.flipped = false;
+	frame.width = w;
+	frame.height = h;
+	frame.pitch = w * 4;
+}
+}
+
+namespace agi { class BackgroundRunner; }
+std::unique_ptr<VideoProvider> CreateRawYUVVideoProvider(agi::fs::path const& path, std::string const&, agi::BackgroundRunner *) {
+	if (!boost::iequals(path.extension().string(), ".yuv"))
+		return {};
+	return agi::make_unique<RawYUVVideoProvider>(path);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+/// @file video_provider_read_ahead.cpp
+/// @brief Background decoding of the next frame for simple video providers
+/// @ingroup video_input
+
+#include "video_provider_read_ahead.h"
+
+FrameReadAhead::FrameReadAhead(int frame_count, std::function<void (int, VideoFrame &)> decode)
+: decode(std::move(decode))
+, frame_count(frame_count)
+, worker([=] { Work(); })
+{
+}
+
+FrameReadAhead::~FrameReadAhead() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop = true;
+	}
+	cond.notify_all();
+	worker.join();
+}
+
+void FrameReadAhead::Work() {
+	// Frames are decoded into a frame object owned by this thread, which
+	// reuses its buffer whenever the previous frame has been released
+	VideoFrame scratch;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		cond.wait(lock, [&] { return stop || wanted >= 0; });
+		if (stop) break;
+
+		int n = wanted;
+		unsigned started_generation = generation;
+		wanted = -1;
+		decoding = n;
+		lock.unlock();
+
+		bool ok = true;
+		try {
+			std::lock_guard<std::mutex> decode_lock(decode_mutex);
+			decode(n, scratch);
+		}
+		catch (...) {
+			// Decoding will be retried in the foreground, which reports the error
+			ok = false;
+		}
+
+		lock.lock();
+		decoding = -1;
+		if (ok && generation == started_generation) {
+			ahead = scratch;
+			ahead_frame = n;
+		}
+		cond.notify_all();
+	}
+}
+
+void FrameReadAhead::GetFrame(int n, VideoFrame &out) {
+	bool hit = false;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		// If the worker is already decoding this frame, wait for it rather
+		// than decoding it a second time
+		cond.wait(lock, [&] { return decoding != n; });
+		if (ahead_frame == n) {
+			out = ahead;
+			hit = true;
+		}
+	}
+
+	if (!hit) {
+		std::lock_guard<std::mutex> decode_lock(decode_mutex);
+		decode(n, out);
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (n + 1 >= frame_count || ahead_frame == n + 1 || decoding == n + 1)
+			return;
+		wanted = n + 1;
+	}
+	cond.notify_all();
+}
+
+void FrameReadAhead::GetFrameUncached(int n, VideoFrame &out) {
+	std::lock_guard<std::mutex> decode_lock(decode_mutex);
+	decode(n, out);
+}
+
+void FrameReadAhead::Reset(std::function<void ()> const& change) {
+	std::lock_guard<std::mutex> decode_lock(decode_mutex);
+	change();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	++generation;
+	ahead_frame = -1;
+}
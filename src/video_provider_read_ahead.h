@@ -0,0 +1,75 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+/// @file video_provider_read_ahead.h
+/// @brief Background decoding of the next frame for simple video providers
+/// @ingroup video_input
+
+#pragma once
+
+#include "video_frame.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// @class FrameReadAhead
+/// @brief Decodes the frame after the most recently requested one on a background thread
+///
+/// Intended for providers where every frame can be decoded independently, so
+/// that playing through the video finds each frame already decoded. Calls to
+/// the decode function are serialized, so it does not need to be thread-safe.
+class FrameReadAhead {
+	std::function<void (int, VideoFrame &)> decode;
+	int frame_count;
+
+	/// Held while calling decode
+	std::mutex decode_mutex;
+
+	/// Guards everything below
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool stop = false;
+	/// Frame the worker should decode next, or -1 for none
+	int wanted = -1;
+	/// Frame the worker is currently decoding, or -1 for none
+	int decoding = -1;
+	/// Frame held in ahead, or -1 for none
+	int ahead_frame = -1;
+	/// Incremented by Reset so that frames decoded before it are thrown away
+	unsigned generation = 0;
+	VideoFrame ahead;
+
+	std::thread worker;
+
+	void Work();
+
+public:
+	/// @param frame_count Number of frames in the video
+	/// @param decode Function which decodes the given frame into the given frame object
+	FrameReadAhead(int frame_count, std::function<void (int, VideoFrame &)> decode);
+	~FrameReadAhead();
+
+	/// Get frame n and start decoding frame n + 1 in the background
+	void GetFrame(int n, VideoFrame &out);
+
+	/// Decode frame n without touching the read-ahead state
+	void GetFrameUncached(int n, VideoFrame &out);
+
+	/// Run a function which changes how frames are decoded while no frame is
+	/// being decoded, and discard the frame decoded ahead with the old settings
+	void Reset(std::function<void ()> const& change);
+};
@@ -43,6 +43,7 @@
 #include "project.h"
 #include "utils.h"
 #include "video_controller.h"
+#include "video_thumbnails.h"
 
 #include <wx/dcbuffer.h>
 #include <wx/settings.h>
@@ -52,13 +53,17 @@ VideoSlider::VideoSlider (wxWindow* parent, agi::Context *c)
 , c(c)
 , connections(agi::signal::make_vector({
 	OPT_SUB("Video/Slider/Show Keyframes", [=] { Refresh(false); }),
+	OPT_SUB("Video/Slider/Show Thumbnails", &VideoSlider::UpdateMinSize, this),
+	c->thumbnails->AddThumbnailsListener([=] {
+		if (GetThumbnailsHeight()) Refresh(false);
+	}),
 	c->videoController->AddSeekListener(&VideoSlider::SetValue, this),
 	c->project->AddVideoProviderListener(&VideoSlider::VideoOpened, this),
 	c->project->AddKeyframesListener(&VideoSlider::KeyframesChanged, this),
 }))
 {
-	SetClientSize(20,25);
-	SetMinSize(wxSize(20, 25));
+	SetClientSize(20, 25 + GetThumbnailsHeight());
+	SetMinSize(wxSize(20, 25 + GetThumbnailsHeight()));
 	SetBackgroundStyle(wxBG_STYLE_PAINT);
 
 	c->videoSlider = this;
@@ -73,6 +78,17 @@ void VideoSlider::SetValue(int value) {
 	val = value;
 }
 
+int VideoSlider::GetThumbnailsHeight() const {
+	if (!OPT_GET("Video/Slider/Show Thumbnails")->GetBool()) return 0;
+	return VideoThumbnails::thumbnail_height + 2;
+}
+
+void VideoSlider::UpdateMinSize() {
+	SetMinSize(wxSize(20, 25 + GetThumbnailsHeight()));
+	GetParent()->Layout();
+	Refresh(false);
+}
+
 void VideoSlider::VideoOpened(AsyncVideoProvider *provider) {
 	if (provider) {
 		max = provider->GetFrameCount() - 1;
@@ -204,6 +220,14 @@ void VideoSlider::OnPaint(wxPaintEvent &) {
 		dc.DrawRectangle(0,0,w,h);
 	}
 
+	// Thumbnails go above the slider, which is otherwise drawn the same
+	// as without them
+	if (int strip = GetThumbnailsHeight()) {
+		PaintThumbnails(dc, w);
+		dc.SetDeviceOrigin(0, strip);
+		h -= strip;
+	}
+
 	// Draw slider
 	x1 = 5;
 	x2 = w-5;
@@ -261,6 +285,19 @@ void VideoSlider::OnPaint(wxPaintEvent &) {
 	dc.DrawRectangle(curX-3,y2+1,7,4);
 }
 
+void VideoSlider::PaintThumbnails(wxDC &dc, int w) {
+	int thumb_w = c->thumbnails->GetWidth();
+	if (thumb_w <= 0 || w <= 10) return;
+
+	// Tile the thumbnails across the slider, each showing the closest
+	// thumbnail before the frame at the middle of the tile
+	wxDCClipper clip(dc, wxRect(5, 1, w - 10, VideoThumbnails::thumbnail_height));
+	for (int x = 5; x < w - 5; x += thumb_w) {
+		if (auto bmp = c->thumbnails->Get(GetValueAtX(x + thumb_w / 2)))
+			dc.DrawBitmap(*bmp, x, 1);
+	}
+}
+
 void VideoSlider::OnFocus(wxFocusEvent &) {
 	Refresh(false);
 }
@@ -53,6 +53,10 @@ class VideoSlider: public wxWindow {
 	int GetXAtValue(int value);
 	/// Set the position of the slider
 	void SetValue(int value);
+	/// Get the height of the thumbnail strip above the slider, if it's shown
+	int GetThumbnailsHeight() const;
+	/// Resize to fit the thumbnail strip after it's been turned on or off
+	void UpdateMinSize();
 
 	/// Video open event handler
 	void VideoOpened(AsyncVideoProvider *new_provider);
@@ -63,6 +67,7 @@ class VideoSlider: public wxWindow {
 	void OnKeyDown(wxKeyEvent &event);
 	void OnCharHook(wxKeyEvent &event);
 	void OnPaint(wxPaintEvent &);
+	void PaintThumbnails(wxDC &dc, int w);
 	void OnFocus(wxFocusEvent &);
 
 public:
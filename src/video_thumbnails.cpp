@@ -0,0 +1,305 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include "video_thumbnails.h"
+
+#include "async_video_provider.h"
+#include "include/aegisub/context.h"
+#include "options.h"
+#include "project.h"
+#include "utils.h"
+#include "video_controller.h"
+
+#include <libaegisub/dispatch.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/io.h>
+#include <libaegisub/log.h>
+#include <libaegisub/path.h>
+
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <cstring>
+#include <mutex>
+#include <wx/image.h>
+
+namespace {
+/// Maximum number of thumbnails to generate for a single video
+const size_t max_thumbnails = 512;
+/// Identifies thumbnail cache files; bump the final digit when the format changes
+const char cache_magic[8] = {'A', 'G', 'I', 'T', 'H', 'M', 'B', '1'};
+
+/// Pick the frames to generate thumbnails for
+///
+/// Keyframes are used when there are some since they're the cheapest frames
+/// to decode and usually mark scene changes, falling back to evenly spaced
+/// frames for intra-only video and formats without keyframe information.
+std::vector<int> ThumbnailFrames(AsyncVideoProvider *provider) {
+	std::vector<int> frames = provider->GetKeyFrames();
+	size_t frame_count = std::max(provider->GetFrameCount(), 0);
+
+	if (frames.size() < 2 || frames.size() >= frame_count) {
+		frames.clear();
+		size_t count = std::min(max_thumbnails, frame_count);
+		for (size_t i = 0; i < count; ++i)
+			frames.push_back(static_cast<int>(i * frame_count / count));
+	}
+	else if (frames.size() > max_thumbnails) {
+		std::vector<int> subset;
+		subset.reserve(max_thumbnails);
+		for (size_t i = 0; i < max_thumbnails; ++i)
+			subset.push_back(frames[i * frames.size() / max_thumbnails]);
+		frames = std::move(subset);
+	}
+	return frames;
+}
+
+/// Reorder frames so that the whole video is covered coarsely first and then
+/// filled in, so that the strip is useful long before it's complete
+std::vector<int> CoarseToFine(std::vector<int> const& frames) {
+	std::vector<int> ret;
+	ret.reserve(frames.size());
+	std::vector<bool> used(frames.size());
+
+	size_t step = 1;
+	while (step * 2 < frames.size()) step *= 2;
+	for (; step > 0; step /= 2) {
+		for (size_t i = 0; i < frames.size(); i += step) {
+			if (used[i]) continue;
+			used[i] = true;
+			ret.push_back(frames[i]);
+		}
+	}
+	return ret;
+}
+
+template<typename T>
+void write(std::ostream& out, T value) {
+	out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<typename T>
+bool read(std::istream& in, T& value) {
+	return !!in.read(reinterpret_cast<char *>(&value), sizeof(value));
+}
+
+/// Get the file the thumbnails for the given video are cached in
+agi::fs::path cache_filename(agi::fs::path const& video_file) {
+	boost::crc_32_type hash;
+	hash.process_bytes(video_file.string().c_str(), video_file.string().size());
+
+	auto result = config::path->Decode("?local/ffms2cache/" + std::to_string(hash.checksum()) + "_" + std::to_string(agi::fs::Size(video_file)) + "_" + std::to_string(agi::fs::ModifiedTime(video_file)) + ".thumbs");
+	agi::fs::CreateDirectory(result.parent_path());
+	return result;
+}
+}
+
+struct VideoThumbnails::Receiver {
+	std::mutex lock;
+	VideoThumbnails *owner;
+	Receiver(VideoThumbnails *owner) : owner(owner) { }
+};
+
+VideoThumbnails::VideoThumbnails(agi::Context *c)
+: c(c)
+, receiver(std::make_shared<Receiver>(this))
+, retry_timer(this)
+, save_queue(agi::dispatch::Create(agi::dispatch::PRIORITY_BACKGROUND))
+{
+	connections.push_back(c->project->AddVideoProviderListener(&VideoThumbnails::OnVideoOpen, this));
+	connections.push_back(OPT_SUB("Video/Slider/Show Thumbnails", &VideoThumbnails::OnOptionChanged, this));
+	connections.push_back(OPT_SUB("Audio/Display/Draw/Video Thumbnails", &VideoThumbnails::OnOptionChanged, this));
+	Bind(wxEVT_TIMER, [=](wxTimerEvent&) { RequestNext(); });
+}
+
+VideoThumbnails::~VideoThumbnails() {
+	{
+		std::lock_guard<std::mutex> lock(receiver->lock);
+		receiver->owner = nullptr;
+	}
+	Save();
+	// Make sure the cache file is finished before exiting
+	save_queue->Sync([]{ });
+}
+
+bool VideoThumbnails::Wanted() const {
+	return OPT_GET("Video/Slider/Show Thumbnails")->GetBool()
+		|| OPT_GET("Audio/Display/Draw/Video Thumbnails")->GetBool();
+}
+
+void VideoThumbnails::OnVideoOpen(AsyncVideoProvider *provider) {
+	Save();
+
+	++generation;
+	busy = false;
+	retry_timer.Stop();
+	thumbnails.clear();
+	thumbnail_pixels.clear();
+	pending.clear();
+	video_file.clear();
+	width = height = 0;
+
+	if (provider && provider->GetWidth() > 0 && provider->GetHeight() > 0) {
+		double dar = provider->GetDAR();
+		if (dar <= 0)
+			dar = double(provider->GetWidth()) / provider->GetHeight();
+		height = thumbnail_height;
+		width = std::max(1, static_cast<int>(thumbnail_height * dar + .5));
+		pending = CoarseToFine(ThumbnailFrames(provider));
+		std::reverse(pending.begin(), pending.end());
+
+		// The project only records the new video's filename after announcing
+		// the new provider
+		int gen = generation;
+		CallAfter([=] { Start(gen); });
+	}
+
+	ThumbnailsChanged();
+}
+
+void VideoThumbnails::Start(int gen) {
+	if (gen != generation) return;
+	video_file = c->project->VideoName();
+	if (Wanted())
+		Load();
+	RequestNext();
+}
+
+void VideoThumbnails::OnOptionChanged() {
+	if (!Wanted()) return;
+	// Thumbnails may not have been loaded from the cache if nothing wanted
+	// them when the video was opened
+	if (thumbnails.empty() && !video_file.empty())
+		Load();
+	RequestNext();
+}
+
+void VideoThumbnails::RequestNext() {
+	if (busy || pending.empty() || video_file.empty() || !Wanted()) return;
+
+	auto provider = c->project->VideoProvider();
+	if (!provider) return;
+
+	// Don't compete with playback for the decoder
+	if (c->videoController->IsPlaying()) {
+		retry_timer.StartOnce(500);
+		return;
+	}
+
+	int frame = pending.back();
+	pending.pop_back();
+	busy = true;
+
+	int gen = generation;
+	auto receiver = this->receiver;
+	provider->RequestThumbnail(frame, width, height, [=](std::vector<unsigned char> pixels) {
+		std::lock_guard<std::mutex> lock(receiver->lock);
+		if (auto owner = receiver->owner)
+			owner->CallAfter([=] { owner->OnThumbnail(gen, frame, pixels); });
+	});
+}
+
+void VideoThumbnails::OnThumbnail(int gen, int frame, std::vector<unsigned char> const& pixels) {
+	if (gen != generation) return;
+	busy = false;
+
+	if (pixels.size() == size_t(width * height * 3)) {
+		AddThumbnail(frame, pixels.data());
+		modified = true;
+		ThumbnailsChanged();
+	}
+
+	if (pending.empty())
+		Save();
+	else
+		RequestNext();
+}
+
+void VideoThumbnails::AddThumbnail(int frame, const unsigned char *pixels) {
+	wxImage img(width, height, false);
+	memcpy(img.GetData(), pixels, width * height * 3);
+	thumbnails[frame] = wxBitmap(img);
+	thumbnail_pixels[frame].assign(pixels, pixels + width * height * 3);
+}
+
+wxBitmap const* VideoThumbnails::Get(int frame) const {
+	auto it = thumbnails.upper_bound(frame);
+	if (it == thumbnails.begin()) return nullptr;
+	return &(--it)->second;
+}
+
+void VideoThumbnails::Load() {
+	try {
+		auto in = agi::io::Open(cache_filename(video_file), true);
+
+		char magic[sizeof(cache_magic)];
+		int32_t w, h, count;
+		if (!in->read(magic, sizeof(magic)) || memcmp(magic, cache_magic, sizeof(magic))) return;
+		if (!read(*in, w) || !read(*in, h) || !read(*in, count)) return;
+		if (w != width || h != height) return;
+
+		std::vector<unsigned char> pixels(width * height * 3);
+		for (int32_t i = 0; i < count; ++i) {
+			int32_t frame;
+			if (!read(*in, frame) || !in->read(reinterpret_cast<char *>(pixels.data()), pixels.size()))
+				break;
+			AddThumbnail(frame, pixels.data());
+		}
+	}
+	catch (agi::fs::FileSystemError const&) {
+		return;
+	}
+
+	// Only the frames missing from the cache still need to be generated
+	pending.erase(std::remove_if(begin(pending), end(pending), [&](int frame) {
+		return thumbnails.count(frame) != 0;
+	}), end(pending));
+
+	if (!thumbnails.empty())
+		ThumbnailsChanged();
+}
+
+void VideoThumbnails::Save() {
+	if (!modified || video_file.empty()) return;
+	modified = false;
+
+	// Write a copy so that generating thumbnails for the next video can
+	// start straight away
+	auto video = video_file;
+	int32_t w = width, h = height;
+	auto pixels = thumbnail_pixels;
+	save_queue->Async([=] {
+		try {
+			agi::io::Save file(cache_filename(video), true);
+			auto& out = file.Get();
+			out.write(cache_magic, sizeof(cache_magic));
+			write<int32_t>(out, w);
+			write<int32_t>(out, h);
+			write<int32_t>(out, pixels.size());
+			for (auto const& thumb : pixels) {
+				write<int32_t>(out, thumb.first);
+				out.write(reinterpret_cast<const char *>(thumb.second.data()), thumb.second.size());
+			}
+			file.Commit();
+		}
+		catch (agi::Exception const& e) {
+			LOG_E("video/thumbnails") << "Failed to save thumbnail cache: " << e.GetMessage();
+		}
+	});
+
+	CleanCache(config::path->Decode("?local/ffms2cache/"), "*.thumbs",
+		OPT_GET("Provider/FFmpegSource/Cache/Size")->GetInt(),
+		OPT_GET("Provider/FFmpegSource/Cache/Files")->GetInt());
+}
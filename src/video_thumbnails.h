@@ -0,0 +1,111 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#pragma once
+
+#include <libaegisub/fs_fwd.h>
+#include <libaegisub/signal.h>
+
+#include <boost/filesystem/path.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <wx/bitmap.h>
+#include <wx/event.h>
+#include <wx/timer.h>
+
+class AsyncVideoProvider;
+namespace agi { struct Context; }
+namespace agi { namespace dispatch { class Queue; } }
+
+/// @class VideoThumbnails
+/// @brief Small images of frames spread across the open video, for finding
+///        scenes without seeking
+///
+/// Thumbnails are decoded one at a time on the video provider's worker
+/// thread while the video isn't playing, so that they never hold up more
+/// than a single frame request. They're only generated if something is
+/// displaying them, and are saved alongside the FFMS2 indexes so that
+/// reopening a video doesn't decode them again.
+class VideoThumbnails final : public wxEvtHandler {
+	agi::Context *c;
+	std::vector<agi::signal::Connection> connections;
+
+	/// Thumbnails are delivered from the worker thread through this, so that
+	/// ones finished after this has been destroyed are dropped
+	struct Receiver;
+	std::shared_ptr<Receiver> receiver;
+
+	/// Thumbnails generated so far, indexed by frame number
+	std::map<int, wxBitmap> thumbnails;
+	/// RGB pixels of each thumbnail, so that the cache file can be written
+	/// on a background thread without touching the bitmaps
+	std::map<int, std::vector<unsigned char>> thumbnail_pixels;
+	/// Frames which still need a thumbnail, in the order they'll be generated
+	std::vector<int> pending;
+	/// Size of each thumbnail in pixels
+	int width = 0;
+	int height = 0;
+
+	/// The video the thumbnails are for
+	agi::fs::path video_file;
+	/// Have thumbnails been generated since the cache file was written?
+	bool modified = false;
+	/// Is a thumbnail currently being generated?
+	bool busy = false;
+	/// Incremented when the video changes, to discard thumbnails for the old
+	/// one which were already in progress
+	int generation = 0;
+
+	/// Retries generating thumbnails after video playback stops
+	wxTimer retry_timer;
+
+	/// Queue which the cache file is written on
+	std::unique_ptr<agi::dispatch::Queue> save_queue;
+
+	/// New thumbnails are available, or the old ones have been discarded
+	agi::signal::Signal<> ThumbnailsChanged;
+
+	void OnVideoOpen(AsyncVideoProvider *provider);
+	void OnOptionChanged();
+	void Start(int gen);
+	void RequestNext();
+	void AddThumbnail(int frame, const unsigned char *pixels);
+	void OnThumbnail(int gen, int frame, std::vector<unsigned char> const& pixels);
+
+	/// Is anything going to display thumbnails?
+	bool Wanted() const;
+	void Load();
+	/// Queue writing the thumbnails to the cache file if any are new
+	void Save();
+
+public:
+	VideoThumbnails(agi::Context *c);
+	~VideoThumbnails();
+
+	/// Height of each thumbnail in pixels
+	static const int thumbnail_height = 36;
+
+	/// Get the thumbnail for the last frame at or before the given one which
+	/// has one, or nullptr if there isn't one
+	wxBitmap const* Get(int frame) const;
+
+	/// Width of each thumbnail in pixels, or 0 if there's no video open
+	int GetWidth() const { return width; }
+
+	DEFINE_SIGNAL_ADDERS(ThumbnailsChanged, AddThumbnailsListener)
+};
@@ -24,6 +24,10 @@
 
 #include <boost/filesystem/fstream.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 namespace bfs = boost::filesystem;
 
 TEST(lagi_audio, dummy_blank) {
@@ -228,6 +232,89 @@ TEST(lagi_audio, hd_cache) {
 		ASSERT_EQ(static_cast<uint16_t>((1 << 22) - 256 + i), buff[i]);
 }
 
+TEST(lagi_audio, decode_ahead) {
+	auto provider = agi::CreateDecodeAheadAudioProvider(agi::make_unique<TestAudioProvider<>>(), 10000);
+	EXPECT_EQ(90 * 48000, provider->GetNumSamples());
+	EXPECT_EQ(2, provider->GetBytesPerSample());
+
+	uint16_t buff[3000];
+	auto check = [&](int64_t start, int64_t count) {
+		provider->GetAudio(buff, start, count);
+		for (int64_t i = 0; i < count; ++i)
+			ASSERT_EQ(static_cast<uint16_t>(start + i), buff[i]);
+	};
+
+	// Sequential reads, including ones outrunning the decoder
+	for (int64_t start = 0; start < 100000; start += 3000)
+		check(start, 3000);
+
+	// Overlapping, backwards and forward jumps, and up to the end
+	check(98000, 3000);
+	check(50000, 1000);
+	check(80000, 3000);
+	check(83000, 500);
+	check(90 * 48000 - 3000, 3000);
+}
+
+TEST(lagi_audio, decode_ahead_sequential_reads_decode_each_sample_once) {
+	struct CountingAudioProvider : TestAudioProvider<> {
+		std::atomic<int64_t> *samples_read;
+		CountingAudioProvider(std::atomic<int64_t> *samples_read) : samples_read(samples_read) { }
+
+		void FillBuffer(void *buf, int64_t start, int64_t count) const override {
+			// Slow enough that reads regularly catch up with the decoder
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			*samples_read += count;
+			TestAudioProvider<>::FillBuffer(buf, start, count);
+		}
+	};
+
+	std::atomic<int64_t> samples_read(0);
+	const int64_t window = 10000;
+	auto provider = agi::CreateDecodeAheadAudioProvider(agi::make_unique<CountingAudioProvider>(&samples_read), window);
+
+	uint16_t buff[1000];
+	const int64_t total = 200000;
+	for (int64_t start = 0; start < total; start += 1000) {
+		provider->GetAudio(buff, start, 1000);
+		ASSERT_EQ(static_cast<uint16_t>(start), buff[0]);
+		ASSERT_EQ(static_cast<uint16_t>(start + 999), buff[999]);
+	}
+
+	// Everything read was decoded once, plus at most what the decoder got
+	// ahead by and the chunk it was working on
+	EXPECT_GE(total + window + 4096, samples_read.load());
+}
+
+TEST(lagi_audio, decode_ahead_decode_error) {
+	struct FailingAudioProvider : TestAudioProvider<> {
+		void FillBuffer(void *buf, int64_t start, int64_t count) const override {
+			if (start + count > 20000 && start < 30000)
+				throw agi::AudioDecodeError("decode failed");
+			TestAudioProvider<>::FillBuffer(buf, start, count);
+		}
+	};
+
+	auto provider = agi::CreateDecodeAheadAudioProvider(agi::make_unique<FailingAudioProvider>(), 10000);
+
+	// Reading up to the bad region lets the decoder run into it in the
+	// background, which must not take down the process
+	uint16_t buff[1000];
+	for (int64_t start = 0; start < 20000; start += 1000) {
+		provider->GetAudio(buff, start, 1000);
+		ASSERT_EQ(static_cast<uint16_t>(start), buff[0]);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	// The bad region reads as silence and everything after it still works
+	provider->GetAudio(buff, 25000, 1000);
+	for (auto sample : buff)
+		ASSERT_EQ(0, sample);
+	provider->GetAudio(buff, 40000, 1000);
+	for (int i = 0; i < 1000; ++i)
+		ASSERT_EQ(static_cast<uint16_t>(40000 + i), buff[i]);
+}
+
 TEST(lagi_audio, convert_8bit) {
 	auto provider = agi::CreateConvertAudioProvider(agi::make_unique<TestAudioProvider<uint8_t>>());
 
@@ -318,6 +405,119 @@ TEST(lagi_audio, stereo_downmix) {
 		EXPECT_EQ(i, samples[i]);
 }
 
+TEST(lagi_audio, downmix_single_channel) {
+	struct AudioProvider : agi::AudioProvider {
+		AudioProvider() {
+			channels = 3;
+			num_samples = 90 * 48000;
+			decoded_samples = num_samples;
+			sample_rate = 48000;
+			bytes_per_sample = 2;
+			float_samples = false;
+		}
+
+		void FillBuffer(void *buf, int64_t start, int64_t count) const override {
+			auto out = static_cast<int16_t *>(buf);
+			for (int64_t end = start + count; start < end; ++start) {
+				*out++ = 1;
+				*out++ = (int16_t)start;
+				*out++ = -1;
+			}
+		}
+	};
+
+	auto provider = agi::CreateConvertAudioProvider(agi::make_unique<AudioProvider>(), 1);
+	EXPECT_EQ(1, provider->GetChannels());
+
+	int16_t samples[100];
+	provider->GetAudio(samples, 1000, 100);
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(1000 + i, samples[i]);
+
+	// Out of range channels fall back to mixing them all
+	provider = agi::CreateConvertAudioProvider(agi::make_unique<AudioProvider>(), 3);
+	provider->GetAudio(samples, 300, 1);
+	EXPECT_EQ(100, samples[0]);
+}
+
+TEST(lagi_audio, channel_summary_encoding) {
+	using agi::AudioChannelSummary;
+	EXPECT_EQ(128, AudioChannelSummary::Encode(0));
+	EXPECT_EQ(0, AudioChannelSummary::Decode(128));
+	EXPECT_EQ(SHRT_MAX, AudioChannelSummary::Decode(AudioChannelSummary::Encode(SHRT_MAX)));
+	EXPECT_EQ(-SHRT_MAX, AudioChannelSummary::Decode(AudioChannelSummary::Encode(SHRT_MIN)));
+
+	for (int sample = SHRT_MIN; sample < SHRT_MAX; ++sample) {
+		ASSERT_LE(AudioChannelSummary::Encode(sample), AudioChannelSummary::Encode(sample + 1));
+		int decoded = AudioChannelSummary::Decode(AudioChannelSummary::Encode(sample));
+		ASSERT_NEAR(sample, decoded, std::abs(sample) / 10 + 1);
+	}
+}
+
+TEST(lagi_audio, channel_summary) {
+	struct AudioProvider : agi::AudioProvider {
+		AudioProvider() {
+			channels = 2;
+			num_samples = 90 * 48000;
+			decoded_samples = num_samples;
+			sample_rate = 48000;
+			bytes_per_sample = 2;
+			float_samples = false;
+		}
+
+		void FillBuffer(void *buf, int64_t start, int64_t count) const override {
+			auto out = static_cast<int16_t *>(buf);
+			for (int64_t end = start + count; start < end; ++start) {
+				*out++ = (int16_t)(start % 1000);
+				*out++ = 0;
+			}
+		}
+	};
+
+	auto provider = agi::CreateRAMAudioProvider(agi::CreateConvertAudioProvider(agi::make_unique<AudioProvider>()));
+	auto summary = provider->GetChannelSummary();
+	ASSERT_TRUE(!!summary);
+	EXPECT_EQ(2, summary->GetChannels());
+	EXPECT_EQ(48000, summary->GetSampleRate());
+	EXPECT_LT(summary->GetSize(), static_cast<size_t>(provider->GetNumSamples() * 2 / 50));
+
+	while (provider->GetDecodedSamples() != provider->GetNumSamples()) agi::util::sleep_for(0);
+
+	int16_t min, max;
+	ASSERT_TRUE(summary->GetPeaks(0, 0, 1000, min, max));
+	EXPECT_EQ(0, min);
+	EXPECT_NEAR(999, max, 100);
+
+	ASSERT_TRUE(summary->GetPeaks(1, 5000, 10000, min, max));
+	EXPECT_EQ(0, min);
+	EXPECT_EQ(0, max);
+
+	// Only the blocks covering the range are used
+	ASSERT_TRUE(summary->GetPeaks(0, 2048, 256, min, max));
+	EXPECT_NEAR(48, min, 5);
+	EXPECT_NEAR(303, max, 30);
+}
+
+TEST(lagi_audio, channel_summary_only_has_decoded_audio) {
+	agi::AudioChannelSummary summary(2, 10000, 48000);
+
+	int16_t min, max;
+	EXPECT_FALSE(summary.GetPeaks(0, 0, 10000, min, max));
+
+	std::vector<int16_t> audio(200, 0);
+	audio[100] = -500;
+	audio[101] = 500;
+	summary.Add(audio.data(), 1000, 100);
+
+	EXPECT_FALSE(summary.GetPeaks(0, 0, 512, min, max));
+	ASSERT_TRUE(summary.GetPeaks(0, 0, 2000, min, max));
+	EXPECT_NEAR(-500, min, 50);
+	EXPECT_EQ(0, max);
+	ASSERT_TRUE(summary.GetPeaks(1, 1050, 1, min, max));
+	EXPECT_EQ(0, min);
+	EXPECT_NEAR(500, max, 50);
+}
+
 template<typename Float>
 struct FloatAudioProvider : agi::AudioProvider {
 	FloatAudioProvider() {
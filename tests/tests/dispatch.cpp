@@ -0,0 +1,209 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <libaegisub/dispatch.h>
+
+#include <main.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace agi::dispatch;
+
+TEST(lagi_dispatch, sync_runs_thunk) {
+	int x = 0;
+	Background().Sync([&] { x = 1; });
+	EXPECT_EQ(1, x);
+}
+
+TEST(lagi_dispatch, sync_rethrows) {
+	EXPECT_THROW(Background().Sync([] { throw 5; }), int);
+}
+
+TEST(lagi_dispatch, serial_queue_runs_in_order) {
+	auto queue = Create();
+	std::vector<int> order;
+	for (int i = 0; i < 100; ++i)
+		queue->Async([&, i] { order.push_back(i); });
+	queue->Sync([] { });
+
+	ASSERT_EQ(100u, order.size());
+	for (int i = 0; i < 100; ++i)
+		EXPECT_EQ(i, order[i]);
+}
+
+TEST(lagi_dispatch, serial_queue_outlives_handle) {
+	std::atomic<int> x{0};
+	{
+		auto queue = Create(PRIORITY_BACKGROUND);
+		for (int i = 0; i < 10; ++i)
+			queue->Async([&] { ++x; });
+	}
+	while (x != 10) std::this_thread::yield();
+	EXPECT_EQ(10, x);
+}
+
+TEST(lagi_dispatch, cancelled_token_skips_thunk) {
+	auto queue = Create();
+	std::mutex m;
+	std::condition_variable cv;
+	bool release = false;
+
+	// Block the queue so that the following thunks can't start until the
+	// token has been cancelled
+	queue->Async([&] {
+		std::unique_lock<std::mutex> l(m);
+		cv.wait(l, [&] { return release; });
+	});
+
+	CancellationToken token;
+	int ran = 0, skipped = 0;
+	queue->Async([&] { ++skipped; }, token);
+	queue->Async([&] { ++ran; }, CancellationToken());
+	token.Cancel();
+
+	{
+		std::lock_guard<std::mutex> l(m);
+		release = true;
+	}
+	cv.notify_all();
+	queue->Sync([] { });
+
+	EXPECT_EQ(0, skipped);
+	EXPECT_EQ(1, ran);
+}
+
+TEST(lagi_dispatch, interactive_work_runs_while_background_is_saturated) {
+	// Shared with the jobs as they may still be running when this returns
+	struct State {
+		std::mutex m;
+		std::condition_variable cv;
+		bool release = false;
+		std::atomic<int> started{0};
+		std::atomic<int> finished{0};
+	};
+	auto state = std::make_shared<State>();
+
+	// Far more blocking bulk jobs than there are workers
+	for (int i = 0; i < 64; ++i) {
+		Background(PRIORITY_BACKGROUND).Async([=] {
+			++state->started;
+			{
+				std::unique_lock<std::mutex> l(state->m);
+				state->cv.wait(l, [&] { return state->release; });
+			}
+			++state->finished;
+		});
+	}
+
+	int x = 0;
+	Background(PRIORITY_INTERACTIVE).Sync([&] { x = 1; });
+	EXPECT_EQ(1, x);
+	EXPECT_LT(state->started, 64);
+	EXPECT_GT(GetStats(PRIORITY_BACKGROUND).depth, 0u);
+
+	{
+		std::lock_guard<std::mutex> l(state->m);
+		state->release = true;
+	}
+	state->cv.notify_all();
+	while (state->finished != 64) std::this_thread::yield();
+	EXPECT_EQ(0u, GetStats(PRIORITY_BACKGROUND).depth);
+}
+
+TEST(lagi_dispatch, background_work_never_takes_every_worker) {
+	struct State {
+		std::atomic<int> running{0};
+		std::atomic<int> max_running{0};
+		std::atomic<int> finished{0};
+	};
+	auto state = std::make_shared<State>();
+
+	for (int i = 0; i < 2000; ++i) {
+		Background(PRIORITY_BACKGROUND).Async([=] {
+			int running = ++state->running;
+			int max_running = state->max_running;
+			while (max_running < running && !state->max_running.compare_exchange_weak(max_running, running)) ;
+			std::this_thread::yield();
+			--state->running;
+			++state->finished;
+		});
+	}
+
+	while (state->finished != 2000) std::this_thread::yield();
+	unsigned workers = std::max<unsigned>(4, std::thread::hardware_concurrency());
+	EXPECT_LT(static_cast<unsigned>(state->max_running), workers);
+}
+
+TEST(lagi_dispatch, background_work_can_sync_on_background_work) {
+	auto finished = std::make_shared<std::atomic<int>>(0);
+	std::shared_ptr<Queue> serial = Create(PRIORITY_BACKGROUND);
+
+	// Enough to fill every worker with background jobs which are each
+	// waiting on more background work
+	for (int i = 0; i < 64; ++i) {
+		Background(PRIORITY_BACKGROUND).Async([=] {
+			int x = 0, y = 0;
+			Background(PRIORITY_BACKGROUND).Sync([&] { x = 1; });
+			serial->Sync([&] { y = 1; });
+			if (x == 1 && y == 1)
+				++*finished;
+		});
+	}
+
+	while (*finished != 64) std::this_thread::yield();
+}
+
+TEST(lagi_dispatch, background_work_stays_within_limit_after_sync) {
+	struct State {
+		std::atomic<int> running{0};
+		std::atomic<int> max_running{0};
+		std::atomic<int> finished{0};
+	};
+	auto state = std::make_shared<State>();
+
+	// Each waits while holding no place in the limit, and then has to get
+	// one back before carrying on
+	for (int i = 0; i < 256; ++i) {
+		Background(PRIORITY_BACKGROUND).Async([=] {
+			Background(PRIORITY_BACKGROUND).Sync([] { });
+			int running = ++state->running;
+			int max_running = state->max_running;
+			while (max_running < running && !state->max_running.compare_exchange_weak(max_running, running)) ;
+			std::this_thread::yield();
+			--state->running;
+			++state->finished;
+		});
+	}
+
+	while (state->finished != 256) std::this_thread::yield();
+	unsigned workers = std::max<unsigned>(4, std::thread::hardware_concurrency());
+	EXPECT_LT(static_cast<unsigned>(state->max_running), workers);
+}
+
+TEST(lagi_dispatch, stats_count_started_thunks) {
+	auto before = GetStats(PRIORITY_NORMAL);
+	auto queue = Create(PRIORITY_NORMAL);
+	for (int i = 0; i < 5; ++i)
+		queue->Async([] { });
+	queue->Sync([] { });
+
+	auto after = GetStats(PRIORITY_NORMAL);
+	EXPECT_EQ(before.started + 6, after.started);
+	EXPECT_GE(after.max_wait, before.max_wait);
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <libaegisub/interval_tree.h>
+
+#include <main.h>
+
+#include <random>
+#include <set>
+#include <utility>
+
+using agi::interval_tree;
+
+namespace {
+std::vector<int> overlapping(interval_tree<int> const& tree, int begin, int end) {
+	std::vector<int> ret;
+	tree.for_each_overlapping(begin, end, [&](int v) { ret.push_back(v); });
+	return ret;
+}
+
+std::set<std::pair<int, int>> pairs(interval_tree<int> const& tree) {
+	std::set<std::pair<int, int>> ret;
+	tree.for_each_overlapping_pair([&](int a, int b) {
+		ret.emplace(std::min(a, b), std::max(a, b));
+	});
+	return ret;
+}
+}
+
+TEST(lagi_interval_tree, empty) {
+	interval_tree<int> tree;
+	EXPECT_TRUE(tree.empty());
+	EXPECT_TRUE(overlapping(tree, 0, 100).empty());
+	EXPECT_TRUE(pairs(tree).empty());
+	EXPECT_FALSE(tree.erase(0, 10, 1));
+}
+
+TEST(lagi_interval_tree, overlap_is_half_open) {
+	interval_tree<int> tree;
+	tree.insert(10, 20, 1);
+
+	EXPECT_TRUE(overlapping(tree, 0, 10).empty());
+	EXPECT_TRUE(overlapping(tree, 20, 30).empty());
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 0, 11));
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 19, 30));
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 12, 15));
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 0, 30));
+}
+
+TEST(lagi_interval_tree, empty_intervals_never_overlap) {
+	interval_tree<int> tree;
+	tree.insert(10, 20, 1);
+	tree.insert(15, 15, 2);
+	tree.insert(10, 10, 3);
+
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 0, 30));
+	EXPECT_TRUE(pairs(tree).empty());
+}
+
+TEST(lagi_interval_tree, results_are_ordered_by_begin) {
+	interval_tree<int> tree;
+	tree.insert(30, 40, 3);
+	tree.insert(10, 40, 1);
+	tree.insert(20, 40, 2);
+
+	EXPECT_EQ((std::vector<int>{1, 2, 3}), overlapping(tree, 35, 36));
+}
+
+TEST(lagi_interval_tree, erase_only_removes_matching_interval) {
+	interval_tree<int> tree;
+	tree.insert(10, 20, 1);
+	tree.insert(10, 20, 2);
+	tree.insert(10, 30, 1);
+
+	EXPECT_FALSE(tree.erase(10, 20, 3));
+	EXPECT_TRUE(tree.erase(10, 20, 1));
+	EXPECT_EQ(2u, tree.size());
+	EXPECT_EQ(2u, overlapping(tree, 15, 16).size());
+	EXPECT_EQ(std::vector<int>{1}, overlapping(tree, 25, 26));
+}
+
+TEST(lagi_interval_tree, pairs) {
+	interval_tree<int> tree;
+	tree.insert(0, 10, 1);
+	tree.insert(5, 15, 2);
+	tree.insert(10, 20, 3);
+	tree.insert(30, 40, 4);
+	tree.insert(0, 100, 5);
+
+	std::set<std::pair<int, int>> expected{{1, 2}, {2, 3}, {1, 5}, {2, 5}, {3, 5}, {4, 5}};
+	EXPECT_EQ(expected, pairs(tree));
+}
+
+TEST(lagi_interval_tree, matches_brute_force) {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> pos(0, 1000), len(0, 50);
+
+	interval_tree<int> tree;
+	std::vector<std::pair<int, int>> intervals;
+	for (int i = 0; i < 500; ++i) {
+		int start = pos(rng);
+		intervals.emplace_back(start, start + len(rng));
+		tree.insert(intervals.back().first, intervals.back().second, i);
+	}
+
+	// Remove every third interval
+	std::vector<bool> live(intervals.size(), true);
+	for (size_t i = 0; i < intervals.size(); i += 3) {
+		ASSERT_TRUE(tree.erase(intervals[i].first, intervals[i].second, (int)i));
+		live[i] = false;
+	}
+	EXPECT_EQ(intervals.size() - (intervals.size() + 2) / 3, tree.size());
+
+	auto overlaps = [](std::pair<int, int> a, std::pair<int, int> b) {
+		return a.first < a.second && b.first < b.second && a.first < b.second && b.first < a.second;
+	};
+
+	for (int i = 0; i < 200; ++i) {
+		int start = pos(rng);
+		std::pair<int, int> q(start, start + len(rng));
+
+		std::set<int> expected;
+		for (size_t j = 0; j < intervals.size(); ++j) {
+			if (live[j] && overlaps(intervals[j], q))
+				expected.insert((int)j);
+		}
+
+		auto actual = overlapping(tree, q.first, q.second);
+		EXPECT_EQ(expected, std::set<int>(begin(actual), end(actual)));
+		EXPECT_EQ(expected.size(), actual.size());
+	}
+
+	std::set<std::pair<int, int>> expected;
+	for (size_t a = 0; a < intervals.size(); ++a) {
+		for (size_t b = a + 1; b < intervals.size(); ++b) {
+			if (live[a] && live[b] && overlaps(intervals[a], intervals[b]))
+				expected.emplace((int)a, (int)b);
+		}
+	}
+	EXPECT_EQ(expected, pairs(tree));
+}
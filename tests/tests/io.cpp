@@ -0,0 +1,95 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include <main.h>
+
+#include <libaegisub/fs.h>
+#include <libaegisub/io.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+std::string read_file(agi::fs::path const& path) {
+	std::ifstream in(path.string());
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+size_t count_files(agi::fs::path const& dir) {
+	return std::distance(boost::filesystem::directory_iterator(dir), boost::filesystem::directory_iterator());
+}
+}
+
+TEST(lagi_io, save_replaces_file) {
+	agi::fs::path dir("data/io_save");
+	boost::filesystem::create_directories(dir);
+	auto path = dir/"file.txt";
+	std::ofstream(path.string()) << "old";
+
+	{
+		agi::io::Save file(path);
+		file.Get() << "new";
+		file.Commit();
+	}
+
+	EXPECT_EQ("new", read_file(path));
+	EXPECT_EQ(1u, count_files(dir));
+}
+
+TEST(lagi_io, uncommitted_save_leaves_file_untouched) {
+	agi::fs::path dir("data/io_save_aborted");
+	boost::filesystem::create_directories(dir);
+	auto path = dir/"file.txt";
+	std::ofstream(path.string()) << "old";
+
+	try {
+		agi::io::Save file(path);
+		file.Get() << "partial";
+		throw std::runtime_error("conversion failed");
+	}
+	catch (std::runtime_error const&) { }
+
+	EXPECT_EQ("old", read_file(path));
+	EXPECT_EQ(1u, count_files(dir));
+}
+
+namespace {
+struct SaveOnUnwind {
+	agi::fs::path path;
+	~SaveOnUnwind() {
+		agi::io::Save file(path);
+		file.Get() << "new";
+		file.Commit();
+	}
+};
+}
+
+TEST(lagi_io, committed_save_during_unwinding_replaces_file) {
+	agi::fs::path dir("data/io_save_unwinding");
+	boost::filesystem::create_directories(dir);
+	auto path = dir/"file.txt";
+	std::ofstream(path.string()) << "old";
+
+	try {
+		SaveOnUnwind saver{path};
+		throw std::runtime_error("unrelated error");
+	}
+	catch (std::runtime_error const&) { }
+
+	EXPECT_EQ("new", read_file(path));
+	EXPECT_EQ(1u, count_files(dir));
+}
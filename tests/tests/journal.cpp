@@ -0,0 +1,248 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Aegisub Project http://www.aegisub.org/
+
+#include <libaegisub/ass/journal.h>
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
+
+#include <main.h>
+
+#include <boost/crc.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+
+using namespace agi::ass;
+
+namespace {
+typedef std::vector<std::pair<int, std::string>> events;
+
+void checkpoint(JournalRecord& record, events const& lines) {
+	record.ClearEvents();
+	int prev = 0;
+	for (auto const& line : lines) {
+		record.SetEvent(line.first, prev, line.second);
+		prev = line.first;
+	}
+}
+
+/// Record a line if its text or the line before it changed, the same as
+/// the subtitles controller does
+void diff(JournalRecord& record, events const& old_lines, events const& new_lines) {
+	std::map<int, std::pair<int, std::string>> old_index;
+	int prev = 0;
+	for (auto const& line : old_lines) {
+		old_index[line.first] = std::make_pair(prev, line.second);
+		prev = line.first;
+	}
+
+	prev = 0;
+	for (auto const& line : new_lines) {
+		auto it = old_index.find(line.first);
+		if (it == old_index.end() || it->second.first != prev || it->second.second != line.second)
+			record.SetEvent(line.first, prev, line.second);
+		if (it != old_index.end())
+			old_index.erase(it);
+		prev = line.first;
+	}
+
+	for (auto const& removed : old_index)
+		record.RemoveEvent(removed.first);
+}
+
+std::string header() {
+	std::string ret("AGIJRNL1");
+	ret.append(4, '\0');
+	return ret;
+}
+
+void put_u32(std::string& out, uint32_t value) {
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((value >> (i * 8)) & 0xFF);
+}
+
+/// Frame raw record data with its size and a valid checksum
+std::string record(std::string const& data) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data.data(), data.size());
+	std::string ret;
+	put_u32(ret, data.size());
+	put_u32(ret, crc.checksum());
+	return ret + data;
+}
+}
+
+TEST(lagi_journal, write_and_read) {
+	agi::fs::Remove("data/journal.bin");
+
+	events lines{{1, "Dialogue: a"}, {2, "Dialogue: b"}, {3, "Dialogue: c"}};
+	JournalRecord start;
+	start.SetInfo({"Title: test"});
+	start.SetStyles({"Style: Default"});
+	checkpoint(start, lines);
+
+	{
+		JournalWriter writer("data/journal.bin", "source.ass", start);
+		EXPECT_EQ(agi::fs::Size("data/journal.bin"), writer.Size());
+
+		JournalRecord change;
+		change.SetEvent(2, 1, "Dialogue: B");
+		change.SetEvent(4, 3, "Dialogue: d");
+		change.RemoveEvent(1);
+		change.SetStyles({"Style: Default", "Style: Alt"});
+		writer.Write(change);
+	}
+
+	JournalState state;
+	ASSERT_NO_THROW(state = ReadJournal("data/journal.bin"));
+	EXPECT_EQ("source.ass", state.source);
+	EXPECT_EQ(std::vector<std::string>{"Title: test"}, state.info);
+	EXPECT_EQ((std::vector<std::string>{"Style: Default", "Style: Alt"}), state.styles);
+	EXPECT_EQ((events{{2, "Dialogue: B"}, {3, "Dialogue: c"}, {4, "Dialogue: d"}}), state.events);
+}
+
+TEST(lagi_journal, compacting_replaces_journal) {
+	JournalRecord first;
+	checkpoint(first, {{1, "a"}});
+	JournalWriter("data/journal.bin", "", first).Write(first);
+
+	JournalRecord second;
+	checkpoint(second, {{2, "b"}});
+	JournalWriter("data/journal.bin", "", second);
+
+	EXPECT_EQ((events{{2, "b"}}), ReadJournal("data/journal.bin").events);
+}
+
+TEST(lagi_journal, damaged_record_is_ignored) {
+	JournalRecord start;
+	checkpoint(start, {{1, "a"}});
+	{
+		JournalWriter writer("data/journal.bin", "", start);
+		JournalRecord change;
+		change.SetEvent(2, 1, "b");
+		writer.Write(change);
+		change = JournalRecord();
+		change.SetEvent(3, 2, "c");
+		writer.Write(change);
+	}
+
+	std::string data;
+	{
+		std::ifstream in("data/journal.bin", std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	// Partially written final record
+	std::istringstream truncated(data.substr(0, data.size() - 3));
+	EXPECT_EQ((events{{1, "a"}, {2, "b"}}), ReadJournal(truncated).events);
+
+	// Corrupted final record
+	data.back() ^= 1;
+	std::istringstream corrupted(data);
+	EXPECT_EQ((events{{1, "a"}, {2, "b"}}), ReadJournal(corrupted).events);
+}
+
+TEST(lagi_journal, malformed_record_is_not_partially_applied) {
+	std::string set_event("\x06");
+	put_u32(set_event, 1);
+	put_u32(set_event, 0);
+	put_u32(set_event, 1);
+	set_event += "a";
+
+	std::string set_second_event("\x06");
+	put_u32(set_second_event, 2);
+	put_u32(set_second_event, 1);
+	put_u32(set_second_event, 1);
+	set_second_event += "b";
+
+	// A valid operation followed by an unknown one, with a correct checksum
+	std::istringstream in(header() + record(set_event) + record(set_second_event + "\x7F"));
+	EXPECT_EQ((events{{1, "a"}}), ReadJournal(in).events);
+}
+
+TEST(lagi_journal, not_a_journal) {
+	std::istringstream empty("");
+	EXPECT_THROW(ReadJournal(empty), agi::InvalidInputException);
+	std::istringstream ass("[Script Info]\n");
+	EXPECT_THROW(ReadJournal(ass), agi::InvalidInputException);
+	std::istringstream header_only(header());
+	EXPECT_NO_THROW(ReadJournal(header_only));
+}
+
+TEST(lagi_journal, replaying_diffs_matches_edits) {
+	std::mt19937 rng(1234);
+	std::string data = header();
+
+	events lines;
+	int next_id = 1;
+	for (; next_id <= 20; ++next_id)
+		lines.emplace_back(next_id, std::to_string(next_id));
+
+	JournalRecord start;
+	checkpoint(start, lines);
+	// Writers always start with a checkpoint, so write each record as the
+	// checkpoint of its own journal and then stitch the records together
+	auto append = [&](JournalRecord const& record) {
+		JournalWriter("data/journal.bin", "", record);
+		std::ifstream in("data/journal.bin", std::ios::binary);
+		std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		data += file.substr(header().size());
+	};
+	append(start);
+
+	for (int i = 0; i < 200; ++i) {
+		events old_lines = lines;
+		int edits = rng() % 4 + 1;
+		for (int j = 0; j < edits; ++j) {
+			switch (rng() % 5) {
+				case 0: // insert
+					lines.insert(lines.begin() + rng() % (lines.size() + 1),
+						std::make_pair(next_id, std::to_string(next_id)));
+					++next_id;
+					break;
+				case 1: // delete
+					if (!lines.empty())
+						lines.erase(lines.begin() + rng() % lines.size());
+					break;
+				case 2: // move
+					if (lines.size() > 1) {
+						auto line = lines[rng() % lines.size()];
+						lines.erase(std::find(lines.begin(), lines.end(), line));
+						lines.insert(lines.begin() + rng() % (lines.size() + 1), line);
+					}
+					break;
+				case 3: // edit
+					if (!lines.empty())
+						lines[rng() % lines.size()].second += "x";
+					break;
+				case 4: // sort
+					std::shuffle(lines.begin(), lines.end(), rng);
+					break;
+			}
+		}
+
+		JournalRecord change;
+		diff(change, old_lines, lines);
+		if (!change.empty())
+			append(change);
+
+		std::istringstream in(data);
+		ASSERT_EQ(lines, ReadJournal(in).events) << "after " << i << " commits";
+	}
+}
@@ -195,3 +195,63 @@ TEST(lagi_karaoke_matcher, lookahead_is_case_insensitive) {
 	EXPECT_EQ((karaoke_match_result{1, 3}),
 	          auto_match_karaoke({"Oh... ", "Nan", "ka ", "ta", "ri", "nai"}, "Oh…なんか足りない"));
 }
+
+using agi::auto_match_karaoke_line;
+
+TEST(lagi_karaoke_matcher, line_empty_source_and_dest) {
+	auto res = auto_match_karaoke_line({}, "");
+	EXPECT_TRUE(res.groups.empty());
+	EXPECT_EQ(1.0, res.confidence);
+}
+
+TEST(lagi_karaoke_matcher, line_empty_source_with_dest_is_not_confident) {
+	auto res = auto_match_karaoke_line({}, "ろ");
+	ASSERT_EQ(1u, res.groups.size());
+	EXPECT_EQ(0u, res.groups[0].source_length);
+	EXPECT_EQ("ろ", res.groups[0].destination);
+	EXPECT_EQ(0.0, res.confidence);
+}
+
+TEST(lagi_karaoke_matcher, line_kana_is_matched_exactly) {
+	auto res = auto_match_karaoke_line({"ro", "ma", "ji"}, "ろまじ");
+	ASSERT_EQ(3u, res.groups.size());
+	EXPECT_EQ(1u, res.groups[0].source_length);
+	EXPECT_EQ("ろ", res.groups[0].destination);
+	EXPECT_EQ(1u, res.groups[1].source_length);
+	EXPECT_EQ("ま", res.groups[1].destination);
+	EXPECT_EQ(1u, res.groups[2].source_length);
+	EXPECT_EQ("じ", res.groups[2].destination);
+	EXPECT_EQ(1.0, res.confidence);
+}
+
+TEST(lagi_karaoke_matcher, line_matches_same_as_repeated_single_matches) {
+	auto res = auto_match_karaoke_line({"Bo", "ku", "wa"}, "僕は");
+	ASSERT_EQ(2u, res.groups.size());
+	EXPECT_EQ(2u, res.groups[0].source_length);
+	EXPECT_EQ("僕", res.groups[0].destination);
+	EXPECT_EQ(1u, res.groups[1].source_length);
+	EXPECT_EQ("は", res.groups[1].destination);
+	EXPECT_LT(res.confidence, 1.0);
+	EXPECT_GT(res.confidence, 0.0);
+}
+
+TEST(lagi_karaoke_matcher, line_trailing_dest_whitespace_goes_with_last_group) {
+	auto res = auto_match_karaoke_line({"ro"}, "ろ ");
+	ASSERT_EQ(1u, res.groups.size());
+	EXPECT_EQ(1u, res.groups[0].source_length);
+	EXPECT_EQ("ろ ", res.groups[0].destination);
+	EXPECT_EQ(1.0, res.confidence);
+}
+
+TEST(lagi_karaoke_matcher, line_leftover_dest_is_not_confident) {
+	auto res = auto_match_karaoke_line({"ro"}, "ろまじ");
+	ASSERT_EQ(1u, res.groups.size());
+	EXPECT_EQ(1u, res.groups[0].source_length);
+	EXPECT_EQ("ろまじ", res.groups[0].destination);
+	EXPECT_EQ(0.0, res.confidence);
+}
+
+TEST(lagi_karaoke_matcher, line_running_out_of_dest_is_not_confident) {
+	auto res = auto_match_karaoke_line({"ro", "ma"}, "ろ");
+	EXPECT_EQ(0.0, res.confidence);
+}
@@ -0,0 +1,203 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/io.h>
+#include <libaegisub/log.h>
+
+#include <main.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace agi::log;
+
+namespace {
+SinkMessage make_message(int64_t time, std::string const& text) {
+	SinkMessage sm;
+	sm.message = text;
+	sm.time = time;
+	sm.section = "test/section";
+	sm.file = "file.cpp";
+	sm.func = "func";
+	sm.severity = Info;
+	sm.line = 10;
+	return sm;
+}
+}
+
+TEST(lagi_log, level_filters_less_severe_messages) {
+	LogSink sink;
+	EXPECT_TRUE(sink.IsEnabled("a", Debug));
+	sink.SetLevel(Warning);
+	EXPECT_TRUE(sink.IsEnabled("a", Exception));
+	EXPECT_TRUE(sink.IsEnabled("a", Warning));
+	EXPECT_FALSE(sink.IsEnabled("a", Info));
+	EXPECT_FALSE(sink.IsEnabled("a", Debug));
+}
+
+TEST(lagi_log, disabled_sections_include_subsections) {
+	LogSink sink;
+	sink.SetDisabledSections({"video/provider"});
+	EXPECT_FALSE(sink.IsEnabled("video/provider", Debug));
+	EXPECT_FALSE(sink.IsEnabled("video/provider/ffms", Debug));
+	EXPECT_TRUE(sink.IsEnabled("video/provider_cache", Debug));
+	EXPECT_TRUE(sink.IsEnabled("video", Debug));
+	EXPECT_TRUE(sink.IsEnabled("audio/provider", Debug));
+
+	sink.SetDisabledSections({});
+	EXPECT_TRUE(sink.IsEnabled("video/provider", Debug));
+}
+
+TEST(lagi_log, filtered_message_is_not_evaluated) {
+	agi::log::log->SetLevel(Warning);
+	int evaluated = 0;
+	LOG_D("test") << ++evaluated;
+	agi::log::log->SetLevel(Debug);
+	EXPECT_EQ(0, evaluated);
+}
+
+TEST(lagi_log, messages_from_multiple_threads_are_collected) {
+	LogSink sink;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			// More than fit in one thread's buffer
+			for (int i = 0; i < 300; ++i)
+				sink.Log(make_message(t * 1000 + i, "x"));
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	// Only the most recent 250 are kept
+	EXPECT_EQ(250u, sink.GetMessages().size());
+}
+
+TEST(lagi_log, messages_from_exited_threads_are_kept) {
+	LogSink sink;
+	// Each thread's buffer is freed once the thread has exited, which must
+	// not lose anything it logged
+	for (int t = 0; t < 100; ++t) {
+		std::thread([&, t] {
+			sink.Log(make_message(t * 2, "x"));
+			sink.Log(make_message(t * 2 + 1, "x"));
+		}).join();
+	}
+
+	EXPECT_EQ(200u, sink.GetMessages().size());
+}
+
+TEST(lagi_log, messages_are_kept_in_order) {
+	LogSink sink;
+	for (int i = 0; i < 10; ++i)
+		sink.Log(make_message(i, std::to_string(i)));
+
+	auto messages = sink.GetMessages();
+	ASSERT_EQ(10u, messages.size());
+	for (int i = 0; i < 10; ++i)
+		EXPECT_EQ(std::to_string(i), messages[i].message);
+}
+
+TEST(lagi_log, binary_log_round_trips_through_json) {
+	agi::fs::path dir = "data/binary_log";
+	agi::fs::CreateDirectory(dir);
+	for (auto const& file : agi::fs::DirectoryIterator(dir, "*.agilog"))
+		agi::fs::Remove(dir/file);
+
+	{
+		BinaryEmitter emitter(dir);
+		emitter.log(make_message(5000000000LL, "first"));
+		emitter.log(make_message(4000000000LL, "second"));
+		emitter.log(make_message(4000000001LL, "third"));
+	}
+
+	std::string file;
+	for (auto const& f : agi::fs::DirectoryIterator(dir, "*.agilog"))
+		file = f;
+	ASSERT_FALSE(file.empty());
+
+	std::unique_ptr<std::istream> in(agi::io::Open(dir/file, true));
+	std::ostringstream out;
+	bool complete = false;
+	ASSERT_NO_THROW(complete = ConvertBinaryLog(*in, out));
+	EXPECT_TRUE(complete);
+
+	auto str = out.str();
+	EXPECT_LT(str.find("first"), str.find("second"));
+	EXPECT_LT(str.find("second"), str.find("third"));
+	EXPECT_NE(std::string::npos, str.find("test/section"));
+	EXPECT_NE(std::string::npos, str.find("file.cpp"));
+	EXPECT_NE(std::string::npos, str.find("\"sec\" : 5"));
+	EXPECT_NE(std::string::npos, str.find("\"usec\" : 1"));
+}
+
+TEST(lagi_log, truncated_binary_log_converts_complete_records) {
+	agi::fs::path dir = "data/binary_log_truncated";
+	agi::fs::CreateDirectory(dir);
+	for (auto const& file : agi::fs::DirectoryIterator(dir, "*.agilog"))
+		agi::fs::Remove(dir/file);
+
+	{
+		BinaryEmitter emitter(dir);
+		emitter.log(make_message(1000, "first"));
+		emitter.log(make_message(2000, "second"));
+	}
+
+	std::string file;
+	for (auto const& f : agi::fs::DirectoryIterator(dir, "*.agilog"))
+		file = f;
+	ASSERT_FALSE(file.empty());
+
+	std::string log;
+	{
+		std::unique_ptr<std::istream> in(agi::io::Open(dir/file, true));
+		std::ostringstream contents;
+		contents << in->rdbuf();
+		log = contents.str();
+	}
+
+	// Cut off partway through the text of the last message, as a crash
+	// while writing it would
+	std::istringstream in(log.substr(0, log.size() - 3));
+	std::ostringstream out;
+	bool complete = true;
+	ASSERT_NO_THROW(complete = ConvertBinaryLog(in, out));
+	EXPECT_FALSE(complete);
+
+	auto str = out.str();
+	EXPECT_NE(std::string::npos, str.find("first"));
+	EXPECT_EQ(std::string::npos, str.find("seco"));
+}
+
+TEST(lagi_log, binary_log_rejects_garbage) {
+	std::istringstream in("not a log file");
+	std::ostringstream out;
+	EXPECT_THROW(ConvertBinaryLog(in, out), agi::InvalidInputException);
+}
+
+TEST(lagi_log, binary_log_with_corrupt_string_length_is_truncated) {
+	// A string record claiming to be far longer than the rest of the file
+	std::string log = "AGILOG01";
+	log += '\0'; // RECORD_STRING
+	log += '\0'; // string id
+	log += std::string(8, '\xFF') + '\x7F';
+	log += "abc";
+
+	std::istringstream in(log);
+	std::ostringstream out;
+	bool complete = true;
+	ASSERT_NO_THROW(complete = ConvertBinaryLog(in, out));
+	EXPECT_FALSE(complete);
+}
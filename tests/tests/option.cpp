@@ -220,3 +220,33 @@ TEST_F(lagi_option, color_vs_string) {
 	CHECK_TYPE("&H000000&", Color);
 	CHECK_TYPE("&H00000000", Color);
 }
+
+TEST_F(lagi_option, cached_value_follows_option) {
+	agi::Options opt("", all_types, agi::Options::FLUSH_SKIP);
+
+	agi::CachedOptionValue<int64_t> integer(opt.Get("Integer"));
+	agi::CachedOptionValue<std::string> string(opt.Get("String"));
+	agi::CachedOptionValue<std::vector<bool>> bools(opt.Get("Array/Boolean"));
+	EXPECT_EQ(0, *integer);
+	EXPECT_TRUE(string->empty());
+	EXPECT_EQ(2u, bools->size());
+
+	opt.Get("Integer")->SetInt(10);
+	opt.Get("String")->SetString("hello");
+	opt.Get("Array/Boolean")->SetListBool({true});
+	EXPECT_EQ(10, *integer);
+	EXPECT_EQ("hello", *string);
+	ASSERT_EQ(1u, bools->size());
+	EXPECT_TRUE(bools->front());
+
+	agi::CachedOptionValue<int64_t> copy(integer);
+	opt.Get("Integer")->Reset();
+	EXPECT_EQ(0, *integer);
+	EXPECT_EQ(0, *copy);
+}
+
+TEST_F(lagi_option, cached_value_wrong_type) {
+	agi::Options opt("", all_types, agi::Options::FLUSH_SKIP);
+	EXPECT_THROW(agi::CachedOptionValue<bool>(opt.Get("Integer")), agi::InternalError);
+	EXPECT_THROW(agi::CachedOptionValue<double>(opt.Get("Array/Double")), agi::InternalError);
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <libaegisub/sequence_match.h>
+
+#include <main.h>
+
+#include <random>
+
+using agi::MatchSequences;
+using agi::sequence_match;
+
+namespace {
+typedef std::vector<uint64_t> seq;
+
+void check_valid(seq const& a, seq const& b, std::vector<sequence_match> const& m) {
+	for (size_t i = 0; i < m.size(); ++i) {
+		ASSERT_LT(m[i].first, a.size());
+		ASSERT_LT(m[i].second, b.size());
+		EXPECT_EQ(a[m[i].first], b[m[i].second]);
+		if (i > 0) {
+			EXPECT_LT(m[i - 1].first, m[i].first);
+			EXPECT_LT(m[i - 1].second, m[i].second);
+		}
+	}
+}
+
+size_t lcs_length(seq const& a, seq const& b) {
+	std::vector<std::vector<size_t>> t(a.size() + 1, std::vector<size_t>(b.size() + 1));
+	for (size_t i = 1; i <= a.size(); ++i) {
+		for (size_t j = 1; j <= b.size(); ++j)
+			t[i][j] = a[i - 1] == b[j - 1] ? t[i - 1][j - 1] + 1 : std::max(t[i - 1][j], t[i][j - 1]);
+	}
+	return t[a.size()][b.size()];
+}
+}
+
+TEST(lagi_sequence_match, empty) {
+	EXPECT_TRUE(MatchSequences(seq(), seq()).empty());
+	EXPECT_TRUE(MatchSequences(seq{1, 2}, seq()).empty());
+	EXPECT_TRUE(MatchSequences(seq(), seq{1, 2}).empty());
+}
+
+TEST(lagi_sequence_match, identical) {
+	seq a{1, 2, 3, 2, 1};
+	auto m = MatchSequences(a, a);
+	ASSERT_EQ(5u, m.size());
+	for (size_t i = 0; i < m.size(); ++i)
+		EXPECT_EQ(sequence_match(i, i), m[i]);
+}
+
+TEST(lagi_sequence_match, insert_and_delete) {
+	auto m = MatchSequences(seq{1, 2, 3, 4}, seq{1, 5, 2, 4});
+	ASSERT_EQ(3u, m.size());
+	EXPECT_EQ(sequence_match(0, 0), m[0]);
+	EXPECT_EQ(sequence_match(1, 2), m[1]);
+	EXPECT_EQ(sequence_match(3, 3), m[2]);
+}
+
+TEST(lagi_sequence_match, unique_lines_anchor_moved_blocks) {
+	// The repeated 0s shouldn't pull the alignment away from the unique lines
+	seq a{10, 0, 0, 11, 0, 12, 0, 0};
+	seq b{0, 10, 0, 0, 11, 12, 0};
+	auto m = MatchSequences(a, b);
+	check_valid(a, b, m);
+	EXPECT_NE(m.end(), std::find(m.begin(), m.end(), sequence_match(0, 1)));
+	EXPECT_NE(m.end(), std::find(m.begin(), m.end(), sequence_match(3, 4)));
+	EXPECT_NE(m.end(), std::find(m.begin(), m.end(), sequence_match(5, 5)));
+}
+
+TEST(lagi_sequence_match, no_unique_elements_is_minimal) {
+	std::mt19937 rng(7);
+	for (int iter = 0; iter < 200; ++iter) {
+		seq a(rng() % 20), b(rng() % 20);
+		for (auto& x : a) x = rng() % 3;
+		for (auto& x : b) x = rng() % 3;
+		auto m = MatchSequences(a, b);
+		check_valid(a, b, m);
+	}
+
+	// With nothing unique it's plain Myers, which is minimal
+	seq a{1, 1, 2, 2, 1, 2, 1, 1};
+	seq b{2, 1, 1, 2, 1, 2, 2, 1};
+	EXPECT_EQ(lcs_length(a, b), MatchSequences(a, b).size());
+}
+
+TEST(lagi_sequence_match, random_edits) {
+	std::mt19937 rng(1);
+	for (int iter = 0; iter < 100; ++iter) {
+		seq a(rng() % 200);
+		for (auto& x : a) x = rng() % 50;
+
+		seq b = a;
+		for (int edits = rng() % 10; edits > 0 && !b.empty(); --edits) {
+			size_t pos = rng() % b.size();
+			switch (rng() % 3) {
+				case 0: b.erase(b.begin() + pos); break;
+				case 1: b.insert(b.begin() + pos, rng() % 50); break;
+				case 2: b[pos] = rng() % 50; break;
+			}
+		}
+
+		auto m = MatchSequences(a, b);
+		check_valid(a, b, m);
+		// A handful of edits should leave almost everything matched
+		EXPECT_GE(m.size() + 20, std::min(a.size(), b.size()));
+	}
+}
+
+TEST(lagi_sequence_match, large_input) {
+	seq a(50000);
+	for (size_t i = 0; i < a.size(); ++i) a[i] = i;
+	seq b = a;
+	b.erase(b.begin() + 100, b.begin() + 200);
+	b.insert(b.begin() + 30000, 1000000);
+	b[40000] = 2000000;
+
+	auto m = MatchSequences(a, b);
+	check_valid(a, b, m);
+	EXPECT_EQ(a.size() - 101, m.size());
+}
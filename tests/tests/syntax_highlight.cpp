@@ -17,6 +17,8 @@
 
 #include <main.h>
 
+#include <random>
+
 class MockSpellChecker : public agi::SpellChecker {
 	void AddWord(std::string const&) override { }
 	void RemoveWord(std::string const&) override { }
@@ -261,3 +263,55 @@ TEST(lagi_syntax, multiple_templater_expressions) {
 		expect_style(ss::KARAOKE_TEMPLATE, 3u);
 	);
 }
+
+TEST(lagi_syntax, incremental) {
+	MockSpellChecker spellchecker;
+	DialogueHighlighter highlighter;
+	std::mt19937 rng(3);
+	const char *snippets[] = {"{", "}", "\\", "p1", "p0", "b1", "fn", "(", ",", ")", " ", "\\N", "$x", "!", "a", "incorrect", "correct", "m 10 10", "\\fnA B", "\\pos(1, 2)"};
+
+	for (int line = 0; line < 100; ++line) {
+		std::string text;
+		highlighter.Reset();
+		highlighter.Update(text, line % 4 == 0, &spellchecker);
+		// Style of each byte of the line, updated only where Update says the
+		// styles changed, as an edit control would be
+		std::vector<int> byte_styles;
+
+		for (int edit = 0; edit < 50; ++edit) {
+			size_t pos = text.empty() ? 0 : rng() % (text.size() + 1);
+			size_t erase = std::min<size_t>(rng() % 3, text.size() - pos);
+			std::string insert = rng() % 4 ? snippets[rng() % (sizeof snippets / sizeof *snippets)] : "";
+
+			text.replace(pos, erase, insert);
+			byte_styles.erase(byte_styles.begin() + pos, byte_styles.begin() + pos + erase);
+			byte_styles.insert(byte_styles.begin() + pos, insert.size(), -1);
+
+			auto range = highlighter.Update(text, line % 4 == 0, &spellchecker, pos, text.size() - pos - insert.size());
+			ASSERT_LE(range.first, range.second);
+			ASSERT_LE(range.second, text.size());
+
+			size_t tok_pos = 0;
+			for (auto style : highlighter.GetStyles()) {
+				for (size_t i = tok_pos; i < tok_pos + style.length; ++i) {
+					if (i >= range.first && i < range.second)
+						byte_styles[i] = style.type;
+				}
+				tok_pos += style.length;
+			}
+
+			auto tokens = TokenizeDialogueBody(text, line % 4 == 0);
+			SplitWords(text, tokens);
+			ASSERT_EQ(tokens.size(), highlighter.GetTokens().size()) << text;
+			for (size_t i = 0; i < tokens.size(); ++i) {
+				EXPECT_EQ(tokens[i].type, highlighter.GetTokens()[i].type) << text;
+				EXPECT_EQ(tokens[i].length, highlighter.GetTokens()[i].length) << text;
+			}
+
+			std::vector<int> expected;
+			for (auto style : SyntaxHighlight(text, tokens, &spellchecker))
+				expected.insert(expected.end(), style.length, style.type);
+			ASSERT_EQ(expected, byte_styles) << text;
+		}
+	}
+}
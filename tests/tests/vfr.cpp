@@ -17,6 +17,7 @@
 #include <libaegisub/fs.h>
 #include <libaegisub/vfr.h>
 
+#include <algorithm>
 #include <climits>
 #include <fstream>
 #include <iterator>
@@ -767,3 +768,38 @@ TEST(lagi_vfr, from_smpte_ntsc_nodrop) {
 		++f;
 	}
 }
+
+TEST(lagi_vfr, frames_at_times_matches_frame_at_time) {
+	std::vector<int> times;
+	for (int ms = -200; ms < 1200; ms += 7)
+		times.push_back(ms);
+	std::vector<int> unsorted(times.rbegin(), times.rend());
+
+	for (auto const& fps : {Framerate(23.976), Framerate({0, 10, 11, 50, 50, 51, 400, 1000})}) {
+		for (Time type : {EXACT, START, END}) {
+			auto frames = fps.FramesAtTimes(times, type);
+			ASSERT_EQ(times.size(), frames.size());
+			for (size_t i = 0; i < times.size(); ++i)
+				EXPECT_EQ(fps.FrameAtTime(times[i], type), frames[i]) << times[i];
+
+			frames = fps.FramesAtTimes(unsorted, type);
+			for (size_t i = 0; i < unsorted.size(); ++i)
+				EXPECT_EQ(fps.FrameAtTime(unsorted[i], type), frames[i]) << unsorted[i];
+		}
+	}
+
+	// A few widely spaced times over many timecodes, with repeats
+	std::vector<int> long_timecodes;
+	for (int i = 0; i < 5000; ++i)
+		long_timecodes.push_back(i * 40 + (i % 3 == 0 ? 0 : 1) - (i % 7 == 0 ? 1 : 0));
+	std::sort(long_timecodes.begin(), long_timecodes.end());
+	Framerate long_fps(long_timecodes);
+	std::vector<int> sparse{-5, 0, 39, 40, 41, 1000, 1001, 1002, 77777, 150000, 150001, 199959, 199999, 200100, 250000};
+	for (Time type : {EXACT, START, END}) {
+		auto frames = long_fps.FramesAtTimes(sparse, type);
+		for (size_t i = 0; i < sparse.size(); ++i)
+			EXPECT_EQ(long_fps.FrameAtTime(sparse[i], type), frames[i]) << sparse[i];
+	}
+
+	EXPECT_TRUE(Framerate(25.).FramesAtTimes(std::vector<int>()).empty());
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2026, Aegisub Project
+//
+// Permission to use, copy, modify, and distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <libaegisub/dispatch.h>
+#include <libaegisub/exception.h>
+#include <libaegisub/fs.h>
+#include <libaegisub/io.h>
+#include <libaegisub/log.h>
+
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		printf("usage: aegisub-convert-binary-log <log.agilog>...\n");
+		printf("Writes <log>.json next to each binary log file\n");
+		return 1;
+	}
+	agi::dispatch::Init([](agi::dispatch::Thunk f) { });
+	agi::log::log = new agi::log::LogSink;
+
+	int ret = 0;
+	for (int i = 1; i < argc; ++i) {
+		agi::fs::path path(argv[i]);
+		try {
+			std::unique_ptr<std::istream> in(agi::io::Open(path, true));
+			agi::io::Save out(agi::fs::path(path).replace_extension(".json"));
+			if (!agi::log::ConvertBinaryLog(*in, out.Get()))
+				fprintf(stderr, "%s: warning: log ends with an incomplete record, which was skipped\n", argv[i]);
+			out.Commit();
+		}
+		catch (agi::Exception const& e) {
+			fprintf(stderr, "%s: %s\n", argv[i], e.GetMessage().c_str());
+			ret = 1;
+		}
+	}
+
+	delete agi::log::log;
+	return ret;
+}
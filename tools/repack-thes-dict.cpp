@@ -74,6 +74,9 @@ void convert(std::string const& path) {
 	}
 
 	idx_out.Get() << entry_count << '\n' << idx_out_buffer.str();
+
+	idx_out.Commit();
+	dat_out.Commit();
 }
 
 }